@@ -26,6 +26,12 @@ import icalRoutes from './routes/ical.routes';
 import calendarTokenRoutes from './routes/calendar-token.routes';
 import { ldapScheduler } from './services/ldap-scheduler.service';
 import { imapManager } from './services/imap.service';
+import { deviceLastSeen } from './services/device-last-seen.service';
+import { deviceTelemetry } from './services/device-telemetry.service';
+import { mqttBridge } from './services/mqtt.service';
+import { deviceApiAdmission } from './middleware/admission.middleware';
+import { gatewayParkOf } from './middleware/gateway.middleware';
+import gatewayRoutes from './routes/gateway.routes';
 
 const app = express();
 const PORT = process.env.PORT || 3001;
@@ -58,9 +64,12 @@ app.use(cors({
   origin: allowedOrigins,
   credentials: true,
   methods: ['GET', 'POST', 'PUT', 'DELETE', 'OPTIONS'],
-  allowedHeaders: ['Content-Type', 'Authorization', 'X-Device-Token'],
+  allowedHeaders: ['Content-Type', 'Authorization', 'X-Device-Token', 'X-Config-Version'],
+  exposedHeaders: ['Retry-After', 'X-Poll-Interval'],
 }));
 
+// Gateway status requests list every room of a site
+app.use('/api/gateway', express.json({ limit: '1mb' }));
 app.use(express.json({ limit: '10kb' }));
 app.use(express.urlencoded({ extended: true, limit: '100kb' })); // For SAML POST binding
 
@@ -71,6 +80,8 @@ const globalLimiter = rateLimit({
   standardHeaders: true,
   legacyHeaders: false,
   message: { error: 'Too many requests, please try again later.' },
+  // An edge gateway sends the requests of a whole site from one address
+  skip: (req) => gatewayParkOf(req) !== null,
 });
 app.use('/api/', globalLimiter);
 
@@ -95,7 +106,8 @@ app.use('/api/rooms', roomRoutes);
 app.use('/api/bookings', bookingRoutes);
 app.use('/api/settings', settingsRoutes);
 app.use('/api/devices', deviceRoutes);
-app.use('/api/device', deviceApiRoutes);
+app.use('/api/device', deviceApiAdmission, deviceApiRoutes);
+app.use('/api/gateway', gatewayRoutes);
 app.use('/api/firmware', firmwareRoutes);
 app.use('/api/statistics', statisticsRoutes);
 app.use('/api/receptionist', receptionistRoutes);
@@ -124,10 +136,30 @@ async function start() {
   await initializeDatabase();
   await ldapScheduler.start();
   await imapManager.start();
+  deviceLastSeen.start();
+  deviceTelemetry.start();
+  mqttBridge.start();
 
-  app.listen(PORT, () => {
+  const server = app.listen(PORT, () => {
     console.log(`Open Meeting API server running on port ${PORT}`);
   });
+
+  // Write what the write-behind services still hold before the process exits
+  let stopping = false;
+  const shutdown = async (signal: string) => {
+    if (stopping) return;
+    stopping = true;
+    console.log(`${signal} received, shutting down`);
+    server.close();
+    try {
+      await Promise.all([deviceLastSeen.stop(), deviceTelemetry.stop()]);
+    } catch (err) {
+      console.error('Error during shutdown:', err);
+    }
+    process.exit(0);
+  };
+  process.on('SIGTERM', () => shutdown('SIGTERM'));
+  process.on('SIGINT', () => shutdown('SIGINT'));
 }
 
 start().catch((err) => {
@@ -0,0 +1,147 @@
+import { Request, Response, NextFunction } from 'express';
+
+// Admission control for the device API. After an outage every panel
+// reconnects at once; without a limit those requests pile onto the database
+// and slow down the web app sharing this backend. At most maxConcurrent
+// device requests run at a time and up to maxQueue wait for a slot, for at
+// most maxQueueMs. The rest are shed with 503, a Retry-After spread out with
+// jitter so panels don't come back in lockstep, and X-Poll-Interval asking
+// them to poll less often until the load has passed.
+
+interface AdmissionOptions {
+  maxConcurrent: number;
+  maxQueue: number;
+  maxQueueMs: number;
+  retryAfterSeconds: number;    // Base; doubles as the queue fills, plus jitter
+  overloadPollSeconds: number;  // Poll interval hint while overloaded
+  isInteractive: (req: Request) => boolean;  // Served ahead of the rest when queued
+}
+
+interface Waiter {
+  admit: () => void;
+  timer: NodeJS.Timeout;
+}
+
+export class AdmissionController {
+  private active = 0;
+  // Panel taps (quick-book, end-meeting) are served before polls
+  private interactive: Waiter[] = [];
+  private background: Waiter[] = [];
+  private shedCount = 0;
+
+  constructor(private options: AdmissionOptions) {}
+
+  middleware = (req: Request, res: Response, next: NextFunction): void => {
+    if (this.active < this.options.maxConcurrent) {
+      this.admit(res, next, false);
+      return;
+    }
+
+    const queued = this.interactive.length + this.background.length;
+    if (queued >= this.options.maxQueue) {
+      this.shed(res);
+      return;
+    }
+
+    const queue = this.options.isInteractive(req) ? this.interactive : this.background;
+    const waiter: Waiter = {
+      admit: () => this.admit(res, next, true),
+      timer: setTimeout(() => {
+        this.remove(queue, waiter);
+        this.shed(res);
+      }, this.options.maxQueueMs),
+    };
+    queue.push(waiter);
+
+    // Don't hold a slot for a panel that gave up while waiting
+    res.on('close', () => {
+      if (this.remove(queue, waiter)) clearTimeout(waiter.timer);
+    });
+  };
+
+  stats(): { active: number; queued: number; shed: number } {
+    return {
+      active: this.active,
+      queued: this.interactive.length + this.background.length,
+      shed: this.shedCount,
+    };
+  }
+
+  private admit(res: Response, next: NextFunction, waited: boolean): void {
+    this.active++;
+    // Requests that had to queue tell the panel to back off its polling too
+    if (waited) res.set('X-Poll-Interval', String(this.options.overloadPollSeconds));
+
+    let released = false;
+    const release = () => {
+      if (released) return;
+      released = true;
+      this.active--;
+      this.next();
+    };
+    res.on('finish', release);
+    res.on('close', release);
+    next();
+  }
+
+  private next(): void {
+    const waiter = this.interactive.shift() ?? this.background.shift();
+    if (!waiter) return;
+    clearTimeout(waiter.timer);
+    waiter.admit();
+  }
+
+  private remove(queue: Waiter[], waiter: Waiter): boolean {
+    const index = queue.indexOf(waiter);
+    if (index < 0) return false;
+    queue.splice(index, 1);
+    return true;
+  }
+
+  private shed(res: Response): void {
+    if (res.headersSent || res.writableEnded) return;
+    this.shedCount++;
+
+    const { maxQueue, retryAfterSeconds, overloadPollSeconds } = this.options;
+    const fill = Math.min(1, (this.interactive.length + this.background.length) / Math.max(1, maxQueue));
+    const retryAfter = Math.round(retryAfterSeconds * (1 + fill) + Math.random() * retryAfterSeconds);
+
+    res.set('Retry-After', String(retryAfter));
+    res.set('X-Poll-Interval', String(overloadPollSeconds));
+    res.status(503).json({
+      error: 'Server busy, please retry later',
+      retryAfterSeconds: retryAfter,
+      pollIntervalSeconds: overloadPollSeconds,
+    });
+  }
+}
+
+export const deviceAdmission = new AdmissionController({
+  maxConcurrent: parseInt(process.env.DEVICE_API_MAX_CONCURRENT ?? '16', 10),
+  maxQueue: parseInt(process.env.DEVICE_API_MAX_QUEUE ?? '64', 10),
+  maxQueueMs: parseInt(process.env.DEVICE_API_QUEUE_MS ?? '2000', 10),
+  retryAfterSeconds: parseInt(process.env.DEVICE_API_RETRY_AFTER_SECONDS ?? '10', 10),
+  overloadPollSeconds: parseInt(process.env.DEVICE_API_OVERLOAD_POLL_SECONDS ?? '120', 10),
+  // Panel taps; polls, reports and telemetry uploads can wait
+  isInteractive: (req) => req.path === '/quick-book' || req.path === '/end-meeting',
+});
+
+// Firmware downloads hold their slot for the whole transfer, which over a
+// slow panel link takes far longer than any other device request. They get
+// their own small limit so an OTA rollout can't starve the polls, and don't
+// queue: a busy server sheds them and the panel tries at its next check.
+export const firmwareAdmission = new AdmissionController({
+  maxConcurrent: parseInt(process.env.DEVICE_FIRMWARE_MAX_CONCURRENT ?? '4', 10),
+  maxQueue: 0,
+  maxQueueMs: 0,
+  retryAfterSeconds: parseInt(process.env.DEVICE_API_RETRY_AFTER_SECONDS ?? '10', 10),
+  overloadPollSeconds: parseInt(process.env.DEVICE_API_OVERLOAD_POLL_SECONDS ?? '120', 10),
+  isInteractive: () => false,
+});
+
+// Mounted on /api/device: firmware downloads to their own limit, the rest to
+// deviceAdmission
+export function deviceApiAdmission(req: Request, res: Response, next: NextFunction): void {
+  const controller = req.path.startsWith('/firmware/download/') ? firmwareAdmission : deviceAdmission;
+  controller.middleware(req, res, next);
+}
@@ -0,0 +1,39 @@
+import crypto from 'crypto';
+import { Request, Response, NextFunction } from 'express';
+
+// Edge gateways: a box on a site's LAN that answers the site's panels and
+// talks to this backend on their behalf (device/tools/gateway). Each gateway
+// has a token and serves one park, configured as
+// GATEWAY_TOKENS=<token>:<parkId>,<token>:<parkId>
+
+export interface GatewayRequest extends Request {
+  gatewayParkId?: string;
+}
+
+const gateways: { token: Buffer; parkId: string }[] = (process.env.GATEWAY_TOKENS ?? '')
+  .split(',')
+  .map(entry => entry.trim())
+  .filter(entry => entry.includes(':'))
+  .map(entry => {
+    const at = entry.lastIndexOf(':');
+    return { token: Buffer.from(entry.slice(0, at)), parkId: entry.slice(at + 1) };
+  });
+
+/** Park of the gateway a request came through, if it carries a valid X-Gateway-Token */
+export function gatewayParkOf(req: Request): string | null {
+  const header = req.headers['x-gateway-token'];
+  if (typeof header !== 'string' || !header) return null;
+  const token = Buffer.from(header);
+  const match = gateways.find(g => g.token.length === token.length && crypto.timingSafeEqual(g.token, token));
+  return match ? match.parkId : null;
+}
+
+export function authenticateGateway(req: GatewayRequest, res: Response, next: NextFunction): void {
+  const parkId = gatewayParkOf(req);
+  if (!parkId) {
+    res.status(401).json({ error: 'Invalid gateway token' });
+    return;
+  }
+  req.gatewayParkId = parkId;
+  next();
+}
@@ -0,0 +1,21 @@
+import { Knex } from 'knex';
+
+export async function up(knex: Knex): Promise<void> {
+  if (!(await knex.schema.hasColumn('settings', 'device_config'))) {
+    await knex.schema.alterTable('settings', (table) => {
+      // JSON object of the values display devices should override; version 0
+      // means devices run their firmware defaults
+      table.text('device_config').nullable();
+      table.integer('device_config_version').notNullable().defaultTo(0);
+    });
+  }
+}
+
+export async function down(knex: Knex): Promise<void> {
+  if (await knex.schema.hasColumn('settings', 'device_config')) {
+    await knex.schema.alterTable('settings', (table) => {
+      table.dropColumn('device_config');
+      table.dropColumn('device_config_version');
+    });
+  }
+}
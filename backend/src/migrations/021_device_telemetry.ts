@@ -0,0 +1,34 @@
+import { Knex } from 'knex';
+
+export async function up(knex: Knex): Promise<void> {
+  if (!(await knex.schema.hasTable('device_telemetry'))) {
+    await knex.schema.createTable('device_telemetry', (table) => {
+      // One row per device and bucket: 60 s buckets from ingest, rolled up
+      // into 3600 s and 86400 s buckets. Sums and counts so rows of any
+      // resolution can be merged again by aggregating.
+      table.increments('id').primary();
+      table.string('device_id').notNullable().references('id').inTable('devices').onDelete('CASCADE');
+      table.integer('resolution').notNullable(); // Bucket length in seconds
+      table.string('bucket_start').notNullable(); // ISO, UTC
+      table.integer('samples').notNullable().defaultTo(0);
+      table.integer('polls').notNullable().defaultTo(0);
+      table.integer('poll_errors').notNullable().defaultTo(0);
+      table.bigInteger('poll_ms_sum').notNullable().defaultTo(0);
+      table.integer('poll_ms_max').notNullable().defaultTo(0);
+      table.integer('heap_min').nullable(); // Lowest free heap in bytes
+      table.integer('rssi_sum').notNullable().defaultTo(0);
+      table.integer('rssi_samples').notNullable().defaultTo(0); // Samples taken while connected
+      table.integer('rssi_min').nullable();
+      table.integer('redraws').notNullable().defaultTo(0);
+      table.bigInteger('redraw_ms_sum').notNullable().defaultTo(0);
+      table.integer('redraw_ms_max').notNullable().defaultTo(0);
+      table.integer('reboots').notNullable().defaultTo(0);
+      table.index(['resolution', 'bucket_start'], 'idx_device_telemetry_bucket');
+      table.index(['device_id', 'resolution', 'bucket_start'], 'idx_device_telemetry_device');
+    });
+  }
+}
+
+export async function down(knex: Knex): Promise<void> {
+  await knex.schema.dropTableIfExists('device_telemetry');
+}
@@ -0,0 +1,171 @@
+import { getDb } from './database';
+import { DeviceTelemetryBucket, DeviceTelemetryMetric, DeviceTelemetrySummary } from '../types';
+
+// Rows per insert (16 bindings each, under MSSQL's 2100 limit)
+const INSERT_BATCH_SIZE = 100;
+
+// Aggregates that merge rows of any resolution into one
+const AGGREGATE_COLUMNS = [
+  'SUM(t.samples) as samples', 'SUM(t.polls) as polls', 'SUM(t.poll_errors) as poll_errors',
+  'SUM(t.poll_ms_sum) as poll_ms_sum', 'MAX(t.poll_ms_max) as poll_ms_max',
+  'MIN(t.heap_min) as heap_min', 'SUM(t.rssi_sum) as rssi_sum', 'SUM(t.rssi_samples) as rssi_samples',
+  'MIN(t.rssi_min) as rssi_min', 'SUM(t.redraws) as redraws', 'SUM(t.redraw_ms_sum) as redraw_ms_sum',
+  'MAX(t.redraw_ms_max) as redraw_ms_max', 'SUM(t.reboots) as reboots',
+];
+
+export class DeviceTelemetryModel {
+  static async insertBuckets(buckets: DeviceTelemetryBucket[]): Promise<void> {
+    const db = getDb();
+    for (let i = 0; i < buckets.length; i += INSERT_BATCH_SIZE) {
+      await db('device_telemetry').insert(buckets.slice(i, i + INSERT_BATCH_SIZE).map(b => this.mapBucketToRow(b)));
+    }
+  }
+
+  /**
+   * Rebuild the `resolution` buckets starting at bucketStart from the finer
+   * rows inside them. Safe to repeat: existing rows for the bucket are
+   * replaced, so a bucket can be rolled up again when late samples arrive.
+   */
+  static async rollup(fromResolution: number, resolution: number, bucketStart: Date): Promise<void> {
+    const db = getDb();
+    const start = bucketStart.toISOString();
+    const end = new Date(bucketStart.getTime() + resolution * 1000).toISOString();
+
+    await db.transaction(async (trx) => {
+      const rows = await trx('device_telemetry as t')
+        .select('t.device_id', ...AGGREGATE_COLUMNS.map(c => trx.raw(c)))
+        .where('t.resolution', fromResolution)
+        .andWhere('t.bucket_start', '>=', start)
+        .andWhere('t.bucket_start', '<', end)
+        .groupBy('t.device_id');
+
+      await trx('device_telemetry')
+        .where('resolution', resolution)
+        .andWhere('bucket_start', start)
+        .del();
+
+      const buckets = rows.map((row: any) => this.mapRowToBucket({ ...row, resolution, bucket_start: start }));
+      for (let i = 0; i < buckets.length; i += INSERT_BATCH_SIZE) {
+        await trx('device_telemetry').insert(buckets.slice(i, i + INSERT_BATCH_SIZE).map(b => this.mapBucketToRow(b)));
+      }
+    });
+  }
+
+  static async deleteOlderThan(resolution: number, before: Date): Promise<number> {
+    const db = getDb();
+    return db('device_telemetry')
+      .where('resolution', resolution)
+      .andWhere('bucket_start', '<', before.toISOString())
+      .del();
+  }
+
+  /**
+   * Per-device summary of the rows of one resolution since `since`, worst
+   * first by `metric`. Park admins pass their park to see only its panels.
+   */
+  static async findWorst(options: {
+    resolution: number;
+    since: Date;
+    metric: DeviceTelemetryMetric;
+    limit: number;
+    parkId?: string;
+  }): Promise<DeviceTelemetrySummary[]> {
+    const db = getDb();
+    let query = db('device_telemetry as t')
+      .join('devices as d', 't.device_id', 'd.id')
+      .leftJoin('meeting_rooms as r', 'd.room_id', 'r.id')
+      .select(
+        't.device_id', 'd.name as device_name', 'r.name as room_name',
+        'd.firmware_version', 'd.last_seen_at',
+        ...AGGREGATE_COLUMNS.map(c => db.raw(c))
+      )
+      .where('t.resolution', options.resolution)
+      .andWhere('t.bucket_start', '>=', options.since.toISOString())
+      .andWhere('d.is_active', true);
+
+    if (options.parkId) {
+      query = query.andWhere('r.park_id', options.parkId);
+    }
+
+    const rows = await query.groupBy('t.device_id', 'd.name', 'r.name', 'd.firmware_version', 'd.last_seen_at');
+    const summaries = rows.map((row: any) => this.mapRowToSummary(row));
+    return summaries.sort((a, b) => this.badness(b, options.metric) - this.badness(a, options.metric)).slice(0, options.limit);
+  }
+
+  // Higher is worse; panels with no data for the metric sort last
+  private static badness(s: DeviceTelemetrySummary, metric: DeviceTelemetryMetric): number {
+    switch (metric) {
+      case 'poll': return s.pollMsAvg ?? -Infinity;
+      case 'errors': return s.polls > 0 ? s.pollErrorRate : -Infinity;
+      case 'heap': return s.heapMin !== null ? -s.heapMin : -Infinity;
+      case 'rssi': return s.rssiAvg !== null ? -s.rssiAvg : -Infinity;
+      case 'redraw': return s.redrawMsAvg ?? -Infinity;
+      case 'reboots': return s.reboots;
+    }
+  }
+
+  private static mapBucketToRow(b: DeviceTelemetryBucket): Record<string, unknown> {
+    return {
+      device_id: b.deviceId,
+      resolution: b.resolution,
+      bucket_start: b.bucketStart,
+      samples: b.samples,
+      polls: b.polls,
+      poll_errors: b.pollErrors,
+      poll_ms_sum: b.pollMsSum,
+      poll_ms_max: b.pollMsMax,
+      heap_min: b.heapMin,
+      rssi_sum: b.rssiSum,
+      rssi_samples: b.rssiSamples,
+      rssi_min: b.rssiMin,
+      redraws: b.redraws,
+      redraw_ms_sum: b.redrawMsSum,
+      redraw_ms_max: b.redrawMsMax,
+      reboots: b.reboots,
+    };
+  }
+
+  // Postgres returns SUM() of bigint columns as strings
+  private static mapRowToBucket(row: any): DeviceTelemetryBucket {
+    return {
+      deviceId: row.device_id,
+      resolution: Number(row.resolution),
+      bucketStart: row.bucket_start,
+      samples: Number(row.samples),
+      polls: Number(row.polls),
+      pollErrors: Number(row.poll_errors),
+      pollMsSum: Number(row.poll_ms_sum),
+      pollMsMax: Number(row.poll_ms_max),
+      heapMin: row.heap_min !== null ? Number(row.heap_min) : null,
+      rssiSum: Number(row.rssi_sum),
+      rssiSamples: Number(row.rssi_samples),
+      rssiMin: row.rssi_min !== null ? Number(row.rssi_min) : null,
+      redraws: Number(row.redraws),
+      redrawMsSum: Number(row.redraw_ms_sum),
+      redrawMsMax: Number(row.redraw_ms_max),
+      reboots: Number(row.reboots),
+    };
+  }
+
+  private static mapRowToSummary(row: any): DeviceTelemetrySummary {
+    const b = this.mapRowToBucket(row);
+    return {
+      deviceId: row.device_id,
+      deviceName: row.device_name,
+      roomName: row.room_name ?? null,
+      firmwareVersion: row.firmware_version ?? null,
+      lastSeenAt: row.last_seen_at ?? null,
+      samples: b.samples,
+      polls: b.polls,
+      pollErrorRate: b.polls > 0 ? b.pollErrors / b.polls : 0,
+      pollMsAvg: b.polls > b.pollErrors ? Math.round(b.pollMsSum / (b.polls - b.pollErrors)) : null,
+      pollMsMax: b.pollMsMax,
+      heapMin: b.heapMin,
+      rssiAvg: b.rssiSamples > 0 ? Math.round(b.rssiSum / b.rssiSamples) : null,
+      rssiMin: b.rssiMin,
+      redrawMsAvg: b.redraws > 0 ? Math.round(b.redrawMsSum / b.redraws) : null,
+      redrawMsMax: b.redrawMsMax,
+      reboots: b.reboots,
+    };
+  }
+}
@@ -3,7 +3,17 @@ import crypto from 'crypto';
 import { getDb } from './database';
 import { Device, DeviceWithRoom, CreateDeviceRequest, MeetingRoom } from '../types';
 
+// How long an authenticated device (with its room) is served from memory.
+// Edits made through this model drop the entry at once; the TTL bounds how
+// stale anything changed behind its back can get.
+const TOKEN_CACHE_TTL_MS = parseInt(process.env.DEVICE_TOKEN_CACHE_TTL_SECONDS ?? '30', 10) * 1000;
+
+// Rows per batched last-seen UPDATE (2 bindings each, under every driver's limit)
+const LAST_SEEN_BATCH_SIZE = 200;
+
 export class DeviceModel {
+  private static tokenCache = new Map<string, { device: DeviceWithRoom; expiresAt: number }>();
+
   private static generateToken(): string {
     return crypto.randomBytes(32).toString('hex');
   }
@@ -79,6 +89,42 @@ export class DeviceModel {
     return this.mapRowToDeviceWithRoom(row);
   }
 
+  /**
+   * findByTokenWithRoom() behind the token cache, for device API requests.
+   * The returned object is shared between requests and must not be modified.
+   */
+  static async findByTokenWithRoomCached(token: string): Promise<DeviceWithRoom | null> {
+    const now = Date.now();
+    const cached = this.tokenCache.get(token);
+    if (cached && cached.expiresAt > now) return cached.device;
+
+    const device = await this.findByTokenWithRoom(token);
+    if (device) {
+      this.tokenCache.set(token, { device, expiresAt: now + TOKEN_CACHE_TTL_MS });
+    } else {
+      this.tokenCache.delete(token);
+    }
+    return device;
+  }
+
+  /** Drop cached entries for a device (all devices when no id is given) */
+  static invalidateCache(id?: string): void {
+    if (!id) {
+      this.tokenCache.clear();
+      return;
+    }
+    for (const [token, entry] of this.tokenCache) {
+      if (entry.device.id === id) this.tokenCache.delete(token);
+    }
+  }
+
+  /** Drop cached entries for every device in a room, after the room changed */
+  static invalidateRoomCache(roomId: string): void {
+    for (const [token, entry] of this.tokenCache) {
+      if (entry.device.roomId === roomId) this.tokenCache.delete(token);
+    }
+  }
+
   static async findAll(includeInactive = false): Promise<DeviceWithRoom[]> {
     const db = getDb();
     let query = db('devices as d')
@@ -132,6 +178,7 @@ export class DeviceModel {
       is_active: data.isActive !== undefined ? data.isActive : existing.isActive,
       updated_at: now,
     });
+    this.invalidateCache(id);
 
     return this.findById(id);
   }
@@ -148,6 +195,7 @@ export class DeviceModel {
       token: newToken,
       updated_at: now,
     });
+    this.invalidateCache(id);
 
     return this.findById(id);
   }
@@ -159,9 +207,24 @@ export class DeviceModel {
     });
   }
 
+  /** Write many last-seen timestamps (device id -> ISO time), one UPDATE per batch */
+  static async updateLastSeenBatch(lastSeen: Map<string, string>): Promise<void> {
+    const db = getDb();
+    const entries = Array.from(lastSeen.entries());
+    for (let i = 0; i < entries.length; i += LAST_SEEN_BATCH_SIZE) {
+      const batch = entries.slice(i, i + LAST_SEEN_BATCH_SIZE);
+      const cases = batch.map(() => 'WHEN ? THEN ?').join(' ');
+      const bindings = batch.flatMap(([id, seenAt]) => [id, seenAt]);
+      await db('devices')
+        .whereIn('id', batch.map(([id]) => id))
+        .update({ last_seen_at: db.raw(`CASE id ${cases} END`, bindings) });
+    }
+  }
+
   static async delete(id: string): Promise<boolean> {
     const db = getDb();
     const count = await db('devices').where('id', id).del();
+    this.invalidateCache(id);
     return count > 0;
   }
 
@@ -171,6 +234,7 @@ export class DeviceModel {
       is_active: false,
       updated_at: new Date().toISOString(),
     });
+    this.invalidateCache(id);
     return count > 0;
   }
 
@@ -182,6 +246,7 @@ export class DeviceModel {
       last_seen_at: now,
       updated_at: now,
     });
+    this.invalidateCache(id);
   }
 
   static async setPendingFirmware(id: string, version: string): Promise<boolean> {
@@ -190,6 +255,7 @@ export class DeviceModel {
       pending_firmware_version: version,
       updated_at: new Date().toISOString(),
     });
+    this.invalidateCache(id);
     return count > 0;
   }
 
@@ -200,6 +266,7 @@ export class DeviceModel {
       pending_firmware_version: version,
       updated_at: now,
     });
+    deviceIds.forEach(id => this.invalidateCache(id));
     return count;
   }
 
@@ -209,6 +276,7 @@ export class DeviceModel {
       pending_firmware_version: null,
       updated_at: new Date().toISOString(),
     });
+    this.invalidateCache(id);
     return count > 0;
   }
 
@@ -2,6 +2,7 @@ import { v4 as uuidv4 } from 'uuid';
 import { getDb } from './database';
 import { MeetingRoom, CreateRoomRequest } from '../types';
 import { encrypt, decrypt } from '../utils/encryption';
+import { DeviceModel } from './device.model';
 
 /** Decrypt an IMAP password from the DB. Falls back to plaintext for legacy
  *  rows stored before encryption was introduced. Encrypted values always have
@@ -140,6 +141,8 @@ export class RoomModel {
       calendar_feed_enabled: data.calendarFeedEnabled !== undefined ? data.calendarFeedEnabled : existing.calendarFeedEnabled,
       updated_at: now,
     });
+    // Devices in the room carry a copy of it in the token cache
+    DeviceModel.invalidateRoomCache(id);
 
     return this.findById(id);
   }
@@ -147,6 +150,7 @@ export class RoomModel {
   static async delete(id: string): Promise<boolean> {
     const db = getDb();
     const count = await db('meeting_rooms').where('id', id).del();
+    DeviceModel.invalidateRoomCache(id);
     return count > 0;
   }
 
@@ -156,6 +160,7 @@ export class RoomModel {
       is_active: false,
       updated_at: new Date().toISOString(),
     });
+    DeviceModel.invalidateRoomCache(id);
     return count > 0;
   }
 
@@ -1,5 +1,28 @@
 import { getDb } from './database';
-import { Settings, TwoFaEnforcement, TwoFaMode } from '../types';
+import { Settings, TwoFaEnforcement, TwoFaMode, DeviceRuntimeConfig } from '../types';
+import { encrypt, decrypt } from '../utils/encryption';
+
+/** The MQTT URL carries the broker credentials, so it is stored encrypted.
+ *  Falls back to plaintext for rows stored before that; encrypted values
+ *  always have the form "<32hex>:<32hex>:<hex...>" produced by encrypt(). */
+function decryptMqttUrl(stored: string): string {
+  const parts = stored.split(':');
+  if (parts.length === 3 && /^[0-9a-f]{32}$/i.test(parts[0])) {
+    return decrypt(stored);
+  }
+  return stored; // legacy plaintext
+}
+
+function parseDeviceConfig(value: string | null | undefined): DeviceRuntimeConfig {
+  if (!value) return {};
+  try {
+    const config: DeviceRuntimeConfig = JSON.parse(value);
+    if (config.mqttUrl) config.mqttUrl = decryptMqttUrl(config.mqttUrl);
+    return config;
+  } catch {
+    return {};
+  }
+}
 
 export class SettingsModel {
   static async getGlobal(): Promise<Settings> {
@@ -21,6 +44,8 @@ export class SettingsModel {
         bannerLevel: 'info',
         bannerStartsAt: null,
         bannerEndsAt: null,
+        deviceConfig: {},
+        deviceConfigVersion: 0,
       };
     }
     return {
@@ -38,6 +63,8 @@ export class SettingsModel {
       bannerLevel: (['info', 'warning', 'critical'].includes(row.banner_level) ? row.banner_level : 'info') as 'info' | 'warning' | 'critical',
       bannerStartsAt: row.banner_starts_at ?? null,
       bannerEndsAt: row.banner_ends_at ?? null,
+      deviceConfig: parseDeviceConfig(row.device_config),
+      deviceConfigVersion: row.device_config_version ?? 0,
     };
   }
 
@@ -86,4 +113,16 @@ export class SettingsModel {
     });
     return this.getGlobal();
   }
+
+  // Replace the device overrides; bumping the version makes every device pick
+  // them up on its next status poll
+  static async updateDeviceConfig(config: DeviceRuntimeConfig): Promise<Settings> {
+    const db = getDb();
+    await db('settings').where('id', 'global').update({
+      device_config: JSON.stringify(config.mqttUrl ? { ...config, mqttUrl: encrypt(config.mqttUrl) } : config),
+      device_config_version: db.raw('device_config_version + 1'),
+      updated_at: new Date().toISOString(),
+    });
+    return this.getGlobal();
+  }
 }
@@ -9,6 +9,7 @@ import { UserRole, MeetingRoom, ExternalGuest } from '../types';
 import { SettingsModel } from '../models/settings.model';
 import { ParkModel } from '../models/park.model';
 import { auditLog, AuditAction, getClientIp } from '../services/audit.service';
+import { deviceStatusCache } from '../services/device-status.service';
 
 // Helper to get global settings
 async function getGlobalSettings(): Promise<{ openingHour: number; closingHour: number }> {
@@ -298,6 +299,7 @@ router.post('/', authenticate, async (req: AuthRequest, res: Response) => {
       attendees: attendees || [],
       externalGuests: externalGuests || []
     }, req.user!.userId);
+    deviceStatusCache.invalidateRoom(roomId);
 
     // Get user for email
     const user = await UserModel.findById(req.user!.userId);
@@ -395,6 +397,7 @@ router.put('/:id', authenticate, async (req: AuthRequest, res: Response) => {
       res.status(404).json({ error: 'Booking not found' });
       return;
     }
+    deviceStatusCache.invalidateRoom(booking.roomId);
 
     const room = await RoomModel.findById(booking.roomId);
     const user = await UserModel.findById(booking.userId);
@@ -464,6 +467,7 @@ router.post('/:id/cancel', authenticate, async (req: AuthRequest, res: Response)
       res.status(500).json({ error: 'Failed to cancel booking' });
       return;
     }
+    deviceStatusCache.invalidateRoom(booking.roomId);
 
     // Send cancellation notice
     const room = await RoomModel.findById(booking.roomId);
@@ -513,6 +517,7 @@ router.delete('/:id', authenticate, async (req: AuthRequest, res: Response) => {
     const admin = await UserModel.findById(req.user!.userId);
 
     await BookingModel.delete(id);
+    deviceStatusCache.invalidateRoom(booking.roomId);
     auditLog({ userId: req.user!.userId, action: AuditAction.BOOKING_DELETE, resourceType: 'booking', resourceId: id, ipAddress: getClientIp(req), userAgent: req.headers['user-agent'], outcome: 'success', metadata: { isAdmin, isOwner } });
 
     // If admin deleted someone else's booking, send notification
@@ -588,6 +593,8 @@ router.post('/:id/move', authenticate, async (req: AuthRequest, res: Response) =
       res.status(500).json({ error: 'Failed to move booking' });
       return;
     }
+    deviceStatusCache.invalidateRoom(booking.roomId);
+    deviceStatusCache.invalidateRoom(newRoomId);
 
     // Send notification to booking owner
     const bookingOwner = await UserModel.findById(booking.userId);
@@ -5,9 +5,13 @@ import { BookingModel } from '../models/booking.model';
 import { RoomModel } from '../models/room.model';
 import { FirmwareModel } from '../models/firmware.model';
 import { SettingsModel } from '../models/settings.model';
-import { DeviceWithRoom, DeviceRoomStatus, BookingWithDetails, BookingStatus } from '../types';
+import { DeviceWithRoom, DeviceRoomStatus, DeviceRoomStatusDynamic, BookingStatus, Settings } from '../types';
 import { getDb } from '../models/database';
 import { auditLog, AuditAction, getClientIp } from '../services/audit.service';
+import { deviceLastSeen } from '../services/device-last-seen.service';
+import { deviceStatusCache, parseBookingTime, roomVersion } from '../services/device-status.service';
+import { deviceTelemetry, isTelemetryBatch } from '../services/device-telemetry.service';
+import { roomGroupSecret } from '../utils/encryption';
 import fs from 'fs';
 
 const router = Router();
@@ -18,7 +22,7 @@ interface DeviceRequest extends Request {
 }
 
 // Helper to get global settings
-async function getGlobalSettings(): Promise<{ openingHour: number; closingHour: number; timezone: string }> {
+async function getGlobalSettings(): Promise<Settings> {
   return SettingsModel.getGlobal();
 }
 
@@ -36,7 +40,9 @@ function getLocalTime(date: Date, timezone: string): { hour: number; minute: num
   };
 }
 
-// Middleware to authenticate device by token
+// Middleware to authenticate device by token. Devices come from the token
+// cache and the last-seen time is written behind, so a poll costs no DB
+// round trip here.
 async function authenticateDevice(req: DeviceRequest, res: Response, next: NextFunction): Promise<void> {
   const token = req.headers['x-device-token'] as string;
 
@@ -45,99 +51,50 @@ async function authenticateDevice(req: DeviceRequest, res: Response, next: NextF
     return;
   }
 
-  const device = await DeviceModel.findByTokenWithRoom(token);
+  const device = await DeviceModel.findByTokenWithRoomCached(token);
   if (!device) {
     res.status(401).json({ error: 'Invalid or inactive device token' });
     return;
   }
 
-  // Update last seen timestamp
-  await DeviceModel.updateLastSeen(device.id);
+  deviceLastSeen.touch(device.id);
 
   req.device = device;
   next();
 }
 
-// Helper function to parse booking time (handles both ISO with and without timezone)
-function parseBookingTime(timeStr: string): Date {
-  // If time string doesn't end with Z or timezone offset, treat as UTC
-  if (timeStr && !timeStr.endsWith('Z') && !timeStr.match(/[+-]\d{2}:\d{2}$/)) {
-    return new Date(timeStr + ':00.000Z');
-  }
-  return new Date(timeStr);
-}
-
-// Get room status and upcoming bookings
+// Get room status and upcoming bookings. The status is built once per room
+// and cached until its bookings change (see device-status.service).
 router.get('/status', authenticateDevice, async (req: DeviceRequest, res: Response) => {
   try {
     const device = req.device!;
     const room = device.room;
 
-    console.log('Status check from device:', device.name, '| Pending firmware:', device.pendingFirmwareVersion || 'none');
-
     if (!room) {
       res.status(404).json({ error: 'Room not found' });
       return;
     }
 
-    const now = new Date();
-    const todayStart = new Date(now);
-    todayStart.setHours(0, 0, 0, 0);
-    const todayEnd = new Date(now);
-    todayEnd.setHours(23, 59, 59, 999);
-
-    console.log('Device status check - Server time:', now.toISOString(), 'Local:', now.toString());
-
-    // Get all bookings for today and beyond for this room
-    const bookings = await BookingModel.findByRoom(
-      room.id,
-      todayStart.toISOString(),
-      new Date(now.getTime() + 7 * 24 * 60 * 60 * 1000).toISOString() // Next 7 days
-    );
+    const cached = await deviceStatusCache.get(room);
 
-    console.log('Found', bookings.length, 'bookings for room', room.name);
-    bookings.forEach(b => {
-      console.log('  Booking:', b.title, 'Start:', b.startTime, 'End:', b.endTime);
-    });
+    // Devices that cache the room from /info send the version they have and
+    // get the status without it; older firmware gets the full status
+    const dynamic = req.headers['x-room-version'] !== undefined;
 
-    // Find current booking (now falls within booking time)
-    const currentBooking = bookings.find(b => {
-      const start = parseBookingTime(b.startTime);
-      const end = parseBookingTime(b.endTime);
-      const isCurrentlyActive = now >= start && now < end;
-      console.log('  Checking booking:', b.title, '| start:', start.toISOString(), '| end:', end.toISOString(), '| now >= start:', now >= start, '| now < end:', now < end, '| active:', isCurrentlyActive);
-      return isCurrentlyActive;
-    });
-
-    // Find upcoming bookings (start time is in the future)
-    const upcomingBookings = bookings
-      .filter(b => parseBookingTime(b.startTime) > now)
-      .slice(0, 3); // Next 3 bookings
-
-    // Get user details for bookings (without password)
-    const bookingsWithDetails: BookingWithDetails[] = upcomingBookings.map(b => ({
-      ...b,
-      attendees: JSON.parse(b.attendees),
-      room: { ...room, amenities: JSON.parse(room.amenities) }
-    }));
-
-    const currentBookingWithDetails = currentBooking ? {
-      ...currentBooking,
-      attendees: JSON.parse(currentBooking.attendees),
-      room: { ...room, amenities: JSON.parse(room.amenities) },
-      isDeviceBooking: currentBooking.userId === 'device-booking-user',
-    } : null;
-
-    const status: DeviceRoomStatus = {
-      room: { ...room, amenities: JSON.parse(room.amenities) },
-      currentBooking: currentBookingWithDetails,
-      upcomingBookings: bookingsWithDetails,
-      isAvailable: !currentBooking
-    };
-
-    console.log('Room status:', room.name, '| Available:', !currentBooking, '| Current booking:', currentBooking?.title || 'none');
+    // Runtime config, only when the device doesn't have the current version.
+    // Older firmware sends no header and ignores the block.
+    const deviceConfigVersion = parseInt(req.headers['x-config-version'] as string, 10);
+    if (cached.config && deviceConfigVersion !== cached.config.version) {
+      const status: DeviceRoomStatus | DeviceRoomStatusDynamic = dynamic
+        ? { ...cached.dynamic, config: cached.config }
+        : { ...cached.status, config: cached.config };
+      res.json(status);
+      return;
+    }
 
-    res.json(status);
+    // Express answers 304 when If-None-Match matches
+    res.set('ETag', dynamic ? cached.dynamicEtag : cached.etag);
+    res.type('json').send(dynamic ? cached.dynamicBody : cached.body);
   } catch (error) {
     console.error('Get room status error:', error);
     res.status(500).json({ error: 'Failed to get room status' });
@@ -237,6 +194,7 @@ router.post('/quick-book', authenticateDevice, async (req: DeviceRequest, res: R
       updated_at: nowIso,
     });
 
+    deviceStatusCache.invalidateRoom(room.id);
     const booking = await BookingModel.findById(bookingId);
 
     auditLog({ userId: 'device-booking-user', action: AuditAction.BOOKING_CREATE, resourceType: 'booking', resourceId: bookingId, ipAddress: getClientIp(req), userAgent: req.headers['user-agent'] as string ?? null, outcome: 'success', metadata: { deviceId: device.id, roomId: room.id } });
@@ -290,6 +248,7 @@ router.post('/end-meeting', authenticateDevice, async (req: DeviceRequest, res:
     }
 
     await BookingModel.endEarly(currentBooking.id, now.toISOString());
+    deviceStatusCache.invalidateRoom(room.id);
 
     auditLog({ userId: 'device-booking-user', action: AuditAction.BOOKING_UPDATE, resourceType: 'booking', resourceId: currentBooking.id, ipAddress: getClientIp(req), userAgent: req.headers['user-agent'] as string ?? null, outcome: 'success', metadata: { deviceId: device.id, action: 'end_early' } });
 
@@ -300,7 +259,8 @@ router.post('/end-meeting', authenticateDevice, async (req: DeviceRequest, res:
   }
 });
 
-// Get device info (for display on screen)
+// Get device info (for display on screen). Devices cache the room from here
+// and fetch it again when the roomVersion in /status changes.
 router.get('/info', authenticateDevice, async (req: DeviceRequest, res: Response) => {
   try {
     const device = req.device!;
@@ -310,7 +270,8 @@ router.get('/info', authenticateDevice, async (req: DeviceRequest, res: Response
       room: device.room ? {
         ...device.room,
         amenities: JSON.parse(device.room.amenities)
-      } : null
+      } : null,
+      roomVersion: device.room ? roomVersion(device.room) : null,
     });
   } catch (error) {
     console.error('Get device info error:', error);
@@ -318,11 +279,34 @@ router.get('/info', authenticateDevice, async (req: DeviceRequest, res: Response
   }
 });
 
+// Secret of the device's room group; panels of the room sign their LAN
+// beacons and relayed statuses with it, so only they can join the group
+router.get('/room-group', authenticateDevice, (req: DeviceRequest, res: Response) => {
+  const device = req.device!;
+  if (!device.roomId) {
+    res.status(404).json({ error: 'Device is not assigned to a room' });
+    return;
+  }
+  res.json({ roomId: device.roomId, secret: roomGroupSecret(device.roomId) });
+});
+
 // Health check endpoint (for device connectivity monitoring)
 router.get('/ping', authenticateDevice, async (req: DeviceRequest, res: Response) => {
   res.json({ status: 'ok', timestamp: new Date().toISOString() });
 });
 
+// Batched telemetry upload (format in device-telemetry.service). Only merged
+// into memory here; the write to the database happens in the background.
+router.post('/telemetry', authenticateDevice, (req: DeviceRequest, res: Response) => {
+  if (!isTelemetryBatch(req.body)) {
+    res.status(400).json({ error: 'Invalid telemetry batch' });
+    return;
+  }
+
+  const accepted = deviceTelemetry.record(req.device!.id, req.body);
+  res.json({ success: true, accepted });
+});
+
 // Report current firmware version
 router.post('/firmware/report', authenticateDevice, async (req: DeviceRequest, res: Response) => {
   try {
@@ -473,6 +457,8 @@ router.get('/firmware/download/:version', authenticateDevice, async (req: Device
     res.setHeader('Content-Length', firmware.size);
     res.setHeader('X-Firmware-Version', firmware.version);
     res.setHeader('X-Firmware-Checksum', firmware.checksum);
+    // HTTPUpdate on the panel checks the image against this before switching to it
+    res.setHeader('x-MD5', firmware.checksum);
 
     // Stream the file
     const fileStream = fs.createReadStream(filePath);
@@ -2,9 +2,12 @@ import { Router, Response } from 'express';
 import { DeviceModel } from '../models/device.model';
 import { RoomModel } from '../models/room.model';
 import { FirmwareModel } from '../models/firmware.model';
+import { DeviceTelemetryModel } from '../models/device-telemetry.model';
 import { authenticate, requireAdmin, AuthRequest } from '../middleware/auth.middleware';
-import { UserRole } from '../types';
+import { UserRole, DeviceTelemetryMetric } from '../types';
+import { telemetryResolutionFor } from '../services/device-telemetry.service';
 import { auditLog, AuditAction, getClientIp } from '../services/audit.service';
+import { mqttBridge, DeviceCommand } from '../services/mqtt.service';
 
 const router = Router();
 
@@ -51,6 +54,37 @@ router.get('/', authenticate, requireAdmin, async (req: AuthRequest, res: Respon
   }
 });
 
+const TELEMETRY_METRICS: DeviceTelemetryMetric[] = ['poll', 'errors', 'heap', 'rssi', 'redraw', 'reboots'];
+
+// Worst panels by a telemetry metric over the last `hours` (admin only) - MUST be before /:id
+router.get('/telemetry/worst', authenticate, requireAdmin, async (req: AuthRequest, res: Response) => {
+  try {
+    const metric = (req.query.metric as DeviceTelemetryMetric) || 'poll';
+    if (!TELEMETRY_METRICS.includes(metric)) {
+      res.status(400).json({ error: `Metric must be one of: ${TELEMETRY_METRICS.join(', ')}` });
+      return;
+    }
+    const hours = Math.min(Math.max(parseInt(req.query.hours as string) || 24, 1), 365 * 24);
+    const limit = Math.min(Math.max(parseInt(req.query.limit as string) || 20, 1), 200);
+
+    // Park admins can only see devices in their park
+    let parkId = req.query.parkId as string | undefined;
+    if (req.user?.role !== UserRole.SUPER_ADMIN && req.user?.parkId) {
+      parkId = req.user.parkId;
+    }
+
+    const resolution = telemetryResolutionFor(hours);
+    const step = resolution * 1000;
+    const since = new Date(Math.floor((Date.now() - hours * 3600 * 1000) / step) * step);
+
+    const panels = await DeviceTelemetryModel.findWorst({ resolution, since, metric, limit, parkId });
+    res.json({ metric, hours, resolution, since: since.toISOString(), panels });
+  } catch (error) {
+    console.error('Get device telemetry error:', error);
+    res.status(500).json({ error: 'Failed to get device telemetry' });
+  }
+});
+
 // Get devices for a room (admin only) - MUST be before /:id to avoid route conflict
 router.get('/room/:roomId', authenticate, requireAdmin, async (req: AuthRequest, res: Response) => {
   try {
@@ -113,6 +147,7 @@ router.post('/', authenticate, requireAdmin, async (req: AuthRequest, res: Respo
     }
 
     const device = await DeviceModel.create({ name, roomId, deviceType });
+    mqttBridge.devicesChanged();
 
     auditLog({
       userId: req.user?.userId ?? null,
@@ -160,6 +195,9 @@ router.put('/:id', authenticate, requireAdmin, async (req: AuthRequest, res: Res
 
     const device = await DeviceModel.update(id, { name, roomId, deviceType, isActive });
     const deviceWithRoom = await DeviceModel.findByIdWithRoom(id);
+    // A panel on MQTT learns about a new room only from a fresh poll
+    mqttBridge.sendCommand(id, 'refresh');
+    mqttBridge.devicesChanged();
 
     auditLog({
       userId: req.user?.userId ?? null,
@@ -197,6 +235,7 @@ router.post('/:id/regenerate-token', authenticate, requireAdmin, async (req: Aut
 
     const device = await DeviceModel.regenerateToken(id);
     const deviceWithRoom = await DeviceModel.findByIdWithRoom(id);
+    mqttBridge.devicesChanged();
 
     auditLog({
       userId: req.user?.userId ?? null,
@@ -262,6 +301,8 @@ router.post('/firmware/schedule-update', authenticate, requireAdmin, async (req:
 
     // Schedule update for all devices
     const updatedCount = await DeviceModel.setPendingFirmwareBatch(deviceIds, firmwareVersion);
+    // Panels on MQTT check now instead of at their next firmware check
+    for (const id of deviceIds) mqttBridge.sendCommand(id, 'ota');
 
     res.json({
       success: true,
@@ -302,6 +343,34 @@ router.post('/:id/firmware/cancel-update', authenticate, requireAdmin, async (re
   }
 });
 
+// Send a command to a panel over MQTT (admin only). 409 when the bridge is
+// off or the panel isn't known to it; the command is not queued.
+router.post('/:id/command', authenticate, requireAdmin, async (req: AuthRequest, res: Response) => {
+  const { id } = req.params;
+  const { command } = req.body ?? {};
+  const allowed: DeviceCommand[] = ['refresh', 'reboot', 'ota'];
+  if (!allowed.includes(command)) {
+    res.status(400).json({ error: `command must be one of ${allowed.join(', ')}` });
+    return;
+  }
+
+  try {
+    const existing = await DeviceModel.findById(id);
+    if (!existing) {
+      res.status(404).json({ error: 'Device not found' });
+      return;
+    }
+    if (!mqttBridge.sendCommand(id, command)) {
+      res.status(409).json({ error: 'Device is not reachable over MQTT' });
+      return;
+    }
+    res.json({ success: true });
+  } catch (error) {
+    console.error('Send device command error:', error);
+    res.status(500).json({ error: 'Failed to send command' });
+  }
+});
+
 // Delete device (admin only)
 router.delete('/:id', authenticate, requireAdmin, async (req: AuthRequest, res: Response) => {
   try {
@@ -314,6 +383,7 @@ router.delete('/:id', authenticate, requireAdmin, async (req: AuthRequest, res:
     }
 
     await DeviceModel.delete(id);
+    mqttBridge.devicesChanged();
 
     auditLog({
       userId: req.user?.userId ?? null,
@@ -0,0 +1,149 @@
+import crypto from 'crypto';
+import { Router, Response } from 'express';
+import { DeviceModel } from '../models/device.model';
+import { RoomModel } from '../models/room.model';
+import { SettingsModel } from '../models/settings.model';
+import { DeviceRoomStatus, DeviceRoomStatusDynamic, DeviceRuntimeConfig } from '../types';
+import { deviceStatusCache } from '../services/device-status.service';
+import { deviceLastSeen } from '../services/device-last-seen.service';
+import { authenticateGateway, GatewayRequest } from '../middleware/gateway.middleware';
+
+// API for edge gateways (see gateway.middleware). A gateway keeps the
+// devices of its park in a token cache and the status of every room they
+// show, and serves /api/device/status and /ping to the panels itself.
+
+const router = Router();
+
+// Longest a status request is held open waiting for a change
+const MAX_WAIT_SECONDS = 30;
+const MAX_ROOMS = 1000;
+const MAX_SEEN = 5000;
+
+interface GatewayRoomStatus {
+  etag: string;
+  status: DeviceRoomStatus;
+  dynamicEtag: string;
+  dynamic: DeviceRoomStatusDynamic;
+}
+
+function tokenHash(token: string): string {
+  return crypto.createHash('sha256').update(token).digest('hex');
+}
+
+// Active devices of the gateway's park. Tokens are sent as SHA-256 hashes;
+// the gateway hashes the token a panel sends and looks that up.
+router.get('/devices', authenticateGateway, async (req: GatewayRequest, res: Response) => {
+  try {
+    const devices = await DeviceModel.findByPark(req.gatewayParkId!);
+    res.json({
+      devices: devices.map(d => ({ id: d.id, roomId: d.roomId, tokenHash: tokenHash(d.token) })),
+    });
+  } catch (error) {
+    console.error('Gateway device list error:', error);
+    res.status(500).json({ error: 'Failed to list devices' });
+  }
+});
+
+// Status of many rooms in one call. The body maps room ids to the ETag the
+// gateway has ("" for none); only rooms whose status differs are returned,
+// as null when the room is not in the gateway's park. configVersion works
+// like a device's X-Config-Version. With wait > 0 the request is held until
+// something changes or wait seconds pass. seen lists devices that polled the
+// gateway since its last call, for their last-seen time.
+//
+//   {"rooms": {"<roomId>": "<etag>"}, "configVersion": 3, "wait": 25, "seen": ["<deviceId>"]}
+router.post('/status', authenticateGateway, async (req: GatewayRequest, res: Response) => {
+  const body = req.body ?? {};
+  const known = body.rooms;
+  if (!known || typeof known !== 'object' || Array.isArray(known) ||
+      Object.keys(known).length > MAX_ROOMS || !Object.values(known).every(v => typeof v === 'string')) {
+    res.status(400).json({ error: `rooms must map up to ${MAX_ROOMS} room ids to ETags` });
+    return;
+  }
+  const seen = body.seen ?? [];
+  if (!Array.isArray(seen) || seen.length > MAX_SEEN || !seen.every((id: unknown) => typeof id === 'string')) {
+    res.status(400).json({ error: `seen must list up to ${MAX_SEEN} device ids` });
+    return;
+  }
+  const configVersion = Number.isInteger(body.configVersion) ? body.configVersion : 0;
+  const wait = Math.min(Math.max(Number.isInteger(body.wait) ? body.wait : 0, 0), MAX_WAIT_SECONDS);
+  const deadline = Date.now() + wait * 1000;
+
+  // Set by any invalidation of a requested room while the request waits
+  let dirty = false;
+  let wake: (() => void) | null = null;
+  let closed = false;
+  const roomIds = new Set(Object.keys(known));
+  const unsubscribe = deviceStatusCache.onInvalidate(roomId => {
+    if (roomId !== null && !roomIds.has(roomId)) return;
+    dirty = true;
+    wake?.();
+  });
+  // The gateway gave up (or restarted) while the request was held
+  res.on('close', () => {
+    closed = true;
+    wake?.();
+  });
+
+  try {
+    const parkId = req.gatewayParkId!;
+    if (seen.length > 0) {
+      const parkDevices = new Set((await DeviceModel.findByPark(parkId)).map(d => d.id));
+      for (const id of seen) {
+        if (parkDevices.has(id)) deviceLastSeen.touch(id);
+      }
+    }
+    const loadRooms = async () => new Map((await RoomModel.findByPark(parkId, true)).map(room => [room.id, room]));
+    let parkRooms = await loadRooms();
+
+    for (;;) {
+      dirty = false;
+      const rooms: Record<string, GatewayRoomStatus | null> = {};
+      let validUntil = Infinity;
+      for (const [roomId, etag] of Object.entries(known)) {
+        const room = parkRooms.get(roomId);
+        if (!room) {
+          rooms[roomId] = null;
+          continue;
+        }
+        const cached = await deviceStatusCache.get(room);
+        validUntil = Math.min(validUntil, cached.validUntil);
+        if (cached.etag !== etag) {
+          rooms[roomId] = { etag: cached.etag, status: cached.status, dynamicEtag: cached.dynamicEtag, dynamic: cached.dynamic };
+        }
+      }
+
+      const settings = await SettingsModel.getGlobal();
+      const config: (DeviceRuntimeConfig & { version: number }) | null = settings.deviceConfigVersion > 0
+        ? { ...settings.deviceConfig, version: settings.deviceConfigVersion }
+        : null;
+
+      if (Object.keys(rooms).length > 0 || (config?.version ?? 0) !== configVersion || Date.now() >= deadline) {
+        res.json({ rooms, config });
+        return;
+      }
+
+      // Nothing new: wait for an invalidation, the next booking boundary or the deadline
+      if (!dirty) {
+        await new Promise<void>(resolve => {
+          const timer = setTimeout(resolve, Math.max(0, Math.min(deadline, validUntil) - Date.now()));
+          wake = () => {
+            clearTimeout(timer);
+            resolve();
+          };
+        });
+        wake = null;
+      }
+      if (closed) return;
+      // The room itself may have been edited or moved to another park
+      if (dirty) parkRooms = await loadRooms();
+    }
+  } catch (error) {
+    console.error('Gateway status error:', error);
+    if (!res.headersSent) res.status(500).json({ error: 'Failed to get room status' });
+  } finally {
+    unsubscribe();
+  }
+});
+
+export default router;
@@ -5,6 +5,7 @@ import { CompanyModel } from '../models/company.model';
 import { authenticate, requireAdmin, AuthRequest } from '../middleware/auth.middleware';
 import { MeetingRoom, UserRole } from '../types';
 import { imapManager } from '../services/imap.service';
+import { deviceStatusCache } from '../services/device-status.service';
 import { auditLog, AuditAction, getClientIp } from '../services/audit.service';
 
 const router = Router();
@@ -341,6 +342,7 @@ router.put('/:id', authenticate, requireAdmin, async (req: AuthRequest, res: Res
       res.status(404).json({ error: 'Room not found' });
       return;
     }
+    deviceStatusCache.invalidateRoom(id);
 
     // Restart IMAP worker so new credentials take effect immediately (fire-and-forget)
     imapManager.restartRoom(id).catch(err =>
@@ -388,6 +390,7 @@ router.delete('/:id', authenticate, requireAdmin, async (req: AuthRequest, res:
 
     // Stop IMAP worker for the deleted/deactivated room
     imapManager.stopRoom(id);
+    deviceStatusCache.invalidateRoom(id);
 
     auditLog({
       userId: req.user?.userId ?? null,
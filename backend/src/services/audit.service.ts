@@ -71,6 +71,7 @@ export const AuditAction = {
   SETTINGS_UPDATE: 'settings.update',
   SETTINGS_2FA_POLICY: 'settings.2fa.policy',
   SETTINGS_BANNER: 'settings.banner',
+  SETTINGS_DEVICE_CONFIG: 'settings.device_config',
   // Devices
   DEVICE_CREATE: 'device.create',
   DEVICE_UPDATE: 'device.update',
@@ -0,0 +1,58 @@
+import { DeviceModel } from '../models/device.model';
+
+// Write-behind for devices.last_seen_at. Every device API request used to
+// UPDATE its row; now requests only note the time here and the latest time per
+// device is written in one batched UPDATE every flush interval. A restart
+// loses at most one interval of timestamps.
+class DeviceLastSeenWriter {
+  private pending = new Map<string, string>();
+  private timer: NodeJS.Timeout | null = null;
+  private flushing = false;
+  private readonly intervalMs: number;
+
+  constructor() {
+    this.intervalMs = parseInt(process.env.DEVICE_LAST_SEEN_FLUSH_SECONDS ?? '15', 10) * 1000;
+  }
+
+  start(): void {
+    if (this.timer) return;
+    this.timer = setInterval(() => this.flush(), this.intervalMs);
+    console.log(`Device last-seen writer started (flushing every ${this.intervalMs / 1000}s)`);
+  }
+
+  /** Record that a device was seen now */
+  touch(deviceId: string): void {
+    this.pending.set(deviceId, new Date().toISOString());
+  }
+
+  async flush(): Promise<void> {
+    if (this.flushing || this.pending.size === 0) return;
+    this.flushing = true;
+    const batch = this.pending;
+    this.pending = new Map();
+    try {
+      await DeviceModel.updateLastSeenBatch(batch);
+    } catch (err: any) {
+      console.error('Failed to write device last-seen times:', err.message);
+      // Keep them for the next flush unless the device has been seen since
+      for (const [id, seenAt] of batch) {
+        if (!this.pending.has(id)) this.pending.set(id, seenAt);
+      }
+    } finally {
+      this.flushing = false;
+    }
+  }
+
+  /** Stop the timer and write what is pending (graceful shutdown) */
+  async stop(): Promise<void> {
+    if (this.timer) {
+      clearInterval(this.timer);
+      this.timer = null;
+    }
+    // A flush already running has taken its batch; let it finish, then write the rest
+    while (this.flushing) await new Promise(resolve => setTimeout(resolve, 50));
+    await this.flush();
+  }
+}
+
+export const deviceLastSeen = new DeviceLastSeenWriter();
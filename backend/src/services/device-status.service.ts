@@ -0,0 +1,209 @@
+import crypto from 'crypto';
+import { BookingModel } from '../models/booking.model';
+import { SettingsModel } from '../models/settings.model';
+import { Booking, BookingWithDetails, DeviceBookingSummary, DeviceRoomStatus, DeviceRoomStatusDynamic, DeviceRuntimeConfig, MeetingRoom } from '../types';
+
+// Longest a built status is served without a rebuild. Covers changes that
+// don't go through a path that invalidates it (direct DB edits, a booking
+// moving into the 7-day window).
+const MAX_AGE_MS = 5 * 60 * 1000;
+
+const DEVICE_BOOKING_USER_ID = 'device-booking-user';
+
+// Parse a booking time (handles both ISO with and without timezone)
+export function parseBookingTime(timeStr: string): Date {
+  // If time string doesn't end with Z or timezone offset, treat as UTC
+  if (timeStr && !timeStr.endsWith('Z') && !timeStr.match(/[+-]\d{2}:\d{2}$/)) {
+    return new Date(timeStr + ':00.000Z');
+  }
+  return new Date(timeStr);
+}
+
+/**
+ * Version of the room data a device shows (name, capacity, floor, quick-book
+ * durations...). Devices that cache the room from /device/info refetch it
+ * when the version in their status response changes.
+ */
+export function roomVersion(room: MeetingRoom): string {
+  return crypto.createHash('sha1').update(JSON.stringify(room)).digest('hex').slice(0, 16);
+}
+
+function bookingSummary(booking: Booking, isDeviceBooking?: boolean): DeviceBookingSummary {
+  const summary: DeviceBookingSummary = {
+    id: booking.id,
+    title: booking.title,
+    startTime: booking.startTime,
+    endTime: booking.endTime,
+  };
+  if (isDeviceBooking !== undefined) summary.isDeviceBooking = isDeviceBooking;
+  return summary;
+}
+
+function etagOf(body: Buffer): string {
+  return `"${crypto.createHash('sha1').update(body).digest('base64')}"`;
+}
+
+export interface CachedRoomStatus {
+  status: DeviceRoomStatus;
+  body: Buffer;                  // status serialized, without a config block
+  etag: string;
+  // Without the room and with slim bookings, for devices that send X-Room-Version
+  dynamic: DeviceRoomStatusDynamic;
+  dynamicBody: Buffer;
+  dynamicEtag: string;
+  config: (DeviceRuntimeConfig & { version: number }) | null;  // Current runtime config, if one was saved
+  validUntil: number;            // Next booking boundary, or the max age
+}
+
+// Device /status responses, built once per room and served to every poll
+// until a booking in the room changes or the next booking starts or ends.
+// Callers that change bookings, rooms or settings invalidate them.
+class DeviceStatusCache {
+  private entries = new Map<string, CachedRoomStatus>();
+  private building = new Map<string, Promise<CachedRoomStatus>>();
+  private generations = new Map<string, number>();
+  private globalGeneration = 0;
+  private listeners = new Set<(roomId: string | null) => void>();
+
+  async get(room: MeetingRoom): Promise<CachedRoomStatus> {
+    const cached = this.entries.get(room.id);
+    if (cached && cached.validUntil > Date.now()) return cached;
+
+    // Panels of the same room polling together share one build
+    let pending = this.building.get(room.id);
+    if (!pending) {
+      const build: Promise<CachedRoomStatus> = this.build(room).finally(() => {
+        // An invalidation may have replaced this build with a newer one
+        if (this.building.get(room.id) === build) this.building.delete(room.id);
+      });
+      pending = build;
+      this.building.set(room.id, pending);
+    }
+    return pending;
+  }
+
+  /** Bookings or the room itself changed */
+  invalidateRoom(roomId: string): void {
+    this.entries.delete(roomId);
+    // A build that started before the change would hand out the old status
+    this.building.delete(roomId);
+    this.generations.set(roomId, (this.generations.get(roomId) ?? 0) + 1);
+    for (const listener of this.listeners) listener(roomId);
+  }
+
+  /** Global settings changed (opening hours, device runtime config) */
+  invalidateAll(): void {
+    this.entries.clear();
+    this.building.clear();
+    this.globalGeneration++;
+    for (const listener of this.listeners) listener(null);
+  }
+
+  /**
+   * Call `listener` with the room id (null: every room) whenever a status is
+   * invalidated, for long-polling gateways. Returns the unsubscribe function.
+   */
+  onInvalidate(listener: (roomId: string | null) => void): () => void {
+    this.listeners.add(listener);
+    return () => this.listeners.delete(listener);
+  }
+
+  private generation(roomId: string): string {
+    return `${this.globalGeneration}.${this.generations.get(roomId) ?? 0}`;
+  }
+
+  private async build(room: MeetingRoom): Promise<CachedRoomStatus> {
+    const generation = this.generation(room.id);
+    const now = new Date();
+    const todayStart = new Date(now);
+    todayStart.setHours(0, 0, 0, 0);
+
+    // Get all bookings for today and beyond for this room
+    const bookings = await BookingModel.findByRoom(
+      room.id,
+      todayStart.toISOString(),
+      new Date(now.getTime() + 7 * 24 * 60 * 60 * 1000).toISOString() // Next 7 days
+    );
+
+    // Find current booking (now falls within booking time)
+    const currentBooking = bookings.find(b => {
+      const start = parseBookingTime(b.startTime);
+      const end = parseBookingTime(b.endTime);
+      return now >= start && now < end;
+    });
+
+    // Find upcoming bookings (start time is in the future)
+    const future = bookings.filter(b => parseBookingTime(b.startTime) > now);
+    const roomWithAmenities = { ...room, amenities: JSON.parse(room.amenities) };
+
+    const upcomingBookings: BookingWithDetails[] = future.slice(0, 3).map(b => ({
+      ...b,
+      attendees: JSON.parse(b.attendees),
+      room: roomWithAmenities,
+    }));
+
+    const currentBookingWithDetails = currentBooking ? {
+      ...currentBooking,
+      attendees: JSON.parse(currentBooking.attendees),
+      room: roomWithAmenities,
+      isDeviceBooking: currentBooking.userId === DEVICE_BOOKING_USER_ID,
+    } : null;
+
+    // Effective opening hours (room override or global), so the panel can
+    // sleep while the building is closed
+    const globalSettings = await SettingsModel.getGlobal();
+
+    const status: DeviceRoomStatus = {
+      room: roomWithAmenities,
+      currentBooking: currentBookingWithDetails,
+      upcomingBookings,
+      isAvailable: !currentBooking,
+      openingHour: room.openingHour ?? globalSettings.openingHour,
+      closingHour: room.closingHour ?? globalSettings.closingHour,
+    };
+
+    // The status changes when the current meeting ends or the next one starts
+    const nextMidnight = new Date(todayStart);
+    nextMidnight.setDate(nextMidnight.getDate() + 1);
+    const boundaries = [now.getTime() + MAX_AGE_MS, nextMidnight.getTime()];
+    if (currentBooking) boundaries.push(parseBookingTime(currentBooking.endTime).getTime());
+    for (const b of future) boundaries.push(parseBookingTime(b.startTime).getTime());
+
+    const dynamic: DeviceRoomStatusDynamic = {
+      roomVersion: roomVersion(room),
+      currentBooking: currentBooking
+        ? bookingSummary(currentBooking, currentBooking.userId === DEVICE_BOOKING_USER_ID)
+        : null,
+      upcomingBookings: future.slice(0, 3).map(b => bookingSummary(b)),
+      isAvailable: status.isAvailable,
+      openingHour: status.openingHour,
+      closingHour: status.closingHour,
+    };
+
+    const body = Buffer.from(JSON.stringify(status));
+    const dynamicBody = Buffer.from(JSON.stringify(dynamic));
+    const entry: CachedRoomStatus = {
+      status,
+      body,
+      etag: etagOf(body),
+      dynamic,
+      dynamicBody,
+      dynamicEtag: etagOf(dynamicBody),
+      config: globalSettings.deviceConfigVersion > 0
+        ? { ...globalSettings.deviceConfig, version: globalSettings.deviceConfigVersion }
+        : null,
+      validUntil: Math.min(...boundaries),
+    };
+
+    console.log('Room status built:', room.name, '| Available:', !currentBooking,
+      '| Current booking:', currentBooking?.title || 'none', '| Bookings:', bookings.length);
+
+    // Don't keep a status that was invalidated while it was being built
+    if (this.generation(room.id) === generation) {
+      this.entries.set(room.id, entry);
+    }
+    return entry;
+  }
+}
+
+export const deviceStatusCache = new DeviceStatusCache();
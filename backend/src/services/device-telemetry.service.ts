@@ -0,0 +1,202 @@
+import { DeviceTelemetryModel } from '../models/device-telemetry.model';
+import { DeviceTelemetryBucket } from '../types';
+
+// Fleet telemetry from display panels. Each panel closes one sample a minute
+// and uploads them in batches every few minutes; ingest only validates the
+// batch and merges it into per-device minute buckets in memory, which are
+// written in one batched INSERT every flush interval. A background pass rolls
+// minute rows up into hours and hours into days, and drops rows past their
+// retention.
+
+const MINUTE = 60;
+const HOUR = 3600;
+const DAY = 86400;
+
+// Minute rows are kept 2 days, hours 30 days, days about a year
+const RETENTION_SECONDS: Record<number, number> = {
+  [MINUTE]: 2 * DAY,
+  [HOUR]: 30 * DAY,
+  [DAY]: 400 * DAY,
+};
+
+const ROLLUP_INTERVAL_MS = 5 * 60 * 1000;
+
+// The current and previous hour (day) are rolled up again on every pass, so
+// samples a panel had to buffer while offline still land in the rollups
+const ROLLUP_REPEAT = 2;
+
+// Samples accepted per upload (the firmware buffers one hour)
+export const TELEMETRY_MAX_SAMPLES = 120;
+
+// Buckets held in memory while the database is unreachable
+const MAX_PENDING_BUCKETS = 100000;
+
+// Upload format version 1: {"v":1,"b":<boot id>,"n":<seq of first sample>,"s":[[...], ...]}
+// with each sample [age, polls, pollErrors, pollMsSum, pollMsMax, heapMin,
+// rssi, redraws, redrawMsSum, redrawMsMax]. age is seconds between the end of
+// the sample's minute and the upload; pollMsSum covers successful polls only;
+// rssi 0 means not connected.
+const SAMPLE_FIELDS = 10;
+
+export interface TelemetryBatch {
+  v: number;
+  b: number;
+  n: number;
+  s: number[][];
+}
+
+export function isTelemetryBatch(body: any): body is TelemetryBatch {
+  return !!body && body.v === 1 &&
+    Number.isInteger(body.b) && Number.isInteger(body.n) && body.n >= 0 &&
+    Array.isArray(body.s) && body.s.length <= TELEMETRY_MAX_SAMPLES &&
+    body.s.every((sample: unknown) => Array.isArray(sample) && sample.length === SAMPLE_FIELDS &&
+      // Only rssi may be negative
+      sample.every((v, i) => Number.isFinite(v) && (v >= 0 || i === 6)));
+}
+
+function floorTo(ms: number, seconds: number): number {
+  return Math.floor(ms / (seconds * 1000)) * seconds * 1000;
+}
+
+class DeviceTelemetryService {
+  private pending = new Map<string, DeviceTelemetryBucket>();
+  // Per device: boot id and next expected sample number, to drop resent samples
+  private sequences = new Map<string, { boot: number; next: number }>();
+  private flushTimer: NodeJS.Timeout | null = null;
+  private rollupTimer: NodeJS.Timeout | null = null;
+  private flushing = false;
+  private rollingUp = false;
+  private readonly flushIntervalMs: number;
+
+  constructor() {
+    this.flushIntervalMs = parseInt(process.env.DEVICE_TELEMETRY_FLUSH_SECONDS ?? '60', 10) * 1000;
+  }
+
+  start(): void {
+    if (this.flushTimer) return;
+    this.flushTimer = setInterval(() => this.flush(), this.flushIntervalMs);
+    this.rollupTimer = setInterval(() => this.rollup(), ROLLUP_INTERVAL_MS);
+    console.log(`Device telemetry started (flushing every ${this.flushIntervalMs / 1000}s)`);
+  }
+
+  /** Merge an upload into the pending minute buckets; returns the samples accepted */
+  record(deviceId: string, batch: TelemetryBatch, receivedAt = Date.now()): number {
+    const seq = this.sequences.get(deviceId);
+    // Samples up to `next` were already stored if the panel is resending after a lost answer
+    const first = seq && seq.boot === batch.b ? Math.max(0, seq.next - batch.n) : 0;
+    let accepted = 0;
+
+    for (let i = first; i < batch.s.length; i++) {
+      const [age, polls, pollErrors, pollMsSum, pollMsMax, heapMin, rssi, redraws, redrawMsSum, redrawMsMax] = batch.s[i];
+      // Bucket by the middle of the sample's minute
+      const bucketStart = floorTo(receivedAt - age * 1000 - 30000, MINUTE);
+      const bucket = this.bucket(deviceId, bucketStart);
+
+      bucket.samples++;
+      bucket.polls += polls;
+      bucket.pollErrors += pollErrors;
+      bucket.pollMsSum += pollMsSum;
+      bucket.pollMsMax = Math.max(bucket.pollMsMax, pollMsMax);
+      if (heapMin > 0) bucket.heapMin = bucket.heapMin === null ? heapMin : Math.min(bucket.heapMin, heapMin);
+      if (rssi !== 0) {
+        bucket.rssiSum += rssi;
+        bucket.rssiSamples++;
+        bucket.rssiMin = bucket.rssiMin === null ? rssi : Math.min(bucket.rssiMin, rssi);
+      }
+      bucket.redraws += redraws;
+      bucket.redrawMsSum += redrawMsSum;
+      bucket.redrawMsMax = Math.max(bucket.redrawMsMax, redrawMsMax);
+      // The first sample after a boot counts the reboot
+      if (batch.n + i === 0) bucket.reboots++;
+      accepted++;
+    }
+
+    const next = batch.n + batch.s.length;
+    if (!seq || seq.boot !== batch.b || next > seq.next) {
+      this.sequences.set(deviceId, { boot: batch.b, next });
+    }
+    return accepted;
+  }
+
+  async flush(): Promise<void> {
+    if (this.flushing || this.pending.size === 0) return;
+    this.flushing = true;
+    const batch = this.pending;
+    this.pending = new Map();
+    try {
+      await DeviceTelemetryModel.insertBuckets(Array.from(batch.values()));
+    } catch (err: any) {
+      console.error('Failed to write device telemetry:', err.message);
+      // Keep them for the next flush, up to a bound
+      for (const [key, bucket] of batch) {
+        if (this.pending.size >= MAX_PENDING_BUCKETS) break;
+        if (!this.pending.has(key)) this.pending.set(key, bucket);
+      }
+    } finally {
+      this.flushing = false;
+    }
+  }
+
+  /** Roll recent minutes into hours and hours into days, then apply retention */
+  async rollup(now = Date.now()): Promise<void> {
+    if (this.rollingUp) return;
+    this.rollingUp = true;
+    try {
+      await this.flush();
+      for (let i = ROLLUP_REPEAT - 1; i >= 0; i--) {
+        await DeviceTelemetryModel.rollup(MINUTE, HOUR, new Date(floorTo(now, HOUR) - i * HOUR * 1000));
+      }
+      for (let i = ROLLUP_REPEAT - 1; i >= 0; i--) {
+        await DeviceTelemetryModel.rollup(HOUR, DAY, new Date(floorTo(now, DAY) - i * DAY * 1000));
+      }
+      for (const [resolution, seconds] of Object.entries(RETENTION_SECONDS)) {
+        await DeviceTelemetryModel.deleteOlderThan(Number(resolution), new Date(now - seconds * 1000));
+      }
+    } catch (err: any) {
+      console.error('Failed to roll up device telemetry:', err.message);
+    } finally {
+      this.rollingUp = false;
+    }
+  }
+
+  /** Stop the timers and write what is pending (graceful shutdown) */
+  async stop(): Promise<void> {
+    if (this.flushTimer) {
+      clearInterval(this.flushTimer);
+      this.flushTimer = null;
+    }
+    if (this.rollupTimer) {
+      clearInterval(this.rollupTimer);
+      this.rollupTimer = null;
+    }
+    // A flush already running has taken its batch; let it finish, then write the rest
+    while (this.flushing) await new Promise(resolve => setTimeout(resolve, 50));
+    await this.flush();
+  }
+
+  private bucket(deviceId: string, bucketStart: number): DeviceTelemetryBucket {
+    const key = `${deviceId}|${bucketStart}`;
+    let bucket = this.pending.get(key);
+    if (!bucket) {
+      bucket = {
+        deviceId,
+        resolution: MINUTE,
+        bucketStart: new Date(bucketStart).toISOString(),
+        samples: 0, polls: 0, pollErrors: 0, pollMsSum: 0, pollMsMax: 0,
+        heapMin: null, rssiSum: 0, rssiSamples: 0, rssiMin: null,
+        redraws: 0, redrawMsSum: 0, redrawMsMax: 0, reboots: 0,
+      };
+      this.pending.set(key, bucket);
+    }
+    return bucket;
+  }
+}
+
+export const deviceTelemetry = new DeviceTelemetryService();
+
+/** Which stored resolution to summarize a range of `hours` from */
+export function telemetryResolutionFor(hours: number): number {
+  if (hours <= 6) return MINUTE;
+  if (hours <= 14 * 24) return HOUR;
+  return DAY;
+}
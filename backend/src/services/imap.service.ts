@@ -42,6 +42,7 @@ import { MeetingRoom } from '../types';
 import { parseMeetingRequest } from './ical-parser.service';
 import { sendImipAccept, sendImipDecline } from './email.service';
 import { auditLog, AuditAction } from './audit.service';
+import { deviceStatusCache } from './device-status.service';
 
 const MAX_EMAIL_BYTES = 1 * 1024 * 1024; // 1 MB hard cap
 
@@ -372,6 +373,7 @@ async function processMessage(rawBuffer: Buffer, room: MeetingRoom): Promise<voi
       });
 
       if (updated) {
+        deviceStatusCache.invalidateRoom(updated.roomId);
         await db('email_uid_map').where('ical_uid', meeting.uid).update({
           sequence: meeting.sequence,
           booking_id: existingUid.booking_id,
@@ -422,6 +424,7 @@ async function processMessage(rawBuffer: Buffer, room: MeetingRoom): Promise<voi
       },
       user.id
     );
+    deviceStatusCache.invalidateRoom(room.id);
 
     // Track the iCal UID so future updates can modify this booking
     await db('email_uid_map')
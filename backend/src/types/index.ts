@@ -115,6 +115,25 @@ export interface Settings {
   bannerLevel: 'info' | 'warning' | 'critical';
   bannerStartsAt: string | null;
   bannerEndsAt: string | null;
+  // Runtime config pushed to display devices
+  deviceConfig: DeviceRuntimeConfig;
+  deviceConfigVersion: number;
+}
+
+// Display device settings the server can override without a firmware
+// rollout. Every field is optional: unset values use the firmware default.
+export interface DeviceRuntimeConfig {
+  statusPollSeconds?: number;
+  pingSeconds?: number;
+  firmwareCheckSeconds?: number;
+  screenTimeoutSeconds?: number;
+  ledBrightness?: number;  // Percent
+  quickBookConfirm?: boolean;
+  bookingResultSeconds?: number;
+  apiUrls?: string[];  // More API base URLs for devices to fail over to
+  mqttUrl?: string;    // Broker for pushed status and commands, mqtt[s]://[user:pass@]host[:port][/prefix]
+  roomGroup?: boolean; // Panels of a room elect one to poll and relay the status over the LAN
+  peerFirmware?: boolean; // Panels fetch firmware updates from panels on the LAN that installed them
 }
 
 export interface Booking {
@@ -250,6 +269,31 @@ export interface DeviceRoomStatus {
   currentBooking: BookingWithDetails | null;
   upcomingBookings: BookingWithDetails[];
   isAvailable: boolean;
+  openingHour: number;  // Effective for this room (room override or global)
+  closingHour: number;
+  // Only when the device's X-Config-Version differs from the current version
+  config?: DeviceRuntimeConfig & { version: number };
+}
+
+// Booking as a display panel shows it
+export interface DeviceBookingSummary {
+  id: string;
+  title: string;
+  startTime: string;
+  endTime: string;
+  isDeviceBooking?: boolean;
+}
+
+// /device/status for devices that cache the room from /device/info: only
+// what changes during the day, plus the version of the room data
+export interface DeviceRoomStatusDynamic {
+  roomVersion: string;
+  currentBooking: DeviceBookingSummary | null;
+  upcomingBookings: DeviceBookingSummary[];
+  isAvailable: boolean;
+  openingHour: number;
+  closingHour: number;
+  config?: DeviceRuntimeConfig & { version: number };
 }
 
 export interface DeviceQuickBookingRequest {
@@ -257,6 +301,48 @@ export interface DeviceQuickBookingRequest {
   durationMinutes: number; // Quick booking duration (e.g., 15, 30, 60 minutes)
 }
 
+// Device telemetry: per-device aggregates over one bucket (60, 3600 or 86400 s)
+export interface DeviceTelemetryBucket {
+  deviceId: string;
+  resolution: number;
+  bucketStart: string;
+  samples: number;
+  polls: number;
+  pollErrors: number;
+  pollMsSum: number;
+  pollMsMax: number;
+  heapMin: number | null;
+  rssiSum: number;
+  rssiSamples: number;
+  rssiMin: number | null;
+  redraws: number;
+  redrawMsSum: number;
+  redrawMsMax: number;
+  reboots: number;
+}
+
+export type DeviceTelemetryMetric = 'poll' | 'errors' | 'heap' | 'rssi' | 'redraw' | 'reboots';
+
+// One panel's telemetry over a time range, for the worst-panels view
+export interface DeviceTelemetrySummary {
+  deviceId: string;
+  deviceName: string;
+  roomName: string | null;
+  firmwareVersion: string | null;
+  lastSeenAt: string | null;
+  samples: number;
+  polls: number;
+  pollErrorRate: number;      // 0-1
+  pollMsAvg: number | null;
+  pollMsMax: number;
+  heapMin: number | null;
+  rssiAvg: number | null;
+  rssiMin: number | null;
+  redrawMsAvg: number | null;
+  redrawMsMax: number;
+  reboots: number;
+}
+
 // Firmware types for OTA updates
 export interface Firmware {
   id: string;
@@ -37,3 +37,10 @@ export function decrypt(encryptedStr: string): string {
   decrypted += decipher.final('utf8');
   return decrypted;
 }
+
+// Key the panels of a room sign their LAN room group messages with
+// (device/include/room_group.h). Derived rather than stored: every panel of
+// the room gets the same one, and a new ENCRYPTION_KEY replaces them all.
+export function roomGroupSecret(roomId: string): string {
+  return crypto.createHmac('sha256', getEncryptionKey()).update(`room-group:${roomId}`).digest('hex');
+}
@@ -0,0 +1,63 @@
+#include "bench.h"
+
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+// Counts every heap allocation made by the benchmarked code. String (std::string)
+// goes through operator new; ArduinoJson calls malloc directly, which is
+// intercepted with the linker's --wrap option (see env:native_bench).
+
+static std::atomic<uint64_t> allocCount(0);
+static std::atomic<uint64_t> allocBytes(0);
+
+static inline void count(size_t size) {
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+AllocStats allocSnapshot() {
+    return {allocCount.load(), allocBytes.load()};
+}
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+void* __wrap_malloc(size_t size) {
+    count(size);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t n, size_t size) {
+    count(n * size);
+    return __real_calloc(n, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    count(size);
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void* ptr) {
+    __real_free(ptr);
+}
+}
+
+void* operator new(size_t size) {
+    count(size);
+    void* p = __real_malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept { __real_free(p); }
+void operator delete[](void* p) noexcept { __real_free(p); }
+void operator delete(void* p, size_t) noexcept { __real_free(p); }
+void operator delete[](void* p, size_t) noexcept { __real_free(p); }
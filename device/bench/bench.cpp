@@ -0,0 +1,56 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+
+static const int RUNS = 7;
+static const double MIN_RUN_NS = 50e6;  // 50 ms per timed run
+
+static double timeRun(BenchFn fn, void* ctx, uint64_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; i++) {
+        fn(ctx);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+}
+
+BenchResult runBenchmark(const char* name, BenchFn fn, void* ctx) {
+    // Warm up and grow the iteration count until one run takes long enough
+    uint64_t iterations = 1;
+    double ns = timeRun(fn, ctx, iterations);
+    while (ns < MIN_RUN_NS && iterations < (1ULL << 32)) {
+        iterations *= (ns < MIN_RUN_NS / 10) ? 10 : 2;
+        ns = timeRun(fn, ctx, iterations);
+    }
+
+    // Allocations are deterministic, so one counted pass is enough
+    AllocStats before = allocSnapshot();
+    timeRun(fn, ctx, iterations);
+    AllocStats after = allocSnapshot();
+
+    double samples[RUNS];
+    for (int i = 0; i < RUNS; i++) {
+        samples[i] = timeRun(fn, ctx, iterations) / iterations;
+    }
+    std::sort(samples, samples + RUNS);
+
+    BenchResult r;
+    r.name = name;
+    r.iterations = iterations;
+    r.nsPerOp = samples[RUNS / 2];
+    r.allocsPerOp = (double)(after.allocs - before.allocs) / iterations;
+    r.bytesPerOp = (double)(after.bytes - before.bytes) / iterations;
+    return r;
+}
+
+void printHeader() {
+    printf("%-36s %12s %12s %12s %12s\n", "benchmark", "iterations", "ns/op", "allocs/op", "B/op");
+}
+
+void printResult(const BenchResult& r) {
+    printf("%-36s %12llu %12.1f %12.1f %12.1f\n", r.name, (unsigned long long)r.iterations,
+           r.nsPerOp, r.allocsPerOp, r.bytesPerOp);
+    fflush(stdout);
+}
@@ -0,0 +1,37 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Heap counters maintained by alloc_counter.cpp (operator new plus wrapped malloc)
+struct AllocStats {
+    uint64_t allocs;
+    uint64_t bytes;
+};
+
+AllocStats allocSnapshot();
+
+// Keep the optimizer from discarding a computed value
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct BenchResult {
+    const char* name;
+    uint64_t iterations;
+    double nsPerOp;
+    double allocsPerOp;
+    double bytesPerOp;
+};
+
+typedef void (*BenchFn)(void* ctx);
+
+// Calibrates an iteration count, then reports the median of several timed runs
+BenchResult runBenchmark(const char* name, BenchFn fn, void* ctx);
+
+void printHeader();
+void printResult(const BenchResult& r);
+
+#endif // BENCH_H
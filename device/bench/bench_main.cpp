@@ -0,0 +1,120 @@
+// Host microbenchmarks for the per-poll and per-redraw hot paths.
+//
+//   pio run -e native_bench -t exec             # all benchmarks
+//   .pio/build/native_bench/program parse       # only names containing "parse"
+//
+// Reports the median ns/op of several runs plus heap allocations per op.
+
+#include <Arduino.h>
+#include <stdio.h>
+#include "api_client.h"
+#include "text_format.h"
+#include "time_utils.h"
+#include "bench.h"
+#include "../test/fixtures/status_payloads.h"
+
+struct ParseCtx {
+    String payload;
+};
+
+static void benchParse(void* ctx) {
+    RoomStatus status = ApiClient::parseRoomStatus(static_cast<ParseCtx*>(ctx)->payload);
+    doNotOptimize(status.isValid);
+}
+
+struct FormatTimeCtx {
+    String iso;
+    String timezone;
+};
+
+static void benchFormatTime(void* ctx) {
+    FormatTimeCtx* c = static_cast<FormatTimeCtx*>(ctx);
+    String s = formatLocalTime(c->iso, c->timezone);
+    doNotOptimize(s.length());
+}
+
+struct CompareCtx {
+    RoomStatus a;
+    RoomStatus b;
+};
+
+static void benchCompare(void* ctx) {
+    CompareCtx* c = static_cast<CompareCtx*>(ctx);
+    bool equal = roomStatusesAreEqual(c->a, c->b);
+    doNotOptimize(equal);
+}
+
+static void benchDurationLabels(void* ctx) {
+    (void)ctx;
+    static const int durations[] = {15, 30, 45, 60, 90, 120};
+    for (int d : durations) {
+        String s = formatDurationLabel(d);
+        doNotOptimize(s.length());
+    }
+}
+
+struct TextCtx {
+    String text;
+    int maxChars;
+};
+
+static void benchTruncate(void* ctx) {
+    TextCtx* c = static_cast<TextCtx*>(ctx);
+    String s = truncateText(c->text, c->maxChars);
+    doNotOptimize(s.length());
+}
+
+static void benchWrap(void* ctx) {
+    TextCtx* c = static_cast<TextCtx*>(ctx);
+    String lines[8];
+    int n = wrapText(c->text, c->maxChars, lines, 8);
+    doNotOptimize(n);
+}
+
+struct Entry {
+    const char* name;
+    BenchFn fn;
+    void* ctx;
+};
+
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+
+    ParseCtx small = {STATUS_SMALL};
+    ParseCtx typical = {STATUS_TYPICAL};
+    ParseCtx large = {STATUS_LARGE};
+
+    FormatTimeCtx utc = {"2025-03-12T09:05:00.000Z", "UTC0"};
+    FormatTimeCtx cet = {"2025-03-12T09:05:00.000Z", "CET-1CEST,M3.5.0,M10.5.0/3"};
+    FormatTimeCtx newYork = {"2025-03-12T09:05:00.000Z", "EST5EDT,M3.2.0,M11.1.0"};
+
+    CompareCtx same;
+    same.a = ApiClient::parseRoomStatus(typical.payload);
+    same.b = same.a;
+    CompareCtx changed = same;
+    changed.b.upcomingBookings[2].id = "b1a0c3d2-4444-4a4a-9c9c-000000000005";
+
+    TextCtx title = {"Quarterly business review with regional sales leads and finance", 28};
+    TextCtx message = {"Room is already booked for this time slot. Please pick another duration.", 35};
+
+    Entry entries[] = {
+        {"parse_status/small", benchParse, &small},
+        {"parse_status/typical", benchParse, &typical},
+        {"parse_status/large", benchParse, &large},
+        {"format_time/utc", benchFormatTime, &utc},
+        {"format_time/cet", benchFormatTime, &cet},
+        {"format_time/new_york", benchFormatTime, &newYork},
+        {"status_equal/same", benchCompare, &same},
+        {"status_equal/last_differs", benchCompare, &changed},
+        {"duration_labels/x6", benchDurationLabels, nullptr},
+        {"truncate_title", benchTruncate, &title},
+        {"wrap_text/error_message", benchWrap, &message},
+    };
+
+    printHeader();
+    for (const Entry& e : entries) {
+        if (filter && !strstr(e.name, filter)) continue;
+        printResult(runBenchmark(e.name, e.fn, e.ctx));
+    }
+    return 0;
+}
@@ -0,0 +1,60 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+// Minimal Arduino core for host (env:native) builds. Only what the
+// platform-independent firmware sources need is provided here.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include "WString.h"
+#include "IPAddress.h"
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT  0x01
+#define OUTPUT 0x03
+
+// Code placement attribute for ISR-reachable code on the ESP32
+#define IRAM_ATTR
+
+using std::min;
+using std::max;
+
+#ifndef constrain
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#endif
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+long random(long howbig);
+long random(long howsmall, long howbig);
+
+// Serial output is dropped unless HOST_SERIAL=1 is set in the environment,
+// so tests and benchmarks aren't dominated by log formatting
+class HardwareSerial {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    size_t print(const String& s);
+    size_t print(const char* s);
+    size_t print(char c);
+    size_t print(int n);
+    size_t print(unsigned long n);
+    size_t println(const String& s);
+    size_t println(const char* s);
+    size_t println(int n);
+    size_t println();
+    int printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+private:
+    bool enabled();
+};
+
+extern HardwareSerial Serial;
+
+#endif // ARDUINO_H
@@ -0,0 +1,82 @@
+#ifndef ESP_MDNS_H
+#define ESP_MDNS_H
+
+#include <Arduino.h>
+#include <map>
+#include <vector>
+
+// Host stand-in for the ESP32 mDNS responder: nothing goes on the network.
+// Tests read back the advertised services and choose what a query finds.
+class MDNSResponder {
+public:
+    struct Service {
+        String name;        // Without the leading underscore, e.g. "openmeeting"
+        String proto;       // "udp" or "tcp"
+        uint16_t port;
+        std::map<String, String> txt;
+    };
+    struct Answer {
+        IPAddress ip;
+        std::map<String, String> txt;
+    };
+
+    bool begin(const char* hostName) {
+        if (refuseBegin) return false;
+        hostname = hostName;
+        return true;
+    }
+    void end() {
+        hostname = "";
+        services.clear();
+    }
+
+    bool addService(const String& name, const String& proto, uint16_t port) {
+        removeService(name, proto);
+        services.push_back({name, proto, port, {}});
+        return true;
+    }
+    bool addServiceTxt(const String& name, const String& proto, const String& key, const String& value) {
+        Service* s = service(name, proto);
+        if (!s) return false;
+        s->txt[key] = value;
+        return true;
+    }
+    void removeService(const String& name, const String& proto) {
+        for (size_t i = 0; i < services.size(); i++) {
+            if (services[i].name == name && services[i].proto == proto) {
+                services.erase(services.begin() + i);
+                return;
+            }
+        }
+    }
+    Service* service(const String& name, const String& proto) {
+        for (Service& s : services) {
+            if (s.name == name && s.proto == proto) return &s;
+        }
+        return nullptr;
+    }
+
+    // Answers the next query with `answers`, whatever it asks for
+    int queryService(const char* service, const char* proto) {
+        (void)service;
+        (void)proto;
+        queries++;
+        return (int)answers.size();
+    }
+    String txt(int index, const char* key) {
+        const std::map<String, String>& t = answers[index].txt;
+        auto it = t.find(key);
+        return it == t.end() ? String("") : it->second;
+    }
+    IPAddress IP(int index) { return answers[index].ip; }
+
+    bool refuseBegin = false;
+    String hostname;                  // Empty until begin()
+    std::vector<Service> services;
+    std::vector<Answer> answers;
+    int queries = 0;
+};
+
+extern MDNSResponder MDNS;
+
+#endif // ESP_MDNS_H
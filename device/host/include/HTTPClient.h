@@ -0,0 +1,80 @@
+#ifndef HTTP_CLIENT_H
+#define HTTP_CLIENT_H
+
+#include <Arduino.h>
+#include <vector>
+#include "WiFiClient.h"
+
+// Error codes as returned by the ESP32 HTTPClient
+#define HTTPC_ERROR_CONNECTION_REFUSED  (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED  (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED       (-4)
+#define HTTPC_ERROR_CONNECTION_LOST     (-5)
+#define HTTPC_ERROR_NO_STREAM           (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER      (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM        (-8)
+#define HTTPC_ERROR_ENCODING            (-9)
+#define HTTPC_ERROR_STREAM_WRITE        (-10)
+#define HTTPC_ERROR_READ_TIMEOUT        (-11)
+
+#define HTTP_CODE_OK 200
+
+// Outcome of the most recent request made on the calling thread.
+// Host-only: lets tools measure what ApiClient did without changing it
+struct HttpExchange {
+    String method;
+    String path;          // URL path, e.g. "/api/device/status"
+    int code;             // HTTP status or HTTPC_ERROR_*
+    uint32_t latencyUs;   // Connect to end of body
+    uint32_t bytesIn;
+};
+
+// Host stand-in for the ESP32 HTTPClient: plain HTTP/1.1 over POSIX sockets,
+// one connection per request (like the firmware's use of it). https:// URLs
+// fail with HTTPC_ERROR_CONNECTION_REFUSED.
+class HTTPClient {
+public:
+    ~HTTPClient();
+
+    bool begin(const String& url);
+    bool begin(WiFiClient& client, const String& url);
+    void end();
+
+    void setTimeout(uint16_t timeout) { _timeout = timeout; }
+    void setConnectTimeout(int32_t timeout) { _connectTimeout = timeout; }
+    void addHeader(const String& name, const String& value);
+    // Response headers to keep; header() returns "" for any other
+    void collectHeaders(const char* headerKeys[], const size_t headerKeysCount);
+    String header(const char* name);
+    bool hasHeader(const char* name);
+
+    int GET();
+    int POST(const String& payload);
+    int sendRequest(const char* method, const String& payload);
+
+    String getString() { return _body; }
+    int getSize() { return (int)_body.length(); }
+    static String errorToString(int error);
+
+    static const HttpExchange& lastExchange();
+
+private:
+    String _url;
+    String _host;
+    uint16_t _port = 80;
+    String _path;
+    bool _secure = false;
+    String _headers;
+    String _body;
+    std::vector<std::pair<String, String>> _collected;  // Lower-case name, value
+    uint16_t _timeout = 5000;
+    int32_t _connectTimeout = 5000;
+    int _socket = -1;
+
+    int connectSocket();
+    int readResponse();
+    void closeSocket();
+};
+
+#endif // HTTP_CLIENT_H
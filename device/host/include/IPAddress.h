@@ -0,0 +1,31 @@
+#ifndef IP_ADDRESS_H
+#define IP_ADDRESS_H
+
+#include <stdint.h>
+#include "WString.h"
+
+// IPv4 address as the ESP32 core has it: converts to and from uint32_t with
+// the first octet in the low byte
+class IPAddress {
+public:
+    IPAddress() : _address(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        : _address((uint32_t)a | (uint32_t)b << 8 | (uint32_t)c << 16 | (uint32_t)d << 24) {}
+    IPAddress(uint32_t address) : _address(address) {}
+
+    operator uint32_t() const { return _address; }
+    uint8_t operator[](int index) const { return (uint8_t)(_address >> (index * 8)); }
+    bool operator==(const IPAddress& other) const { return _address == other._address; }
+    bool operator!=(const IPAddress& other) const { return _address != other._address; }
+
+    String toString() const {
+        char s[16];
+        snprintf(s, sizeof(s), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+        return String(s);
+    }
+
+private:
+    uint32_t _address;
+};
+
+#endif // IP_ADDRESS_H
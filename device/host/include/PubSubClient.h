@@ -0,0 +1,123 @@
+#ifndef PUB_SUB_CLIENT_H
+#define PUB_SUB_CLIENT_H
+
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+#include "WiFiClient.h"
+
+// state() values, as in knolleary/PubSubClient
+#define MQTT_CONNECTION_TIMEOUT      (-4)
+#define MQTT_CONNECTION_LOST         (-3)
+#define MQTT_CONNECT_FAILED          (-2)
+#define MQTT_DISCONNECTED            (-1)
+#define MQTT_CONNECTED               0
+#define MQTT_CONNECT_BAD_PROTOCOL    1
+#define MQTT_CONNECT_BAD_CLIENT_ID   2
+#define MQTT_CONNECT_UNAVAILABLE     3
+#define MQTT_CONNECT_BAD_CREDENTIALS 4
+#define MQTT_CONNECT_UNAUTHORIZED    5
+
+// Host stand-in for PubSubClient: there is no broker. Tests choose what
+// connect() answers, queue messages for loop() to deliver, and read back
+// what was published and subscribed.
+class PubSubClient {
+public:
+    typedef std::function<void(char*, uint8_t*, unsigned int)> Callback;
+
+    struct Message {
+        String topic;
+        String payload;
+        bool retained;
+    };
+
+    PubSubClient& setClient(WiFiClient& client) { (void)client; return *this; }
+    PubSubClient& setServer(const char* host, uint16_t port) {
+        this->host = host;
+        this->port = port;
+        return *this;
+    }
+    PubSubClient& setCallback(Callback callback) { _callback = callback; return *this; }
+    PubSubClient& setKeepAlive(uint16_t seconds) { (void)seconds; return *this; }
+    PubSubClient& setSocketTimeout(uint16_t seconds) { (void)seconds; return *this; }
+    bool setBufferSize(uint16_t size) { (void)size; return true; }
+
+    bool connect(const char* id, const char* user, const char* pass, const char* willTopic,
+                 uint8_t willQos, bool willRetain, const char* willMessage) {
+        (void)pass;
+        (void)willQos;
+        (void)willRetain;
+        (void)willMessage;
+        connectAttempts++;
+        clientId = id;
+        username = user ? user : "";
+        this->willTopic = willTopic ? willTopic : "";
+        _connected = refuseWith == MQTT_CONNECTED;
+        _state = refuseWith;
+        return _connected;
+    }
+    void disconnect() {
+        _connected = false;
+        _state = MQTT_DISCONNECTED;
+    }
+    bool connected() { return _connected; }
+    int state() { return _state; }
+
+    bool publish(const char* topic, const char* payload, bool retained = false) {
+        if (!_connected) return false;
+        published.push_back({topic, payload, retained});
+        return true;
+    }
+    bool subscribe(const char* topic) {
+        if (!_connected) return false;
+        subscriptions.push_back(topic);
+        return true;
+    }
+    bool unsubscribe(const char* topic) {
+        if (!_connected) return false;
+        for (size_t i = 0; i < subscriptions.size(); i++) {
+            if (subscriptions[i] == topic) {
+                subscriptions.erase(subscriptions.begin() + i);
+                return true;
+            }
+        }
+        return true;
+    }
+
+    // Hands the queued messages to the callback
+    bool loop() {
+        if (!_connected) return false;
+        std::vector<Message> messages;
+        messages.swap(incoming);
+        for (Message& m : messages) {
+            String topic = m.topic;
+            std::vector<char> name(topic.c_str(), topic.c_str() + topic.length() + 1);
+            if (_callback) _callback(name.data(), (uint8_t*)m.payload.c_str(), m.payload.length());
+        }
+        return true;
+    }
+
+    // Test side: the broker goes away, as a dropped TCP connection looks
+    void dropConnection() {
+        _connected = false;
+        _state = MQTT_CONNECTION_LOST;
+    }
+
+    int refuseWith = MQTT_CONNECTED;   // state() after connect(); MQTT_CONNECTED accepts
+    int connectAttempts = 0;
+    String host;
+    uint16_t port = 0;
+    String clientId;
+    String username;
+    String willTopic;
+    std::vector<Message> incoming;     // Delivered by the next loop()
+    std::vector<Message> published;
+    std::vector<String> subscriptions;
+
+private:
+    Callback _callback;
+    bool _connected = false;
+    int _state = MQTT_DISCONNECTED;
+};
+
+#endif // PUB_SUB_CLIENT_H
@@ -0,0 +1,96 @@
+#ifndef WSTRING_H
+#define WSTRING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#define DEC 10
+#define HEX 16
+
+// Host stand-in for the Arduino String class, backed by std::string.
+// Only the subset used by the firmware and ArduinoJson is provided.
+class String {
+public:
+    String() {}
+    String(const char* s) : _s(s ? s : "") {}
+    String(const std::string& s) : _s(s) {}
+    String(char c) : _s(1, c) {}
+    String(int value, unsigned char base = DEC) : _s(fromLong(value, base)) {}
+    String(unsigned int value, unsigned char base = DEC) : _s(fromULong(value, base)) {}
+    String(long value, unsigned char base = DEC) : _s(fromLong(value, base)) {}
+    String(unsigned long value, unsigned char base = DEC) : _s(fromULong(value, base)) {}
+    String(long long value, unsigned char base = DEC) : _s(fromLong(value, base)) {}
+    String(unsigned long long value, unsigned char base = DEC) : _s(fromULong(value, base)) {}
+    String(float value, unsigned int decimals = 2) : _s(fromDouble(value, decimals)) {}
+    String(double value, unsigned int decimals = 2) : _s(fromDouble(value, decimals)) {}
+
+    unsigned int length() const { return (unsigned int)_s.size(); }
+    const char* c_str() const { return _s.c_str(); }
+    bool reserve(unsigned int size) { _s.reserve(size); return true; }
+    char charAt(unsigned int index) const { return index < _s.size() ? _s[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char& operator[](unsigned int index) { return _s[index]; }
+
+    bool concat(const String& s) { _s += s._s; return true; }
+    bool concat(const char* s) { if (s) _s += s; return true; }
+    bool concat(const char* s, unsigned int n) { if (s) _s.append(s, n); return true; }
+    bool concat(char c) { _s += c; return true; }
+    String& operator+=(const String& s) { _s += s._s; return *this; }
+    String& operator+=(const char* s) { if (s) _s += s; return *this; }
+    String& operator+=(char c) { _s += c; return *this; }
+    String& operator+=(int v) { _s += fromLong(v, DEC); return *this; }
+    String& operator+=(unsigned long v) { _s += fromULong(v, DEC); return *this; }
+
+    bool equals(const String& s) const { return _s == s._s; }
+    bool equals(const char* s) const { return _s == (s ? s : ""); }
+    bool operator==(const String& s) const { return _s == s._s; }
+    bool operator==(const char* s) const { return equals(s); }
+    bool operator!=(const String& s) const { return _s != s._s; }
+    bool operator!=(const char* s) const { return !equals(s); }
+    bool operator<(const String& s) const { return _s < s._s; }
+
+    bool startsWith(const String& prefix) const { return _s.compare(0, prefix._s.size(), prefix._s) == 0; }
+    bool endsWith(const String& suffix) const {
+        return _s.size() >= suffix._s.size() &&
+               _s.compare(_s.size() - suffix._s.size(), suffix._s.size(), suffix._s) == 0;
+    }
+
+    int indexOf(char c, unsigned int from = 0) const { return npos(_s.find(c, from)); }
+    int indexOf(const String& s, unsigned int from = 0) const { return npos(_s.find(s._s, from)); }
+    int lastIndexOf(char c) const { return npos(_s.rfind(c)); }
+    int lastIndexOf(const String& s) const { return npos(_s.rfind(s._s)); }
+
+    String substring(unsigned int from) const { return from < _s.size() ? String(_s.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) { unsigned int t = from; from = to; to = t; }
+        if (from >= _s.size()) return String();
+        return String(_s.substr(from, to - from));
+    }
+
+    void trim();
+    void toLowerCase();
+    void toUpperCase();
+    void replace(const String& find, const String& with);
+    void remove(unsigned int index, unsigned int count = (unsigned int)-1) { if (index < _s.size()) _s.erase(index, count); }
+    long toInt() const;
+    float toFloat() const;
+
+    const std::string& str() const { return _s; }
+
+private:
+    std::string _s;
+
+    static int npos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+    static std::string fromLong(long long value, unsigned char base);
+    static std::string fromULong(unsigned long long value, unsigned char base);
+    static std::string fromDouble(double value, unsigned int decimals);
+};
+
+inline String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+inline String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, char b) { String r(a); r += b; return r; }
+inline bool operator==(const char* a, const String& b) { return b == a; }
+
+#endif // WSTRING_H
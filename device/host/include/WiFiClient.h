@@ -0,0 +1,12 @@
+#ifndef WIFI_CLIENT_H
+#define WIFI_CLIENT_H
+
+#include <Arduino.h>
+
+// Host stand-in; connections are made by HTTPClient itself
+class WiFiClient {
+public:
+    virtual ~WiFiClient() {}
+};
+
+#endif // WIFI_CLIENT_H
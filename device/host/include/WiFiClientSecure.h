@@ -0,0 +1,12 @@
+#ifndef WIFI_CLIENT_SECURE_H
+#define WIFI_CLIENT_SECURE_H
+
+#include "WiFiClient.h"
+
+// Host stand-in; TLS is not supported by the host HTTPClient
+class WiFiClientSecure : public WiFiClient {
+public:
+    void setInsecure() {}
+};
+
+#endif // WIFI_CLIENT_SECURE_H
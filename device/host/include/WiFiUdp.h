@@ -0,0 +1,68 @@
+#ifndef WIFI_UDP_H
+#define WIFI_UDP_H
+
+#include <Arduino.h>
+#include <vector>
+
+// Host stand-in for WiFiUDP: there is no network. Tests queue datagrams for
+// parsePacket()/read() and read back what was sent.
+class WiFiUDP {
+public:
+    struct Datagram {
+        IPAddress ip;       // Sender of incoming, destination of sent
+        uint16_t port;
+        String data;
+    };
+
+    uint8_t begin(uint16_t port) {
+        if (refuseBegin) return 0;
+        localPort = port;
+        running = true;
+        return 1;
+    }
+    void stop() { running = false; }
+
+    int beginPacket(IPAddress ip, uint16_t port) {
+        _out = {ip, port, ""};
+        return running ? 1 : 0;
+    }
+    size_t write(const uint8_t* data, size_t length) {
+        _out.data.concat((const char*)data, length);
+        return length;
+    }
+    int endPacket() {
+        if (!running) return 0;
+        sent.push_back(_out);
+        return 1;
+    }
+
+    // Next queued datagram's size, 0 when there is none
+    int parsePacket() {
+        if (!running || incoming.empty()) return 0;
+        _in = incoming.front();
+        incoming.erase(incoming.begin());
+        _readPos = 0;
+        return (int)_in.data.length();
+    }
+    int read(char* buffer, size_t length) {
+        size_t n = min(length, (size_t)_in.data.length() - _readPos);
+        memcpy(buffer, _in.data.c_str() + _readPos, n);
+        _readPos += n;
+        return (int)n;
+    }
+    IPAddress remoteIP() { return _in.ip; }
+    uint16_t remotePort() { return _in.port; }
+
+    bool refuseBegin = false;
+    bool running = false;
+    uint16_t localPort = 0;
+    std::vector<Datagram> incoming;   // Read by the next parsePacket() calls
+    std::vector<Datagram> sent;
+
+private:
+    Datagram _out;
+    Datagram _in;
+    size_t _readPos = 0;
+};
+
+#endif // WIFI_UDP_H
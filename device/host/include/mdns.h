@@ -0,0 +1,15 @@
+#ifndef MDNS_H
+#define MDNS_H
+
+#include "ESPmDNS.h"
+
+typedef int esp_err_t;
+#ifndef ESP_OK
+#define ESP_OK 0
+#endif
+#define ESP_ERR_NOT_FOUND 0x105
+
+// ESP-IDF call, as the firmware uses it: "_openmeeting", "_udp"
+esp_err_t mdns_service_remove(const char* service_type, const char* proto);
+
+#endif // MDNS_H
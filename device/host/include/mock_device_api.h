@@ -0,0 +1,128 @@
+#ifndef MOCK_DEVICE_API_H
+#define MOCK_DEVICE_API_H
+
+#include <Arduino.h>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// What the mock server does to a matching request instead of answering normally
+enum MockFaultType {
+    FAULT_NONE,
+    FAULT_STATUS,       // Reply with fault.status (e.g. 500, 503, 429) and fault.body
+    FAULT_TRUNCATE,     // Announce the full Content-Length, send truncateAt bytes, close
+    FAULT_RESET,        // Close the connection without answering
+    FAULT_TLS_ALERT,    // Answer with a TLS handshake alert, as a TLS-only server would
+    FAULT_HANG,         // Read the request, never answer (client hits its read timeout)
+    FAULT_SLOWLORIS     // Send the response a few bytes at a time with pauses in between
+};
+
+struct MockFault {
+    MockFaultType type = FAULT_NONE;
+    uint32_t delayMs = 0;        // Added before the first response byte (any type)
+    int status = 500;            // FAULT_STATUS
+    String body;                 // FAULT_STATUS body, default {"error":"..."}
+    uint32_t retryAfterSec = 0;  // FAULT_STATUS: send Retry-After when > 0
+    uint32_t pollIntervalSec = 0;  // Any answer: send X-Poll-Interval when > 0
+    size_t truncateAt = 0;       // FAULT_TRUNCATE
+    size_t chunkBytes = 1;       // FAULT_SLOWLORIS
+    uint32_t chunkDelayMs = 50;  // FAULT_SLOWLORIS
+    int times = -1;              // Number of requests to hit, -1 = until cleared
+
+    static MockFault latency(uint32_t ms) { MockFault f; f.delayMs = ms; return f; }
+    static MockFault httpStatus(int code, uint32_t retryAfter = 0) {
+        MockFault f; f.type = FAULT_STATUS; f.status = code; f.retryAfterSec = retryAfter; return f;
+    }
+    static MockFault truncate(size_t bytes) { MockFault f; f.type = FAULT_TRUNCATE; f.truncateAt = bytes; return f; }
+    static MockFault reset() { MockFault f; f.type = FAULT_RESET; return f; }
+    static MockFault tlsAlert() { MockFault f; f.type = FAULT_TLS_ALERT; return f; }
+    static MockFault hang() { MockFault f; f.type = FAULT_HANG; return f; }
+    static MockFault slowloris(size_t bytes, uint32_t everyMs) {
+        MockFault f; f.type = FAULT_SLOWLORIS; f.chunkBytes = bytes; f.chunkDelayMs = everyMs; return f;
+    }
+};
+
+// A request as the mock server saw it
+struct MockRequest {
+    String method;
+    String path;          // Relative to /api/device, e.g. "/status"
+    String query;         // After the '?', without it
+    String deviceToken;   // X-Device-Token header
+    String body;
+    int connection;       // Index of the TCP connection it arrived on
+    MockFaultType fault;  // Fault applied, FAULT_NONE when answered normally
+};
+
+// In-process stand-in for the backend's /api/device/* routes, for host tests.
+// Responses are scripted per endpoint; faults are queued per endpoint and
+// consumed in order, so every scenario is deterministic:
+//
+//   MockDeviceApi server;
+//   server.start();
+//   server.setResponse("GET", "/status", 200, STATUS_TYPICAL);
+//   server.addFault("GET", "/status", MockFault::httpStatus(503, 30));
+//   client.setApiUrl(server.url());
+//
+// Keep-alive is honoured, so connectionCount() vs requests().size() shows
+// whether a client reuses connections.
+class MockDeviceApi {
+public:
+    MockDeviceApi();
+    ~MockDeviceApi();
+
+    // Listen on 127.0.0.1; port 0 picks a free port
+    bool start(uint16_t port = 0);
+    void stop();
+
+    String url() const;
+    uint16_t port() const { return _port; }
+
+    // Normal answer for an endpoint; unscripted endpoints answer 404
+    void setResponse(const String& method, const String& path, int status, const String& body);
+    // Extra header on that answer, e.g. a signature; "" removes it
+    void setResponseHeader(const String& method, const String& path, const String& name, const String& value);
+    // Only accept this token (any token is accepted while empty); others get 401
+    void requireToken(const String& token);
+
+    // Queue a fault for an endpoint; path "*" matches every endpoint
+    void addFault(const String& method, const String& path, const MockFault& fault);
+    void clearFaults();
+
+    // Forget recorded requests and connections (scripted responses stay)
+    void clearLog();
+    std::vector<MockRequest> requests() const;
+    int requestCount(const String& method, const String& path) const;
+    int connectionCount() const;
+
+private:
+    struct Response {
+        int status = 404;
+        String body = "{\"error\":\"Not found\"}";
+        std::map<String, String> headers;
+    };
+
+    int _listenFd;
+    uint16_t _port;
+    bool _running;
+    std::thread _acceptThread;
+    std::vector<int> _connFds;      // Open connections; their threads are detached
+
+    mutable std::mutex _mutex;
+    std::condition_variable _stopCv;   // Signals stop and connection exit
+    std::map<String, Response> _responses;
+    std::deque<std::pair<String, MockFault>> _faults;
+    String _requiredToken;
+    std::vector<MockRequest> _log;
+    int _connections;
+
+    void acceptLoop();
+    void serveConnection(int fd, int connection);
+    void serveRequests(int fd, int connection);
+    bool takeFault(const String& key, MockFault& out);
+    bool sleepUnlessStopped(uint32_t ms);
+};
+
+#endif // MOCK_DEVICE_API_H
@@ -0,0 +1,12 @@
+#include <mdns.h>
+
+MDNSResponder MDNS;
+
+esp_err_t mdns_service_remove(const char* service_type, const char* proto) {
+    // The IDF names carry the underscore, MDNSResponder's don't
+    String name = service_type[0] == '_' ? service_type + 1 : service_type;
+    String p = proto[0] == '_' ? proto + 1 : proto;
+    if (!MDNS.service(name, p)) return ESP_ERR_NOT_FOUND;
+    MDNS.removeService(name, p);
+    return ESP_OK;
+}
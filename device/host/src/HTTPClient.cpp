@@ -0,0 +1,272 @@
+#include <HTTPClient.h>
+
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+static thread_local HttpExchange exchange = {"", "", 0, 0, 0};
+
+const HttpExchange& HTTPClient::lastExchange() {
+    return exchange;
+}
+
+HTTPClient::~HTTPClient() {
+    closeSocket();
+}
+
+bool HTTPClient::begin(const String& url) {
+    _url = url;
+    _headers = "";
+    _body = "";
+    _secure = url.startsWith("https://");
+
+    int schemeEnd = url.indexOf("://");
+    if (schemeEnd < 0) return false;
+    String rest = url.substring(schemeEnd + 3);
+
+    int slash = rest.indexOf('/');
+    String hostPort = slash >= 0 ? rest.substring(0, slash) : rest;
+    _path = slash >= 0 ? rest.substring(slash) : String("/");
+
+    int colon = hostPort.indexOf(':');
+    if (colon >= 0) {
+        _host = hostPort.substring(0, colon);
+        _port = (uint16_t)hostPort.substring(colon + 1).toInt();
+    } else {
+        _host = hostPort;
+        _port = _secure ? 443 : 80;
+    }
+    return _host.length() > 0;
+}
+
+bool HTTPClient::begin(WiFiClient& client, const String& url) {
+    (void)client;
+    return begin(url);
+}
+
+void HTTPClient::end() {
+    closeSocket();
+}
+
+void HTTPClient::closeSocket() {
+    if (_socket >= 0) {
+        close(_socket);
+        _socket = -1;
+    }
+}
+
+void HTTPClient::addHeader(const String& name, const String& value) {
+    _headers += name + ": " + value + "\r\n";
+}
+
+void HTTPClient::collectHeaders(const char* headerKeys[], const size_t headerKeysCount) {
+    _collected.clear();
+    for (size_t i = 0; i < headerKeysCount; i++) {
+        String key(headerKeys[i]);
+        key.toLowerCase();
+        _collected.push_back({key, String("")});
+    }
+}
+
+String HTTPClient::header(const char* name) {
+    String key(name);
+    key.toLowerCase();
+    for (const auto& h : _collected) {
+        if (h.first == key) return h.second;
+    }
+    return "";
+}
+
+bool HTTPClient::hasHeader(const char* name) {
+    return header(name).length() > 0;
+}
+
+int HTTPClient::GET() {
+    return sendRequest("GET", "");
+}
+
+int HTTPClient::POST(const String& payload) {
+    return sendRequest("POST", payload);
+}
+
+int HTTPClient::connectSocket() {
+    if (_secure) return HTTPC_ERROR_CONNECTION_REFUSED;
+
+    struct addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* res = nullptr;
+    if (getaddrinfo(_host.c_str(), String((int)_port).c_str(), &hints, &res) != 0) {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+
+    int result = HTTPC_ERROR_CONNECTION_REFUSED;
+    for (struct addrinfo* ai = res; ai && result != 0; ai = ai->ai_next) {
+        int fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) continue;
+
+        // Non-blocking connect so the connect timeout applies
+        int flags = fcntl(fd, F_GETFL, 0);
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        int rc = connect(fd, ai->ai_addr, ai->ai_addrlen);
+        if (rc < 0 && errno == EINPROGRESS) {
+            struct pollfd pfd = {fd, POLLOUT, 0};
+            rc = poll(&pfd, 1, _connectTimeout) == 1 ? 0 : -1;
+            int err = 0;
+            socklen_t len = sizeof(err);
+            if (rc == 0 && (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0)) rc = -1;
+        }
+        if (rc < 0) {
+            close(fd);
+            continue;
+        }
+        fcntl(fd, F_SETFL, flags);
+
+        struct timeval tv = {_timeout / 1000, (_timeout % 1000) * 1000};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        _socket = fd;
+        result = 0;
+    }
+    freeaddrinfo(res);
+    return result;
+}
+
+static bool sendAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+int HTTPClient::sendRequest(const char* method, const String& payload) {
+    auto start = std::chrono::steady_clock::now();
+    _body = "";
+    closeSocket();
+
+    int code = connectSocket();
+    if (code == 0) {
+        String request = String(method) + " " + _path + " HTTP/1.1\r\n";
+        request += "Host: " + _host + "\r\n";
+        request += "User-Agent: ESP32HTTPClient\r\n";
+        request += "Connection: close\r\n";
+        request += _headers;
+        if (payload.length() > 0 || strcmp(method, "POST") == 0) {
+            request += "Content-Length: " + String((int)payload.length()) + "\r\n";
+        }
+        request += "\r\n";
+
+        if (!sendAll(_socket, request.c_str(), request.length())) {
+            code = HTTPC_ERROR_SEND_HEADER_FAILED;
+        } else if (payload.length() > 0 && !sendAll(_socket, payload.c_str(), payload.length())) {
+            code = HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+        } else {
+            code = readResponse();
+        }
+    }
+    closeSocket();
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    exchange.method = method;
+    exchange.path = _path;
+    exchange.code = code;
+    exchange.latencyUs = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    exchange.bytesIn = _body.length();
+    return code;
+}
+
+int HTTPClient::readResponse() {
+    std::string raw;
+    char buf[4096];
+    size_t headerEnd = std::string::npos;
+    long contentLength = -1;
+    bool chunked = false;
+    int status = 0;
+
+    for (;;) {
+        ssize_t n = recv(_socket, buf, sizeof(buf), 0);
+        if (n < 0) {
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? HTTPC_ERROR_READ_TIMEOUT : HTTPC_ERROR_CONNECTION_LOST;
+        }
+        if (n == 0) break;
+        raw.append(buf, (size_t)n);
+
+        if (headerEnd == std::string::npos) {
+            headerEnd = raw.find("\r\n\r\n");
+            if (headerEnd == std::string::npos) continue;
+
+            // Status line and the headers we care about
+            if (raw.compare(0, 5, "HTTP/") != 0) return HTTPC_ERROR_NO_HTTP_SERVER;
+            size_t sp = raw.find(' ');
+            status = atoi(raw.c_str() + sp + 1);
+
+            String original(raw.substr(0, headerEnd));
+            String headers = original;
+            headers.toLowerCase();
+            // Names are case-insensitive; collected values keep their case
+            for (auto& h : _collected) {
+                h.second = "";
+                int at = headers.indexOf("\r\n" + h.first + ":");
+                if (at < 0) continue;
+                int start = at + 2 + h.first.length() + 1;
+                int end = headers.indexOf("\r\n", start);
+                h.second = original.substring(start, end < 0 ? original.length() : end);
+                h.second.trim();
+            }
+            int cl = headers.indexOf("\r\ncontent-length:");
+            if (cl >= 0) contentLength = atol(headers.c_str() + cl + 17);
+            chunked = headers.indexOf("\r\ntransfer-encoding: chunked") >= 0;
+        }
+        if (!chunked && contentLength >= 0 && raw.size() - (headerEnd + 4) >= (size_t)contentLength) break;
+        if (chunked && raw.size() >= 5 && raw.compare(raw.size() - 5, 5, "0\r\n\r\n") == 0) break;
+    }
+
+    if (headerEnd == std::string::npos) return HTTPC_ERROR_CONNECTION_LOST;
+    std::string body = raw.substr(headerEnd + 4);
+    if (contentLength >= 0 && body.size() < (size_t)contentLength) return HTTPC_ERROR_CONNECTION_LOST;
+
+    if (chunked) {
+        std::string decoded;
+        size_t pos = 0;
+        for (;;) {
+            size_t lineEnd = body.find("\r\n", pos);
+            if (lineEnd == std::string::npos) return HTTPC_ERROR_ENCODING;
+            size_t size = strtoul(body.c_str() + pos, nullptr, 16);
+            if (size == 0) break;
+            if (lineEnd + 2 + size > body.size()) return HTTPC_ERROR_CONNECTION_LOST;
+            decoded.append(body, lineEnd + 2, size);
+            pos = lineEnd + 2 + size + 2;
+        }
+        body.swap(decoded);
+    } else if (contentLength >= 0) {
+        body.resize((size_t)contentLength);
+    }
+
+    _body = String(body);
+    return status;
+}
+
+String HTTPClient::errorToString(int error) {
+    switch (error) {
+        case HTTPC_ERROR_CONNECTION_REFUSED: return "connection refused";
+        case HTTPC_ERROR_SEND_HEADER_FAILED: return "send header failed";
+        case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return "send payload failed";
+        case HTTPC_ERROR_NOT_CONNECTED: return "not connected";
+        case HTTPC_ERROR_CONNECTION_LOST: return "connection lost";
+        case HTTPC_ERROR_NO_STREAM: return "no stream";
+        case HTTPC_ERROR_NO_HTTP_SERVER: return "no HTTP server";
+        case HTTPC_ERROR_TOO_LESS_RAM: return "too less ram";
+        case HTTPC_ERROR_ENCODING: return "Transfer-Encoding not supported";
+        case HTTPC_ERROR_STREAM_WRITE: return "Stream write error";
+        case HTTPC_ERROR_READ_TIMEOUT: return "read Timeout";
+        default: return String();
+    }
+}
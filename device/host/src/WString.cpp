@@ -0,0 +1,64 @@
+#include "WString.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+std::string String::fromLong(long long value, unsigned char base) {
+    if (value < 0 && base == DEC) {
+        return "-" + fromULong((unsigned long long)(-value), base);
+    }
+    return fromULong((unsigned long long)value, base);
+}
+
+std::string String::fromULong(unsigned long long value, unsigned char base) {
+    if (base < 2 || base > 36) base = DEC;
+    char buf[65];
+    int i = sizeof(buf) - 1;
+    buf[i] = '\0';
+    do {
+        int digit = (int)(value % base);
+        buf[--i] = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+        value /= base;
+    } while (value > 0 && i > 0);
+    return std::string(&buf[i]);
+}
+
+std::string String::fromDouble(double value, unsigned int decimals) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimals, value);
+    return std::string(buf);
+}
+
+void String::trim() {
+    size_t start = 0;
+    while (start < _s.size() && isspace((unsigned char)_s[start])) start++;
+    size_t end = _s.size();
+    while (end > start && isspace((unsigned char)_s[end - 1])) end--;
+    _s = _s.substr(start, end - start);
+}
+
+void String::toLowerCase() {
+    for (size_t i = 0; i < _s.size(); i++) _s[i] = (char)tolower((unsigned char)_s[i]);
+}
+
+void String::toUpperCase() {
+    for (size_t i = 0; i < _s.size(); i++) _s[i] = (char)toupper((unsigned char)_s[i]);
+}
+
+void String::replace(const String& find, const String& with) {
+    if (find._s.empty()) return;
+    size_t pos = 0;
+    while ((pos = _s.find(find._s, pos)) != std::string::npos) {
+        _s.replace(pos, find._s.size(), with._s);
+        pos += with._s.size();
+    }
+}
+
+long String::toInt() const {
+    return strtol(_s.c_str(), nullptr, 10);
+}
+
+float String::toFloat() const {
+    return strtof(_s.c_str(), nullptr);
+}
@@ -0,0 +1,74 @@
+#include <Arduino.h>
+
+#include <chrono>
+#include <stdarg.h>
+#include <thread>
+
+HardwareSerial Serial;
+
+static const auto bootTime = std::chrono::steady_clock::now();
+
+unsigned long millis() {
+    auto elapsed = std::chrono::steady_clock::now() - bootTime;
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+}
+
+unsigned long micros() {
+    auto elapsed = std::chrono::steady_clock::now() - bootTime;
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+long random(long howbig) {
+    return random(0, howbig);
+}
+
+long random(long howsmall, long howbig) {
+    if (howsmall >= howbig) return howsmall;
+    return howsmall + rand() % (howbig - howsmall);
+}
+
+bool HardwareSerial::enabled() {
+    // Function-local static: initialised once, thread-safe for multi-threaded tools
+    static const bool on = [] {
+        const char* env = getenv("HOST_SERIAL");
+        return env && env[0] == '1';
+    }();
+    return on;
+}
+
+size_t HardwareSerial::print(const String& s) { return print(s.c_str()); }
+
+size_t HardwareSerial::print(const char* s) {
+    if (!enabled() || !s) return 0;
+    return fputs(s, stdout) >= 0 ? strlen(s) : 0;
+}
+
+size_t HardwareSerial::print(char c) {
+    char s[2] = {c, '\0'};
+    return print(s);
+}
+
+size_t HardwareSerial::print(int n) { return print(String(n)); }
+
+size_t HardwareSerial::print(unsigned long n) { return print(String(n)); }
+
+size_t HardwareSerial::println(const String& s) { return print(s) + println(); }
+
+size_t HardwareSerial::println(const char* s) { return print(s) + println(); }
+
+size_t HardwareSerial::println(int n) { return print(n) + println(); }
+
+size_t HardwareSerial::println() { return print("\n"); }
+
+int HardwareSerial::printf(const char* format, ...) {
+    if (!enabled()) return 0;
+    va_list args;
+    va_start(args, format);
+    int n = vprintf(format, args);
+    va_end(args);
+    return n;
+}
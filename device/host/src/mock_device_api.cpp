@@ -0,0 +1,343 @@
+#include <mock_device_api.h>
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static const char* API_PREFIX = "/api/device";
+
+static String statusText(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 404: return "Not Found";
+        case 409: return "Conflict";
+        case 429: return "Too Many Requests";
+        case 500: return "Internal Server Error";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+        default: return "Status";
+    }
+}
+
+static bool sendAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+MockDeviceApi::MockDeviceApi()
+    : _listenFd(-1), _port(0), _running(false), _connections(0) {
+}
+
+MockDeviceApi::~MockDeviceApi() {
+    stop();
+}
+
+bool MockDeviceApi::start(uint16_t port) {
+    if (_running) return true;
+
+    _listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (_listenFd < 0) return false;
+    int one = 1;
+    setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (bind(_listenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(_listenFd, 64) < 0) {
+        close(_listenFd);
+        _listenFd = -1;
+        return false;
+    }
+
+    socklen_t len = sizeof(addr);
+    getsockname(_listenFd, (struct sockaddr*)&addr, &len);
+    _port = ntohs(addr.sin_port);
+
+    _running = true;
+    _acceptThread = std::thread(&MockDeviceApi::acceptLoop, this);
+    return true;
+}
+
+void MockDeviceApi::stop() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_running) return;
+        _running = false;
+        // Wake connection threads blocked in recv()
+        for (int fd : _connFds) {
+            shutdown(fd, SHUT_RDWR);
+        }
+    }
+    _stopCv.notify_all();
+    _acceptThread.join();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _stopCv.wait(lock, [this] { return _connFds.empty(); });
+    close(_listenFd);
+    _listenFd = -1;
+}
+
+String MockDeviceApi::url() const {
+    return "http://127.0.0.1:" + String((int)_port);
+}
+
+void MockDeviceApi::setResponse(const String& method, const String& path, int status, const String& body) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Response& response = _responses[method + " " + path];
+    response.status = status;
+    response.body = body;
+}
+
+void MockDeviceApi::setResponseHeader(const String& method, const String& path, const String& name, const String& value) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::map<String, String>& headers = _responses[method + " " + path].headers;
+    if (value.length() > 0) {
+        headers[name] = value;
+    } else {
+        headers.erase(name);
+    }
+}
+
+void MockDeviceApi::requireToken(const String& token) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _requiredToken = token;
+}
+
+void MockDeviceApi::addFault(const String& method, const String& path, const MockFault& fault) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _faults.push_back({method + " " + path, fault});
+}
+
+void MockDeviceApi::clearFaults() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _faults.clear();
+}
+
+void MockDeviceApi::clearLog() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _log.clear();
+    _connections = 0;
+}
+
+std::vector<MockRequest> MockDeviceApi::requests() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _log;
+}
+
+int MockDeviceApi::requestCount(const String& method, const String& path) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    int count = 0;
+    for (const MockRequest& r : _log) {
+        if (r.method == method && r.path == path) count++;
+    }
+    return count;
+}
+
+int MockDeviceApi::connectionCount() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _connections;
+}
+
+void MockDeviceApi::acceptLoop() {
+    for (;;) {
+        struct pollfd pfd = {_listenFd, POLLIN, 0};
+        int ready = poll(&pfd, 1, 50);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_running) return;
+        if (ready <= 0) continue;
+
+        int fd = accept(_listenFd, nullptr, nullptr);
+        if (fd < 0) continue;
+        _connFds.push_back(fd);
+        std::thread(&MockDeviceApi::serveConnection, this, fd, _connections++).detach();
+    }
+}
+
+// First queued fault matching key ("METHOD /path"), consuming one use of it
+bool MockDeviceApi::takeFault(const String& key, MockFault& out) {
+    int space = key.indexOf(' ');
+    String method = key.substring(0, space);
+    String path = key.substring(space + 1);
+
+    for (auto it = _faults.begin(); it != _faults.end(); ++it) {
+        int fs = it->first.indexOf(' ');
+        String fMethod = it->first.substring(0, fs);
+        String fPath = it->first.substring(fs + 1);
+        if ((fMethod != "*" && fMethod != method) || (fPath != "*" && fPath != path)) continue;
+
+        out = it->second;
+        if (it->second.times > 0 && --it->second.times == 0) {
+            _faults.erase(it);
+        }
+        return true;
+    }
+    return false;
+}
+
+// Sleep, returning false early if the server is stopped meanwhile
+bool MockDeviceApi::sleepUnlessStopped(uint32_t ms) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _stopCv.wait_for(lock, std::chrono::milliseconds(ms), [this] { return !_running; });
+    return _running;
+}
+
+void MockDeviceApi::serveConnection(int fd, int connection) {
+    serveRequests(fd, connection);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    shutdown(fd, SHUT_RDWR);
+    close(fd);
+    _connFds.erase(std::find(_connFds.begin(), _connFds.end(), fd));
+    _stopCv.notify_all();
+}
+
+void MockDeviceApi::serveRequests(int fd, int connection) {
+    std::string buffer;
+    char chunk[2048];
+
+    for (;;) {
+        // Request line and headers
+        size_t headerEnd;
+        while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) return;
+            buffer.append(chunk, (size_t)n);
+        }
+
+        String head(buffer.substr(0, headerEnd));
+        String lower = head;
+        lower.toLowerCase();
+        buffer.erase(0, headerEnd + 4);
+
+        MockRequest request;
+        int sp1 = head.indexOf(' ');
+        int sp2 = head.indexOf(' ', sp1 + 1);
+        request.method = head.substring(0, sp1);
+        request.path = head.substring(sp1 + 1, sp2);
+        int query = request.path.indexOf('?');
+        if (query >= 0) {
+            request.query = request.path.substring(query + 1);
+            request.path = request.path.substring(0, query);
+        }
+        if (request.path.startsWith(API_PREFIX)) request.path = request.path.substring(strlen(API_PREFIX));
+        request.connection = connection;
+        request.fault = FAULT_NONE;
+
+        int tokenAt = lower.indexOf("\r\nx-device-token:");
+        if (tokenAt >= 0) {
+            int lineEnd = head.indexOf("\r\n", tokenAt + 2);
+            request.deviceToken = head.substring(tokenAt + 17, lineEnd < 0 ? head.length() : lineEnd);
+            request.deviceToken.trim();
+        }
+        bool keepAlive = lower.indexOf("\r\nconnection: close") < 0;
+
+        // Body
+        long contentLength = 0;
+        int clAt = lower.indexOf("\r\ncontent-length:");
+        if (clAt >= 0) contentLength = atol(lower.c_str() + clAt + 17);
+        while (buffer.size() < (size_t)contentLength) {
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) return;
+            buffer.append(chunk, (size_t)n);
+        }
+        request.body = String(buffer.substr(0, (size_t)contentLength));
+        buffer.erase(0, (size_t)contentLength);
+
+        // Pick the answer
+        String key = request.method + " " + request.path;
+        MockFault fault;
+        Response response;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!takeFault(key, fault)) fault = MockFault();
+            request.fault = fault.type;
+            _log.push_back(request);
+
+            if (_requiredToken.length() > 0 && request.deviceToken != _requiredToken) {
+                response.status = 401;
+                response.body = "{\"error\":\"Invalid or inactive device token\"}";
+            } else {
+                auto it = _responses.find(key);
+                if (it != _responses.end()) response = it->second;
+            }
+        }
+
+        if (fault.delayMs > 0 && !sleepUnlessStopped(fault.delayMs)) return;
+
+        String extraHeaders;
+        for (const auto& h : response.headers) {
+            extraHeaders += h.first + ": " + h.second + "\r\n";
+        }
+        if (fault.type == FAULT_STATUS) {
+            response.status = fault.status;
+            response.body = fault.body.length() > 0
+                ? fault.body
+                : "{\"error\":\"" + statusText(fault.status) + "\"}";
+            if (fault.retryAfterSec > 0) extraHeaders = "Retry-After: " + String((unsigned long)fault.retryAfterSec) + "\r\n";
+        }
+        if (fault.pollIntervalSec > 0) {
+            extraHeaders += "X-Poll-Interval: " + String((unsigned long)fault.pollIntervalSec) + "\r\n";
+        }
+
+        switch (fault.type) {
+            case FAULT_RESET:
+                return;
+            case FAULT_TLS_ALERT: {
+                // Fatal handshake_failure alert, then close
+                static const char alert[] = {0x15, 0x03, 0x03, 0x00, 0x02, 0x02, 0x28};
+                sendAll(fd, alert, sizeof(alert));
+                return;
+            }
+            case FAULT_HANG:
+                // Hold the connection open until the client gives up or the server stops
+                while (recv(fd, chunk, sizeof(chunk), 0) > 0) {}
+                return;
+            default:
+                break;
+        }
+
+        if (fault.type == FAULT_TRUNCATE) keepAlive = false;
+        String raw = "HTTP/1.1 " + String(response.status) + " " + statusText(response.status) + "\r\n";
+        raw += "Content-Type: application/json; charset=utf-8\r\n";
+        raw += "Content-Length: " + String((int)response.body.length()) + "\r\n";
+        raw += extraHeaders;
+        raw += keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+        raw += "\r\n";
+        size_t bodyStart = raw.length();
+        raw += response.body;
+
+        if (fault.type == FAULT_TRUNCATE) {
+            size_t cut = bodyStart + (fault.truncateAt < response.body.length() ? fault.truncateAt : response.body.length());
+            sendAll(fd, raw.c_str(), cut);
+            return;
+        }
+        if (fault.type == FAULT_SLOWLORIS) {
+            size_t step = fault.chunkBytes > 0 ? fault.chunkBytes : 1;
+            for (size_t pos = 0; pos < raw.length(); pos += step) {
+                size_t n = raw.length() - pos < step ? raw.length() - pos : step;
+                if (!sendAll(fd, raw.c_str() + pos, n)) return;
+                if (pos + n < raw.length() && !sleepUnlessStopped(fault.chunkDelayMs)) return;
+            }
+        } else if (!sendAll(fd, raw.c_str(), raw.length())) {
+            return;
+        }
+
+        if (!keepAlive) return;
+    }
+}
@@ -5,6 +5,11 @@
 #include <HTTPClient.h>
 #include <WiFiClientSecure.h>
 #include <ArduinoJson.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include "endpoint_pool.h"
+#include "runtime_config.h"
 
 // Booking structure
 struct Booking {
@@ -34,8 +39,14 @@ struct RoomStatus {
     Booking currentBooking;
     Booking upcomingBookings[3];
     int upcomingCount;
+    int openingHour;  // Effective building hours (local), -1 if the server didn't send them
+    int closingHour;
+    bool hasConfig;        // The server sent a new, valid runtime config
+    RuntimeConfig config;
     bool isValid;
     String errorMessage;
+    uint32_t fetchedAt;    // nowMs() when the response arrived (0 = never fetched)
+    String roomVersion;    // Version of the room data; empty from servers that send the room every time
 };
 
 // Quick book result
@@ -73,31 +84,136 @@ class ApiClient {
 public:
     ApiClient();
 
+    // One base URL, or several separated by commas to fail over between
     void setApiUrl(const String& url);
+    // More endpoints from the server's runtime config, tried after the
+    // configured ones; empty clears them
+    void setExtraApiUrls(const String& urls);
     void setDeviceToken(const String& token);
+    // Sent as X-Config-Version; the server only includes its config block
+    // in status responses when its version differs
+    void setConfigVersion(uint32_t version) { _configVersion = version; }
 
     String getApiUrl() const { return _apiUrl; }
+    // Base URL requests go to now
+    String currentApiUrl();
+    // Copy of the endpoint list with its health and latency
+    size_t endpointStats(Endpoint* out, size_t max);
+    // With several endpoints: ping one that hasn't been measured for
+    // ENDPOINT_PROBE_MS, so failover picks by fresh latency. False if none was due.
+    bool probeEndpoints();
     String getDeviceToken() const { return _deviceToken; }
     bool isConfigured() const { return _apiUrl.length() > 0 && _deviceToken.length() > 0; }
 
     // API methods
-    RoomStatus getRoomStatus();
+
+    // Room status. Callers that arrive while a status request is in flight
+    // wait for it and share its result instead of sending their own. With
+    // maxAgeMs > 0 a valid status fetched less than maxAgeMs ago is returned
+    // without a request at all.
+    RoomStatus getRoomStatus(uint32_t maxAgeMs = 0);
+    // Forget the cached status and supersede a status request in flight: it
+    // is abandoned before its body is read and sent again, so no caller gets
+    // a status from before the change. quickBook() and endMeeting() call
+    // this when they succeed.
+    void invalidateStatus();
+    // A status the server pushed (MQTT) or a room group leader relayed, in
+    // the /status body format. Cached like a fetched one; a room version
+    // change still fetches /info. A config block in it is ignored: the
+    // runtime config only comes from our own /status request.
+    RoomStatus pushRoomStatus(const String& body);
+    // Body of the cached status as the server sent it, for relaying to the
+    // room's other panels (room_group.h); empty while nothing is cached
+    String statusBody();
+    // Status requests saved by the freshness window and by coalescing
+    uint32_t statusRequestsSaved() const { return _statusSaved; }
+
+    // Load hints from the server. An overloaded server answers 503 with
+    // Retry-After, and asks for slower polling with X-Poll-Interval; the
+    // next answer without them lifts them.
+    // Milliseconds until the server wants to hear from us again (0 = now)
+    uint32_t retryAfterMs() const;
+    // `configured`, or the server's longer poll interval while it is loaded
+    uint32_t pollIntervalMs(uint32_t configured) const;
+    // Whole seconds in a hint header, capped at SERVER_HINT_MAX_S; 0 if
+    // absent or not a number (HTTP-date Retry-After isn't supported)
+    static uint32_t parseHintSeconds(const String& value);
+
     QuickBookResult quickBook(const String& title, int durationMinutes);
     EndMeetingResult endMeeting();
     bool ping();
+    // Upload a batch built by Telemetry::encode(); true once the server has it
+    bool sendTelemetry(const String& body);
+    // Room and key the room group signs with (room_group.h). False if the
+    // device has no room, or the server predates room group keys.
+    bool fetchRoomGroupSecret(String& roomId, String& secret);
 
     // Firmware update methods
     FirmwareUpdateResult checkForFirmwareUpdate();
     bool reportFirmwareVersion(const String& version);
     String getFirmwareDownloadUrl(const String& version);
 
+    // Room data cache. The server sends a status without the room (name,
+    // capacity, quick-book durations) and only its version; the room comes
+    // from /info when the version changes and the caller keeps it in flash.
+    // Adopt a room saved with roomInfoJson(), or an /info response
+    bool loadRoomInfo(const String& json);
+    // The cached room for flash, empty when there is none
+    String roomInfoJson() const;
+    // True once after /info replaced the cached room
+    bool takeRoomInfoChanged();
+
+    // Response parsing (static so it can run without a network, e.g. in host tests)
+    static RoomStatus parseRoomStatus(const String& response);
+    static bool parseRoomInfo(const String& json, Room& room, String& version);
+    static Booking parseBooking(JsonObject& obj);
+    static Room parseRoom(JsonObject& obj);
+
 private:
     String _apiUrl;
+    String _extraApiUrls;
+    std::mutex _endpointMutex;
+    EndpointPool _endpoints;
     String _deviceToken;
-
-    String makeRequest(const String& endpoint, const String& method = "GET", const String& body = "");
-    Booking parseBooking(JsonObject& obj);
-    Room parseRoom(JsonObject& obj);
+    uint32_t _configVersion;
+
+    // Single-flight status: one request at a time, its result shared
+    std::mutex _statusMutex;
+    std::condition_variable _statusDone;
+    bool _statusInFlight;
+    uint32_t _statusPublished;        // Completed status requests
+    RoomStatus _statusLast;           // Result of the last one, valid or not
+    bool _statusCached;               // _statusLast is valid and still current
+    String _statusBody;               // Response behind _statusLast
+    String _statusResponse;           // Response of the request in flight (leader only)
+    std::atomic<uint32_t> _statusEpoch;  // Bumped by invalidateStatus()
+    std::atomic<uint32_t> _statusSaved;
+
+    std::atomic<uint32_t> _retryAfterMs;  // From the last answer, counted from _retrySetAt
+    std::atomic<uint32_t> _retrySetAt;
+    std::atomic<uint32_t> _pollHintMs;
+
+    void noteLoadHints(int httpCode, const String& retryAfter, const String& pollInterval);
+
+    // Only touched by the status request leader (and before the first status)
+    Room _room;
+    String _roomVersion;
+    bool _roomInfoChanged;
+
+    RoomStatus fetchRoomStatus(int64_t epoch);
+    void addCachedRoom(RoomStatus& status);
+    bool fetchRoomInfo();
+    // epoch >= 0: a status request, abandoned once _statusEpoch moves past it
+    // A GET the chosen endpoint doesn't answer at all is sent once more to
+    // the next one; a POST is not, it may have been carried out
+    String makeRequest(const String& endpoint, const String& method = "GET", const String& body = "",
+                       int64_t epoch = -1);
+    // One attempt at one endpoint (-1: the selected one); sets *httpCode
+    String requestOnce(int target, const String& endpoint, const String& method, const String& body,
+                       int64_t epoch, int* httpCode);
 };
 
+// True when both statuses are valid and would render the same room screen
+bool roomStatusesAreEqual(const RoomStatus& first, const RoomStatus& second);
+
 #endif // API_CLIENT_H
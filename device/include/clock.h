@@ -0,0 +1,73 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <Arduino.h>
+#include <time.h>
+
+// Time source for all scheduling and time display. The firmware runs on the
+// system clock; host tests and tools install a SimulatedClock to fast-forward
+// through days, DST switches and the 49.7-day millis() rollover.
+//
+// Monotonic time is uint32_t milliseconds on every platform, so interval
+// arithmetic wraps exactly as millis() does on the ESP32.
+class Clock {
+public:
+    virtual ~Clock() {}
+
+    // Milliseconds since boot, wraps every 2^32 ms
+    virtual uint32_t monotonicMs() = 0;
+    // Seconds since the Unix epoch (UTC); small until NTP has synced
+    virtual time_t wallTime() = 0;
+    // Block for ms milliseconds (a simulated clock just advances)
+    virtual void delayMs(uint32_t ms) = 0;
+};
+
+// millis(), time() and delay()
+class SystemClock : public Clock {
+public:
+    uint32_t monotonicMs() override;
+    time_t wallTime() override;
+    void delayMs(uint32_t ms) override;
+};
+
+// Deterministic clock that only moves when told to
+class SimulatedClock : public Clock {
+public:
+    explicit SimulatedClock(time_t wallStart = 0, uint32_t monotonicStart = 0)
+        : _ms(monotonicStart), _wall(wallStart), _wallMsRemainder(0) {}
+
+    uint32_t monotonicMs() override { return _ms; }
+    time_t wallTime() override { return _wall; }
+    void delayMs(uint32_t ms) override { advanceMs(ms); }
+
+    // Move both clocks forward together
+    void advanceMs(uint32_t ms) {
+        _ms += ms;
+        uint64_t total = (uint64_t)_wallMsRemainder + ms;
+        _wall += (time_t)(total / 1000);
+        _wallMsRemainder = (uint32_t)(total % 1000);
+    }
+    void advanceSeconds(uint32_t seconds) {
+        _ms += seconds * 1000u;
+        _wall += seconds;
+    }
+
+    // Jump the wall clock only, as an NTP sync does
+    void setWallTime(time_t wall) { _wall = wall; }
+    void setMonotonicMs(uint32_t ms) { _ms = ms; }
+
+private:
+    uint32_t _ms;
+    time_t _wall;
+    uint32_t _wallMsRemainder;
+};
+
+// Active clock used by nowMs()/wallNow()/clockDelay(); nullptr restores the system clock
+void setClock(Clock* clock);
+Clock& activeClock();
+
+inline uint32_t nowMs() { return activeClock().monotonicMs(); }
+inline time_t wallNow() { return activeClock().wallTime(); }
+inline void clockDelay(uint32_t ms) { activeClock().delayMs(ms); }
+
+#endif // CLOCK_H
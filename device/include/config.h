@@ -1,9 +1,13 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
-// Display settings
+// Display settings (override from build_flags for larger panels, e.g. 480x320)
+#ifndef SCREEN_WIDTH
 #define SCREEN_WIDTH 320
+#endif
+#ifndef SCREEN_HEIGHT
 #define SCREEN_HEIGHT 240
+#endif
 #define TFT_ROTATION 1  // Landscape mode
 
 // Capacitive touch I2C pins (CST820/GT911)
@@ -37,10 +41,60 @@
 #define COLOR_OCCUPIED    0xC904  // Rose (same as danger)
 #define COLOR_ACCENT      0x4C7F  // Sky blue (#38bdf8)
 
-// API settings
+// API settings. The intervals here, the screen timeout, LED brightness,
+// booking behaviour and firmware check interval are defaults the server can
+// override at runtime (runtime_config.h).
 #define API_TIMEOUT 10000        // 10 seconds
 #define STATUS_POLL_INTERVAL 30000  // 30 seconds
 #define PING_INTERVAL 60000      // 1 minute
+#define STATUS_FRESH_MS 5000     // Refresh taps reuse a status fetched this recently
+
+// API endpoints: the API URL setting (and the server's runtime config) may
+// list several servers; requests stick to one and fail over (endpoint_pool.h)
+#define API_MAX_ENDPOINTS 4
+#define ENDPOINT_SOFT_FAILURES 2      // 5xx answers in a row before an endpoint is skipped
+#define ENDPOINT_DOWN_MS 30000        // First back-off, doubled per failure after that
+#define ENDPOINT_DOWN_MAX_MS 300000   // 5 minutes
+#define ENDPOINT_SWITCH_RATIO 2       // Leave a healthy endpoint only for one this many times faster
+#define ENDPOINT_PROBE_MS 600000      // Re-measure an idle endpoint every 10 minutes
+
+// Fleet telemetry: one sample a minute, uploaded in batches; an hour is kept
+// while uploads fail
+#define TELEMETRY_SAMPLE_MS 60000
+#define TELEMETRY_UPLOAD_MS 300000    // 5 minutes
+#define TELEMETRY_BUFFER_SAMPLES 60
+
+// MQTT (mqtt_link.h): on while the server's runtime config names a broker.
+// With the session up, status, ping and firmware polls stop and the room
+// status, commands, heartbeats and telemetry go over the one connection.
+#define MQTT_DEFAULT_PORT 1883
+#define MQTT_DEFAULT_TLS_PORT 8883
+#define MQTT_DEFAULT_PREFIX "openmeeting"
+#define MQTT_KEEPALIVE_S 60
+#define MQTT_BUFFER_SIZE 4096         // Largest message in or out (a room status)
+#define MQTT_RECONNECT_MS 5000        // First retry, doubled per failure after that
+#define MQTT_RECONNECT_MAX_MS 300000  // 5 minutes
+
+// LAN room groups (room_group.h): on while the runtime config enables them.
+// Panels of one room elect a leader that polls; the others get its status.
+#define ROOM_GROUP_ENABLED false
+#define ROOM_GROUP_PORT 47811             // UDP beacons
+#define ROOM_GROUP_BEACON_MS 5000
+#define ROOM_GROUP_PEER_TIMEOUT_MS 16000  // Three beacons missed
+#define ROOM_GROUP_DISCOVER_MS 600000     // mDNS query, which blocks up to 3 s
+#define ROOM_GROUP_RELAY_TIMEOUT_MS 3000  // Fetching the status from the leader
+#define ROOM_GROUP_MAX_PEERS 8
+#define ROOM_GROUP_MAX_SKEW_S 30          // Signed messages older or newer than this are dropped
+#define ROOM_GROUP_KEY_RETRY_MS 300000    // The server gave no room group key
+
+// Peer firmware (peer_firmware.h): on while the runtime config enables it.
+// Panels fetch an update from a panel on the LAN that already installed it.
+#define PEER_FIRMWARE_ENABLED false
+#define PEER_FIRMWARE_WAIT_MS 600000      // Nobody here has the update: server download after a random part of this
+#define PEER_FIRMWARE_MAX_PEERS 8         // Taken from one mDNS query
+#define PEER_FIRMWARE_TRIES 3             // Peers tried before the server
+#define PEER_FIRMWARE_TIMEOUT_MS 10000
+#define PEER_FIRMWARE_CHUNK 4096          // Flash reads while serving the image
 
 // Quick booking durations (minutes)
 #define QUICK_BOOK_15 15
@@ -48,6 +102,10 @@
 #define QUICK_BOOK_45 45
 #define QUICK_BOOK_60 60
 
+// Quick booking behaviour
+#define QUICK_BOOK_CONFIRM true   // Confirmation screen after picking a duration
+#define BOOKING_RESULT_MS 3000    // How long the booking result stays on screen
+
 // WiFi AP settings for setup
 #define WIFI_AP_NAME "MeetingRoom-Setup"
 #define WIFI_AP_PASSWORD "setup1234"
@@ -68,6 +126,23 @@
 #define PREF_SETUP_PIN "setup_pin"
 #define PREF_BOOT_COUNT "boot_count"
 #define PREF_BOOT_TIME "boot_time"
+#define PREF_POWER_SAVE "power_save"
+#define PREF_ROOM_INFO "room_info"     // Room data from /info, refetched when its version changes
+#define PREF_FIRMWARE_SEED "fw_seed"   // Version, size and MD5 of the last installed update (peer_firmware.h)
+// Server-pushed runtime config (see runtime_config.h); a key exists only
+// while the server overrides that value
+#define PREF_RC_VERSION "rc_version"
+#define PREF_RC_STATUS_POLL "rc_poll"
+#define PREF_RC_PING "rc_ping"
+#define PREF_RC_FIRMWARE_CHECK "rc_fw_check"
+#define PREF_RC_SCREEN_TIMEOUT "rc_screen"
+#define PREF_RC_LED_LEVEL "rc_led"
+#define PREF_RC_QUICK_BOOK_CONFIRM "rc_qb_confirm"
+#define PREF_RC_BOOKING_RESULT "rc_result"
+#define PREF_RC_API_URLS "rc_api_urls"
+#define PREF_RC_MQTT_URL "rc_mqtt_url"
+#define PREF_RC_ROOM_GROUP "rc_room_group"
+#define PREF_RC_PEER_FIRMWARE "rc_peer_fw"
 
 // Boot loop detection
 #define BOOT_LOOP_THRESHOLD 3     // Number of rapid reboots before safe mode
@@ -88,18 +163,80 @@
 // PWM settings for LED brightness control
 #define LED_PWM_FREQ 5000
 #define LED_PWM_RESOLUTION 8
-#define LED_RED_CHANNEL 0
-#define LED_GREEN_CHANNEL 1
-#define LED_BLUE_CHANNEL 2
+// Low-speed channels (8-15): only their timers can run from the RTC clock
+// and keep the LED lit through light sleep
+#define LED_RED_CHANNEL 8
+#define LED_GREEN_CHANNEL 9
+#define LED_BLUE_CHANNEL 10
+// Pulse the LED amber once the current meeting has this long left
+#define LED_ENDING_SOON_S 300
 
 // Screen timeout (turn off backlight after inactivity)
 #define SCREEN_TIMEOUT_MS 120000  // 2 minutes
 
+// Power saving (see power.h); the setup page switches it per device
+#ifndef POWER_SAVE_DEFAULT
+#define POWER_SAVE_DEFAULT false  // Opt in per device, or per build with -DPOWER_SAVE_DEFAULT=true
+#endif
+#ifndef WIFI_LISTEN_INTERVAL
+#define WIFI_LISTEN_INTERVAL 3    // Beacons between radio wakeups; use a multiple of the AP's DTIM period
+#endif
+#define POWER_MIN_CPU_MHZ 40      // CPU clock while loop() waits (crystal frequency)
+#define IDLE_MAX_WAIT_MS 500      // Longest wait between loop() passes; bounds web page latency
+#define TOUCH_POLL_MS 20          // Loop period while a finger is on the panel
+
+// Out-of-hours sleep (power save only): after closing time, once the screen
+// has timed out and the room is free, sleep until shortly before opening
+#define OUT_OF_HOURS_WAKE_LEAD_S 900     // Be live this long before opening
+#define OUT_OF_HOURS_MIN_SLEEP_S 600     // Shorter gaps aren't worth a sleep
+#define OUT_OF_HOURS_MAX_SLEEP_S 14400   // The RTC clock drifts; wake to resync NTP
+#define RESUME_WIFI_TIMEOUT_MS 3000      // Reconnect to the known AP before falling back to a scan
+
 // Connection retry interval when server is unreachable
 #define CONNECTION_RETRY_INTERVAL 30000  // 30 seconds
+#define CONNECTION_RETRY_JITTER_MS 10000 // Spread retries so panels don't reconnect in lockstep
+#define SERVER_HINT_MAX_S 3600           // Cap on Retry-After / X-Poll-Interval from the server
 
 // Firmware/OTA update settings
 #define FIRMWARE_CHECK_INTERVAL 300000   // 5 minutes - how often to check for updates
 #define FIRMWARE_VERSION "1.1.4"         // Current firmware version - update this with each release
 
+// Energy model: average mA at the board's 5 V input per state, rough figures
+// for an ESP32-2432S028 (CYD). Measure your board and override from
+// build_flags; estimates are mainly for comparing firmware builds.
+#ifndef ENERGY_SUPPLY_MV
+#define ENERGY_SUPPLY_MV 5000
+#endif
+#ifndef ENERGY_BASE_MA
+#define ENERGY_BASE_MA 15.0f              // Regulator, ILI9341 controller, touch
+#endif
+#ifndef ENERGY_CPU_BUSY_MA
+#define ENERGY_CPU_BUSY_MA 45.0f          // 240 MHz, both cores running
+#endif
+#ifndef ENERGY_CPU_IDLE_MA
+#define ENERGY_CPU_IDLE_MA 25.0f          // In loop()'s idle delay
+#endif
+#ifndef ENERGY_CPU_LIGHT_SLEEP_MA
+#define ENERGY_CPU_LIGHT_SLEEP_MA 4.0f    // Idle with automatic light sleep, wakeups averaged
+#endif
+#ifndef ENERGY_BACKLIGHT_MA
+#define ENERGY_BACKLIGHT_MA 70.0f
+#endif
+#ifndef ENERGY_WIFI_MODEM_SLEEP_MA
+#define ENERGY_WIFI_MODEM_SLEEP_MA 12.0f  // DTIM beacon wakeups averaged
+#endif
+#ifndef ENERGY_WIFI_ACTIVE_MA
+#define ENERGY_WIFI_ACTIVE_MA 95.0f       // RX/TX averaged
+#endif
+#ifndef ENERGY_LED_CHANNEL_MA
+#define ENERGY_LED_CHANNEL_MA 10.0f       // One RGB LED channel fully on
+#endif
+
+// Trace ring buffer (TRACE_ENABLED builds only, see trace.h)
+#define TRACE_BUFFER_EVENTS 1024  // 12 bytes each, a few seconds of loop()
+
+// Sampling profiler (PROFILER_ENABLED builds only, see profiler.h)
+#define PROFILER_STACK_DEPTH 6    // Sampled PC plus up to 5 return addresses
+#define PROFILER_SLOTS 256        // Distinct stacks per core, 28 bytes each
+
 #endif // CONFIG_H
@@ -0,0 +1,64 @@
+#ifndef ENDPOINT_POOL_H
+#define ENDPOINT_POOL_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// The API servers a device may talk to, with health and latency per server.
+// Requests stick to the current endpoint (its DNS answer, TLS session and
+// the server's caches stay warm) and only move when it stops answering or
+// another healthy endpoint has measured ENDPOINT_SWITCH_RATIO times faster.
+// A server that doesn't answer at all is skipped at once; one that answers
+// 5xx after ENDPOINT_SOFT_FAILURES in a row. Skipped endpoints back off
+// from ENDPOINT_DOWN_MS, doubling up to ENDPOINT_DOWN_MAX_MS, and are tried
+// again after that. Not thread-safe: ApiClient serializes access.
+
+struct Endpoint {
+    String url;            // Base URL without trailing slash
+    uint32_t ewmaMs;       // Smoothed time to the response headers; 0 = not measured
+    uint32_t measuredAt;   // nowMs() of the last answer
+    uint8_t failures;      // In a row
+    uint32_t downUntil;    // nowMs() when it may be tried again; 0 = healthy
+    uint32_t requests;
+    uint32_t errors;
+};
+
+class EndpointPool {
+public:
+    EndpointPool();
+
+    // Replace the list from a comma-separated string; blanks and duplicates
+    // are dropped, at most API_MAX_ENDPOINTS kept. Stats and the current
+    // choice survive for URLs still in the list. Returns the number kept.
+    size_t setUrls(const String& list);
+    // The list back as a comma-separated string
+    String urls() const;
+
+    size_t size() const { return _count; }
+    const Endpoint& endpoint(size_t index) const { return _endpoints[index]; }
+    int current() const { return _current; }  // -1 when the list is empty
+
+    // Endpoint for the next request, -1 when the list is empty. If every
+    // endpoint is backing off, the one that may be retried first.
+    int select(uint32_t nowMs);
+    bool isDown(size_t index, uint32_t nowMs) const;
+
+    // Any HTTP answer below 500 counts as a success
+    void reportSuccess(int index, uint32_t latencyMs, uint32_t nowMs);
+    // hard: no answer at all (refused, reset, timeout, TLS failure)
+    void reportFailure(int index, bool hard, uint32_t nowMs);
+
+    // A non-current endpoint not measured for ENDPOINT_PROBE_MS (or whose
+    // back-off is over), to ping so failover has fresh numbers; -1 if none
+    int probeCandidate(uint32_t nowMs) const;
+
+    // Trailing slash and surrounding blanks removed
+    static String normalizeUrl(const String& url);
+
+private:
+    Endpoint _endpoints[API_MAX_ENDPOINTS];
+    size_t _count;
+    int _current;
+};
+
+#endif // ENDPOINT_POOL_H
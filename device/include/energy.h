@@ -0,0 +1,105 @@
+#ifndef ENERGY_H
+#define ENERGY_H
+
+#include <Arduino.h>
+
+// Energy accounting model. The firmware reports every change of a
+// power-relevant state (CPU busy/idle, backlight, WiFi radio, LED PWM duty);
+// the meter keeps the time spent in each and turns it into an estimated
+// charge and energy with a per-state current table. Absolute numbers are only
+// as good as the table, but builds can be compared against each other.
+
+enum EnergyWifiState {
+    ENERGY_WIFI_OFF,          // Radio off
+    ENERGY_WIFI_MODEM_SLEEP,  // Associated, radio asleep between beacons
+    ENERGY_WIFI_ACTIVE,       // Radio on: traffic, scanning, AP mode, or sleep disabled
+    ENERGY_WIFI_STATE_COUNT
+};
+
+#define ENERGY_LED_CHANNELS 3  // Red, green, blue
+
+// Average current per state in mA at the board input
+struct EnergyCurrents {
+    float baseMa;          // Always drawn: regulator, display controller, touch
+    float cpuBusyMa;
+    float cpuIdleMa;
+    float backlightOnMa;
+    float wifiMa[ENERGY_WIFI_STATE_COUNT];
+    float ledChannelMa;    // One LED channel at 100% duty
+    uint32_t supplyMv;
+};
+
+// Table from the ENERGY_* settings in config.h
+EnergyCurrents defaultEnergyCurrents();
+
+struct EnergyReport {
+    uint64_t elapsedMs;
+    uint64_t cpuBusyMs;
+    uint64_t backlightOnMs;
+    uint64_t wifiMs[ENERGY_WIFI_STATE_COUNT];
+    float ledDuty[ENERGY_LED_CHANNELS];  // Average on-duty, 0..1
+
+    // Estimated charge per subsystem
+    float baseMah;
+    float cpuMah;
+    float backlightMah;
+    float wifiMah;
+    float ledMah;
+
+    float totalMah;
+    float averageMa;
+    float energyMwh;
+};
+
+class EnergyMeter {
+public:
+    EnergyMeter();
+
+    // Start (or restart) accounting from nowMs() with the given table.
+    // State changes before begin() are remembered but not timed.
+    void begin(const EnergyCurrents& currents);
+    void reset();
+
+    void setCpuBusy(bool busy);
+    void setBacklight(bool on);
+    void setWifi(EnergyWifiState state);
+    // Radio traffic (HTTP requests, OTA download) keeps WiFi active; nests
+    void beginRadioActivity();
+    void endRadioActivity();
+    // On-duty per channel, 0 = off, 255 = fully on
+    void setLedDuty(uint8_t red, uint8_t green, uint8_t blue);
+
+    EnergyReport report();
+    const EnergyCurrents& currents() const { return _currents; }
+
+private:
+    void accumulate();
+    EnergyWifiState effectiveWifi() const;
+
+    EnergyCurrents _currents;
+    bool _started;
+    uint32_t _lastMs;
+
+    bool _cpuBusy;
+    bool _backlightOn;
+    EnergyWifiState _wifi;
+    int _radioActivity;
+    uint8_t _ledDuty[ENERGY_LED_CHANNELS];
+
+    uint64_t _elapsedMs;
+    uint64_t _cpuBusyMs;
+    uint64_t _backlightOnMs;
+    uint64_t _wifiMs[ENERGY_WIFI_STATE_COUNT];
+    uint64_t _ledDutyMs[ENERGY_LED_CHANNELS];  // Duty (0-255) x ms
+};
+
+extern EnergyMeter energyMeter;
+
+// Counts as radio activity for the lifetime of the scope
+class EnergyRadioScope {
+public:
+    EnergyRadioScope() { energyMeter.beginRadioActivity(); }
+    ~EnergyRadioScope() { energyMeter.endRadioActivity(); }
+};
+
+#endif // ENERGY_H
@@ -0,0 +1,124 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include <stdint.h>
+
+// Reference design resolution - all base sizes below are expressed in these pixels
+#define LAYOUT_REF_WIDTH  320
+#define LAYOUT_REF_HEIGHT 240
+
+// Rectangle in screen pixels
+struct Rect {
+    int16_t x, y, w, h;
+
+    int16_t cx() const { return x + w / 2; }
+    int16_t cy() const { return y + h / 2; }
+    int16_t right() const { return x + w; }
+    int16_t bottom() const { return y + h; }
+    bool contains(int px, int py) const {
+        return px >= x && px <= x + w && py >= y && py <= y + h;
+    }
+    Rect inset(int16_t dx, int16_t dy) const {
+        return {(int16_t)(x + dx), (int16_t)(y + dy), (int16_t)(w - 2 * dx), (int16_t)(h - 2 * dy)};
+    }
+};
+
+// Flex item: basis is a fixed size along the main axis (already scaled),
+// grow is the share of leftover space the item receives (0 = fixed)
+struct FlexItem {
+    int16_t basis;
+    uint8_t grow;
+};
+
+enum FlexDirection {
+    FLEX_ROW,
+    FLEX_COLUMN
+};
+
+// Distribute items along the main axis of area; each item fills the cross axis
+void flexLayout(const Rect& area, FlexDirection dir, const FlexItem* items, int count, int16_t gap, Rect* out);
+
+// Screen-size dependent metrics, derived from the reference design
+struct LayoutMetrics {
+    int16_t width;
+    int16_t height;
+    uint16_t scale;     // 8.8 fixed point, 256 = reference size
+    int16_t margin;
+    int16_t gap;
+    uint8_t fontSmall;
+    uint8_t fontBody;
+    uint8_t fontTitle;
+
+    // Scale a reference-design length to this screen
+    int16_t px(int ref) const { return (int16_t)((ref * (int32_t)scale + 128) >> 8); }
+    // Map a reference-design y coordinate proportionally to this screen height
+    int16_t py(int ref) const { return (int16_t)(ref * (int32_t)height / LAYOUT_REF_HEIGHT); }
+};
+
+// Room status screen
+struct RoomStatusLayout {
+    Rect title;
+    Rect statusPanel;
+    int16_t availableLabelY, availableHintY;   // Text baselines (middle datum) in the panel
+    int16_t occupiedLabelY, occupiedUntilY;
+    Rect endMeetingButton;
+    int16_t listTop;            // Upcoming list start (also where "End Meeting" sits)
+    int16_t listTopWithEndButton;
+    int16_t listLimitY;         // No new card starts at or below this line
+    int16_t listLabelHeight;    // Height of the "NEXT" caption
+    Rect card;                  // First card slot; x/w/h apply to every card
+    int16_t cardPitch;
+    int16_t cardTitleChars;     // Max title characters before truncating with "..."
+    Rect refreshButton;         // Hit area; drawn as a circle inside
+    int16_t refreshRadius;
+};
+
+// Quick book duration menu
+struct QuickBookLayout {
+    Rect title;
+    Rect subtitle;
+    Rect durations[4];          // 2x2 grid
+    Rect cancelButton;
+};
+
+// Two-button confirmation screens (booking confirm, end meeting)
+struct ConfirmLayout {
+    Rect title;
+    Rect card;
+    int16_t cardLabelY, cardValueY;
+    int16_t noteY;              // Line under the card (booking confirm)
+    int16_t line1Y, line2Y, line3Y;
+    Rect leftButton;
+    Rect rightButton;
+};
+
+// Result and error screens
+struct MessageLayout {
+    int16_t iconX, iconY, iconRadius;
+    int16_t headingY;
+    int16_t messageTop, messageBottom, lineHeight;
+    int16_t wrapChars;
+    Rect button;
+};
+
+// Loading spinner screen
+struct LoadingLayout {
+    int16_t cx, cy;
+    int16_t outerRadius, innerRadius, dotRadius;
+    int16_t messageY;
+};
+
+// All screen layouts for one screen size; computed once, then only read while drawing
+struct ScreenLayouts {
+    LayoutMetrics metrics;
+    RoomStatusLayout roomStatus;
+    QuickBookLayout quickBook;
+    ConfirmLayout confirm;
+    MessageLayout message;
+    LoadingLayout loading;
+};
+
+// Compute all screen layouts for a display of the given size
+void computeScreenLayouts(int16_t width, int16_t height, ScreenLayouts& out);
+
+#endif // LAYOUT_H
@@ -0,0 +1,123 @@
+#ifndef MQTT_LINK_H
+#define MQTT_LINK_H
+
+#include <Arduino.h>
+#include <PubSubClient.h>
+#include <WiFiClient.h>
+#include <WiFiClientSecure.h>
+
+// Optional MQTT transport. When the server's runtime config names a broker
+// (mqttUrl) the panel keeps one connection to it instead of polling:
+//
+//   <prefix>/rooms/<roomId>/status    retained room status from the backend  (subscribed)
+//   <prefix>/devices/<key>/command    {"cmd": "refresh"} etc. for this panel (subscribed)
+//   <prefix>/command                  the same for every panel               (subscribed)
+//   <prefix>/backend                  retained "online", "offline" as will   (subscribed)
+//   <prefix>/devices/<key>/heartbeat  in place of /ping                      (published)
+//   <prefix>/devices/<key>/telemetry  telemetry batches                      (published)
+//   <prefix>/devices/<key>/online     retained "1", "0" as will              (published)
+//
+// <key> is mqttDeviceKey() of the device token. MqttLink runs the session;
+// main.cpp acts on what it hands over.
+
+struct MqttBroker {
+    String host;
+    uint16_t port;
+    bool tls;
+    String username;   // Empty: connect without credentials
+    String password;
+    String prefix;     // Topic prefix, MQTT_DEFAULT_PREFIX unless the URL has a path
+};
+
+// mqtt://[user[:password]@]host[:port][/prefix], or mqtts:// for TLS.
+// User and password may be percent-encoded.
+bool parseMqttUrl(const String& url, MqttBroker& out);
+
+// Names the panel in topics: the first 16 hex digits of the token's SHA-256
+String mqttDeviceKey(const String& deviceToken);
+
+struct MqttTopics {
+    String roomStatus;
+    String command;
+    String fleetCommand;
+    String backend;
+    String heartbeat;
+    String telemetry;
+    String online;
+};
+
+MqttTopics mqttTopics(const String& prefix, const String& deviceKey, const String& roomId);
+
+enum MqttCommand {
+    MQTT_CMD_NONE,      // Not a command we know
+    MQTT_CMD_REFRESH,   // Fetch the status over HTTP now
+    MQTT_CMD_REBOOT,
+    MQTT_CMD_CONFIG,    // Runtime config changed: refresh, the status carries it
+    MQTT_CMD_OTA,       // Check for a firmware update now
+};
+
+// {"cmd": "refresh" | "reboot" | "config" | "ota"}
+MqttCommand parseMqttCommand(const char* payload, size_t length);
+
+// Wait before reconnect attempt number `failures` (1 = after the first
+// failure), without jitter
+uint32_t mqttReconnectDelayMs(uint8_t failures);
+
+// The PubSubClient session. loop() runs every pass of the main loop; the
+// message callback only notes what arrived, for takeStatus()/takeCommand().
+class MqttLink {
+public:
+    MqttLink();
+
+    // Apply the runtime config's broker; an empty or unusable URL turns MQTT off
+    void configure(const String& url);
+
+    // Keep the session up: service it, follow the panel to another room, and
+    // reconnect with back-off once it drops. roomId is empty until the first
+    // status over HTTP, which the status topic needs.
+    void loop(const String& deviceToken, const String& roomId);
+
+    // Statuses are pushed while we are subscribed and the backend publishes;
+    // otherwise the HTTP polls run
+    bool live();
+
+    // QoS 0 on this panel's topics; false unless live()
+    bool publishHeartbeat(const String& body);
+    bool publishTelemetry(const String& batch);
+
+    // The last status pushed since the previous call; false if none
+    bool takeStatus(String& body);
+    // The last command since the previous call
+    MqttCommand takeCommand();
+
+    // Say offline (retained) and disconnect, e.g. before a reboot
+    void disconnect();
+
+    bool enabled() const { return _enabled; }
+    const MqttBroker& broker() const { return _broker; }
+    bool backendOnline() const { return _backendOnline; }
+    uint8_t failures() const { return _failures; }
+    PubSubClient& client() { return _client; }
+
+private:
+    bool connect(const String& deviceToken, const String& roomId);
+    void onMessage(char* topic, uint8_t* payload, unsigned int length);
+
+    WiFiClient _plainClient;
+    WiFiClientSecure _tlsClient;
+    PubSubClient _client;
+    bool _enabled;
+    MqttBroker _broker;
+    MqttTopics _topics;
+    String _roomId;              // Room whose status topic we subscribed to
+    bool _backendOnline;         // Retained on <prefix>/backend; pushes only count while it is
+    bool _wasConnected;
+    uint8_t _failures;
+    uint32_t _lastAttempt;
+    uint32_t _retryMs;
+    String _pendingStatus;
+    bool _statusPending;
+    MqttCommand _pendingCommand;
+};
+
+#endif // MQTT_LINK_H
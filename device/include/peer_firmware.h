@@ -0,0 +1,41 @@
+#ifndef PEER_FIRMWARE_H
+#define PEER_FIRMWARE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Firmware from other panels on the LAN. A panel that installs an update
+// keeps the version, size and MD5 the server listed for it (its "seed").
+// After the reboot it checks the image in its running partition against
+// them and, if they match, advertises the version over mDNS
+// (_openmeeting._tcp, TXT fw=<version>) and serves the image at
+// GET /firmware?version=<version>. A panel updating to that version tries a
+// few such peers before the server, checking the server's MD5 as it writes.
+// This file holds what can run without a network; main.cpp does the rest.
+
+struct FirmwareSeed {
+    String version;
+    uint32_t size;
+    String md5;              // Lowercase hex, as the server lists it
+};
+
+// "<version>|<size>|<md5>", for preferences
+String encodeFirmwareSeed(const FirmwareSeed& seed);
+// False unless there is a version, a size and a 32 digit hex MD5
+bool parseFirmwareSeed(const String& stored, FirmwareSeed& out);
+
+// Path of the image on a panel's web server
+String peerFirmwarePath(const String& version);
+
+struct FirmwarePeer {
+    uint32_t ip;             // IPv4, as IPAddress converts it
+    String key;              // mqttDeviceKey() of its token
+    String version;          // The image it serves
+};
+
+// Keep the peers that serve `version`, other than us, in a random order
+// (from `seed`) so updating panels spread over them. Returns how many.
+size_t pickFirmwarePeers(FirmwarePeer* peers, size_t count, const String& version,
+                         const String& selfKey, uint32_t seed);
+
+#endif // PEER_FIRMWARE_H
@@ -0,0 +1,84 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <Arduino.h>
+#include <time.h>
+
+// Power saving between loop() passes. With power save on, WiFi uses modem
+// sleep with a fixed listen interval (the radio wakes for every Nth beacon,
+// pick a multiple of the AP's DTIM period), the CPU drops to its minimum
+// frequency while loop() waits and, when the Arduino core was built with
+// tickless idle, enters automatic light sleep. Waits end early on the touch
+// INT line or a network event, so taps are handled as fast as before.
+
+// A periodic timer in loop(): due once now - last > interval
+struct PowerDeadline {
+    uint32_t last;
+    uint32_t interval;
+};
+
+// Milliseconds until the earliest deadline is due (0 if one already is),
+// never more than capMs. Safe across millis() wrap.
+uint32_t msUntilNextDeadline(uint32_t now, const PowerDeadline* deadlines, size_t count, uint32_t capMs);
+
+// Out-of-hours sleep: seconds from `now` until leadSeconds before the next
+// opening hour in the process timezone (DST-aware), or 0 while the building
+// is open, inside the lead time, or the hours are unknown (-1) or invalid.
+uint32_t outOfHoursSleepSeconds(time_t now, int openingHour, int closingHour, uint32_t leadSeconds);
+
+#ifdef ESP32
+
+#include <esp_pm.h>
+
+class PowerManager {
+public:
+    PowerManager();
+
+    // Set up frequency scaling / light sleep and the touch wake interrupt.
+    // Call once from setup() (the loop task), before WiFi is connected.
+    void begin(bool powerSave, int touchIntPin);
+    // Before connecting: store the listen interval in the station config so
+    // it goes out in the association request
+    void configureWifi();
+    // After connecting: select the modem sleep mode
+    void applyWifiSleep();
+    // Clock a low-speed LEDC channel's timer from the RTC 8 MHz oscillator so
+    // its PWM output keeps running through light sleep. Call after ledcSetup().
+    bool keepPwmInLightSleep(uint8_t channel, uint32_t freq, uint8_t resolutionBits);
+
+    // Wait up to timeoutMs; returns early when the panel is touched or
+    // notify() is called
+    void waitForEvent(uint32_t timeoutMs);
+    // Wait the full time, with the CPU allowed to slow down and sleep
+    void idle(uint32_t ms);
+    // Ends the current waitForEvent(); safe from other tasks
+    void notify();
+
+    // Out-of-hours sleep. Deep sleep can only wake on touch when the INT pin
+    // is an RTC GPIO (not on the CYD, where it is GPIO 21).
+    bool touchWakesDeepSleep() const;
+    // Timer (and touch) wake; the panel restarts through setup()
+    void deepSleep(uint32_t seconds);
+    // Light sleep until the timer or a touch; returns true when touched
+    bool sleepFor(uint32_t seconds);
+
+    bool powerSave() const { return _powerSave; }
+    bool frequencyScaling() const { return _frequencyScaling; }
+    bool lightSleep() const { return _lightSleep; }
+
+private:
+    void holdCpu();
+    void releaseCpu();
+
+    bool _powerSave;
+    bool _frequencyScaling;
+    bool _lightSleep;
+    int _touchPin;
+    esp_pm_lock_handle_t _busyLock;  // Held while loop() is working
+};
+
+extern PowerManager powerManager;
+
+#endif // ESP32
+
+#endif // POWER_H
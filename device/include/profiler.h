@@ -0,0 +1,61 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Sampling CPU profiler. Built with -DPROFILER_ENABLED=1 (env:esp32-cyd-profile),
+// the FreeRTOS tick interrupt on each core (1 kHz) records the interrupted
+// program counter and a few return addresses into a per-core histogram of
+// stacks. The setup page starts and stops it; GET /profile downloads the
+// histogram for tools/profile/flamegraph.py to symbolize against firmware.elf.
+
+struct ProfileStack {
+    uint32_t pcs[PROFILER_STACK_DEPTH];  // Sampled PC first, zero padded
+    uint32_t count;                      // 0 = empty slot
+};
+
+// Fixed-size open-addressing table of sampled stacks. add() never allocates
+// and probes a bounded number of slots, so one writer may call it from an ISR.
+class ProfileHistogram {
+public:
+    ProfileHistogram() : _slots(nullptr), _slotCount(0), _samples(0), _dropped(0) {}
+    ~ProfileHistogram() { end(); }
+
+    bool begin(size_t slots);
+    void end();
+    void clear();
+
+    // Count one sample; false (and counted as dropped) when the table is full
+    bool add(const uint32_t* pcs, uint8_t depth);
+
+    size_t slotCount() const { return _slotCount; }
+    const ProfileStack& slot(size_t index) const { return _slots[index]; }
+    uint32_t samples() const { return _samples; }
+    uint32_t dropped() const { return _dropped; }
+
+private:
+    ProfileStack* _slots;
+    size_t _slotCount;
+    volatile uint32_t _samples;
+    volatile uint32_t _dropped;
+};
+
+// Text dump read by flamegraph.py: '#' header lines, then one line per stack,
+// "<core> <count> <pc> <return address>..." in hex, innermost first
+void profileWriteText(const ProfileHistogram* cores, int coreCount, uint32_t sampleHz,
+                      void (*write)(const String& chunk), size_t chunkBytes = 1024);
+
+#if defined(PROFILER_ENABLED) && defined(ESP32)
+
+// Allocate the histograms (cleared) and hook the tick interrupt of both cores
+bool profilerStart();
+// Unhook; the histograms are kept for download until the next start
+void profilerStop();
+bool profilerRunning();
+uint32_t profilerSamples();
+void profilerWriteText(void (*write)(const String& chunk));
+
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,56 @@
+#ifndef RESUME_STATE_H
+#define RESUME_STATE_H
+
+#include <Arduino.h>
+#include "api_client.h"
+
+// What the panel needs to be live again right after an out-of-hours deep
+// sleep: the last room status (drawn before the network is up) and the
+// access point to reconnect to without a scan. Fixed-size so it fits in RTC
+// slow memory, which survives deep sleep but not a power cycle.
+
+#define RESUME_ID_LEN 40     // UUIDs
+#define RESUME_TIME_LEN 32   // ISO 8601
+#define RESUME_TEXT_LEN 64   // Titles and names, cut at a UTF-8 boundary
+
+struct BookingSnapshot {
+    char id[RESUME_ID_LEN];
+    char title[RESUME_TEXT_LEN];
+    char startTime[RESUME_TIME_LEN];
+    char endTime[RESUME_TIME_LEN];
+    bool isDeviceBooking;
+    bool isValid;
+};
+
+struct RoomStatusSnapshot {
+    char roomId[RESUME_ID_LEN];
+    char roomName[RESUME_TEXT_LEN];
+    char floor[RESUME_TEXT_LEN];
+    int32_t capacity;
+    int32_t quickBookDurations[4];
+    int32_t quickBookDurationCount;
+    bool isAvailable;
+    BookingSnapshot currentBooking;
+    BookingSnapshot upcomingBookings[3];
+    int32_t upcomingCount;
+    int32_t openingHour;
+    int32_t closingHour;
+};
+
+struct ResumeState {
+    uint32_t magic;
+    uint32_t checksum;  // Over everything after this field
+    int32_t wifiChannel;
+    uint8_t bssid[6];
+    bool hasStatus;
+    RoomStatusSnapshot status;
+};
+
+// Fill state; status may be nullptr (only the access point is kept)
+void saveResumeState(ResumeState& state, const RoomStatus* status, int32_t wifiChannel, const uint8_t* bssid);
+// False for zeroed, stale or corrupted memory (e.g. after a power cycle)
+bool resumeStateValid(const ResumeState& state);
+void clearResumeState(ResumeState& state);
+RoomStatus restoreRoomStatus(const ResumeState& state);
+
+#endif // RESUME_STATE_H
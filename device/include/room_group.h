@@ -0,0 +1,185 @@
+#ifndef ROOM_GROUP_H
+#define ROOM_GROUP_H
+
+#include <Arduino.h>
+#include <WiFiUdp.h>
+#include "api_client.h"
+#include "clock.h"
+#include "config.h"
+
+// LAN room groups. Panels showing the same room find each other with mDNS
+// and send each other a small UDP beacon every ROOM_GROUP_BEACON_MS. The
+// member with the lowest key that reaches the server leads: it polls, and the
+// others fetch its status body from GET /room/status on its web server when
+// the fingerprint in its beacon differs from theirs. A follower that stops
+// hearing the leader for ROOM_GROUP_PEER_TIMEOUT_MS polls the server again.
+//
+//   {"v":2,"r":"<roomId>","k":"<key>","s":"<fingerprint>","c":7,"o":1,"p":0,
+//    "t":<unix seconds>,"m":"<mac>"}
+//
+// <key> is mqttDeviceKey() of the device token. Everything is signed with
+// HMAC-SHA256 under the room's secret, which the server hands out to the
+// room's panels only (GET /api/device/room-group): <mac> covers the other
+// fields, the relay request carries a MAC of its time, and the leader signs
+// the body together with that time (ROOM_GROUP_SIGNATURE_HEADER). Messages
+// more than ROOM_GROUP_MAX_SKEW_S off our clock are dropped, so the group
+// only runs once NTP has set it. Bodies still travel in clear on the LAN.
+
+#define ROOM_GROUP_SIGNATURE_HEADER "X-Room-Signature"
+
+struct RoomBeacon {
+    String roomId;
+    String key;
+    String fingerprint;      // roomStatusFingerprint() of the status the sender shows; empty = none
+    uint32_t configVersion;  // Runtime config version the sender runs
+    bool upstreamOk;         // The sender reaches the server and may lead
+    bool refresh;            // Asks the leader to poll now: the sender just changed the room
+    time_t sentAt;           // Wall clock of the sender
+};
+
+// Signs with the room's secret
+String encodeRoomBeacon(const RoomBeacon& beacon, const String& secret);
+// False for anything that isn't a version 2 beacon with a room and a key,
+// signed with `secret` and sent within ROOM_GROUP_MAX_SKEW_S of `now`
+bool parseRoomBeacon(const char* data, size_t length, const String& secret, time_t now, RoomBeacon& out);
+
+// Names a status body in beacons: the first 16 hex digits of its SHA-256
+String roomStatusFingerprint(const String& body);
+
+// GET /room/status?t=<t>&m=<roomRelayRequestMac()>
+String roomRelayRequestMac(const String& secret, const String& roomId, time_t t);
+// ROOM_GROUP_SIGNATURE_HEADER of the answer; binds the body to the request's t
+String roomRelaySignature(const String& secret, const String& roomId, time_t t, const String& body);
+
+struct RoomPeer {
+    uint32_t ip;             // IPv4, as IPAddress converts it
+    uint32_t lastSeen;       // nowMs() of the last beacon
+    RoomBeacon beacon;
+};
+
+enum RoomBeaconResult {
+    ROOM_BEACON_IGNORED,     // Other room, our own, a replay, or the table is full
+    ROOM_BEACON_KNOWN,
+    ROOM_BEACON_NEW,         // A panel we didn't know: answer so it learns about us
+};
+
+class RoomGroup {
+public:
+    RoomGroup() : _count(0) {}
+
+    void setSelfKey(const String& key) { _selfKey = key; }
+    const String& selfKey() const { return _selfKey; }
+    // Forgets every peer when the room changes
+    void setRoom(const String& roomId);
+    const String& roomId() const { return _roomId; }
+
+    // A beacon older than the peer's last one is a replay; so is one from a
+    // new address that isn't newer
+    RoomBeaconResult onBeacon(const RoomBeacon& beacon, uint32_t ip, uint32_t now);
+    // Drop peers not heard for ROOM_GROUP_PEER_TIMEOUT_MS
+    void expire(uint32_t now);
+
+    // The peer that leads, or nullptr when this panel does (or nobody can).
+    // Candidates are this panel while selfOk and every live peer whose
+    // beacon says it reaches the server; the lowest key wins.
+    const RoomPeer* leader(uint32_t now, bool selfOk) const;
+    // A live peer at this address, e.g. to check who asks for the status
+    bool hasPeer(uint32_t ip, uint32_t now) const;
+
+    size_t count() const { return _count; }
+    const RoomPeer& peer(size_t i) const { return _peers[i]; }
+
+private:
+    String _selfKey;
+    String _roomId;
+    RoomPeer _peers[ROOM_GROUP_MAX_PEERS];
+    size_t _count;
+
+    bool live(const RoomPeer& peer, uint32_t now) const;
+};
+
+// What main.cpp should do after RoomGroupLink::loop()
+enum RoomGroupEvent {
+    ROOM_GROUP_IDLE,
+    ROOM_GROUP_POLL,         // Poll the server: a follower changed the room, or the leader runs a newer config
+    ROOM_GROUP_RELAYED,      // relayedStatus() is the leader's status; show it
+    ROOM_GROUP_VOUCHED,      // The leader shows our status: count it as polled at vouchedAt()
+};
+
+// Runs the group over the network: the room's key, the UDP socket, the mDNS
+// service, beacons in and out, and fetching or serving the relayed status.
+// main.cpp polls and shows what it hands over.
+class RoomGroupLink {
+public:
+    explicit RoomGroupLink(ApiClient& api);
+
+    // Start once the room is known (from the first status) and the server
+    // gave its key, then handle beacons and follow the leader. Stops while
+    // !enabled. An empty roomId keeps the room we have. selfOk: we may lead,
+    // i.e. our last poll worked and the server isn't shedding our requests.
+    RoomGroupEvent loop(bool enabled, const String& roomId, bool selfOk, uint32_t configVersion);
+    void stop();
+
+    // After our own poll: note its body, and as leader tell the followers at
+    // once when it changed
+    void polled(bool selfOk);
+    // We booked or ended a meeting and polled; have the leader poll too so
+    // the other panels don't wait for its next interval
+    void refreshLeader();
+    // Answer GET /room/status from `ip` with query t and m: 200 with the
+    // signed body, else the code to send and a reason in body
+    int answerRelay(uint32_t ip, const String& t, const String& mac, String& body, String& signature);
+
+    // A follower polls only once the leader's beacons have stopped vouching
+    // for its status that much longer
+    uint32_t pollIntervalMs(uint32_t ms) const;
+
+    const RoomStatus& relayedStatus() const { return _relayed; }
+    uint32_t vouchedAt() const { return _vouchedAt; }
+
+    bool running() const { return _running; }
+    // nowMs() of the last broadcast; the next is due ROOM_GROUP_BEACON_MS later
+    uint32_t lastBeacon() const { return _lastBeacon; }
+    const RoomGroup& group() const { return _group; }
+    const String& fingerprint() const { return _fingerprint; }
+    // As of the last loop()
+    const RoomPeer* leader() const { return _group.leader(nowMs(), _selfOk); }
+    bool selfOk() const { return _selfOk; }
+
+    WiFiUDP& udp() { return _udp; }
+    // Port of the panels' web servers (80); tests point it elsewhere
+    void setRelayPort(uint16_t port) { _relayPort = port; }
+
+private:
+    bool start(const String& roomId);
+    void receiveBeacons();
+    void discoverPeers();
+    void sendBeacon(const IPAddress& to, bool refresh);
+    void broadcastBeacon();
+    RoomGroupEvent follow(const RoomPeer& leader);
+
+    ApiClient& _api;
+    WiFiUDP _udp;
+    RoomGroup _group;
+    String _secret;
+    bool _running;
+    bool _selfOk;
+    uint32_t _configVersion;
+    uint16_t _relayPort;
+    String _fingerprint;         // Of the status body shown here
+    uint32_t _lastStart;
+    uint32_t _startRetryMs;
+    uint32_t _lastBeacon;
+    uint32_t _lastDiscovery;
+    uint32_t _lastDirectPoll;    // Relays would be older than our own poll for a while
+    uint32_t _lastRelayAttempt;
+    bool _refreshWanted;         // A follower changed the room; leader polls now
+    RoomStatus _relayed;
+    uint32_t _vouchedAt;
+};
+
+// The mDNS responder, shared by the room group and peer firmware. The host
+// name has to be unique on the LAN; the key is.
+bool startPanelMdns(const String& key);
+
+#endif // ROOM_GROUP_H
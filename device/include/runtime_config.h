@@ -0,0 +1,56 @@
+#ifndef RUNTIME_CONFIG_H
+#define RUNTIME_CONFIG_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Settings operations can retune without a firmware rollout. The server adds
+// a versioned "config" block to the status response when its version differs
+// from the X-Config-Version the device sent; the block lists only the values
+// the server overrides, everything else is the config.h default.
+//
+//   "config": {"version": 7, "statusPollSeconds": 60, "ledBrightness": 40,
+//              "apiUrls": ["https://meet-b.example.com"]}
+
+struct RuntimeConfig {
+    uint32_t version;          // 0 = firmware defaults, never configured
+    uint32_t statusPollMs;
+    uint32_t pingMs;
+    uint32_t firmwareCheckMs;
+    uint32_t screenTimeoutMs;
+    uint8_t ledLevel;          // LED on-level 0-255 (the server sends percent)
+    bool quickBookConfirm;     // Ask before booking, or book on the duration tap
+    uint32_t bookingResultMs;  // How long booking results stay on screen
+    String apiUrls;            // More API endpoints to fail over to, comma-separated; empty = none
+    String mqttUrl;            // Broker for the MQTT transport (mqtt_link.h); empty = poll over HTTP
+    bool roomGroup;            // Share one poll with the room's other panels (room_group.h)
+    bool peerFirmware;         // Get and serve updates on the LAN (peer_firmware.h)
+};
+
+// One bit per setting, for runtimeConfigChanges()
+enum RuntimeConfigField {
+    RC_VERSION = 1 << 0,
+    RC_STATUS_POLL = 1 << 1,
+    RC_PING = 1 << 2,
+    RC_FIRMWARE_CHECK = 1 << 3,
+    RC_SCREEN_TIMEOUT = 1 << 4,
+    RC_LED_LEVEL = 1 << 5,
+    RC_QUICK_BOOK_CONFIRM = 1 << 6,
+    RC_BOOKING_RESULT = 1 << 7,
+    RC_API_URLS = 1 << 8,
+    RC_MQTT_URL = 1 << 9,
+    RC_ROOM_GROUP = 1 << 10,
+    RC_PEER_FIRMWARE = 1 << 11,
+};
+
+RuntimeConfig defaultRuntimeConfig();
+
+// Build the config a block describes. Returns false, leaving out untouched,
+// if the block has no version or any value is of the wrong type or out of
+// range; a bad block is never half-applied.
+bool parseRuntimeConfig(JsonObjectConst block, RuntimeConfig& out, String* error = nullptr);
+
+// RC_* bits of the fields that differ
+uint32_t runtimeConfigChanges(const RuntimeConfig& a, const RuntimeConfig& b);
+
+#endif // RUNTIME_CONFIG_H
@@ -0,0 +1,13 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <Arduino.h>
+
+// SHA-256 of a string as 64 lower-case hex digits. Device tokens are only
+// shared in this form: the edge gateway's token cache, MQTT topic names.
+String sha256Hex(const String& data);
+
+// HMAC-SHA256 of message under key, as 64 lower-case hex digits
+String hmacSha256Hex(const String& key, const String& message);
+
+#endif // SHA256_H
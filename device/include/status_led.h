@@ -0,0 +1,88 @@
+#ifndef STATUS_LED_H
+#define STATUS_LED_H
+
+#include <Arduino.h>
+
+// RGB status LED patterns. Each pattern is a short list of steps (fade to a
+// colour, then hold it); the LEDC fade engine runs the fades in hardware and
+// a small task starts the next step when the fade-complete interrupt fires,
+// so loop() never animates the LED.
+
+enum LedPattern {
+    LED_PATTERN_OFF,
+    LED_PATTERN_AVAILABLE,    // Solid green
+    LED_PATTERN_OCCUPIED,     // Solid red
+    LED_PATTERN_ENDING_SOON,  // Pulsing amber: meeting ends within LED_ENDING_SOON_S
+    LED_PATTERN_OFFLINE,      // Slow white breathe: server or WiFi unreachable
+    LED_PATTERN_BOOKED,       // Green double blink, played once
+    LED_PATTERN_UPDATING,     // Solid blue during a firmware update
+    LED_PATTERN_COUNT
+};
+
+// Brightness per channel at full LED level, 0 = off (scaled by the
+// configured level and inverted for the active-LOW LED when played)
+struct LedStep {
+    uint8_t red;
+    uint8_t green;
+    uint8_t blue;
+    uint16_t fadeMs;  // Fade from the previous step's colour; 0 = jump
+    uint16_t holdMs;  // Then stay; 0 on a pattern's last step = forever
+};
+
+struct LedPatternSteps {
+    const LedStep* steps;
+    uint8_t count;
+    bool repeat;  // Loop forever; otherwise stay on the last step
+};
+
+const LedPatternSteps& ledPatternSteps(LedPattern pattern);
+
+// Pattern for a valid room status. secondsToEnd is the time left in the
+// current meeting when endKnown (negative once it is overdue).
+LedPattern roomLedPattern(bool isAvailable, bool endKnown, long secondsToEnd);
+
+// A step brightness at LED level `level` (255 = as written)
+uint8_t scaleLedLevel(uint8_t value, uint8_t level);
+
+// Time-weighted average brightness of one cycle at `level` (the last step for
+// patterns that don't repeat), for the energy model
+void ledPatternAverage(LedPattern pattern, uint8_t level, uint8_t& red, uint8_t& green, uint8_t& blue);
+
+#ifdef ESP32
+
+class StatusLed {
+public:
+    StatusLed();
+
+    // Install the fade service and start the LED task. Call after
+    // ledcSetup()/ledcAttachPin() on the three channels.
+    void begin();
+    // Switch to a pattern (no-op if it is already showing). A running fade
+    // finishes first; the LED task picks the change up right after.
+    void show(LedPattern pattern);
+    // Play a non-repeating pattern once, then go back to the current one
+    void flash(LedPattern pattern);
+    // Overall brightness, 0-255 (default 255 - LED_BRIGHTNESS)
+    void setLevel(uint8_t level);
+
+    LedPattern pattern() const { return _pattern; }
+    uint8_t level() const { return _level; }
+
+private:
+    static void taskEntry(void* arg);
+    void run();
+    void playStep(const LedStep& step);
+
+    volatile LedPattern _pattern;
+    volatile LedPattern _flash;  // LED_PATTERN_COUNT = none
+    volatile bool _changed;      // show(), flash() or setLevel() since the task last looked
+    volatile uint8_t _level;
+    uint8_t _channel[3];         // Brightness each channel was last set to
+    TaskHandle_t _task;
+};
+
+extern StatusLed statusLed;
+
+#endif // ESP32
+
+#endif // STATUS_LED_H
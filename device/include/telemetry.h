@@ -0,0 +1,70 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Fleet telemetry. The firmware reports status polls, redraws and free heap
+// as they happen; every TELEMETRY_SAMPLE_MS they are closed into one sample,
+// and samples wait in a RAM ring (oldest dropped when full) until the next
+// upload. Samples are numbered from boot, so the server can drop the ones it
+// already has when an upload is retried after a lost answer.
+
+struct TelemetrySample {
+    uint32_t seq;          // Since boot; 0 is counted as a reboot by the server
+    uint32_t endMs;        // nowMs() when the sample closed
+    uint16_t polls;
+    uint16_t pollErrors;
+    uint32_t pollMsSum;    // Successful polls only
+    uint16_t pollMsMax;
+    uint32_t heapMin;      // Bytes; 0 = not recorded
+    int8_t rssi;           // dBm when the sample closed; 0 = not connected
+    uint16_t redraws;
+    uint32_t redrawMsSum;
+    uint16_t redrawMsMax;
+};
+
+class Telemetry {
+public:
+    Telemetry();
+
+    // Start sampling. bootId is random per boot; countBoot false (waking
+    // from out-of-hours sleep) numbers samples from 1 so no reboot is counted.
+    void begin(uint32_t bootId, bool countBoot, uint32_t nowMs);
+
+    void recordPoll(bool ok, uint32_t ms);
+    void recordRedraw(uint32_t ms);
+    void recordHeap(uint32_t freeBytes);
+
+    // Close the current sample once TELEMETRY_SAMPLE_MS has passed; true if one was closed
+    bool tick(uint32_t nowMs, int rssi);
+    // nowMs() when the current sample is due to close
+    uint32_t sampleStartMs() const { return _startMs; }
+
+    size_t pending() const { return _count; }
+    const TelemetrySample& sample(size_t index) const;  // 0 = oldest pending
+    uint32_t dropped() const { return _dropped; }
+
+    // Upload body for every pending sample:
+    // {"v":1,"b":<boot id>,"n":<first seq>,"s":[[age,polls,pollErrors,pollMsSum,
+    //  pollMsMax,heapMin,rssi,redraws,redrawMsSum,redrawMsMax],...]}
+    // with age the seconds since the sample closed
+    String encode(uint32_t nowMs) const;
+    // Drop the `count` oldest samples once the server has them
+    void acknowledge(size_t count);
+
+private:
+    void resetCurrent();
+
+    TelemetrySample _ring[TELEMETRY_BUFFER_SAMPLES];
+    size_t _head;          // Oldest pending
+    size_t _count;
+    TelemetrySample _current;
+    uint32_t _bootId;
+    uint32_t _nextSeq;
+    uint32_t _startMs;
+    uint32_t _dropped;
+    bool _started;
+};
+
+#endif // TELEMETRY_H
@@ -0,0 +1,17 @@
+#ifndef TEXT_FORMAT_H
+#define TEXT_FORMAT_H
+
+#include <Arduino.h>
+
+// Format a quick book duration for a button label ("30 min", "1.5 hours", ...)
+String formatDurationLabel(int minutes);
+
+// Shorten text to maxChars, ending in "..." when it had to be cut
+String truncateText(const String& text, int maxChars);
+
+// Word-wrap text into at most maxLines lines of up to maxChars characters.
+// Breaks at the last space that fits, or hard-breaks long words.
+// Returns the number of lines written to lines[]
+int wrapText(const String& text, int maxChars, String* lines, int maxLines);
+
+#endif // TEXT_FORMAT_H
@@ -0,0 +1,33 @@
+#ifndef TIME_UTILS_H
+#define TIME_UTILS_H
+
+#include <Arduino.h>
+#include <time.h>
+
+// Check if a year is a leap year
+bool isLeapYear(int year);
+
+// Convert UTC calendar time to a Unix timestamp.
+// This is our own implementation of timegm() since ESP32 doesn't have it
+time_t utcToTimestamp(int year, int month, int day, int hour, int minute, int second);
+
+// Make a POSIX TZ string the process timezone (no-op if already active,
+// also after something else like configTime() replaced TZ)
+void applyTimezone(const String& timezone);
+
+// Break a Unix timestamp into local time for a POSIX TZ string (empty keeps
+// the current TZ)
+void toLocalTime(time_t timestamp, const String& timezone, struct tm& out);
+
+// True once the wall clock has been set by NTP (the ESP32 boots at 1970)
+bool isWallTimeSynced(time_t timestamp);
+
+// Parse an ISO 8601 UTC time (e.g. "2024-01-15T14:30:00.000Z") to a Unix
+// timestamp; 0 if it has no time part
+time_t parseIsoTimestamp(const String& isoTime);
+
+// Format an ISO 8601 UTC time (e.g. "2024-01-15T14:30:00.000Z") as local "HH:MM".
+// timezone is a POSIX TZ string; empty keeps the current TZ
+String formatLocalTime(const String& isoTime, const String& timezone);
+
+#endif // TIME_UTILS_H
@@ -0,0 +1,64 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <Arduino.h>
+
+// Lightweight span tracing for performance work. Built with -DTRACE_ENABLED=1
+// (env:esp32-cyd-trace), begin/end events go to a fixed ring buffer that
+// /trace dumps as Chrome trace JSON for chrome://tracing or ui.perfetto.dev.
+// In normal builds the macros compile to nothing.
+//
+// Names must be string literals: only the pointer is stored. Recording is not
+// thread-safe; spans belong on the loop task.
+
+#ifdef TRACE_ENABLED
+
+#define TRACE_PHASE_BEGIN 'B'
+#define TRACE_PHASE_END   'E'
+#define TRACE_PHASE_INSTANT 'i'
+
+struct TraceEvent {
+    const char* name;
+    uint32_t timestampUs;  // micros(), wraps every ~71 minutes
+    char phase;
+};
+
+void traceRecord(const char* name, char phase);
+void traceClear();
+
+// Events currently held, oldest first (at most TRACE_BUFFER_EVENTS)
+size_t traceEventCount();
+const TraceEvent& traceEventAt(size_t index);
+
+// Stream the buffer as Chrome trace JSON in pieces of about chunkBytes.
+// Recording is paused meanwhile so the export doesn't trace itself.
+void traceWriteJson(void (*write)(const String& chunk), size_t chunkBytes = 1024);
+
+// Ends its span when it goes out of scope, including on early return
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : _name(name) { traceRecord(name, TRACE_PHASE_BEGIN); }
+    ~TraceScope() { traceRecord(_name, TRACE_PHASE_END); }
+
+private:
+    const char* _name;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#define TRACE_BEGIN(name) traceRecord(name, TRACE_PHASE_BEGIN)
+#define TRACE_END(name) traceRecord(name, TRACE_PHASE_END)
+#define TRACE_INSTANT(name) traceRecord(name, TRACE_PHASE_INSTANT)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(_traceScope, __LINE__)(name)
+
+#else
+
+#define TRACE_BEGIN(name) do {} while (0)
+#define TRACE_END(name) do {} while (0)
+#define TRACE_INSTANT(name) do {} while (0)
+#define TRACE_SCOPE(name) do {} while (0)
+
+#endif // TRACE_ENABLED
+
+#endif // TRACE_H
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include <TFT_eSPI.h>
 #include "config.h"
+#include "layout.h"
 #include "api_client.h"
 #include "touch.h"
 
@@ -86,17 +87,22 @@ private:
     String _timezone;  // POSIX timezone string (e.g., "CET-1CEST,M3.5.0,M10.5.0/3")
     int _quickBookDurations[4] = {30, 60, 90, 120};  // Current quick book durations
     int _quickBookDurationCount = 4;
+    ScreenLayouts _layout;  // Computed for the current screen size in begin()/setRotation()
 
     // Drawing helpers
     void drawHeader(const String& title, uint16_t bgColor = COLOR_PRIMARY);
     void drawButton(int x, int y, int w, int h, const String& label, uint16_t bgColor, uint16_t textColor);
+    void drawButton(const Rect& r, const String& label, uint16_t bgColor, uint16_t textColor);
     void drawCard(int x, int y, int w, int h, uint16_t bgColor);
+    void drawCard(const Rect& r, uint16_t bgColor);
     void drawCenteredText(const String& text, int y, uint8_t font = 2);
+    void drawWrappedMessage(const String& message);
     void drawBookingCard(int y, const Booking& booking, bool isCurrent = false);
     void drawStatusIndicator(bool available);
 
     void clearButtons();
     void addButton(int x, int y, int w, int h, const String& label, uint16_t bgColor = COLOR_PRIMARY, uint16_t textColor = COLOR_TEXT);
+    void addButton(const Rect& r, const String& label, uint16_t bgColor = COLOR_PRIMARY, uint16_t textColor = COLOR_TEXT);
 
     // Time formatting
     String formatTime(const String& isoTime);
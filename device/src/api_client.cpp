@@ -1,31 +1,168 @@
 #include "api_client.h"
+#include "clock.h"
 #include "config.h"
+#include "energy.h"
+#include "trace.h"
 
-ApiClient::ApiClient() : _apiUrl(""), _deviceToken("") {}
+static RoomStatus emptyRoomStatus() {
+    RoomStatus status;
+    status.isValid = false;
+    status.upcomingCount = 0;
+    status.openingHour = -1;
+    status.closingHour = -1;
+    status.hasConfig = false;
+    status.fetchedAt = 0;
+    return status;
+}
+
+ApiClient::ApiClient()
+    : _apiUrl(""), _deviceToken(""), _configVersion(0), _statusInFlight(false),
+      _statusPublished(0), _statusLast(emptyRoomStatus()), _statusCached(false),
+      _statusEpoch(0), _statusSaved(0), _retryAfterMs(0), _retrySetAt(0), _pollHintMs(0),
+      _roomInfoChanged(false) {
+    _room.isValid = false;
+}
 
 void ApiClient::setApiUrl(const String& url) {
-    _apiUrl = url;
-    // Remove trailing slash if present
-    if (_apiUrl.endsWith("/")) {
-        _apiUrl = _apiUrl.substring(0, _apiUrl.length() - 1);
+    {
+        std::lock_guard<std::mutex> lock(_endpointMutex);
+        // Normalized: trailing slashes, blanks and duplicates removed
+        EndpointPool configured;
+        configured.setUrls(url);
+        _apiUrl = configured.urls();
+        _endpoints.setUrls(_extraApiUrls.length() > 0 ? _apiUrl + "," + _extraApiUrls : _apiUrl);
     }
+    // A status from another server or room must not be reused
+    invalidateStatus();
+}
+
+void ApiClient::setExtraApiUrls(const String& urls) {
+    // Same backend behind other addresses: cached status and room stay valid
+    std::lock_guard<std::mutex> lock(_endpointMutex);
+    _extraApiUrls = urls;
+    _endpoints.setUrls(urls.length() > 0 ? _apiUrl + "," + urls : _apiUrl);
+}
+
+String ApiClient::currentApiUrl() {
+    std::lock_guard<std::mutex> lock(_endpointMutex);
+    int index = _endpoints.select(nowMs());
+    return index >= 0 ? _endpoints.endpoint(index).url : String("");
+}
+
+size_t ApiClient::endpointStats(Endpoint* out, size_t max) {
+    std::lock_guard<std::mutex> lock(_endpointMutex);
+    size_t count = _endpoints.size() < max ? _endpoints.size() : max;
+    for (size_t i = 0; i < count; i++) {
+        out[i] = _endpoints.endpoint(i);
+    }
+    return count;
+}
+
+bool ApiClient::probeEndpoints() {
+    int target;
+    {
+        std::lock_guard<std::mutex> lock(_endpointMutex);
+        target = _endpoints.probeCandidate(nowMs());
+    }
+    if (target < 0) return false;
+    int httpCode;
+    requestOnce(target, "/ping", "GET", "", -1, &httpCode);
+    return true;
 }
 
 void ApiClient::setDeviceToken(const String& token) {
     _deviceToken = token;
+    invalidateStatus();
 }
 
-String ApiClient::makeRequest(const String& endpoint, const String& method, const String& body) {
+uint32_t ApiClient::parseHintSeconds(const String& value) {
+    if (value.length() == 0) return 0;
+    uint32_t seconds = 0;
+    for (unsigned int i = 0; i < value.length(); i++) {
+        char c = value[i];
+        if (c < '0' || c > '9') return 0;
+        seconds = seconds * 10 + (c - '0');
+        if (seconds > SERVER_HINT_MAX_S) return SERVER_HINT_MAX_S;
+    }
+    return seconds;
+}
+
+void ApiClient::noteLoadHints(int httpCode, const String& retryAfter, const String& pollInterval) {
+    // Only "busy" answers carry a usable Retry-After
+    uint32_t retrySeconds = (httpCode == 503 || httpCode == 429) ? parseHintSeconds(retryAfter) : 0;
+    _retrySetAt = nowMs();
+    _retryAfterMs = retrySeconds * 1000;
+    _pollHintMs = parseHintSeconds(pollInterval) * 1000;
+    if (retrySeconds > 0) {
+        Serial.printf("Server busy: retry in %us\n", (unsigned)retrySeconds);
+    }
+}
+
+uint32_t ApiClient::retryAfterMs() const {
+    uint32_t wait = _retryAfterMs;
+    uint32_t elapsed = nowMs() - _retrySetAt;
+    return elapsed < wait ? wait - elapsed : 0;
+}
+
+uint32_t ApiClient::pollIntervalMs(uint32_t configured) const {
+    uint32_t hint = _pollHintMs;
+    return hint > configured ? hint : configured;
+}
+
+void ApiClient::invalidateStatus() {
+    std::lock_guard<std::mutex> lock(_statusMutex);
+    _statusCached = false;
+    _statusEpoch++;
+}
+
+String ApiClient::makeRequest(const String& endpoint, const String& method, const String& body, int64_t epoch) {
+    int httpCode = 0;
+    String response = requestOnce(-1, endpoint, method, body, epoch, &httpCode);
+    if (httpCode < 0 && method == "GET" && (epoch < 0 || (uint32_t)epoch == _statusEpoch)) {
+        bool another;
+        {
+            std::lock_guard<std::mutex> lock(_endpointMutex);
+            int failed = _endpoints.current();
+            another = _endpoints.select(nowMs()) != failed;
+        }
+        if (another) {
+            response = requestOnce(-1, endpoint, method, body, epoch, &httpCode);
+        }
+    }
+    return response;
+}
+
+String ApiClient::requestOnce(int target, const String& endpoint, const String& method, const String& body,
+                              int64_t epoch, int* httpCodeOut) {
+    *httpCodeOut = 0;
     if (_apiUrl.length() == 0 || _deviceToken.length() == 0) {
         return "";
     }
+    if (epoch >= 0 && (uint32_t)epoch != _statusEpoch) {
+        return "";
+    }
+    if (method != "GET" && method != "POST") {
+        return "";
+    }
+
+    String baseUrl;
+    {
+        std::lock_guard<std::mutex> lock(_endpointMutex);
+        if (target < 0) target = _endpoints.select(nowMs());
+        if (target < 0) return "";
+        baseUrl = _endpoints.endpoint(target).url;
+    }
+
+    TRACE_SCOPE("http");
+    EnergyRadioScope radioActive;
 
     HTTPClient http;
     WiFiClientSecure secureClient;
-    String url = _apiUrl + "/api/device" + endpoint;
+    String url = baseUrl + "/api/device" + endpoint;
 
     Serial.println("API Request: " + method + " " + url);
 
+    TRACE_BEGIN("http.begin");
     if (url.startsWith("https")) {
         secureClient.setInsecure(); // Skip cert verification for self-signed/proxy setups
         http.begin(secureClient, url);
@@ -35,27 +172,61 @@ String ApiClient::makeRequest(const String& endpoint, const String& method, cons
     http.setTimeout(API_TIMEOUT);
     http.addHeader("Content-Type", "application/json");
     http.addHeader("X-Device-Token", _deviceToken);
-
+    http.addHeader("X-Config-Version", String(_configVersion));
+    // Asks for statuses without the room; "0" until one is cached
+    http.addHeader("X-Room-Version", _roomVersion.length() > 0 ? _roomVersion : String("0"));
+    static const char* hintHeaders[] = {"Retry-After", "X-Poll-Interval"};
+    http.collectHeaders(hintHeaders, 2);
+    TRACE_END("http.begin");
+
+    // Connect (and TLS handshake), send, and read the status line and headers.
+    // The time this takes is the endpoint's latency.
     int httpCode;
+    uint32_t sentAt = nowMs();
+    TRACE_BEGIN("http.request");
     if (method == "GET") {
         httpCode = http.GET();
-    } else if (method == "POST") {
-        httpCode = http.POST(body);
     } else {
-        http.end();
-        return "";
+        httpCode = http.POST(body);
+    }
+    TRACE_END("http.request");
+    uint32_t answeredAt = nowMs();
+
+    {
+        std::lock_guard<std::mutex> lock(_endpointMutex);
+        if (httpCode > 0 && httpCode < 500) {
+            _endpoints.reportSuccess(target, answeredAt - sentAt, answeredAt);
+        } else {
+            _endpoints.reportFailure(target, httpCode <= 0, answeredAt);
+        }
     }
 
-    String response = "";
     if (httpCode > 0) {
+        noteLoadHints(httpCode, http.header("Retry-After"), http.header("X-Poll-Interval"));
+    }
+
+    String response = "";
+    if (httpCode > 0 && epoch >= 0 && (uint32_t)epoch != _statusEpoch) {
+        // Superseded while waiting for the server: skip the body, the caller
+        // sends the request again
+        Serial.println("Superseded, response dropped");
+        httpCode = HTTPC_ERROR_CONNECTION_LOST;
+        *httpCodeOut = 0;  // Not the endpoint's fault, don't fail over
+    } else if (httpCode > 0) {
+        TRACE_BEGIN("http.body");
         response = http.getString();
+        TRACE_END("http.body");
         Serial.println("Response code: " + String(httpCode));
         Serial.println("Response: " + response);
+        *httpCodeOut = httpCode;
     } else {
         Serial.println("HTTP Error: " + http.errorToString(httpCode));
+        *httpCodeOut = httpCode;
     }
 
+    TRACE_BEGIN("http.end");
     http.end();
+    TRACE_END("http.end");
     return (httpCode >= 200 && httpCode < 300) ? response : "";
 }
 
@@ -103,7 +274,7 @@ Room ApiClient::parseRoom(JsonObject& obj) {
     if (!obj["quickBookDurations"].isNull()) {
         JsonArray durationsArr = obj["quickBookDurations"];
         room.quickBookDurationCount = 0;
-        for (int i = 0; i < 4 && i < durationsArr.size(); i++) {
+        for (int i = 0; i < 4 && i < (int)durationsArr.size(); i++) {
             room.quickBookDurations[i] = durationsArr[i] | 30;
             room.quickBookDurationCount++;
         }
@@ -112,19 +283,186 @@ Room ApiClient::parseRoom(JsonObject& obj) {
     return room;
 }
 
-RoomStatus ApiClient::getRoomStatus() {
+RoomStatus ApiClient::getRoomStatus(uint32_t maxAgeMs) {
+    std::unique_lock<std::mutex> lock(_statusMutex);
+
+    if (maxAgeMs > 0 && _statusCached && nowMs() - _statusLast.fetchedAt < maxAgeMs) {
+        _statusSaved++;
+        return _statusLast;
+    }
+
+    // Someone else is already asking: wait for their answer. A request
+    // superseded while we wait is sent again before it is published.
+    if (_statusInFlight) {
+        uint32_t published = _statusPublished;
+        _statusDone.wait(lock, [&] { return _statusPublished != published; });
+        _statusSaved++;
+        return _statusLast;
+    }
+
+    _statusInFlight = true;
     RoomStatus status;
-    status.isValid = false;
-    status.upcomingCount = 0;
+    uint32_t epoch;
+    for (int attempt = 0;; attempt++) {
+        epoch = _statusEpoch;
+        lock.unlock();
+        // The retry runs to completion: superseded again means changes are
+        // still coming in, and callers get what we have rather than wait for
+        // them to settle (it isn't cached)
+        status = fetchRoomStatus(attempt == 0 ? (int64_t)epoch : -1);
+        lock.lock();
+        if (epoch == _statusEpoch || attempt >= 1) break;
+        Serial.println("Status request superseded, sending again");
+    }
 
-    String response = makeRequest("/status", "GET");
+    _statusLast = status;
+    _statusCached = status.isValid && epoch == _statusEpoch;
+    _statusBody = _statusResponse;
+    _statusResponse = "";
+    _statusInFlight = false;
+    _statusPublished++;
+    lock.unlock();
+    _statusDone.notify_all();
+    return status;
+}
+
+RoomStatus ApiClient::fetchRoomStatus(int64_t epoch) {
+    String response = makeRequest("/status", "GET", "", epoch);
+    _statusResponse = response;
+    RoomStatus status;
     if (response.length() == 0) {
+        status = emptyRoomStatus();
         status.errorMessage = "Failed to connect to server";
-        return status;
+    } else {
+        status = parseRoomStatus(response);
+        addCachedRoom(status);
+    }
+    status.fetchedAt = nowMs();
+    return status;
+}
+
+// Status without the room: use the cached one, refreshed when its version
+// moved. A failed refresh keeps showing the old room.
+void ApiClient::addCachedRoom(RoomStatus& status) {
+    if (!status.isValid || status.room.isValid) {
+        return;
+    }
+    if (status.roomVersion != _roomVersion) {
+        fetchRoomInfo();
+    }
+    status.room = _room;
+    status.isValid = _room.isValid;
+    if (!status.isValid) {
+        status.errorMessage = "Failed to load room";
+    }
+}
+
+RoomStatus ApiClient::pushRoomStatus(const String& body) {
+    // Take the leader's place so the room cache has one user at a time;
+    // callers waiting for a request in flight get this status too
+    std::unique_lock<std::mutex> lock(_statusMutex);
+    _statusDone.wait(lock, [&] { return !_statusInFlight; });
+    _statusInFlight = true;
+    lock.unlock();
+
+    RoomStatus status = parseRoomStatus(body);
+    // Config only comes from our own request; the body may have been
+    // relayed by another panel
+    status.hasConfig = false;
+    addCachedRoom(status);
+    status.fetchedAt = nowMs();
+
+    lock.lock();
+    if (status.isValid) {
+        _statusLast = status;
+        _statusCached = true;
+        _statusBody = body;
+    }
+    _statusInFlight = false;
+    _statusPublished++;
+    lock.unlock();
+    _statusDone.notify_all();
+    return status;
+}
+
+String ApiClient::statusBody() {
+    std::lock_guard<std::mutex> lock(_statusMutex);
+    return _statusCached ? _statusBody : String("");
+}
+
+bool ApiClient::fetchRoomInfo() {
+    String response = makeRequest("/info", "GET");
+    if (response.length() == 0 || !loadRoomInfo(response)) {
+        Serial.println("Failed to load room info");
+        return false;
     }
+    Serial.println("Room info updated to version " + _roomVersion);
+    _roomInfoChanged = true;
+    return true;
+}
 
+bool ApiClient::parseRoomInfo(const String& json, Room& room, String& version) {
     JsonDocument doc;
+    TRACE_BEGIN("json.parse");
+    DeserializationError error = deserializeJson(doc, json);
+    TRACE_END("json.parse");
+    if (error) {
+        return false;
+    }
+
+    JsonObject roomObj = doc["room"];
+    room = parseRoom(roomObj);
+    version = doc["roomVersion"] | "";
+    return room.isValid && version.length() > 0;
+}
+
+bool ApiClient::loadRoomInfo(const String& json) {
+    Room room;
+    String version;
+    if (json.length() == 0 || !parseRoomInfo(json, room, version)) {
+        return false;
+    }
+    _room = room;
+    _roomVersion = version;
+    return true;
+}
+
+String ApiClient::roomInfoJson() const {
+    if (!_room.isValid) {
+        return "";
+    }
+
+    // Same shape as /info, just the fields the panel uses
+    JsonDocument doc;
+    doc["roomVersion"] = _roomVersion;
+    JsonObject room = doc["room"].to<JsonObject>();
+    room["id"] = _room.id;
+    room["name"] = _room.name;
+    room["capacity"] = _room.capacity;
+    room["floor"] = _room.floor;
+    JsonArray durations = room["quickBookDurations"].to<JsonArray>();
+    for (int i = 0; i < _room.quickBookDurationCount; i++) {
+        durations.add(_room.quickBookDurations[i]);
+    }
+
+    String json;
+    serializeJson(doc, json);
+    return json;
+}
+
+bool ApiClient::takeRoomInfoChanged() {
+    bool changed = _roomInfoChanged;
+    _roomInfoChanged = false;
+    return changed;
+}
+
+RoomStatus ApiClient::parseRoomStatus(const String& response) {
+    RoomStatus status = emptyRoomStatus();
+
+    JsonDocument doc;
+    TRACE_BEGIN("json.parse");
     DeserializationError error = deserializeJson(doc, response);
+    TRACE_END("json.parse");
 
     if (error) {
         Serial.println("JSON parse error: " + String(error.c_str()));
@@ -138,12 +476,26 @@ RoomStatus ApiClient::getRoomStatus() {
         return status;
     }
 
-    // Parse room
+    // Parse room; servers that version it send only roomVersion (the
+    // caller fills the room in from its cache)
     JsonObject roomObj = doc["room"];
     status.room = parseRoom(roomObj);
+    status.roomVersion = doc["roomVersion"] | "";
 
     // Parse availability
     status.isAvailable = doc["isAvailable"] | false;
+    status.openingHour = doc["openingHour"] | -1;
+    status.closingHour = doc["closingHour"] | -1;
+
+    // Runtime config, only present when it changed; a bad block is ignored
+    // and the device keeps its current settings
+    if (!doc["config"].isNull()) {
+        String configError;
+        status.hasConfig = parseRuntimeConfig(doc["config"].as<JsonObjectConst>(), status.config, &configError);
+        if (!status.hasConfig) {
+            Serial.println("Ignoring runtime config: " + configError);
+        }
+    }
 
     // Parse current booking
     if (!doc["currentBooking"].isNull()) {
@@ -156,7 +508,7 @@ RoomStatus ApiClient::getRoomStatus() {
     // Parse upcoming bookings
     JsonArray upcomingArr = doc["upcomingBookings"];
     status.upcomingCount = 0;
-    for (int i = 0; i < 3 && i < upcomingArr.size(); i++) {
+    for (int i = 0; i < 3 && i < (int)upcomingArr.size(); i++) {
         JsonObject bookingObj = upcomingArr[i];
         status.upcomingBookings[i] = parseBooking(bookingObj);
         if (status.upcomingBookings[i].isValid) {
@@ -164,7 +516,7 @@ RoomStatus ApiClient::getRoomStatus() {
         }
     }
 
-    status.isValid = status.room.isValid;
+    status.isValid = status.room.isValid || status.roomVersion.length() > 0;
     return status;
 }
 
@@ -186,7 +538,9 @@ QuickBookResult ApiClient::quickBook(const String& title, int durationMinutes) {
     }
 
     JsonDocument responseDoc;
+    TRACE_BEGIN("json.parse");
     DeserializationError error = deserializeJson(responseDoc, response);
+    TRACE_END("json.parse");
 
     if (error) {
         result.message = "Invalid response from server";
@@ -200,6 +554,7 @@ QuickBookResult ApiClient::quickBook(const String& title, int durationMinutes) {
     }
 
     // Parse successful booking
+    invalidateStatus();
     result.success = true;
     result.message = "Room booked successfully!";
 
@@ -223,7 +578,9 @@ EndMeetingResult ApiClient::endMeeting() {
     }
 
     JsonDocument responseDoc;
+    TRACE_BEGIN("json.parse");
     DeserializationError error = deserializeJson(responseDoc, response);
+    TRACE_END("json.parse");
 
     if (error) {
         result.message = "Invalid response from server";
@@ -235,6 +592,7 @@ EndMeetingResult ApiClient::endMeeting() {
         return result;
     }
 
+    invalidateStatus();
     result.success = true;
     result.message = "Meeting ended";
     return result;
@@ -247,7 +605,9 @@ bool ApiClient::ping() {
     }
 
     JsonDocument doc;
+    TRACE_BEGIN("json.parse");
     DeserializationError error = deserializeJson(doc, response);
+    TRACE_END("json.parse");
     if (error) {
         return false;
     }
@@ -267,7 +627,9 @@ FirmwareUpdateResult ApiClient::checkForFirmwareUpdate() {
     }
 
     JsonDocument doc;
+    TRACE_BEGIN("json.parse");
     DeserializationError error = deserializeJson(doc, response);
+    TRACE_END("json.parse");
 
     if (error) {
         Serial.println("Firmware check: JSON parse error");
@@ -296,6 +658,39 @@ FirmwareUpdateResult ApiClient::checkForFirmwareUpdate() {
     return result;
 }
 
+bool ApiClient::sendTelemetry(const String& body) {
+    String response = makeRequest("/telemetry", "POST", body);
+    if (response.length() == 0) {
+        return false;
+    }
+
+    JsonDocument responseDoc;
+    TRACE_BEGIN("json.parse");
+    DeserializationError error = deserializeJson(responseDoc, response);
+    TRACE_END("json.parse");
+    if (error) {
+        return false;
+    }
+
+    return responseDoc["success"] | false;
+}
+
+bool ApiClient::fetchRoomGroupSecret(String& roomId, String& secret) {
+    String response = makeRequest("/room-group", "GET");
+    JsonDocument doc;
+    if (response.length() == 0 || deserializeJson(doc, response)) {
+        return false;
+    }
+    String room = doc["roomId"] | "";
+    String key = doc["secret"] | "";
+    if (room.length() == 0 || key.length() < 32) {
+        return false;
+    }
+    roomId = room;
+    secret = key;
+    return true;
+}
+
 bool ApiClient::reportFirmwareVersion(const String& version) {
     JsonDocument doc;
     doc["version"] = version;
@@ -309,7 +704,9 @@ bool ApiClient::reportFirmwareVersion(const String& version) {
     }
 
     JsonDocument responseDoc;
+    TRACE_BEGIN("json.parse");
     DeserializationError error = deserializeJson(responseDoc, response);
+    TRACE_END("json.parse");
     if (error) {
         return false;
     }
@@ -318,5 +715,36 @@ bool ApiClient::reportFirmwareVersion(const String& version) {
 }
 
 String ApiClient::getFirmwareDownloadUrl(const String& version) {
-    return _apiUrl + "/api/device/firmware/download/" + version;
+    return currentApiUrl() + "/api/device/firmware/download/" + version;
+}
+
+bool roomStatusesAreEqual(const RoomStatus& first, const RoomStatus& second) {
+    // Both must be valid to compare
+    if (!first.isValid || !second.isValid) {
+        return false;
+    }
+
+    // Compare availability
+    if (first.isAvailable != second.isAvailable) {
+        return false;
+    }
+
+    // Compare room name
+    if (first.room.name != second.room.name) {
+        return false;
+    }
+
+    // Compare upcoming bookings count
+    if (first.upcomingCount != second.upcomingCount) {
+        return false;
+    }
+
+    // Compare upcoming booking IDs
+    for (int i = 0; i < first.upcomingCount && i < 3; i++) {
+        if (first.upcomingBookings[i].id != second.upcomingBookings[i].id) {
+            return false;
+        }
+    }
+
+    return true;
 }
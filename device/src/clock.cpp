@@ -0,0 +1,24 @@
+#include "clock.h"
+
+static SystemClock systemClock;
+static Clock* currentClock = &systemClock;
+
+uint32_t SystemClock::monotonicMs() {
+    return (uint32_t)millis();
+}
+
+time_t SystemClock::wallTime() {
+    return time(nullptr);
+}
+
+void SystemClock::delayMs(uint32_t ms) {
+    delay(ms);
+}
+
+void setClock(Clock* clock) {
+    currentClock = clock ? clock : &systemClock;
+}
+
+Clock& activeClock() {
+    return *currentClock;
+}
@@ -0,0 +1,157 @@
+#include "endpoint_pool.h"
+
+static Endpoint freshEndpoint(const String& url) {
+    Endpoint e;
+    e.url = url;
+    e.ewmaMs = 0;
+    e.measuredAt = 0;
+    e.failures = 0;
+    e.downUntil = 0;
+    e.requests = 0;
+    e.errors = 0;
+    return e;
+}
+
+// Unmeasured endpoints rank after every measured one, then in list order
+static uint32_t rankOf(const Endpoint& e) {
+    return e.ewmaMs > 0 ? e.ewmaMs : UINT32_MAX;
+}
+
+EndpointPool::EndpointPool() : _count(0), _current(-1) {}
+
+String EndpointPool::normalizeUrl(const String& url) {
+    String out = url;
+    out.trim();
+    while (out.endsWith("/")) {
+        out = out.substring(0, out.length() - 1);
+    }
+    return out;
+}
+
+size_t EndpointPool::setUrls(const String& list) {
+    Endpoint next[API_MAX_ENDPOINTS];
+    size_t count = 0;
+    int current = -1;
+
+    unsigned int start = 0;
+    while (start <= list.length() && count < API_MAX_ENDPOINTS) {
+        int comma = list.indexOf(',', start);
+        unsigned int end = comma < 0 ? list.length() : (unsigned int)comma;
+        String url = normalizeUrl(list.substring(start, end));
+        start = end + 1;
+        if (url.length() == 0) continue;
+
+        bool duplicate = false;
+        for (size_t i = 0; i < count; i++) {
+            if (next[i].url == url) duplicate = true;
+        }
+        if (duplicate) continue;
+
+        next[count] = freshEndpoint(url);
+        for (size_t i = 0; i < _count; i++) {
+            if (_endpoints[i].url == url) {
+                next[count] = _endpoints[i];
+                if ((int)i == _current) current = count;
+            }
+        }
+        count++;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        _endpoints[i] = next[i];
+    }
+    _count = count;
+    _current = current >= 0 ? current : (count > 0 ? 0 : -1);
+    return count;
+}
+
+String EndpointPool::urls() const {
+    String out;
+    for (size_t i = 0; i < _count; i++) {
+        if (i > 0) out += ",";
+        out += _endpoints[i].url;
+    }
+    return out;
+}
+
+bool EndpointPool::isDown(size_t index, uint32_t nowMs) const {
+    uint32_t until = _endpoints[index].downUntil;
+    return until != 0 && (int32_t)(until - nowMs) > 0;
+}
+
+int EndpointPool::select(uint32_t nowMs) {
+    if (_count == 0) return -1;
+
+    // Fastest healthy endpoint, earlier in the list on a tie
+    int best = -1;
+    for (size_t i = 0; i < _count; i++) {
+        if (isDown(i, nowMs)) continue;
+        if (best < 0 || rankOf(_endpoints[i]) < rankOf(_endpoints[best])) best = i;
+    }
+
+    if (best < 0) {
+        // All backing off: the one that may be retried first
+        best = 0;
+        for (size_t i = 1; i < _count; i++) {
+            if ((int32_t)(_endpoints[i].downUntil - _endpoints[best].downUntil) < 0) best = i;
+        }
+    } else if (_current >= 0 && !isDown(_current, nowMs)) {
+        // Sticky: stay unless the other one is clearly faster
+        const Endpoint& cur = _endpoints[_current];
+        const Endpoint& other = _endpoints[best];
+        bool clearlyFaster = cur.ewmaMs > 0 && other.ewmaMs > 0 &&
+                             (uint64_t)other.ewmaMs * ENDPOINT_SWITCH_RATIO < cur.ewmaMs;
+        if (!clearlyFaster) best = _current;
+    }
+
+    if (best != _current) {
+        Serial.printf("API endpoint: %s\n", _endpoints[best].url.c_str());
+        _current = best;
+    }
+    return _current;
+}
+
+void EndpointPool::reportSuccess(int index, uint32_t latencyMs, uint32_t nowMs) {
+    if (index < 0 || (size_t)index >= _count) return;
+    Endpoint& e = _endpoints[index];
+    e.requests++;
+    e.failures = 0;
+    e.downUntil = 0;
+    e.measuredAt = nowMs;
+    if (latencyMs == 0) latencyMs = 1;  // 0 means unmeasured
+    // EWMA with weight 1/5 for the new sample
+    e.ewmaMs = e.ewmaMs == 0 ? latencyMs : (uint32_t)(((uint64_t)e.ewmaMs * 4 + latencyMs) / 5);
+    if (e.ewmaMs == 0) e.ewmaMs = 1;
+}
+
+void EndpointPool::reportFailure(int index, bool hard, uint32_t nowMs) {
+    if (index < 0 || (size_t)index >= _count) return;
+    Endpoint& e = _endpoints[index];
+    e.requests++;
+    e.errors++;
+    if (e.failures < UINT8_MAX) e.failures++;
+
+    uint8_t threshold = hard ? 1 : ENDPOINT_SOFT_FAILURES;
+    if (e.failures < threshold) return;
+
+    uint32_t backoff = ENDPOINT_DOWN_MS;
+    for (uint8_t i = threshold; i < e.failures && backoff < ENDPOINT_DOWN_MAX_MS; i++) {
+        backoff *= 2;
+    }
+    if (backoff > ENDPOINT_DOWN_MAX_MS) backoff = ENDPOINT_DOWN_MAX_MS;
+    e.downUntil = nowMs + backoff;
+    if (e.downUntil == 0) e.downUntil = 1;
+    Serial.printf("API endpoint %s down for %lus\n", e.url.c_str(), (unsigned long)(backoff / 1000));
+}
+
+int EndpointPool::probeCandidate(uint32_t nowMs) const {
+    int oldest = -1;
+    for (size_t i = 0; i < _count; i++) {
+        if ((int)i == _current || isDown(i, nowMs)) continue;
+        const Endpoint& e = _endpoints[i];
+        bool due = e.measuredAt == 0 || e.downUntil != 0 || nowMs - e.measuredAt >= ENDPOINT_PROBE_MS;
+        if (!due) continue;
+        if (oldest < 0 || (int32_t)(e.measuredAt - _endpoints[oldest].measuredAt) < 0) oldest = i;
+    }
+    return oldest;
+}
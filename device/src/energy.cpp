@@ -0,0 +1,142 @@
+#include "energy.h"
+#include "clock.h"
+#include "config.h"
+
+EnergyMeter energyMeter;
+
+EnergyCurrents defaultEnergyCurrents() {
+    EnergyCurrents c;
+    c.baseMa = ENERGY_BASE_MA;
+    c.cpuBusyMa = ENERGY_CPU_BUSY_MA;
+    c.cpuIdleMa = ENERGY_CPU_IDLE_MA;
+    c.backlightOnMa = ENERGY_BACKLIGHT_MA;
+    c.wifiMa[ENERGY_WIFI_OFF] = 0;
+    c.wifiMa[ENERGY_WIFI_MODEM_SLEEP] = ENERGY_WIFI_MODEM_SLEEP_MA;
+    c.wifiMa[ENERGY_WIFI_ACTIVE] = ENERGY_WIFI_ACTIVE_MA;
+    c.ledChannelMa = ENERGY_LED_CHANNEL_MA;
+    c.supplyMv = ENERGY_SUPPLY_MV;
+    return c;
+}
+
+EnergyMeter::EnergyMeter()
+    : _started(false), _lastMs(0), _cpuBusy(true), _backlightOn(false),
+      _wifi(ENERGY_WIFI_OFF), _radioActivity(0) {
+    memset(&_currents, 0, sizeof(_currents));
+    memset(_ledDuty, 0, sizeof(_ledDuty));
+    reset();
+}
+
+void EnergyMeter::begin(const EnergyCurrents& currents) {
+    _currents = currents;
+    _started = true;
+    reset();
+}
+
+void EnergyMeter::reset() {
+    _elapsedMs = 0;
+    _cpuBusyMs = 0;
+    _backlightOnMs = 0;
+    memset(_wifiMs, 0, sizeof(_wifiMs));
+    memset(_ledDutyMs, 0, sizeof(_ledDutyMs));
+    if (_started) _lastMs = nowMs();
+}
+
+// Credit the time since the last call to the states that were active. Called
+// on every state change, which happens every loop() pass, so the uint32_t
+// difference never spans a full millis() wrap.
+void EnergyMeter::accumulate() {
+    if (!_started) return;
+
+    uint32_t now = nowMs();
+    uint32_t dt = now - _lastMs;
+    _lastMs = now;
+    if (dt == 0) return;
+
+    _elapsedMs += dt;
+    if (_cpuBusy) _cpuBusyMs += dt;
+    if (_backlightOn) _backlightOnMs += dt;
+    _wifiMs[effectiveWifi()] += dt;
+    for (int i = 0; i < ENERGY_LED_CHANNELS; i++) {
+        _ledDutyMs[i] += (uint64_t)_ledDuty[i] * dt;
+    }
+}
+
+EnergyWifiState EnergyMeter::effectiveWifi() const {
+    return (_radioActivity > 0 && _wifi != ENERGY_WIFI_OFF) ? ENERGY_WIFI_ACTIVE : _wifi;
+}
+
+void EnergyMeter::setCpuBusy(bool busy) {
+    if (busy == _cpuBusy) return;
+    accumulate();
+    _cpuBusy = busy;
+}
+
+void EnergyMeter::setBacklight(bool on) {
+    if (on == _backlightOn) return;
+    accumulate();
+    _backlightOn = on;
+}
+
+void EnergyMeter::setWifi(EnergyWifiState state) {
+    if (state == _wifi) return;
+    accumulate();
+    _wifi = state;
+}
+
+// Ignored until begin(): host tools drive ApiClient from several threads
+// without a meter
+void EnergyMeter::beginRadioActivity() {
+    if (!_started) return;
+    accumulate();
+    _radioActivity++;
+}
+
+void EnergyMeter::endRadioActivity() {
+    if (!_started) return;
+    accumulate();
+    if (_radioActivity > 0) _radioActivity--;
+}
+
+void EnergyMeter::setLedDuty(uint8_t red, uint8_t green, uint8_t blue) {
+    if (red == _ledDuty[0] && green == _ledDuty[1] && blue == _ledDuty[2]) return;
+    accumulate();
+    _ledDuty[0] = red;
+    _ledDuty[1] = green;
+    _ledDuty[2] = blue;
+}
+
+EnergyReport EnergyMeter::report() {
+    accumulate();
+
+    EnergyReport r;
+    memset(&r, 0, sizeof(r));
+    r.elapsedMs = _elapsedMs;
+    r.cpuBusyMs = _cpuBusyMs;
+    r.backlightOnMs = _backlightOnMs;
+    memcpy(r.wifiMs, _wifiMs, sizeof(r.wifiMs));
+    if (_elapsedMs == 0) return r;
+
+    // mA x ms -> mAh
+    const double MS_PER_HOUR = 3600000.0;
+    double elapsed = (double)_elapsedMs;
+    r.baseMah = (float)(_currents.baseMa * elapsed / MS_PER_HOUR);
+    r.cpuMah = (float)((_currents.cpuBusyMa * (double)_cpuBusyMs +
+                        _currents.cpuIdleMa * (double)(_elapsedMs - _cpuBusyMs)) / MS_PER_HOUR);
+    r.backlightMah = (float)(_currents.backlightOnMa * (double)_backlightOnMs / MS_PER_HOUR);
+    double wifi = 0;
+    for (int s = 0; s < ENERGY_WIFI_STATE_COUNT; s++) {
+        wifi += _currents.wifiMa[s] * (double)_wifiMs[s];
+    }
+    r.wifiMah = (float)(wifi / MS_PER_HOUR);
+    double led = 0;
+    for (int i = 0; i < ENERGY_LED_CHANNELS; i++) {
+        r.ledDuty[i] = (float)((double)_ledDutyMs[i] / 255.0 / elapsed);
+        led += _currents.ledChannelMa * (double)_ledDutyMs[i] / 255.0;
+    }
+    r.ledMah = (float)(led / MS_PER_HOUR);
+
+    r.totalMah = r.baseMah + r.cpuMah + r.backlightMah + r.wifiMah + r.ledMah;
+    r.averageMa = (float)(r.totalMah * MS_PER_HOUR / elapsed);
+    r.energyMwh = r.totalMah * _currents.supplyMv / 1000.0f;
+    return r;
+}
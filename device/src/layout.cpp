@@ -0,0 +1,190 @@
+#include "layout.h"
+
+void flexLayout(const Rect& area, FlexDirection dir, const FlexItem* items, int count, int16_t gap, Rect* out) {
+    if (count <= 0) return;
+
+    int mainSize = (dir == FLEX_ROW) ? area.w : area.h;
+
+    // Fixed space first, then hand out what is left by grow weight
+    int fixed = gap * (count - 1);
+    int totalGrow = 0;
+    for (int i = 0; i < count; i++) {
+        fixed += items[i].basis;
+        totalGrow += items[i].grow;
+    }
+    int free = mainSize - fixed;
+    if (free < 0) free = 0;
+
+    int pos = (dir == FLEX_ROW) ? area.x : area.y;
+    int handedOut = 0;
+    int growSeen = 0;
+    for (int i = 0; i < count; i++) {
+        int size = items[i].basis;
+        if (items[i].grow > 0 && totalGrow > 0) {
+            // Cumulative rounding so the last growing item absorbs the remainder
+            growSeen += items[i].grow;
+            int share = free * growSeen / totalGrow - handedOut;
+            handedOut += share;
+            size += share;
+        }
+
+        if (dir == FLEX_ROW) {
+            out[i] = {(int16_t)pos, area.y, (int16_t)size, area.h};
+        } else {
+            out[i] = {area.x, (int16_t)pos, area.w, (int16_t)size};
+        }
+        pos += size + gap;
+    }
+}
+
+static void computeMetrics(int16_t width, int16_t height, LayoutMetrics& m) {
+    m.width = width;
+    m.height = height;
+
+    // Uniform scale that fits the reference design inside the screen
+    uint32_t sx = (uint32_t)width * 256 / LAYOUT_REF_WIDTH;
+    uint32_t sy = (uint32_t)height * 256 / LAYOUT_REF_HEIGHT;
+    m.scale = (uint16_t)(sx < sy ? sx : sy);
+
+    m.margin = m.px(12);
+    m.gap = m.px(10);
+
+    // Built-in TFT_eSPI fonts don't scale, so step up where there is room
+    bool large = m.scale >= 320;  // >= 1.25x
+    m.fontSmall = large ? 2 : 1;
+    m.fontBody = 2;
+    m.fontTitle = 4;
+}
+
+static void computeRoomStatus(const LayoutMetrics& m, RoomStatusLayout& l) {
+    // Vertical stack: pad, title, status, pad, end button, pad, list, footer
+    FlexItem column[] = {
+        {m.px(10), 0},
+        {m.px(40), 0},
+        {m.px(70), 0},
+        {m.px(10), 0},
+        {m.px(36), 0},
+        {m.px(10), 0},
+        {0, 1},
+        {m.px(35), 0},
+    };
+    Rect rows[8];
+    Rect screen = {0, 0, m.width, m.height};
+    flexLayout(screen.inset(m.margin, 0), FLEX_COLUMN, column, 8, 0, rows);
+
+    l.title = rows[1];
+    l.statusPanel = rows[2];
+    l.availableLabelY = l.statusPanel.y + m.px(28);
+    l.availableHintY = l.statusPanel.y + m.px(52);
+    l.occupiedLabelY = l.statusPanel.y + m.px(22);
+    l.occupiedUntilY = l.statusPanel.y + m.px(50);
+
+    l.endMeetingButton = rows[4];
+    l.listTop = rows[4].y;
+    l.listTopWithEndButton = rows[6].y;
+    l.listLimitY = rows[7].y;
+    l.listLabelHeight = m.px(14);
+
+    l.card = {m.margin, 0, (int16_t)(m.width - 2 * m.margin), m.px(42)};
+    l.cardPitch = m.px(46);
+    // 28 characters of font 2 fit the reference card
+    l.cardTitleChars = 28 * l.card.w / (LAYOUT_REF_WIDTH - 24);
+
+    l.refreshRadius = m.px(15);
+    int16_t cx = m.width - m.px(25);
+    int16_t cy = m.height - m.px(20);
+    l.refreshButton = {(int16_t)(cx - l.refreshRadius), (int16_t)(cy - l.refreshRadius),
+                       (int16_t)(2 * l.refreshRadius), (int16_t)(2 * l.refreshRadius)};
+}
+
+static void computeQuickBook(const LayoutMetrics& m, QuickBookLayout& l) {
+    FlexItem column[] = {
+        {m.px(12), 0},
+        {m.px(33), 0},
+        {m.px(30), 0},
+        {0, 1},
+        {m.px(10), 0},
+        {m.px(38), 0},
+        {m.px(7), 0},
+    };
+    Rect rows[7];
+    Rect screen = {0, 0, m.width, m.height};
+    flexLayout(screen.inset(m.margin, 0), FLEX_COLUMN, column, 7, 0, rows);
+
+    l.title = rows[1];
+    l.subtitle = rows[2];
+    l.cancelButton = rows[5];
+
+    // 2x2 duration grid; the reference design runs it to 8 px from the
+    // right edge, not the margin
+    FlexItem halves[] = {{0, 1}, {0, 1}};
+    Rect grid = rows[3];
+    grid.w = m.width - m.margin - m.px(8);
+    Rect gridRows[2];
+    flexLayout(grid, FLEX_COLUMN, halves, 2, m.gap, gridRows);
+    flexLayout(gridRows[0], FLEX_ROW, halves, 2, m.gap, &l.durations[0]);
+    flexLayout(gridRows[1], FLEX_ROW, halves, 2, m.gap, &l.durations[2]);
+}
+
+static void computeConfirm(const LayoutMetrics& m, ConfirmLayout& l) {
+    FlexItem column[] = {
+        {m.px(12), 0},
+        {m.px(43), 0},
+        {m.px(70), 0},
+        {0, 1},
+        {m.px(45), 0},
+        {m.px(10), 0},
+    };
+    Rect rows[6];
+    Rect screen = {0, 0, m.width, m.height};
+    flexLayout(screen.inset(m.margin, 0), FLEX_COLUMN, column, 6, 0, rows);
+
+    l.title = rows[1];
+    l.card = rows[2];
+    l.cardLabelY = l.card.y + m.px(17);
+    l.cardValueY = l.card.y + m.px(45);
+    l.noteY = m.py(145);
+    l.line1Y = m.py(110);
+    l.line2Y = m.py(150);
+    l.line3Y = m.py(170);
+
+    FlexItem buttons[] = {{0, 1}, {0, 1}};
+    Rect cols[2];
+    flexLayout(rows[4], FLEX_ROW, buttons, 2, m.px(6), cols);
+    l.leftButton = cols[0];
+    l.rightButton = cols[1];
+}
+
+static void computeMessage(const LayoutMetrics& m, MessageLayout& l) {
+    l.iconX = m.width / 2;
+    l.iconY = m.py(70);
+    l.iconRadius = m.px(35);
+    l.headingY = m.py(125);
+    l.messageTop = m.py(160);
+    l.messageBottom = m.py(200);
+    l.lineHeight = m.px(20);
+    // 35 characters of font 2 fit the reference width
+    l.wrapChars = 35 * m.width / LAYOUT_REF_WIDTH;
+
+    int16_t bw = m.px(120);
+    int16_t bh = m.px(40);
+    l.button = {(int16_t)(m.width / 2 - bw / 2), (int16_t)(m.height - m.px(50)), bw, bh};
+}
+
+static void computeLoading(const LayoutMetrics& m, LoadingLayout& l) {
+    l.cx = m.width / 2;
+    l.cy = m.height / 2 - m.px(20);
+    l.outerRadius = m.px(25);
+    l.innerRadius = m.px(20);
+    l.dotRadius = m.px(5);
+    l.messageY = m.height / 2 + m.px(30);
+}
+
+void computeScreenLayouts(int16_t width, int16_t height, ScreenLayouts& out) {
+    computeMetrics(width, height, out.metrics);
+    computeRoomStatus(out.metrics, out.roomStatus);
+    computeQuickBook(out.metrics, out.quickBook);
+    computeConfirm(out.metrics, out.confirm);
+    computeMessage(out.metrics, out.message);
+    computeLoading(out.metrics, out.loading);
+}
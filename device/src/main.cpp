@@ -6,10 +6,32 @@
 #include <TFT_eSPI.h>
 #include <HTTPClient.h>
 #include <HTTPUpdate.h>
+#include <Update.h>
+#include <MD5Builder.h>
+#include <esp_ota_ops.h>
 #include <time.h>
+#include <esp_sleep.h>
+#include <esp_sntp.h>
+#include <esp_wifi.h>
+#include <driver/gpio.h>
+#include <ESPmDNS.h>
+#include <mdns.h>
 #include "config.h"
 #include "timezones.h"
 #include "api_client.h"
+#include "clock.h"
+#include "energy.h"
+#include "mqtt_link.h"
+#include "peer_firmware.h"
+#include "power.h"
+#include "resume_state.h"
+#include "room_group.h"
+#include "runtime_config.h"
+#include "status_led.h"
+#include "telemetry.h"
+#include "time_utils.h"
+#include "trace.h"
+#include "profiler.h"
 #include "ui_manager.h"
 #include "touch.h"
 
@@ -18,6 +40,7 @@ TFT_eSPI tft = TFT_eSPI();
 TouchController touch;
 UIManager ui(tft, touch);
 ApiClient apiClient;
+Telemetry telemetry;
 Preferences preferences;
 WebServer server(80);
 WiFiManager wifiManager;
@@ -31,17 +54,48 @@ bool screenOn = true;    // Track screen backlight state
 bool connectionLost = false;  // Track if we lost connection to server
 bool forceRedraw = true;  // Force redraw on next status update (e.g., after loading)
 bool safeMode = false;    // Safe mode after boot loop detection
-unsigned long lastStatusUpdate = 0;
-unsigned long lastPing = 0;
-unsigned long lastTouchTime = 0;
-unsigned long lastActivityTime = 0;  // For screen timeout
-unsigned long lastConnectionRetry = 0;  // For connection retry
-unsigned long lastFirmwareCheck = 0;  // For firmware update checks
-unsigned long wifiLostTime = 0;       // When WiFi was first lost
+// Timestamps are nowMs() values; uint32_t so interval math wraps like nowMs()
+uint32_t lastStatusUpdate = 0;
+uint32_t lastPing = 0;
+uint32_t lastTouchTime = 0;
+uint32_t lastActivityTime = 0;  // For screen timeout
+uint32_t lastConnectionRetry = 0;  // For connection retry
+uint32_t connectionRetryMs = CONNECTION_RETRY_INTERVAL;  // Server's Retry-After, or the default plus jitter
+uint32_t lastFirmwareCheck = 0;  // For firmware update checks
+uint32_t lastTelemetryUpload = 0;
+uint32_t wifiLostTime = 0;       // When WiFi was first lost
 int wifiRetryCount = 0;               // WiFi reconnection attempts
 int selectedDuration = 0;
 RoomStatus currentStatus;
 RoomStatus lastStatus;
+RuntimeConfig runtimeConfig = defaultRuntimeConfig();  // Server overrides of the config.h defaults
+
+// MQTT transport (mqtt_link.h), while the runtime config names a broker
+MqttLink mqttLink;
+uint32_t lastHeartbeat = 0;
+
+// LAN room group (room_group.h), while the runtime config enables it and no
+// MQTT session pushes the status anyway
+RoomGroupLink roomGroupLink(apiClient);
+
+// Peer firmware (peer_firmware.h), while the runtime config enables it
+FirmwareSeed firmwareSeed;
+bool firmwareSeedChecked = false;  // Once per boot: the image is checked against the seed
+bool firmwareSeedReady = false;    // The running image is the seed and may be served
+bool firmwareSeedAdvertised = false;
+uint32_t firmwareImagesServed = 0;
+uint8_t firmwareChunk[PEER_FIRMWARE_CHUNK];  // Flash reads of the running image
+String firmwareWaitVersion;        // Nobody here had it: wait before the server download
+uint32_t firmwareWaitStart = 0;
+uint32_t firmwareWaitMs = 0;
+bool firmwareWaitPending = false;
+
+// Out-of-hours sleep
+RTC_DATA_ATTR ResumeState resumeState;  // Kept in RTC memory through deep sleep
+bool wallClockFresh = false;  // NTP has synced since boot or the last sleep
+// Pins that must keep their level through deep sleep: backlight and LED off
+const uint8_t SLEEP_HOLD_PINS[] = {TFT_BL, LED_RED_PIN, LED_GREEN_PIN, LED_BLUE_PIN};
+const uint8_t SLEEP_HOLD_LEVELS[] = {LOW, HIGH, HIGH, HIGH};
 
 // Web authentication
 String sessionToken = "";
@@ -56,28 +110,65 @@ void handleSaveConfig();
 void handleLogin();
 void handleLoginPost();
 void handleLogout();
+void handleDiagnostics();
+void handlePowerMode();
+#ifdef TRACE_ENABLED
+void handleTrace();
+#endif
+#ifdef PROFILER_ENABLED
+void handleProfile();
+void handleProfileStart();
+void handleProfileStop();
+#endif
 bool isAuthenticated();
 String maskToken(const String& token);
 void loadConfig();
 void saveConfig();
+void loadRuntimeConfig();
+void applyRuntimeConfig(const RuntimeConfig& next);
 void initTimeSync(const String& timezone);
+void startTimeSync(const String& timezone);
 void checkWiFi();
-void updateRoomStatus();
+void updateRoomStatus(uint32_t maxAgeMs = 0);
+void handleRoomStatus();
+void handleMqttEvents();
+void roomGroupLoop();
+bool roomGroupSelfOk();
+void handleRoomStatusRelay();
+uint32_t statusPollMs();
+bool startMdns();
+void peerFirmwareLoop();
+void checkFirmwareSeed();
+void handleFirmwareImage();
+size_t findFirmwarePeers(const String& version, FirmwarePeer* peers);
+bool holdFirmwareDownload(const String& version);
+bool installFirmwareFromPeer(const FirmwarePeer& peer, const FirmwareInfo& firmware);
+void finishFirmwareUpdate(const FirmwareInfo& firmware);
 void handleTouch();
 void performQuickBook(int duration);
 void performEndMeeting();
 void setupRgbLed();
-void setLedColor(bool available);
+void showLedPattern(LedPattern pattern);
+void updateStatusLed();
 void setLedOff();
+void updateEnergyWifiState();
+void idleDelay(uint32_t ms);
+void waitForNextEvent();
+bool resumeWifi();
+void checkOutOfHours();
+void sleepOutOfHours(uint32_t seconds);
+void holdPinsForSleep();
+void releaseSleepHolds();
 void checkScreenTimeout();
 void wakeScreen();
-bool roomStatusesAreEqual(const RoomStatus& first, const RoomStatus& second);
 void checkForFirmwareUpdate();
-void performFirmwareUpdate(const String& version);
+void uploadTelemetry();
+void drawRoomStatus();
+void performFirmwareUpdate(const FirmwareInfo& firmware, FirmwarePeer* peers, size_t peerCount);
 
 // Boot loop detection - returns true if device should enter safe mode
 bool checkBootLoop() {
-    unsigned long now = millis() / 1000;  // seconds since boot (approximate)
+    unsigned long now = nowMs() / 1000;  // seconds since boot (approximate)
     int bootCount = preferences.getInt(PREF_BOOT_COUNT, 0);
     unsigned long lastBootTime = preferences.getULong(PREF_BOOT_TIME, 0);
 
@@ -101,6 +192,7 @@ bool checkBootLoop() {
 
 // Call this after device is running stably to reset boot counter
 void clearBootCount() {
+    TRACE_SCOPE("prefs.clearBootCount");
     preferences.putInt(PREF_BOOT_COUNT, 0);
 }
 
@@ -108,6 +200,16 @@ void setup() {
     Serial.begin(115200);
     Serial.println("\n\nOpen Meeting Display Starting...");
 
+    // Woken from out-of-hours deep sleep? (Power-on, reset and crashes report
+    // ESP_SLEEP_WAKEUP_UNDEFINED)
+    esp_sleep_wakeup_cause_t wakeCause = esp_sleep_get_wakeup_cause();
+    bool resumed = (wakeCause == ESP_SLEEP_WAKEUP_TIMER || wakeCause == ESP_SLEEP_WAKEUP_EXT0) &&
+                   resumeStateValid(resumeState);
+    releaseSleepHolds();
+    if (resumed) {
+        Serial.println(wakeCause == ESP_SLEEP_WAKEUP_EXT0 ? "Woken by touch" : "Woken by timer");
+    }
+
     // Initialize RGB LED
     setupRgbLed();
     setLedOff();  // Start with LED off
@@ -117,19 +219,58 @@ void setup() {
 
     // Initialize display
     ui.begin();
-    lastActivityTime = millis();  // Initialize activity timer
+    lastActivityTime = nowMs();  // Initialize activity timer
+
+    // A timer wake is still out of hours or just before opening: keep the
+    // backlight off until someone touches the panel
+    if (resumed && wakeCause == ESP_SLEEP_WAKEUP_TIMER) {
+        screenOn = false;
+        ui.setBacklight(false);
+    }
 
     // Initialize preferences
     preferences.begin(PREFS_NAMESPACE, false);
 
-    // Check for boot loop before doing anything that might crash
-    safeMode = checkBootLoop();
+    // Check for boot loop before doing anything that might crash. Waking
+    // from sleep is not a reboot; a crash after it reports no wake cause.
+    safeMode = resumed ? false : checkBootLoop();
 
     // Load saved configuration
     loadConfig();
 
+    // Power mode; the LED PWM has to keep running if the CPU light-sleeps
+    powerManager.begin(preferences.getBool(PREF_POWER_SAVE, POWER_SAVE_DEFAULT), TOUCH_INT);
+    powerManager.keepPwmInLightSleep(LED_RED_CHANNEL, LED_PWM_FREQ, LED_PWM_RESOLUTION);
+    powerManager.keepPwmInLightSleep(LED_GREEN_CHANNEL, LED_PWM_FREQ, LED_PWM_RESOLUTION);
+    powerManager.keepPwmInLightSleep(LED_BLUE_CHANNEL, LED_PWM_FREQ, LED_PWM_RESOLUTION);
+
+    EnergyCurrents currents = defaultEnergyCurrents();
+    if (powerManager.lightSleep()) {
+        currents.cpuIdleMa = ENERGY_CPU_LIGHT_SLEEP_MA;
+    }
+    energyMeter.begin(currents);
+
+    // Waking from out-of-hours sleep starts a new boot id but isn't a reboot
+    telemetry.begin(esp_random(), !resumed, nowMs());
+
+    // Show the status from before the sleep while WiFi comes up
+    if (resumed && resumeState.hasStatus) {
+        currentStatus = restoreRoomStatus(resumeState);
+        lastStatus = currentStatus;
+        drawRoomStatus();
+        updateStatusLed();
+        forceRedraw = false;
+    }
+
+    // Out-of-hours sleep only trusts the wall clock after a fresh NTP sync
+    sntp_set_time_sync_notification_cb([](struct timeval* tv) {
+        wallClockFresh = true;
+    });
+
     // Set up WiFi Manager
-    ui.showConnecting();
+    if (!resumed) {
+        ui.showConnecting();
+    }
 
     // Configure WiFiManager
     wifiManager.setConfigPortalTimeout(180);  // 3 minute timeout for config portal
@@ -143,9 +284,20 @@ void setup() {
         Serial.println("WiFi config saved, will restart...");
     });
 
-    // Try to connect to WiFi (blocking call)
-    Serial.println("Attempting WiFi connection...");
-    bool connected = wifiManager.autoConnect(WIFI_AP_NAME, WIFI_AP_PASSWORD);
+    // Any WiFi event (connect, disconnect, got IP) ends loop()'s idle wait
+    WiFi.onEvent([](WiFiEvent_t event, WiFiEventInfo_t info) {
+        powerManager.notify();
+    });
+    powerManager.configureWifi();
+
+    // Try to connect to WiFi (blocking call); after a sleep, straight to the
+    // access point we were on
+    energyMeter.setWifi(ENERGY_WIFI_ACTIVE);
+    bool connected = resumed && resumeWifi();
+    if (!connected) {
+        Serial.println("Attempting WiFi connection...");
+        connected = wifiManager.autoConnect(WIFI_AP_NAME, WIFI_AP_PASSWORD);
+    }
 
     if (!connected) {
         Serial.println("Failed to connect to WiFi, starting AP mode");
@@ -159,6 +311,8 @@ void setup() {
     Serial.print("IP Address: ");
     Serial.println(WiFi.localIP());
     wifiConnected = true;
+    powerManager.applyWifiSleep();
+    startTimeSync(preferences.getString(PREF_TIMEZONE, DEFAULT_TIMEZONE));
 
     // Start our own web server for device configuration
     setupWebServer();
@@ -175,14 +329,19 @@ void setup() {
     // Check if device is configured with API token
     if (apiClient.isConfigured()) {
         deviceConfigured = true;
-        ui.showLoading("Loading room status...");
 
-        // Report firmware version on startup
-        Serial.println("Reporting firmware version: " + String(FIRMWARE_VERSION));
-        apiClient.reportFirmwareVersion(FIRMWARE_VERSION);
+        // Resuming keeps the restored screen and skips the version report
+        // (nothing can have changed during the sleep)
+        if (!resumed) {
+            ui.showLoading("Loading room status...");
+
+            // Report firmware version on startup
+            Serial.println("Reporting firmware version: " + String(FIRMWARE_VERSION));
+            apiClient.reportFirmwareVersion(FIRMWARE_VERSION);
+        }
 
         // Delay first firmware check to 60s after boot (avoid heavy OTA during startup)
-        lastFirmwareCheck = millis() - FIRMWARE_CHECK_INTERVAL + 60000;
+        lastFirmwareCheck = nowMs() - runtimeConfig.firmwareCheckMs + 60000;
 
         updateRoomStatus();
     } else {
@@ -195,42 +354,52 @@ void setup() {
 }
 
 void loop() {
+    TRACE_SCOPE("loop");
+
     // Handle web server requests
     if (webServerRunning) {
+        TRACE_SCOPE("web");
         server.handleClient();
     }
 
     // Clear boot counter after device runs stably for BOOT_LOOP_WINDOW seconds
     static bool bootCountCleared = false;
-    if (!bootCountCleared && !safeMode && millis() > BOOT_LOOP_WINDOW * 1000UL) {
+    if (!bootCountCleared && !safeMode && nowMs() > BOOT_LOOP_WINDOW * 1000UL) {
         clearBootCount();
         bootCountCleared = true;
         Serial.println("Device stable for 30s - boot counter cleared");
     }
 
+    updateEnergyWifiState();
+
+    // Telemetry samples close on the first pass after each minute, also
+    // while offline (that is when the poll errors happen)
+    telemetry.recordHeap(ESP.getFreeHeap());
+    telemetry.tick(nowMs(), WiFi.status() == WL_CONNECTED ? WiFi.RSSI() : 0);
+
     // Check WiFi connection
     if (WiFi.status() != WL_CONNECTED) {
         if (wifiConnected) {
             // WiFi just dropped - start tracking
             wifiConnected = false;
-            wifiLostTime = millis();
+            wifiLostTime = nowMs();
             wifiRetryCount = 0;
             webServerRunning = false;
-            setLedOff();
+            showLedPattern(LED_PATTERN_OFFLINE);
             Serial.println("WiFi disconnected - attempting reconnection...");
             ui.showError("WiFi disconnected\n\nReconnecting...");
             WiFi.reconnect();
-        } else if (millis() - wifiLostTime > 60000) {
+        } else if (nowMs() - wifiLostTime > 60000) {
             // WiFi has been down for over 60 seconds - restart
             Serial.println("WiFi down for 60s - restarting");
             ESP.restart();
-        } else if (wifiRetryCount < 5 && millis() - wifiLostTime > (unsigned long)(wifiRetryCount + 1) * 10000) {
+        } else if (wifiRetryCount < 5 && nowMs() - wifiLostTime > (uint32_t)(wifiRetryCount + 1) * 10000) {
             // Retry reconnection every 10 seconds, up to 5 times
             wifiRetryCount++;
             Serial.printf("WiFi reconnect attempt %d/5\n", wifiRetryCount);
             WiFi.reconnect();
         }
-        delay(100);
+        idleDelay(100);
         return;
     }
 
@@ -240,6 +409,7 @@ void loop() {
         wifiRetryCount = 0;
         Serial.println("WiFi reconnected!");
         setupWebServer();
+        startTimeSync(preferences.getString(PREF_TIMEZONE, DEFAULT_TIMEZONE));
         forceRedraw = true;
         if (deviceConfigured) {
             ui.showLoading("Reconnected! Loading...");
@@ -251,29 +421,29 @@ void loop() {
     if (safeMode) {
         int touchX, touchY;
         if (ui.getTouchPoint(touchX, touchY)) {
-            if (millis() - lastTouchTime > 300) {
-                lastTouchTime = millis();
+            if (nowMs() - lastTouchTime > 300) {
+                lastTouchTime = nowMs();
                 if (ui.checkButtonPress(touchX, touchY) >= 0) {
                     Serial.println("Safe mode restart requested by user");
                     ESP.restart();
                 }
             }
         }
-        delay(100);
+        idleDelay(100);
         return;
     }
 
     // If in setup mode, just wait for config via web interface
     if (setupMode) {
         setLedOff();  // No LED color during setup
-        delay(100);
+        idleDelay(100);
         return;
     }
 
     // If not configured, wait for config via web interface
     if (!deviceConfigured) {
         setLedOff();
-        delay(100);
+        idleDelay(100);
         return;
     }
 
@@ -283,38 +453,76 @@ void loop() {
     // Check screen timeout
     checkScreenTimeout();
 
-    // If connection was lost, retry every 30 seconds
+    // MQTT session and whatever arrived on it; a pushed status also ends a
+    // lost connection
+    mqttLink.loop(apiClient.getDeviceToken(), currentStatus.isValid ? currentStatus.room.id : String());
+    handleMqttEvents();
+
+    // Beacons from the room's other panels, and the leader's status when following
+    roomGroupLoop();
+
+    // Offer the installed update to other panels
+    peerFirmwareLoop();
+
+    // If connection was lost, retry every 30 seconds (or when the server said)
     if (connectionLost) {
-        if (millis() - lastConnectionRetry > CONNECTION_RETRY_INTERVAL) {
+        if (nowMs() - lastConnectionRetry > connectionRetryMs) {
             Serial.println("Retrying server connection...");
             forceRedraw = true;  // Force redraw after connection retry
             updateRoomStatus();
-            lastConnectionRetry = millis();
+            lastConnectionRetry = nowMs();
         }
-        delay(50);
+        waitForNextEvent();
         return;
     }
 
-    // Periodic status update
-    if (millis() - lastStatusUpdate > STATUS_POLL_INTERVAL) {
+    // Periodic status update, slower while the server asks for it. Over
+    // MQTT the status is pushed and the firmware check is a command.
+    bool pushed = mqttLink.live();
+    if (!pushed && nowMs() - lastStatusUpdate > statusPollMs()) {
         updateRoomStatus();
+    } else if (currentStatus.isValid) {
+        // The last minutes of a meeting start between polls
+        updateStatusLed();
     }
 
-    // Periodic ping
-    if (millis() - lastPing > PING_INTERVAL) {
+    // Periodic ping, or heartbeat over MQTT
+    if (pushed && nowMs() - lastHeartbeat > runtimeConfig.pingMs) {
+        JsonDocument heartbeat;
+        heartbeat["firmwareVersion"] = FIRMWARE_VERSION;
+        heartbeat["uptimeS"] = nowMs() / 1000;
+        heartbeat["rssi"] = WiFi.RSSI();
+        String body;
+        serializeJson(heartbeat, body);
+        mqttLink.publishHeartbeat(body);
+        lastHeartbeat = nowMs();
+    } else if (!pushed && nowMs() - lastPing > apiClient.pollIntervalMs(runtimeConfig.pingMs)) {
         if (!apiClient.ping()) {
             Serial.println("Ping failed");
         }
-        lastPing = millis();
+        // With several API endpoints, keep the latency of the idle ones current
+        apiClient.probeEndpoints();
+        lastPing = nowMs();
     }
 
-    // Periodic firmware update check
-    if (millis() - lastFirmwareCheck > FIRMWARE_CHECK_INTERVAL) {
+    // Periodic firmware update check, and again when waiting for a peer to
+    // get an update has run out
+    if ((!pushed && nowMs() - lastFirmwareCheck > runtimeConfig.firmwareCheckMs) ||
+        (firmwareWaitPending && nowMs() - firmwareWaitStart > firmwareWaitMs)) {
         checkForFirmwareUpdate();
-        lastFirmwareCheck = millis();
+        lastFirmwareCheck = nowMs();
+    }
+
+    // Batched telemetry upload; held back while the server is shedding load
+    if (telemetry.pending() > 0 && nowMs() - lastTelemetryUpload > TELEMETRY_UPLOAD_MS &&
+        apiClient.retryAfterMs() == 0) {
+        uploadTelemetry();
     }
 
-    delay(50);
+    // Building closed and nobody around: sleep until shortly before opening
+    checkOutOfHours();
+
+    waitForNextEvent();
 }
 
 void loadConfig() {
@@ -331,6 +539,8 @@ void loadConfig() {
 
     apiClient.setApiUrl(apiUrl);
     apiClient.setDeviceToken(token);
+    apiClient.loadRoomInfo(preferences.getString(PREF_ROOM_INFO, ""));
+    loadRuntimeConfig();
 
     // Set timezone on UI manager for time formatting
     ui.setTimezone(timezone);
@@ -342,38 +552,133 @@ void loadConfig() {
 }
 
 void saveConfig() {
+    TRACE_SCOPE("prefs.save");
     preferences.putString(PREF_API_URL, apiClient.getApiUrl());
     preferences.putString(PREF_DEVICE_TOKEN, apiClient.getDeviceToken());
     Serial.println("Config saved");
 }
 
-void initTimeSync(const String& timezoneStr) {
-    Serial.println("Initializing NTP time sync...");
-    Serial.println("Timezone: " + timezoneStr);
+// Server overrides from earlier runs; missing keys are config.h defaults
+void loadRuntimeConfig() {
+    RuntimeConfig c = defaultRuntimeConfig();
+    c.version = preferences.getUInt(PREF_RC_VERSION, c.version);
+    c.statusPollMs = preferences.getUInt(PREF_RC_STATUS_POLL, c.statusPollMs);
+    c.pingMs = preferences.getUInt(PREF_RC_PING, c.pingMs);
+    c.firmwareCheckMs = preferences.getUInt(PREF_RC_FIRMWARE_CHECK, c.firmwareCheckMs);
+    c.screenTimeoutMs = preferences.getUInt(PREF_RC_SCREEN_TIMEOUT, c.screenTimeoutMs);
+    c.ledLevel = preferences.getUChar(PREF_RC_LED_LEVEL, c.ledLevel);
+    c.quickBookConfirm = preferences.getBool(PREF_RC_QUICK_BOOK_CONFIRM, c.quickBookConfirm);
+    c.bookingResultMs = preferences.getUInt(PREF_RC_BOOKING_RESULT, c.bookingResultMs);
+    c.apiUrls = preferences.getString(PREF_RC_API_URLS, c.apiUrls);
+    c.mqttUrl = preferences.getString(PREF_RC_MQTT_URL, c.mqttUrl);
+    c.roomGroup = preferences.getBool(PREF_RC_ROOM_GROUP, c.roomGroup);
+    c.peerFirmware = preferences.getBool(PREF_RC_PEER_FIRMWARE, c.peerFirmware);
+
+    runtimeConfig = c;
+    apiClient.setConfigVersion(c.version);
+    apiClient.setExtraApiUrls(c.apiUrls);
+    mqttLink.configure(c.mqttUrl);
+    statusLed.setLevel(c.ledLevel);
+    Serial.printf("Loaded config - Runtime config version %lu\n", (unsigned long)c.version);
+}
 
-    // Set timezone with DST rules FIRST
-    setenv("TZ", timezoneStr.c_str(), 1);
-    tzset();
+// Write one runtime config value: only if it changed, and as no key at all
+// when it is back to the firmware default
+template <typename T>
+static void persistRuntimeValue(uint32_t changes, uint32_t field, const char* key, T value, T defaultValue,
+                                size_t (Preferences::*put)(const char*, T)) {
+    if (!(changes & field)) return;
+    if (value == defaultValue) {
+        preferences.remove(key);
+    } else {
+        (preferences.*put)(key, value);
+    }
+}
 
+// Apply a config block from the server live and persist what changed. Flash
+// writes are per value, so a version bump that changes one interval costs
+// two small writes rather than rewriting the whole set.
+void applyRuntimeConfig(const RuntimeConfig& next) {
+    uint32_t changes = runtimeConfigChanges(runtimeConfig, next);
+    if (changes == 0) return;
+
+    TRACE_SCOPE("prefs.runtimeConfig");
+    const RuntimeConfig defaults = defaultRuntimeConfig();
+    persistRuntimeValue(changes, RC_VERSION, PREF_RC_VERSION, next.version, defaults.version, &Preferences::putUInt);
+    persistRuntimeValue(changes, RC_STATUS_POLL, PREF_RC_STATUS_POLL, next.statusPollMs, defaults.statusPollMs, &Preferences::putUInt);
+    persistRuntimeValue(changes, RC_PING, PREF_RC_PING, next.pingMs, defaults.pingMs, &Preferences::putUInt);
+    persistRuntimeValue(changes, RC_FIRMWARE_CHECK, PREF_RC_FIRMWARE_CHECK, next.firmwareCheckMs, defaults.firmwareCheckMs, &Preferences::putUInt);
+    persistRuntimeValue(changes, RC_SCREEN_TIMEOUT, PREF_RC_SCREEN_TIMEOUT, next.screenTimeoutMs, defaults.screenTimeoutMs, &Preferences::putUInt);
+    persistRuntimeValue(changes, RC_LED_LEVEL, PREF_RC_LED_LEVEL, next.ledLevel, defaults.ledLevel, &Preferences::putUChar);
+    persistRuntimeValue(changes, RC_QUICK_BOOK_CONFIRM, PREF_RC_QUICK_BOOK_CONFIRM, next.quickBookConfirm, defaults.quickBookConfirm, &Preferences::putBool);
+    persistRuntimeValue(changes, RC_BOOKING_RESULT, PREF_RC_BOOKING_RESULT, next.bookingResultMs, defaults.bookingResultMs, &Preferences::putUInt);
+    persistRuntimeValue(changes, RC_ROOM_GROUP, PREF_RC_ROOM_GROUP, next.roomGroup, defaults.roomGroup, &Preferences::putBool);
+    persistRuntimeValue(changes, RC_PEER_FIRMWARE, PREF_RC_PEER_FIRMWARE, next.peerFirmware, defaults.peerFirmware, &Preferences::putBool);
+    if (changes & RC_API_URLS) {
+        if (next.apiUrls.length() == 0) {
+            preferences.remove(PREF_RC_API_URLS);
+        } else {
+            preferences.putString(PREF_RC_API_URLS, next.apiUrls);
+        }
+    }
+    if (changes & RC_MQTT_URL) {
+        if (next.mqttUrl.length() == 0) {
+            preferences.remove(PREF_RC_MQTT_URL);
+        } else {
+            preferences.putString(PREF_RC_MQTT_URL, next.mqttUrl);
+        }
+    }
+
+    Serial.printf("Runtime config v%lu -> v%lu (changes 0x%02lx)\n", (unsigned long)runtimeConfig.version,
+                  (unsigned long)next.version, (unsigned long)changes);
+    runtimeConfig = next;
+
+    // Intervals and timeouts are read where they are used; the rest is pushed
+    apiClient.setConfigVersion(next.version);
+    if (changes & RC_API_URLS) {
+        apiClient.setExtraApiUrls(next.apiUrls);
+    }
+    if (changes & RC_MQTT_URL) {
+        mqttLink.configure(next.mqttUrl);
+    }
+    if (changes & RC_LED_LEVEL) {
+        statusLed.setLevel(next.ledLevel);
+        showLedPattern(statusLed.pattern());
+    }
+}
+
+// Start (or restart) NTP in the background and apply the timezone
+void startTimeSync(const String& timezoneStr) {
     // Configure time with NTP servers
     configTime(0, 0, NTP_SERVER1, NTP_SERVER2, NTP_SERVER3);
 
+    // Set timezone with DST rules - after configTime(), which resets TZ to
+    // its own UTC offset
+    applyTimezone(timezoneStr);
+}
+
+void initTimeSync(const String& timezoneStr) {
+    Serial.println("Initializing NTP time sync...");
+    Serial.println("Timezone: " + timezoneStr);
+
+    startTimeSync(timezoneStr);
+
     // Wait for time to be set with longer timeout
     Serial.print("Waiting for NTP time sync");
     int retries = 0;
     time_t now = 0;
     struct tm timeinfo = {0};
 
-    while (timeinfo.tm_year < (2024 - 1900) && retries < 40) {  // Increased to 20 seconds
-        delay(500);
-        time(&now);
-        localtime_r(&now, &timeinfo);
+    while (!isWallTimeSynced(now) && retries < 40) {  // Increased to 20 seconds
+        clockDelay(500);
+        now = wallNow();
+        toLocalTime(now, "", timeinfo);
         Serial.print(".");
         retries++;
     }
     Serial.println();
 
-    if (timeinfo.tm_year >= (2024 - 1900)) {
+    if (isWallTimeSynced(now)) {
         Serial.println("NTP time synced successfully!");
         char timeStr[64];
         strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S %Z", &timeinfo);
@@ -442,6 +747,18 @@ void setupWebServer() {
     server.on("/setup", HTTP_GET, handleSetup);
     server.on("/save", HTTP_POST, handleSaveConfig);
     server.on("/reset", HTTP_POST, handleReset);
+    server.on("/diagnostics", HTTP_GET, handleDiagnostics);
+    server.on("/power", HTTP_POST, handlePowerMode);
+    server.on("/room/status", HTTP_GET, handleRoomStatusRelay);
+    server.on("/firmware", HTTP_GET, handleFirmwareImage);
+#ifdef TRACE_ENABLED
+    server.on("/trace", HTTP_GET, handleTrace);
+#endif
+#ifdef PROFILER_ENABLED
+    server.on("/profile", HTTP_GET, handleProfile);
+    server.on("/profile/start", HTTP_POST, handleProfileStart);
+    server.on("/profile/stop", HTTP_POST, handleProfileStop);
+#endif
     server.begin();
     webServerRunning = true;
     Serial.println("Web server started on port 80");
@@ -462,15 +779,14 @@ void handleRoot() {
     bool hasToken = currentToken.length() > 0;
 
     // Get current time info for display
-    time_t now;
+    time_t now = wallNow();
     struct tm timeinfo;
-    time(&now);
-    localtime_r(&now, &timeinfo);
+    toLocalTime(now, "", timeinfo);
     char timeStr[64];
     strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S %Z", &timeinfo);
 
     // Check if time is synced (year should be >= 2024)
-    bool timeIsSynced = (timeinfo.tm_year >= (2024 - 1900));
+    bool timeIsSynced = isWallTimeSynced(now);
 
     // If time is not synced and WiFi is connected, trigger sync
     if (!timeIsSynced && WiFi.status() == WL_CONNECTED) {
@@ -515,13 +831,20 @@ void handleRoot() {
         server.sendContent("<div class=\"time-warning\">Time not synced - NTP sync in progress...<br><small>Refresh page in a few seconds</small></div>");
     }
 
+    // Energy estimate since boot
+    EnergyReport energy = energyMeter.report();
+    server.sendContent("<div class=\"current\" style=\"margin-bottom:15px\">Estimated power: " +
+        String(energy.averageMa, 0) + " mA avg, " + String(energy.energyMwh, 0) + " mWh since boot - "
+        "<a href=\"/diagnostics?session=" + sessionToken + "\">diagnostics</a></div>");
+
     // Form start
     server.sendContent("<form action=\"/save?session=" + sessionToken + "\" method=\"POST\">"
         "<input type=\"hidden\" name=\"session\" value=\"" + sessionToken + "\">"
         "<div class=\"form-group\">"
         "<label>API Server URL</label>"
         "<input type=\"text\" name=\"apiUrl\" placeholder=\"http://your-server:3001\" value=\"" + apiClient.getApiUrl() + "\">"
-        "<div class=\"current\">Example: http://192.168.1.100:3001</div>"
+        "<div class=\"current\">Example: http://192.168.1.100:3001 &mdash; separate up to " + String(API_MAX_ENDPOINTS) +
+        " servers with commas to fail over between them</div>"
         "</div>"
         "<div class=\"form-group\">"
         "<label>Device Token</label>");
@@ -556,6 +879,38 @@ void handleRoot() {
         "<button type=\"submit\">Save Configuration</button>"
         "</form>");
 
+    // Power saving
+    String powerState = "Off - CPU and WiFi radio stay awake";
+    if (powerManager.powerSave()) {
+        powerState = "On - WiFi wakes every " + String(WIFI_LISTEN_INTERVAL) + " beacons, " +
+            String(powerManager.lightSleep() ? "CPU light-sleeps between events" :
+                   powerManager.frequencyScaling() ? "CPU slows down between events (no light sleep in this build)" :
+                   "CPU power management unavailable in this build");
+    }
+    server.sendContent("<hr style=\"margin:20px 0;border:none;border-top:1px solid #ddd\">"
+        "<div class=\"form-group\"><label>Power Saving</label>"
+        "<div class=\"current\">" + powerState + "</div></div>"
+        "<form action=\"/power?session=" + sessionToken + "\" method=\"POST\">"
+        "<input type=\"hidden\" name=\"session\" value=\"" + sessionToken + "\">"
+        "<input type=\"hidden\" name=\"enabled\" value=\"" + String(powerManager.powerSave() ? "0" : "1") + "\">"
+        "<button type=\"submit\">" + String(powerManager.powerSave() ? "Turn Power Saving Off" : "Turn Power Saving On") + "</button>"
+        "<div class=\"current\" style=\"margin-top:5px\">The device restarts to apply this</div>"
+        "</form>");
+
+#ifdef PROFILER_ENABLED
+    // Profiler controls
+    bool profiling = profilerRunning();
+    server.sendContent("<hr style=\"margin:20px 0;border:none;border-top:1px solid #ddd\">"
+        "<div class=\"form-group\"><label>CPU Profiler</label>"
+        "<div class=\"current\">" + String(profiling ? "Running" : "Stopped") + ", " +
+        String((unsigned long)profilerSamples()) + " samples - "
+        "<a href=\"/profile?session=" + sessionToken + "\">download</a></div></div>"
+        "<form action=\"/profile/" + String(profiling ? "stop" : "start") + "?session=" + sessionToken + "\" method=\"POST\">"
+        "<input type=\"hidden\" name=\"session\" value=\"" + sessionToken + "\">"
+        "<button type=\"submit\">" + String(profiling ? "Stop Profiler" : "Start Profiler") + "</button>"
+        "</form>");
+#endif
+
     // Reset and logout forms
     server.sendContent("<hr style=\"margin:20px 0;border:none;border-top:1px solid #ddd\">"
         "<form action=\"/reset?session=" + sessionToken + "\" method=\"POST\">"
@@ -705,6 +1060,22 @@ void handleLogout() {
     server.send(200, "text/html; charset=UTF-8", html);
 }
 
+// Store the power mode and restart; PowerManager is only set up at boot
+void handlePowerMode() {
+    if (!isAuthenticated()) {
+        server.send(401, "text/plain", "Unauthorized");
+        return;
+    }
+
+    bool enabled = server.arg("enabled") == "1";
+    preferences.putBool(PREF_POWER_SAVE, enabled);
+    Serial.printf("Power save %s - restarting\n", enabled ? "on" : "off");
+
+    server.send(200, "text/plain", String("Power saving ") + (enabled ? "on" : "off") + ", restarting...");
+    clockDelay(1000);
+    ESP.restart();
+}
+
 void handleReset() {
     // Check authentication
     if (!isAuthenticated()) {
@@ -731,13 +1102,205 @@ void handleReset() {
     html += "</div></body></html>";
 
     server.send(200, "text/html; charset=UTF-8", html);
-    delay(2000);
+    clockDelay(2000);
 
     // Reset WiFiManager settings and restart
     wifiManager.resetSettings();
     ESP.restart();
 }
 
+// Runtime diagnostics as JSON, including the energy model's estimate since boot
+void handleDiagnostics() {
+    if (!isAuthenticated()) {
+        server.sendHeader("Location", "/login");
+        server.send(303, "text/plain", "Redirecting to login...");
+        return;
+    }
+
+    EnergyReport report = energyMeter.report();
+    const EnergyCurrents& currents = energyMeter.currents();
+
+    JsonDocument doc;
+    doc["firmware"] = FIRMWARE_VERSION;
+    doc["uptimeS"] = nowMs() / 1000;
+    doc["freeHeap"] = ESP.getFreeHeap();
+    doc["rssi"] = WiFi.RSSI();
+
+    JsonObject config = doc["runtimeConfig"].to<JsonObject>();
+    config["version"] = runtimeConfig.version;
+    config["statusPollMs"] = runtimeConfig.statusPollMs;
+    config["pingMs"] = runtimeConfig.pingMs;
+    config["firmwareCheckMs"] = runtimeConfig.firmwareCheckMs;
+    config["screenTimeoutMs"] = runtimeConfig.screenTimeoutMs;
+    config["ledLevel"] = runtimeConfig.ledLevel;
+    config["quickBookConfirm"] = runtimeConfig.quickBookConfirm;
+    config["bookingResultMs"] = runtimeConfig.bookingResultMs;
+    config["apiUrls"] = runtimeConfig.apiUrls;
+
+    // The broker URL may hold a password
+    JsonObject mqtt = doc["mqtt"].to<JsonObject>();
+    mqtt["enabled"] = mqttLink.enabled();
+    if (mqttLink.enabled()) {
+        const MqttBroker& broker = mqttLink.broker();
+        mqtt["broker"] = broker.host + ":" + String(broker.port);
+        mqtt["tls"] = broker.tls;
+        mqtt["prefix"] = broker.prefix;
+        mqtt["connected"] = mqttLink.client().connected();
+        mqtt["state"] = mqttLink.client().state();
+        mqtt["backendOnline"] = mqttLink.backendOnline();
+        mqtt["failures"] = mqttLink.failures();
+    }
+
+    JsonObject group = doc["roomGroup"].to<JsonObject>();
+    group["enabled"] = runtimeConfig.roomGroup;
+    group["running"] = roomGroupLink.running();
+    if (roomGroupLink.running()) {
+        const RoomGroup& roomGroup = roomGroupLink.group();
+        const RoomPeer* leader = roomGroupLink.leader();
+        group["key"] = roomGroup.selfKey();
+        group["role"] = leader ? "follower" : roomGroupLink.selfOk() ? "leader" : "alone";
+        group["leader"] = leader ? leader->beacon.key : roomGroup.selfKey();
+        group["fingerprint"] = roomGroupLink.fingerprint();
+        JsonArray peers = group["peers"].to<JsonArray>();
+        for (size_t i = 0; i < roomGroup.count(); i++) {
+            const RoomPeer& p = roomGroup.peer(i);
+            JsonObject peer = peers.add<JsonObject>();
+            peer["key"] = p.beacon.key;
+            peer["ip"] = IPAddress(p.ip).toString();
+            peer["ageS"] = (nowMs() - p.lastSeen) / 1000;
+            peer["upstreamOk"] = p.beacon.upstreamOk;
+            peer["fingerprint"] = p.beacon.fingerprint;
+        }
+    }
+
+    JsonObject peerFw = doc["peerFirmware"].to<JsonObject>();
+    peerFw["enabled"] = runtimeConfig.peerFirmware;
+    peerFw["serving"] = firmwareSeedReady ? firmwareSeed.version : String("");
+    peerFw["served"] = firmwareImagesServed;
+    if (firmwareWaitPending) {
+        peerFw["waitingFor"] = firmwareWaitVersion;
+        peerFw["serverDownloadInS"] = (firmwareWaitMs - (nowMs() - firmwareWaitStart)) / 1000;
+    }
+
+    doc["statusRequestsSaved"] = apiClient.statusRequestsSaved();
+    doc["statusPollMs"] = statusPollMs();  // With the server's load hint and the room group
+
+    Endpoint endpoints[API_MAX_ENDPOINTS];
+    size_t endpointCount = apiClient.endpointStats(endpoints, API_MAX_ENDPOINTS);
+    String currentUrl = apiClient.currentApiUrl();
+    JsonArray endpointsDoc = doc["endpoints"].to<JsonArray>();
+    for (size_t i = 0; i < endpointCount; i++) {
+        JsonObject e = endpointsDoc.add<JsonObject>();
+        e["url"] = endpoints[i].url;
+        e["current"] = endpoints[i].url == currentUrl;
+        e["ewmaMs"] = endpoints[i].ewmaMs;
+        e["failures"] = endpoints[i].failures;
+        e["downForS"] = endpoints[i].downUntil != 0 && (int32_t)(endpoints[i].downUntil - nowMs()) > 0
+                        ? (endpoints[i].downUntil - nowMs()) / 1000 : 0;
+        e["requests"] = endpoints[i].requests;
+        e["errors"] = endpoints[i].errors;
+    }
+
+    JsonObject telemetryDoc = doc["telemetry"].to<JsonObject>();
+    telemetryDoc["pending"] = telemetry.pending();
+    telemetryDoc["dropped"] = telemetry.dropped();
+
+    JsonObject power = doc["power"].to<JsonObject>();
+    power["powerSave"] = powerManager.powerSave();
+    power["frequencyScaling"] = powerManager.frequencyScaling();
+    power["lightSleep"] = powerManager.lightSleep();
+    power["listenInterval"] = powerManager.powerSave() ? WIFI_LISTEN_INTERVAL : 0;
+    power["outOfHoursSleep"] = !powerManager.powerSave() ? "off" :
+                               powerManager.touchWakesDeepSleep() ? "deep" : "light";
+
+    JsonObject energy = doc["energy"].to<JsonObject>();
+    energy["elapsedS"] = (uint32_t)(report.elapsedMs / 1000);
+    energy["supplyMv"] = currents.supplyMv;
+    energy["averageMa"] = report.averageMa;
+    energy["totalMah"] = report.totalMah;
+    energy["totalMwh"] = report.energyMwh;
+
+    JsonObject mah = energy["subsystemMah"].to<JsonObject>();
+    mah["base"] = report.baseMah;
+    mah["cpu"] = report.cpuMah;
+    mah["backlight"] = report.backlightMah;
+    mah["wifi"] = report.wifiMah;
+    mah["led"] = report.ledMah;
+
+    JsonObject seconds = energy["stateSeconds"].to<JsonObject>();
+    seconds["cpuBusy"] = (uint32_t)(report.cpuBusyMs / 1000);
+    seconds["cpuIdle"] = (uint32_t)((report.elapsedMs - report.cpuBusyMs) / 1000);
+    seconds["backlightOn"] = (uint32_t)(report.backlightOnMs / 1000);
+    seconds["backlightOff"] = (uint32_t)((report.elapsedMs - report.backlightOnMs) / 1000);
+    seconds["wifiOff"] = (uint32_t)(report.wifiMs[ENERGY_WIFI_OFF] / 1000);
+    seconds["wifiModemSleep"] = (uint32_t)(report.wifiMs[ENERGY_WIFI_MODEM_SLEEP] / 1000);
+    seconds["wifiActive"] = (uint32_t)(report.wifiMs[ENERGY_WIFI_ACTIVE] / 1000);
+
+    JsonObject duty = energy["ledDuty"].to<JsonObject>();
+    duty["red"] = report.ledDuty[0];
+    duty["green"] = report.ledDuty[1];
+    duty["blue"] = report.ledDuty[2];
+
+    String json;
+    serializeJson(doc, json);
+    server.send(200, "application/json", json);
+}
+
+#ifdef TRACE_ENABLED
+// Download the trace ring buffer; open it in ui.perfetto.dev or chrome://tracing
+void handleTrace() {
+    if (!isAuthenticated()) {
+        server.sendHeader("Location", "/login");
+        server.send(303, "text/plain", "Redirecting to login...");
+        return;
+    }
+
+    // Streamed in chunks - the full buffer is too big for one String
+    server.sendHeader("Content-Disposition", "attachment; filename=\"panel-trace.json\"");
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "application/json", "");
+    traceWriteJson([](const String& chunk) { server.sendContent(chunk); });
+    server.sendContent("");
+}
+#endif
+
+#ifdef PROFILER_ENABLED
+// Download the profile histogram for tools/profile/flamegraph.py
+void handleProfile() {
+    if (!isAuthenticated()) {
+        server.sendHeader("Location", "/login");
+        server.send(303, "text/plain", "Redirecting to login...");
+        return;
+    }
+
+    server.sendHeader("Content-Disposition", "attachment; filename=\"panel-profile.txt\"");
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "text/plain", "");
+    profilerWriteText([](const String& chunk) { server.sendContent(chunk); });
+    server.sendContent("");
+}
+
+void handleProfileStart() {
+    if (!isAuthenticated()) {
+        server.send(401, "text/plain", "Unauthorized");
+        return;
+    }
+    profilerStart();
+    server.sendHeader("Location", "/?session=" + sessionToken);
+    server.send(303, "text/plain", "Profiler started");
+}
+
+void handleProfileStop() {
+    if (!isAuthenticated()) {
+        server.send(401, "text/plain", "Unauthorized");
+        return;
+    }
+    profilerStop();
+    server.sendHeader("Location", "/?session=" + sessionToken);
+    server.send(303, "text/plain", "Profiler stopped");
+}
+#endif
+
 void handleSaveConfig() {
     // Check authentication
     if (!isAuthenticated()) {
@@ -825,15 +1388,38 @@ void handleSaveConfig() {
 
     setupMode = false;  // Exit setup mode to try new config
     deviceConfigured = true;
-    delay(1000);
+    clockDelay(1000);
     ui.showLoading("Connecting to server...");
     forceRedraw = true;  // Force redraw after loading screen
     updateRoomStatus();
 }
 
-void updateRoomStatus() {
-    currentStatus = apiClient.getRoomStatus();
-    lastStatusUpdate = millis();
+// maxAgeMs > 0 lets a status fetched that recently stand in for a new request
+// (repeated taps); bookings made or ended from the panel always refetch
+void updateRoomStatus(uint32_t maxAgeMs) {
+    TRACE_SCOPE("status.update");
+    uint32_t start = nowMs();
+    currentStatus = apiClient.getRoomStatus(maxAgeMs);
+    // A status reused from the freshness window wasn't a poll
+    if ((int32_t)(currentStatus.fetchedAt - start) >= 0) {
+        telemetry.recordPoll(currentStatus.isValid, currentStatus.fetchedAt - start);
+    }
+    handleRoomStatus();
+    roomGroupLink.polled(roomGroupSelfOk());
+}
+
+// Act on a new currentStatus, fetched or pushed: config, room cache,
+// screen, LED, or the lost-connection screen
+void handleRoomStatus() {
+    // The next poll is due an interval after the status was fetched, not reused
+    lastStatusUpdate = currentStatus.fetchedAt;
+    if (currentStatus.hasConfig) {
+        applyRuntimeConfig(currentStatus.config);
+    }
+    if (apiClient.takeRoomInfoChanged()) {
+        TRACE_SCOPE("prefs.roomInfo");
+        preferences.putString(PREF_ROOM_INFO, apiClient.roomInfoJson());
+    }
 
     if (currentStatus.isValid) {
         setupMode = false;  // Connection successful, exit setup mode
@@ -843,7 +1429,7 @@ void updateRoomStatus() {
         // Only redraw if status changed or forced (e.g., coming from loading screen)
         if (forceRedraw || !roomStatusesAreEqual(currentStatus, lastStatus)) {
             Serial.println("Status changed or forced redraw - updating display");
-            ui.showRoomStatus(currentStatus);
+            drawRoomStatus();
             forceRedraw = false;
         } else {
             Serial.println("Status unchanged - skipping redraw");
@@ -851,7 +1437,7 @@ void updateRoomStatus() {
 
         lastStatus = currentStatus;
         // Update LED based on room availability
-        setLedColor(currentStatus.isAvailable);
+        updateStatusLed();
     } else {
         // Check if this is a first-time setup (no config) or connection lost
         if (!apiClient.isConfigured()) {
@@ -864,42 +1450,342 @@ void updateRoomStatus() {
             Serial.println(WiFi.localIP());
             ui.showTokenSetup(WiFi.localIP().toString());
         } else {
-            // Device is configured but can't reach server - show error and retry
+            // Device is configured but can't reach server - retry when the
+            // server said to, otherwise in 30s plus jitter so a fleet that
+            // lost the server together doesn't come back together
+            uint32_t retryAfter = apiClient.retryAfterMs();
+            connectionRetryMs = retryAfter > 0 ? retryAfter
+                                               : CONNECTION_RETRY_INTERVAL + random(CONNECTION_RETRY_JITTER_MS);
             connectionLost = true;
-            lastConnectionRetry = millis();
-            setLedOff();
+            lastConnectionRetry = nowMs();
+
+            // Busy rather than down: keep showing the last status
+            if (retryAfter > 0 && lastStatus.isValid) {
+                currentStatus = lastStatus;
+                Serial.printf("Server busy - keeping last status, retry in %us\n", (unsigned)(connectionRetryMs / 1000));
+                return;
+            }
+
+            showLedPattern(LED_PATTERN_OFFLINE);
             String errorMsg = currentStatus.errorMessage.length() > 0 ?
                              currentStatus.errorMessage : "Cannot reach server";
-            errorMsg += "\n\nRetrying in 30s...";
-            Serial.println("Connection lost - will retry in 30 seconds");
+            errorMsg += "\n\nRetrying in " + String(connectionRetryMs / 1000) + "s...";
+            Serial.println("Connection lost - will retry in " + String(connectionRetryMs / 1000) + " seconds");
             ui.showError(errorMsg);
         }
     }
 }
 
+// Draw the room status screen, timing the redraw for telemetry
+void drawRoomStatus() {
+    uint32_t start = nowMs();
+    ui.showRoomStatus(currentStatus);
+    telemetry.recordRedraw(nowMs() - start);
+}
+
+// Upload the buffered telemetry samples; they stay buffered if it fails
+void uploadTelemetry() {
+    TRACE_SCOPE("telemetry.upload");
+    size_t count = telemetry.pending();
+    String batch = telemetry.encode(nowMs());
+    // QoS 0: the server skips samples it already has if a batch is sent twice
+    bool sent = mqttLink.publishTelemetry(batch);
+    if (sent || apiClient.sendTelemetry(batch)) {
+        telemetry.acknowledge(count);
+    } else {
+        Serial.println("Telemetry upload failed");
+    }
+    lastTelemetryUpload = nowMs();
+}
+
+// A status or command that arrived over MQTT
+void handleMqttEvents() {
+    String body;
+    if (mqttLink.takeStatus(body)) {
+        TRACE_SCOPE("mqtt.status");
+        RoomStatus pushed = apiClient.pushRoomStatus(body);
+        if (pushed.isValid) {
+            currentStatus = pushed;
+            handleRoomStatus();
+        } else {
+            Serial.println("MQTT: unusable status push");
+        }
+    }
+
+    switch (mqttLink.takeCommand()) {
+        case MQTT_CMD_REFRESH:
+        case MQTT_CMD_CONFIG:
+            // Over HTTP: a new config comes with the status, and a new room
+            // moves the subscription
+            Serial.println("MQTT: refresh");
+            forceRedraw = true;
+            updateRoomStatus();
+            break;
+        case MQTT_CMD_REBOOT:
+            Serial.println("MQTT: reboot");
+            mqttLink.disconnect();
+            ESP.restart();
+            break;
+        case MQTT_CMD_OTA:
+            checkForFirmwareUpdate();
+            lastFirmwareCheck = nowMs();
+            break;
+        case MQTT_CMD_NONE:
+            break;
+    }
+}
+
+// Run the room group while the config enables it, and show or count what
+// it hands over
+void roomGroupLoop() {
+    bool enabled = runtimeConfig.roomGroup && !mqttLink.live();
+    // The room comes from the first status; meanwhile the group keeps its own
+    String roomId = currentStatus.isValid ? currentStatus.room.id : String("");
+    switch (roomGroupLink.loop(enabled, roomId, roomGroupSelfOk(), runtimeConfig.version)) {
+        case ROOM_GROUP_POLL:
+            updateRoomStatus();
+            break;
+        case ROOM_GROUP_RELAYED:
+            currentStatus = roomGroupLink.relayedStatus();
+            handleRoomStatus();
+            break;
+        case ROOM_GROUP_VOUCHED:
+            if ((int32_t)(roomGroupLink.vouchedAt() - lastStatusUpdate) > 0) {
+                lastStatusUpdate = roomGroupLink.vouchedAt();
+            }
+            break;
+        case ROOM_GROUP_IDLE:
+            break;
+    }
+}
+
+// May lead: the last poll worked and the server isn't shedding our requests
+bool roomGroupSelfOk() {
+    return !connectionLost && currentStatus.isValid && apiClient.retryAfterMs() == 0;
+}
+
+// GET /room/status: the leader's status body, signed, for panels of the room only
+void handleRoomStatusRelay() {
+    String body;
+    String signature;
+    int code = roomGroupLink.answerRelay((uint32_t)server.client().remoteIP(), server.arg("t"), server.arg("m"),
+                                         body, signature);
+    if (code != 200) {
+        server.send(code, "text/plain", body);
+        return;
+    }
+    server.sendHeader(ROOM_GROUP_SIGNATURE_HEADER, signature);
+    server.send(200, "application/json", body);
+}
+
+// Status poll interval with the server's load hint and the room group
+uint32_t statusPollMs() {
+    return roomGroupLink.pollIntervalMs(apiClient.pollIntervalMs(runtimeConfig.statusPollMs));
+}
+
+bool startMdns() {
+    return startPanelMdns(mqttDeviceKey(apiClient.getDeviceToken()));
+}
+
+// Check the running image once per boot and, while it is the update we
+// installed last, advertise it to the other panels
+void peerFirmwareLoop() {
+    if (!runtimeConfig.peerFirmware) {
+        if (firmwareSeedAdvertised) {
+            mdns_service_remove("_openmeeting", "_tcp");
+            firmwareSeedAdvertised = false;
+            Serial.println("Peer firmware: stopped serving");
+        }
+        firmwareWaitPending = false;
+        return;
+    }
+    if (!firmwareSeedChecked) {
+        checkFirmwareSeed();
+    }
+    if (firmwareSeedReady && !firmwareSeedAdvertised && startMdns()) {
+        MDNS.addService("openmeeting", "tcp", 80);
+        MDNS.addServiceTxt("openmeeting", "tcp", "fw", firmwareSeed.version);
+        MDNS.addServiceTxt("openmeeting", "tcp", "key", mqttDeviceKey(apiClient.getDeviceToken()));
+        firmwareSeedAdvertised = true;
+        Serial.println("Peer firmware: serving " + firmwareSeed.version);
+    }
+}
+
+// Is the running image the update we installed last? An update boots from
+// the partition it was written to, so that is where the checked copy is.
+// Reads the whole image back from flash, so once per boot.
+void checkFirmwareSeed() {
+    firmwareSeedChecked = true;
+    if (!parseFirmwareSeed(preferences.getString(PREF_FIRMWARE_SEED, ""), firmwareSeed)) {
+        return;
+    }
+    TRACE_SCOPE("peerFirmware.check");
+    const esp_partition_t* running = esp_ota_get_running_partition();
+    bool ok = running && firmwareSeed.size <= running->size;
+    MD5Builder md5;
+    md5.begin();
+    for (uint32_t offset = 0; ok && offset < firmwareSeed.size; offset += sizeof(firmwareChunk)) {
+        size_t n = min((uint32_t)sizeof(firmwareChunk), firmwareSeed.size - offset);
+        ok = esp_partition_read(running, offset, firmwareChunk, n) == ESP_OK;
+        md5.add(firmwareChunk, n);
+    }
+    md5.calculate();
+    firmwareSeedReady = ok && md5.toString() == firmwareSeed.md5;
+    if (!firmwareSeedReady) {
+        // Flashed over USB since, or rolled back
+        Serial.println("Peer firmware: running image is not " + firmwareSeed.version);
+        preferences.remove(PREF_FIRMWARE_SEED);
+    }
+}
+
+// The running image, for panels updating to the version we installed last.
+// Anyone on the LAN may fetch it; panels check it against the server's MD5.
+// Blocks the loop for the transfer, a few seconds on a LAN.
+void handleFirmwareImage() {
+    if (!runtimeConfig.peerFirmware || !firmwareSeedReady || server.arg("version") != firmwareSeed.version) {
+        server.send(404, "text/plain", "Not serving that version");
+        return;
+    }
+    TRACE_SCOPE("peerFirmware.serve");
+    const esp_partition_t* running = esp_ota_get_running_partition();
+    server.setContentLength(firmwareSeed.size);
+    server.send(200, "application/octet-stream", "");
+
+    energyMeter.beginRadioActivity();
+    uint32_t offset = 0;
+    while (offset < firmwareSeed.size) {
+        size_t n = min((uint32_t)sizeof(firmwareChunk), firmwareSeed.size - offset);
+        if (esp_partition_read(running, offset, firmwareChunk, n) != ESP_OK ||
+            server.client().write(firmwareChunk, n) != n) {
+            break;
+        }
+        offset += n;
+    }
+    energyMeter.endRadioActivity();
+
+    if (offset == firmwareSeed.size) {
+        firmwareImagesServed++;
+    }
+    Serial.printf("Peer firmware: sent %lu of %lu bytes to %s\n", (unsigned long)offset,
+                  (unsigned long)firmwareSeed.size, server.client().remoteIP().toString().c_str());
+}
+
+// Panels on the LAN that serve this version, in the order to try them.
+// Blocks for the length of the mDNS query.
+size_t findFirmwarePeers(const String& version, FirmwarePeer* peers) {
+    if (!startMdns()) {
+        return 0;
+    }
+    TRACE_SCOPE("peerFirmware.discover");
+    int found = MDNS.queryService("openmeeting", "tcp");
+    size_t count = 0;
+    for (int i = 0; i < found && count < PEER_FIRMWARE_MAX_PEERS; i++) {
+        peers[count].ip = (uint32_t)MDNS.IP(i);
+        peers[count].key = MDNS.txt(i, "key");
+        peers[count].version = MDNS.txt(i, "fw");
+        count++;
+    }
+    return pickFirmwarePeers(peers, count, version, mqttDeviceKey(apiClient.getDeviceToken()), esp_random());
+}
+
+// No panel here has this version yet. Hold the server download for a random
+// part of PEER_FIRMWARE_WAIT_MS: in a rollout one panel of the site usually
+// gets it from the server first, and the others find it on that panel when
+// they look again. True while waiting.
+bool holdFirmwareDownload(const String& version) {
+    if (version != firmwareWaitVersion) {
+        firmwareWaitVersion = version;
+        firmwareWaitStart = nowMs();
+        firmwareWaitMs = esp_random() % PEER_FIRMWARE_WAIT_MS;
+        firmwareWaitPending = true;
+        Serial.printf("Peer firmware: no panel has %s yet, server download in %lu s\n",
+                      version.c_str(), (unsigned long)(firmwareWaitMs / 1000));
+        return true;
+    }
+    if (firmwareWaitPending && nowMs() - firmwareWaitStart < firmwareWaitMs) {
+        return true;
+    }
+    firmwareWaitPending = false;
+    return false;
+}
+
+// Download from one peer into the other OTA partition. Update.end() fails
+// unless the image has the size and MD5 the server listed, so a peer can't
+// install anything else.
+bool installFirmwareFromPeer(const FirmwarePeer& peer, const FirmwareInfo& firmware) {
+    String from = IPAddress(peer.ip).toString();
+    Serial.println("Peer firmware: fetching from " + from);
+    TRACE_SCOPE("peerFirmware.fetch");
+    WiFiClient client;
+    HTTPClient http;
+    http.begin(client, "http://" + from + peerFirmwarePath(firmware.version));
+    http.setConnectTimeout(PEER_FIRMWARE_TIMEOUT_MS);
+    http.setTimeout(PEER_FIRMWARE_TIMEOUT_MS);
+
+    energyMeter.beginRadioActivity();
+    int code = http.GET();
+    bool ok = code == HTTP_CODE_OK && http.getSize() == firmware.size && Update.begin(firmware.size);
+    if (ok) {
+        Update.setMD5(firmware.checksum.c_str());
+        size_t written = Update.writeStream(*http.getStreamPtr());
+        if (written != (size_t)firmware.size) {
+            Update.abort();
+            ok = false;
+        } else {
+            ok = Update.end();
+        }
+    }
+    energyMeter.endRadioActivity();
+    http.end();
+
+    if (!ok) {
+        Serial.printf("Peer firmware: %s failed (HTTP %d, %s)\n", from.c_str(), code, Update.errorString());
+    }
+    return ok;
+}
+
+// Installed and checked: keep what the server said about the image so it
+// can be served after the reboot (checkFirmwareSeed)
+void finishFirmwareUpdate(const FirmwareInfo& firmware) {
+    FirmwareSeed seed;
+    seed.version = firmware.version;
+    seed.size = firmware.size;
+    seed.md5 = firmware.checksum;
+    seed.md5.toLowerCase();
+    preferences.putString(PREF_FIRMWARE_SEED, encodeFirmwareSeed(seed));
+
+    Serial.println("Firmware update installed - Rebooting...");
+    ui.showLoading("Update complete!\n\nRebooting...");
+    clockDelay(2000);
+    ESP.restart();
+}
+
 void handleTouch() {
     int touchX, touchY;
 
-    if (!ui.getTouchPoint(touchX, touchY)) {
+    TRACE_BEGIN("touch.read");
+    bool touched = ui.getTouchPoint(touchX, touchY);
+    TRACE_END("touch.read");
+    if (!touched) {
         return;
     }
 
     // Any touch wakes the screen and resets activity timer
-    lastActivityTime = millis();
+    lastActivityTime = nowMs();
 
     // If screen was off, wake it up first
     if (!screenOn) {
         wakeScreen();
         // Debounce - don't process this touch as a button press
-        lastTouchTime = millis();
+        lastTouchTime = nowMs();
         return;
     }
 
     // Debounce
-    if (millis() - lastTouchTime < 300) {
+    if (nowMs() - lastTouchTime < 300) {
         return;
     }
-    lastTouchTime = millis();
+    lastTouchTime = nowMs();
 
     int buttonIndex = ui.checkButtonPress(touchX, touchY);
     if (buttonIndex < 0) {
@@ -920,7 +1806,7 @@ void handleTouch() {
             } else if (label == "Refresh") {
                 ui.showLoading("Refreshing...");
                 forceRedraw = true;
-                updateRoomStatus();
+                updateRoomStatus(STATUS_FRESH_MS);
             }
             break;
         }
@@ -928,7 +1814,7 @@ void handleTouch() {
         case UI_END_MEETING_CONFIRM:
             if (buttonIndex == 0) {
                 // Cancel — go back to status
-                ui.showRoomStatus(currentStatus);
+                drawRoomStatus();
             } else if (buttonIndex == 1) {
                 // Confirm end meeting
                 performEndMeeting();
@@ -939,10 +1825,14 @@ void handleTouch() {
             // Button indices 0-3 are duration buttons, 4 is cancel
             if (buttonIndex >= 0 && buttonIndex < ui.getQuickBookDurationCount()) {
                 selectedDuration = ui.getQuickBookDuration(buttonIndex);
-                ui.showBookingConfirm(selectedDuration);
+                if (runtimeConfig.quickBookConfirm) {
+                    ui.showBookingConfirm(selectedDuration);
+                } else {
+                    performQuickBook(selectedDuration);
+                }
             } else if (buttonIndex == ui.getQuickBookDurationCount()) {
                 // Cancel button (after duration buttons)
-                ui.showRoomStatus(currentStatus);
+                drawRoomStatus();
             }
             break;
 
@@ -978,7 +1868,7 @@ void handleTouch() {
             // For booking result, any button returns to status
             ui.showLoading("Loading...");
             forceRedraw = true;  // Force redraw after loading screen
-            updateRoomStatus();
+            updateRoomStatus(STATUS_FRESH_MS);
             break;
     }
 }
@@ -990,11 +1880,17 @@ void performQuickBook(int duration) {
     QuickBookResult result = apiClient.quickBook(title, duration);
 
     ui.showBookingResult(result.success, result.message);
+    if (result.success) {
+        statusLed.flash(LED_PATTERN_BOOKED);
+    }
 
-    // Auto-return to status after 3 seconds
-    delay(3000);
+    // Auto-return to status (3 seconds unless the server says otherwise)
+    idleDelay(runtimeConfig.bookingResultMs);
     forceRedraw = true;  // Force redraw after booking result
     updateRoomStatus();
+    if (result.success) {
+        roomGroupLink.refreshLeader();
+    }
 }
 
 void performEndMeeting() {
@@ -1004,14 +1900,17 @@ void performEndMeeting() {
 
     ui.showBookingResult(result.success, result.message);
 
-    // Auto-return to status after 3 seconds
-    delay(3000);
+    // Auto-return to status (3 seconds unless the server says otherwise)
+    idleDelay(runtimeConfig.bookingResultMs);
     forceRedraw = true;
     updateRoomStatus();
+    if (result.success) {
+        roomGroupLink.refreshLeader();
+    }
 }
 
-// RGB LED functions (active LOW on CYD boards)
-// RGB LED functions using PWM for brightness control (active LOW on CYD boards)
+// RGB LED functions using PWM for brightness control (active LOW on CYD boards).
+// Patterns are played by statusLed on the LEDC fade engine.
 void setupRgbLed() {
     // Set up PWM channels for each LED color
     ledcSetup(LED_RED_CHANNEL, LED_PWM_FREQ, LED_PWM_RESOLUTION);
@@ -1027,26 +1926,203 @@ void setupRgbLed() {
     ledcWrite(LED_RED_CHANNEL, 255);
     ledcWrite(LED_GREEN_CHANNEL, 255);
     ledcWrite(LED_BLUE_CHANNEL, 255);
+
+    statusLed.begin();
+}
+
+// Switch the LED pattern and tell the energy model its average on-duty
+void showLedPattern(LedPattern pattern) {
+    statusLed.show(pattern);
+    uint8_t red, green, blue;
+    ledPatternAverage(pattern, statusLed.level(), red, green, blue);
+    energyMeter.setLedDuty(red, green, blue);
 }
 
-void setLedColor(bool available) {
-    if (available) {
-        // Green for available (at reduced 75% brightness)
-        ledcWrite(LED_RED_CHANNEL, 255);              // Off
-        ledcWrite(LED_GREEN_CHANNEL, LED_BRIGHTNESS); // On at 75% brightness
-        ledcWrite(LED_BLUE_CHANNEL, 255);             // Off
+// Green when available, red when occupied, pulsing amber in the meeting's
+// last LED_ENDING_SOON_S
+void updateStatusLed() {
+    time_t now = wallNow();
+    time_t end = currentStatus.currentBooking.isValid ?
+                 parseIsoTimestamp(currentStatus.currentBooking.endTime) : 0;
+    bool endKnown = end > 0 && isWallTimeSynced(now);
+    showLedPattern(roomLedPattern(currentStatus.isAvailable, endKnown, (long)(end - now)));
+}
+
+void setLedOff() {
+    showLedPattern(LED_PATTERN_OFF);
+}
+
+// Energy model: associated and idle is modem sleep unless power save is off;
+// any other radio use (connecting, scanning, config portal) counts as active
+void updateEnergyWifiState() {
+    if (WiFi.getMode() == WIFI_OFF) {
+        energyMeter.setWifi(ENERGY_WIFI_OFF);
+    } else if (WiFi.status() == WL_CONNECTED && WiFi.getSleep()) {
+        energyMeter.setWifi(ENERGY_WIFI_MODEM_SLEEP);
     } else {
-        // Red for occupied (at reduced 75% brightness)
-        ledcWrite(LED_RED_CHANNEL, LED_BRIGHTNESS);   // On at 75% brightness
-        ledcWrite(LED_GREEN_CHANNEL, 255);            // Off
-        ledcWrite(LED_BLUE_CHANNEL, 255);             // Off
+        energyMeter.setWifi(ENERGY_WIFI_ACTIVE);
     }
 }
 
-void setLedOff() {
-    ledcWrite(LED_RED_CHANNEL, 255);
-    ledcWrite(LED_GREEN_CHANNEL, 255);
-    ledcWrite(LED_BLUE_CHANNEL, 255);
+// Wait with nothing to do; counted as CPU idle by the energy model
+void idleDelay(uint32_t ms) {
+    energyMeter.setCpuBusy(false);
+    powerManager.idle(ms);
+    energyMeter.setCpuBusy(true);
+}
+
+// End of a loop() pass: sleep until the next timer below is due, the panel
+// is touched or a WiFi event arrives. Without power save, poll every 50 ms.
+void waitForNextEvent() {
+    if (!powerManager.powerSave()) {
+        idleDelay(50);
+        return;
+    }
+
+    PowerDeadline deadlines[6];
+    size_t count = 0;
+    if (connectionLost) {
+        deadlines[count++] = {lastConnectionRetry, connectionRetryMs};
+    } else if (mqttLink.live()) {
+        // Pushes arrive within IDLE_MAX_WAIT_MS, the longest wait anyway
+        deadlines[count++] = {lastHeartbeat, runtimeConfig.pingMs};
+    } else {
+        deadlines[count++] = {lastStatusUpdate, statusPollMs()};
+        deadlines[count++] = {lastPing, apiClient.pollIntervalMs(runtimeConfig.pingMs)};
+        deadlines[count++] = {lastFirmwareCheck, runtimeConfig.firmwareCheckMs};
+    }
+    if (screenOn) {
+        deadlines[count++] = {lastActivityTime, runtimeConfig.screenTimeoutMs};
+    }
+    if (roomGroupLink.running()) {
+        deadlines[count++] = {roomGroupLink.lastBeacon(), ROOM_GROUP_BEACON_MS};
+    }
+    if (firmwareWaitPending) {
+        deadlines[count++] = {firmwareWaitStart, firmwareWaitMs};
+    }
+
+    energyMeter.setCpuBusy(false);
+    powerManager.waitForEvent(msUntilNextDeadline(nowMs(), deadlines, count, IDLE_MAX_WAIT_MS));
+    energyMeter.setCpuBusy(true);
+}
+
+// Reconnect to the access point saved before an out-of-hours sleep without
+// scanning. Channel and BSSID are pinned in RAM only, so a normal boot still
+// picks the best access point.
+bool resumeWifi() {
+    if (!resumeStateValid(resumeState) || resumeState.wifiChannel <= 0) {
+        return false;
+    }
+
+    WiFi.mode(WIFI_STA);
+    wifi_config_t conf;
+    if (esp_wifi_get_config(WIFI_IF_STA, &conf) != ESP_OK || conf.sta.ssid[0] == 0) {
+        return false;
+    }
+    conf.sta.channel = resumeState.wifiChannel;
+    memcpy(conf.sta.bssid, resumeState.bssid, sizeof(conf.sta.bssid));
+    conf.sta.bssid_set = true;
+    esp_wifi_set_storage(WIFI_STORAGE_RAM);
+    esp_wifi_set_config(WIFI_IF_STA, &conf);
+    esp_wifi_set_storage(WIFI_STORAGE_FLASH);
+    esp_wifi_connect();
+
+    uint32_t start = nowMs();
+    while (WiFi.status() != WL_CONNECTED && nowMs() - start < RESUME_WIFI_TIMEOUT_MS) {
+        clockDelay(20);
+    }
+    if (WiFi.status() == WL_CONNECTED) {
+        Serial.printf("WiFi resumed in %lu ms\n", (unsigned long)(nowMs() - start));
+        return true;
+    }
+
+    // Access point gone or moved: drop the pin and let a scan find one
+    Serial.println("WiFi resume failed - scanning");
+    esp_wifi_disconnect();
+    conf.sta.channel = 0;
+    conf.sta.bssid_set = false;
+    esp_wifi_set_storage(WIFI_STORAGE_RAM);
+    esp_wifi_set_config(WIFI_IF_STA, &conf);
+    esp_wifi_set_storage(WIFI_STORAGE_FLASH);
+    return false;
+}
+
+// Sleep through closed hours once the panel is left alone. Waits for a fresh
+// NTP sync because the RTC clock drifts by minutes over a long sleep.
+void checkOutOfHours() {
+    if (!powerManager.powerSave() || screenOn || !wallClockFresh) {
+        return;
+    }
+    // A meeting running past closing keeps the panel awake
+    if (!currentStatus.isValid || !currentStatus.isAvailable) {
+        return;
+    }
+
+    uint32_t seconds = outOfHoursSleepSeconds(wallNow(), currentStatus.openingHour,
+                                              currentStatus.closingHour, OUT_OF_HOURS_WAKE_LEAD_S);
+    if (seconds < OUT_OF_HOURS_MIN_SLEEP_S) {
+        return;
+    }
+    sleepOutOfHours(min(seconds, (uint32_t)OUT_OF_HOURS_MAX_SLEEP_S));
+}
+
+void sleepOutOfHours(uint32_t seconds) {
+    Serial.printf("Out of hours - sleeping for %lu s\n", (unsigned long)seconds);
+    // RAM doesn't survive deep sleep
+    if (telemetry.pending() > 0) {
+        uploadTelemetry();
+    }
+    setLedOff();
+    wallClockFresh = false;
+    saveResumeState(resumeState, &currentStatus, WiFi.channel(), WiFi.BSSID());
+
+    if (powerManager.touchWakesDeepSleep()) {
+        holdPinsForSleep();
+        powerManager.deepSleep(seconds);  // Comes back through setup()
+    }
+
+    // The touch INT pin can't wake deep sleep on this board. Light sleep with
+    // the radio off keeps RAM, so only WiFi has to come back.
+    WiFi.mode(WIFI_OFF);
+    updateEnergyWifiState();
+    energyMeter.setCpuBusy(false);
+    bool touched = powerManager.sleepFor(seconds);
+    energyMeter.setCpuBusy(true);
+    Serial.println(touched ? "Woken by touch" : "Woken by timer");
+
+    // loop() treats this as a reconnect: refreshes the status and NTP
+    wifiConnected = false;
+    webServerRunning = false;
+    wifiLostTime = nowMs();
+    wifiRetryCount = 0;
+    if (resumeWifi()) {
+        powerManager.applyWifiSleep();
+    } else {
+        WiFi.begin();  // Saved credentials, with a scan
+    }
+    if (touched) {
+        wakeScreen();
+    }
+    updateStatusLed();
+}
+
+void holdPinsForSleep() {
+    ledcDetachPin(LED_RED_PIN);
+    ledcDetachPin(LED_GREEN_PIN);
+    ledcDetachPin(LED_BLUE_PIN);
+    for (size_t i = 0; i < sizeof(SLEEP_HOLD_PINS); i++) {
+        pinMode(SLEEP_HOLD_PINS[i], OUTPUT);
+        digitalWrite(SLEEP_HOLD_PINS[i], SLEEP_HOLD_LEVELS[i]);
+        gpio_hold_en((gpio_num_t)SLEEP_HOLD_PINS[i]);
+    }
+}
+
+// Holds survive the wake from deep sleep; free the pins before setting them up
+void releaseSleepHolds() {
+    gpio_deep_sleep_hold_dis();
+    for (size_t i = 0; i < sizeof(SLEEP_HOLD_PINS); i++) {
+        gpio_hold_dis((gpio_num_t)SLEEP_HOLD_PINS[i]);
+    }
 }
 
 // Screen timeout functions
@@ -1055,7 +2131,7 @@ void checkScreenTimeout() {
         return;  // Already off
     }
 
-    if (millis() - lastActivityTime > SCREEN_TIMEOUT_MS) {
+    if (nowMs() - lastActivityTime > runtimeConfig.screenTimeoutMs) {
         // Turn off backlight but keep LED showing status
         screenOn = false;
         ui.setBacklight(false);
@@ -1070,43 +2146,10 @@ void wakeScreen() {
         Serial.println("Screen wake - backlight on");
         // Refresh the display
         if (currentStatus.isValid) {
-            ui.showRoomStatus(currentStatus);
+            drawRoomStatus();
         }
     }
-    lastActivityTime = millis();
-}
-
-bool roomStatusesAreEqual(const RoomStatus& first, const RoomStatus& second) {
-    // Both must be valid to compare
-    if (!first.isValid || !second.isValid) {
-        return false;
-    }
-
-    // Compare availability
-    if (first.isAvailable != second.isAvailable) {
-        return false;
-    }
-
-    // Compare room name
-    if (first.room.name != second.room.name) {
-        return false;
-    }
-
- 
-
-    // Compare upcoming bookings count
-    if (first.upcomingCount != second.upcomingCount) {
-        return false;
-    }
-
-    // Compare upcoming booking IDs
-    for (int i = 0; i < first.upcomingCount && i < 3; i++) {
-        if (first.upcomingBookings[i].id != second.upcomingBookings[i].id) {
-            return false;
-        }
-    }
-
-    return true;
+    lastActivityTime = nowMs();
 }
 
 // Firmware OTA update functions
@@ -1126,23 +2169,41 @@ void checkForFirmwareUpdate() {
         Serial.println("  New: " + result.firmware.version);
         Serial.println("  Size: " + String(result.firmware.size) + " bytes");
 
+        // Look on the LAN first; when nobody has it yet, maybe wait for a
+        // panel that gets it from the server
+        FirmwarePeer peers[PEER_FIRMWARE_MAX_PEERS];
+        size_t peerCount = 0;
+        if (runtimeConfig.peerFirmware && result.firmware.size > 0 && result.firmware.checksum.length() == 32) {
+            peerCount = findFirmwarePeers(result.firmware.version, peers);
+            if (peerCount == 0 && holdFirmwareDownload(result.firmware.version)) {
+                return;
+            }
+        }
+
         // Perform the update
-        performFirmwareUpdate(result.firmware.version);
+        performFirmwareUpdate(result.firmware, peers, peerCount);
     } else {
         Serial.println("No firmware update available");
     }
 }
 
-void performFirmwareUpdate(const String& version) {
+void performFirmwareUpdate(const FirmwareInfo& firmware, FirmwarePeer* peers, size_t peerCount) {
+    const String& version = firmware.version;
     Serial.println("Starting firmware update to version " + version);
 
     // Show update screen
     ui.showLoading("Updating firmware...\nv" + String(FIRMWARE_VERSION) + " -> v" + version + "\n\nDo not power off!");
 
     // Turn LED blue during update
-    ledcWrite(LED_RED_CHANNEL, 255);
-    ledcWrite(LED_GREEN_CHANNEL, 255);
-    ledcWrite(LED_BLUE_CHANNEL, LED_BRIGHTNESS);
+    showLedPattern(LED_PATTERN_UPDATING);
+
+    // Panels on the LAN first, the server if none of them delivers
+    for (size_t i = 0; i < peerCount && i < PEER_FIRMWARE_TRIES; i++) {
+        if (installFirmwareFromPeer(peers[i], firmware)) {
+            finishFirmwareUpdate(firmware);
+            return;
+        }
+    }
 
     // Get the download URL
     String updateUrl = apiClient.getFirmwareDownloadUrl(version);
@@ -1174,7 +2235,9 @@ void performFirmwareUpdate(const String& version) {
     // Perform the update with the authenticated HTTP client
     httpUpdate.rebootOnUpdate(false);  // We'll handle reboot ourselves
 
+    energyMeter.beginRadioActivity();
     t_httpUpdate_return ret = httpUpdate.update(http);
+    energyMeter.endRadioActivity();
 
     switch (ret) {
         case HTTP_UPDATE_FAILED:
@@ -1183,29 +2246,27 @@ void performFirmwareUpdate(const String& version) {
                          httpUpdate.getLastErrorString().c_str());
             ui.showError("Update failed!\n\n" + httpUpdate.getLastErrorString());
             setLedOff();
-            delay(5000);
+            clockDelay(5000);
             // Return to normal operation
             if (currentStatus.isValid) {
-                ui.showRoomStatus(currentStatus);
-                setLedColor(currentStatus.isAvailable);
+                drawRoomStatus();
+                updateStatusLed();
             }
             break;
 
         case HTTP_UPDATE_NO_UPDATES:
             Serial.println("HTTP_UPDATE_NO_UPDATES");
             ui.showError("No update available");
-            delay(3000);
+            clockDelay(3000);
             if (currentStatus.isValid) {
-                ui.showRoomStatus(currentStatus);
-                setLedColor(currentStatus.isAvailable);
+                drawRoomStatus();
+                updateStatusLed();
             }
             break;
 
         case HTTP_UPDATE_OK:
-            Serial.println("HTTP_UPDATE_OK - Rebooting...");
-            ui.showLoading("Update complete!\n\nRebooting...");
-            delay(2000);
-            ESP.restart();
+            Serial.println("HTTP_UPDATE_OK");
+            finishFirmwareUpdate(firmware);
             break;
     }
 }
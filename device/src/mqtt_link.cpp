@@ -0,0 +1,279 @@
+#include "mqtt_link.h"
+#include <ArduinoJson.h>
+#include "clock.h"
+#include "config.h"
+#include "sha256.h"
+#include "trace.h"
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// %XX escapes; false on a malformed one
+static bool percentDecode(const String& in, String& out) {
+    out = "";
+    for (unsigned int i = 0; i < in.length(); i++) {
+        char c = in.charAt(i);
+        if (c != '%') {
+            out += c;
+            continue;
+        }
+        if (i + 2 >= in.length() || hexValue(in.charAt(i + 1)) < 0 || hexValue(in.charAt(i + 2)) < 0) {
+            return false;
+        }
+        out += (char)(hexValue(in.charAt(i + 1)) * 16 + hexValue(in.charAt(i + 2)));
+        i += 2;
+    }
+    return true;
+}
+
+bool parseMqttUrl(const String& url, MqttBroker& out) {
+    MqttBroker b;
+    String rest;
+    if (url.startsWith("mqtt://")) {
+        b.tls = false;
+        rest = url.substring(7);
+    } else if (url.startsWith("mqtts://")) {
+        b.tls = true;
+        rest = url.substring(8);
+    } else {
+        return false;
+    }
+    b.port = b.tls ? MQTT_DEFAULT_TLS_PORT : MQTT_DEFAULT_PORT;
+    b.prefix = MQTT_DEFAULT_PREFIX;
+
+    int slash = rest.indexOf('/');
+    String authority = slash < 0 ? rest : rest.substring(0, slash);
+    if (slash >= 0) {
+        String prefix = rest.substring(slash + 1);
+        while (prefix.endsWith("/")) {
+            prefix = prefix.substring(0, prefix.length() - 1);
+        }
+        // Wildcards would subscribe to other panels' topics
+        if (prefix.indexOf('+') >= 0 || prefix.indexOf('#') >= 0) return false;
+        if (prefix.length() > 0) b.prefix = prefix;
+    }
+
+    int at = authority.lastIndexOf('@');
+    if (at >= 0) {
+        String credentials = authority.substring(0, at);
+        authority = authority.substring(at + 1);
+        int colon = credentials.indexOf(':');
+        String user = colon < 0 ? credentials : credentials.substring(0, colon);
+        String password = colon < 0 ? String("") : credentials.substring(colon + 1);
+        if (!percentDecode(user, b.username) || !percentDecode(password, b.password)) return false;
+    }
+
+    int colon = authority.lastIndexOf(':');
+    if (colon >= 0) {
+        String port = authority.substring(colon + 1);
+        long value = port.toInt();
+        if (port.length() == 0 || value <= 0 || value > 65535 || String(value) != port) return false;
+        b.port = (uint16_t)value;
+        authority = authority.substring(0, colon);
+    }
+    if (authority.length() == 0) return false;
+    b.host = authority;
+
+    out = b;
+    return true;
+}
+
+String mqttDeviceKey(const String& deviceToken) {
+    return sha256Hex(deviceToken).substring(0, 16);
+}
+
+MqttTopics mqttTopics(const String& prefix, const String& deviceKey, const String& roomId) {
+    MqttTopics t;
+    String device = prefix + "/devices/" + deviceKey;
+    t.roomStatus = prefix + "/rooms/" + roomId + "/status";
+    t.command = device + "/command";
+    t.fleetCommand = prefix + "/command";
+    t.backend = prefix + "/backend";
+    t.heartbeat = device + "/heartbeat";
+    t.telemetry = device + "/telemetry";
+    t.online = device + "/online";
+    return t;
+}
+
+MqttCommand parseMqttCommand(const char* payload, size_t length) {
+    JsonDocument doc;
+    if (deserializeJson(doc, payload, length)) {
+        return MQTT_CMD_NONE;
+    }
+    String cmd = doc["cmd"] | "";
+    if (cmd == "refresh") return MQTT_CMD_REFRESH;
+    if (cmd == "reboot") return MQTT_CMD_REBOOT;
+    if (cmd == "config") return MQTT_CMD_CONFIG;
+    if (cmd == "ota") return MQTT_CMD_OTA;
+    return MQTT_CMD_NONE;
+}
+
+uint32_t mqttReconnectDelayMs(uint8_t failures) {
+    uint32_t delayMs = MQTT_RECONNECT_MS;
+    for (uint8_t i = 1; i < failures && delayMs < MQTT_RECONNECT_MAX_MS; i++) {
+        delayMs *= 2;
+    }
+    return delayMs > MQTT_RECONNECT_MAX_MS ? MQTT_RECONNECT_MAX_MS : delayMs;
+}
+
+MqttLink::MqttLink()
+    : _enabled(false), _backendOnline(false), _wasConnected(false), _failures(0),
+      _lastAttempt(0), _retryMs(0), _statusPending(false), _pendingCommand(MQTT_CMD_NONE) {}
+
+void MqttLink::configure(const String& url) {
+    disconnect();
+    _wasConnected = false;
+    _backendOnline = false;
+    _roomId = "";
+    _failures = 0;
+    _retryMs = 0;
+    _enabled = url.length() > 0 && parseMqttUrl(url, _broker);
+    if (_enabled) {
+        Serial.printf("MQTT broker %s:%u\n", _broker.host.c_str(), _broker.port);
+    }
+}
+
+bool MqttLink::live() {
+    return _enabled && _backendOnline && _roomId.length() > 0 && _client.connected();
+}
+
+void MqttLink::loop(const String& deviceToken, const String& roomId) {
+    if (!_enabled) {
+        return;
+    }
+
+    if (_client.connected()) {
+        TRACE_SCOPE("mqtt.loop");
+        _client.loop();
+        // Moved to another room, as a fetched status shows
+        if (roomId.length() > 0 && roomId != _roomId) {
+            _client.unsubscribe(_topics.roomStatus.c_str());
+            _topics = mqttTopics(_broker.prefix, mqttDeviceKey(deviceToken), roomId);
+            _client.subscribe(_topics.roomStatus.c_str());
+            _roomId = roomId;
+        }
+        return;
+    }
+
+    if (_wasConnected) {
+        // Polls take over until we are back; jitter so a broker restart
+        // doesn't bring every panel back at once
+        _wasConnected = false;
+        _backendOnline = false;
+        Serial.printf("MQTT disconnected (state %d)\n", _client.state());
+        _lastAttempt = nowMs();
+        _retryMs = random(CONNECTION_RETRY_JITTER_MS);
+    }
+
+    if (roomId.length() == 0 || nowMs() - _lastAttempt < _retryMs) {
+        return;
+    }
+    _lastAttempt = nowMs();
+    if (connect(deviceToken, roomId)) {
+        _failures = 0;
+        _retryMs = 0;
+    } else {
+        if (_failures < UINT8_MAX) _failures++;
+        _retryMs = mqttReconnectDelayMs(_failures) + random(CONNECTION_RETRY_JITTER_MS);
+    }
+}
+
+bool MqttLink::connect(const String& deviceToken, const String& roomId) {
+    TRACE_SCOPE("mqtt.connect");
+    String key = mqttDeviceKey(deviceToken);
+    _topics = mqttTopics(_broker.prefix, key, roomId);
+
+    if (_broker.tls) {
+        _tlsClient.setInsecure();  // Same as the API client: self-signed brokers are common
+        _client.setClient(_tlsClient);
+    } else {
+        _client.setClient(_plainClient);
+    }
+    _client.setServer(_broker.host.c_str(), _broker.port);
+    _client.setBufferSize(MQTT_BUFFER_SIZE);
+    _client.setKeepAlive(MQTT_KEEPALIVE_S);
+    _client.setSocketTimeout(5);
+    _client.setCallback([this](char* topic, uint8_t* payload, unsigned int length) {
+        onMessage(topic, payload, length);
+    });
+
+    String clientId = "panel-" + key;
+    bool login = _broker.username.length() > 0;
+    if (!_client.connect(clientId.c_str(), login ? _broker.username.c_str() : nullptr,
+                         login ? _broker.password.c_str() : nullptr,
+                         _topics.online.c_str(), 0, true, "0")) {
+        Serial.printf("MQTT connect to %s failed (state %d)\n", _broker.host.c_str(), _client.state());
+        return false;
+    }
+
+    _client.publish(_topics.online.c_str(), "1", true);
+    _client.subscribe(_topics.backend.c_str());
+    _client.subscribe(_topics.roomStatus.c_str());
+    _client.subscribe(_topics.command.c_str());
+    _client.subscribe(_topics.fleetCommand.c_str());
+    _roomId = roomId;
+    _wasConnected = true;
+    _backendOnline = false;  // Until its retained message arrives
+    Serial.println("MQTT connected");
+    return true;
+}
+
+// Runs inside _client.loop(): only note what arrived
+void MqttLink::onMessage(char* topic, uint8_t* payload, unsigned int length) {
+    String name(topic);
+    if (name == _topics.backend) {
+        bool online = length == 6 && memcmp(payload, "online", 6) == 0;
+        if (online != _backendOnline) {
+            Serial.println(online ? "MQTT: backend online" : "MQTT: backend offline - polling");
+        }
+        _backendOnline = online;
+    } else if (name == _topics.roomStatus) {
+        if (length == 0) return;  // Retained status cleared (room deleted)
+        _pendingStatus = "";
+        _pendingStatus.reserve(length);
+        for (unsigned int i = 0; i < length; i++) {
+            _pendingStatus += (char)payload[i];
+        }
+        _statusPending = true;
+    } else if (name == _topics.command || name == _topics.fleetCommand) {
+        MqttCommand command = parseMqttCommand((const char*)payload, length);
+        if (command != MQTT_CMD_NONE) {
+            _pendingCommand = command;
+        }
+    }
+}
+
+bool MqttLink::publishHeartbeat(const String& body) {
+    return live() && _client.publish(_topics.heartbeat.c_str(), body.c_str());
+}
+
+bool MqttLink::publishTelemetry(const String& batch) {
+    return live() && _client.publish(_topics.telemetry.c_str(), batch.c_str());
+}
+
+bool MqttLink::takeStatus(String& body) {
+    if (!_statusPending) {
+        return false;
+    }
+    _statusPending = false;
+    body = _pendingStatus;
+    _pendingStatus = "";
+    return true;
+}
+
+MqttCommand MqttLink::takeCommand() {
+    MqttCommand command = _pendingCommand;
+    _pendingCommand = MQTT_CMD_NONE;
+    return command;
+}
+
+void MqttLink::disconnect() {
+    if (_client.connected()) {
+        _client.publish(_topics.online.c_str(), "0", true);
+        _client.disconnect();
+    }
+}
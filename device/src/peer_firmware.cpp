@@ -0,0 +1,72 @@
+#include "peer_firmware.h"
+
+String encodeFirmwareSeed(const FirmwareSeed& seed) {
+    return seed.version + "|" + String(seed.size) + "|" + seed.md5;
+}
+
+static bool isHexDigest(const String& s) {
+    if (s.length() != 32) return false;
+    for (unsigned int i = 0; i < s.length(); i++) {
+        char c = s[i];
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) return false;
+    }
+    return true;
+}
+
+bool parseFirmwareSeed(const String& stored, FirmwareSeed& out) {
+    int first = stored.indexOf('|');
+    int second = first < 0 ? -1 : stored.indexOf('|', first + 1);
+    if (first <= 0 || second < 0) {
+        return false;
+    }
+    FirmwareSeed s;
+    s.version = stored.substring(0, first);
+    long size = stored.substring(first + 1, second).toInt();
+    s.md5 = stored.substring(second + 1);
+    s.md5.toLowerCase();
+    if (size <= 0 || !isHexDigest(s.md5)) {
+        return false;
+    }
+    s.size = (uint32_t)size;
+    out = s;
+    return true;
+}
+
+String peerFirmwarePath(const String& version) {
+    static const char HEX_DIGITS[] = "0123456789ABCDEF";
+    String path = "/firmware?version=";
+    for (unsigned int i = 0; i < version.length(); i++) {
+        char c = version[i];
+        if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+            c == '.' || c == '-' || c == '_') {
+            path += c;
+        } else {
+            path += '%';
+            path += HEX_DIGITS[(uint8_t)c >> 4];
+            path += HEX_DIGITS[(uint8_t)c & 0x0f];
+        }
+    }
+    return path;
+}
+
+size_t pickFirmwarePeers(FirmwarePeer* peers, size_t count, const String& version,
+                         const String& selfKey, uint32_t seed) {
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (peers[i].ip != 0 && peers[i].version == version && peers[i].key != selfKey) {
+            if (kept != i) peers[kept] = peers[i];
+            kept++;
+        }
+    }
+    // Fisher-Yates with a small LCG; it only has to differ between panels
+    for (size_t i = kept; i > 1; i--) {
+        seed = seed * 1664525u + 1013904223u;
+        size_t j = (seed >> 8) % i;
+        if (j != i - 1) {
+            FirmwarePeer t = peers[i - 1];
+            peers[i - 1] = peers[j];
+            peers[j] = t;
+        }
+    }
+    return kept;
+}
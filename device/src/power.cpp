@@ -0,0 +1,213 @@
+#include "power.h"
+#include "config.h"
+
+uint32_t msUntilNextDeadline(uint32_t now, const PowerDeadline* deadlines, size_t count, uint32_t capMs) {
+    uint32_t wait = capMs;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t elapsed = now - deadlines[i].last;
+        // Due on the first millisecond past the interval, as in loop()
+        uint32_t remaining = elapsed > deadlines[i].interval ? 0 : deadlines[i].interval - elapsed + 1;
+        if (remaining < wait) wait = remaining;
+    }
+    return wait;
+}
+
+uint32_t outOfHoursSleepSeconds(time_t now, int openingHour, int closingHour, uint32_t leadSeconds) {
+    if (openingHour < 0 || closingHour > 24 || openingHour >= closingHour) return 0;
+
+    struct tm local;
+    localtime_r(&now, &local);
+    if (local.tm_hour >= openingHour && local.tm_hour < closingHour) return 0;
+
+    // Next opening is today before it, otherwise tomorrow; mktime() rolls the
+    // date over and applies the DST offset in force at that time
+    struct tm opening = local;
+    if (local.tm_hour >= closingHour) opening.tm_mday += 1;
+    opening.tm_hour = openingHour;
+    opening.tm_min = 0;
+    opening.tm_sec = 0;
+    opening.tm_isdst = -1;
+    time_t wake = mktime(&opening) - (time_t)leadSeconds;
+    return wake > now ? (uint32_t)(wake - now) : 0;
+}
+
+#ifdef ESP32
+
+#include <WiFi.h>
+#include <esp_wifi.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#include <driver/ledc.h>
+#include <driver/rtc_io.h>
+#include <hal/gpio_ll.h>
+#include "clock.h"
+
+PowerManager powerManager;
+
+static SemaphoreHandle_t wakeEvent = nullptr;
+static int touchWakePin = -1;
+
+// The touch INT line is a low-level interrupt because light sleep can only be
+// woken by GPIO levels. Mask it here so a held finger doesn't keep firing; the
+// next waitForEvent() unmasks it.
+static void IRAM_ATTR onTouchInterrupt() {
+    gpio_ll_intr_disable(&GPIO, (gpio_num_t)touchWakePin);
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(wakeEvent, &woken);
+    if (woken) portYIELD_FROM_ISR();
+}
+
+PowerManager::PowerManager()
+    : _powerSave(false), _frequencyScaling(false), _lightSleep(false),
+      _touchPin(-1), _busyLock(nullptr) {}
+
+void PowerManager::begin(bool powerSave, int touchIntPin) {
+    _powerSave = powerSave;
+    if (!wakeEvent) wakeEvent = xSemaphoreCreateBinary();
+
+    if (!_powerSave) {
+        Serial.println("Power save off");
+        return;
+    }
+
+    // Frequency scaling, plus light sleep when FreeRTOS tickless idle is built
+    // in; otherwise esp_pm_configure() refuses light_sleep_enable
+    esp_pm_config_esp32_t pm;
+    pm.max_freq_mhz = getCpuFrequencyMhz();
+    pm.min_freq_mhz = POWER_MIN_CPU_MHZ;
+    pm.light_sleep_enable = true;
+    esp_err_t err = esp_pm_configure(&pm);
+    if (err == ESP_ERR_NOT_SUPPORTED) {
+        pm.light_sleep_enable = false;
+        err = esp_pm_configure(&pm);
+    }
+    _frequencyScaling = (err == ESP_OK);
+    _lightSleep = _frequencyScaling && pm.light_sleep_enable;
+
+    // Without the lock the CPU would run loop() at the minimum frequency, and
+    // TFT_eSPI, Wire and Serial assume an 80 MHz APB clock
+    if (_frequencyScaling && esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "loop", &_busyLock) == ESP_OK) {
+        holdCpu();
+    } else {
+        _busyLock = nullptr;
+    }
+
+    if (touchIntPin >= 0) {
+        _touchPin = touchIntPin;
+        touchWakePin = touchIntPin;
+        attachInterrupt(digitalPinToInterrupt(touchIntPin), onTouchInterrupt, ONLOW);
+        if (_lightSleep) {
+            gpio_wakeup_enable((gpio_num_t)touchIntPin, GPIO_INTR_LOW_LEVEL);
+            esp_sleep_enable_gpio_wakeup();
+        }
+    }
+
+    Serial.printf("Power save on: CPU %d-%d MHz, light sleep %s, WiFi listen interval %d\n",
+                  POWER_MIN_CPU_MHZ, pm.max_freq_mhz, _lightSleep ? "on" : "unavailable",
+                  WIFI_LISTEN_INTERVAL);
+}
+
+void PowerManager::configureWifi() {
+    if (!_powerSave) return;
+
+    // Needs the WiFi driver started; WiFiManager keeps station mode
+    if (!(WiFi.getMode() & WIFI_MODE_STA)) WiFi.mode(WIFI_STA);
+
+    wifi_config_t conf;
+    if (esp_wifi_get_config(WIFI_IF_STA, &conf) != ESP_OK) return;
+    if (conf.sta.listen_interval == WIFI_LISTEN_INTERVAL) return;
+    conf.sta.listen_interval = WIFI_LISTEN_INTERVAL;
+    esp_wifi_set_config(WIFI_IF_STA, &conf);
+}
+
+void PowerManager::applyWifiSleep() {
+    // Power save off keeps the Arduino default: wake for every DTIM beacon
+    WiFi.setSleep(_powerSave ? WIFI_PS_MAX_MODEM : WIFI_PS_MIN_MODEM);
+}
+
+bool PowerManager::keepPwmInLightSleep(uint8_t channel, uint32_t freq, uint8_t resolutionBits) {
+    if (!_lightSleep) return true;
+
+    // Only the low-speed group (channels 8-15) can use the RTC clock; the
+    // Arduino core maps channel c to timer (c / 2) % 4
+    if (channel < 8) {
+        Serial.printf("LEDC channel %d stops in light sleep (use 8-15)\n", channel);
+        return false;
+    }
+    ledc_timer_config_t timer = {};
+    timer.speed_mode = LEDC_LOW_SPEED_MODE;
+    timer.duty_resolution = (ledc_timer_bit_t)resolutionBits;
+    timer.timer_num = (ledc_timer_t)((channel / 2) % 4);
+    timer.freq_hz = freq;
+    timer.clk_cfg = LEDC_USE_RTC8M_CLK;
+    if (ledc_timer_config(&timer) != ESP_OK) return false;
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC8M, ESP_PD_OPTION_ON);
+    return true;
+}
+
+void PowerManager::holdCpu() {
+    if (_busyLock) esp_pm_lock_acquire(_busyLock);
+}
+
+void PowerManager::releaseCpu() {
+    if (_busyLock) esp_pm_lock_release(_busyLock);
+}
+
+void PowerManager::waitForEvent(uint32_t timeoutMs) {
+    if (!_powerSave) {
+        clockDelay(timeoutMs);
+        return;
+    }
+
+    // Finger still down: poll the controller like the old loop did so
+    // debounce and repeated touches behave the same
+    if (_touchPin >= 0 && digitalRead(_touchPin) == LOW) {
+        clockDelay(min(timeoutMs, (uint32_t)TOUCH_POLL_MS));
+        return;
+    }
+
+    if (_touchPin >= 0) gpio_intr_enable((gpio_num_t)_touchPin);
+    releaseCpu();
+    xSemaphoreTake(wakeEvent, pdMS_TO_TICKS(timeoutMs));
+    holdCpu();
+}
+
+void PowerManager::idle(uint32_t ms) {
+    releaseCpu();
+    clockDelay(ms);
+    holdCpu();
+}
+
+void PowerManager::notify() {
+    if (wakeEvent) xSemaphoreGive(wakeEvent);
+}
+
+bool PowerManager::touchWakesDeepSleep() const {
+    return _touchPin >= 0 && rtc_gpio_is_valid_gpio((gpio_num_t)_touchPin);
+}
+
+void PowerManager::deepSleep(uint32_t seconds) {
+    esp_sleep_enable_timer_wakeup((uint64_t)seconds * 1000000ULL);
+    if (touchWakesDeepSleep()) {
+        esp_sleep_enable_ext0_wakeup((gpio_num_t)_touchPin, 0);
+    }
+    // Keep pins latched with gpio_hold_en() at their level while asleep
+    gpio_deep_sleep_hold_en();
+    Serial.flush();
+    esp_deep_sleep_start();
+}
+
+bool PowerManager::sleepFor(uint32_t seconds) {
+    esp_sleep_enable_timer_wakeup((uint64_t)seconds * 1000000ULL);
+    if (_touchPin >= 0) {
+        gpio_wakeup_enable((gpio_num_t)_touchPin, GPIO_INTR_LOW_LEVEL);
+        esp_sleep_enable_gpio_wakeup();
+    }
+    Serial.flush();
+    esp_light_sleep_start();
+    bool touched = esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO;
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+    return touched;
+}
+
+#endif // ESP32
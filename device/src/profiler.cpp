@@ -0,0 +1,184 @@
+#include "profiler.h"
+
+// Bounded probing keeps add() short inside the tick interrupt
+static const size_t MAX_PROBES = 32;
+
+bool ProfileHistogram::begin(size_t slots) {
+    end();
+    _slots = (ProfileStack*)calloc(slots, sizeof(ProfileStack));
+    if (!_slots) return false;
+    _slotCount = slots;
+    return true;
+}
+
+void ProfileHistogram::end() {
+    free(_slots);
+    _slots = nullptr;
+    _slotCount = 0;
+    _samples = 0;
+    _dropped = 0;
+}
+
+void ProfileHistogram::clear() {
+    if (_slots) memset(_slots, 0, _slotCount * sizeof(ProfileStack));
+    _samples = 0;
+    _dropped = 0;
+}
+
+static inline bool IRAM_ATTR sameStack(const ProfileStack& slot, const uint32_t* pcs, uint8_t depth) {
+    for (uint8_t i = 0; i < PROFILER_STACK_DEPTH; i++) {
+        if (slot.pcs[i] != (i < depth ? pcs[i] : 0)) return false;
+    }
+    return true;
+}
+
+bool IRAM_ATTR ProfileHistogram::add(const uint32_t* pcs, uint8_t depth) {
+    if (!_slots) return false;
+    if (depth > PROFILER_STACK_DEPTH) depth = PROFILER_STACK_DEPTH;
+
+    // FNV-1a over the addresses
+    uint32_t hash = 2166136261u;
+    for (uint8_t i = 0; i < depth; i++) {
+        hash = (hash ^ pcs[i]) * 16777619u;
+    }
+
+    _samples++;
+    for (size_t probe = 0; probe < MAX_PROBES && probe < _slotCount; probe++) {
+        ProfileStack& slot = _slots[(hash + probe) % _slotCount];
+        if (slot.count == 0) {
+            for (uint8_t i = 0; i < PROFILER_STACK_DEPTH; i++) {
+                slot.pcs[i] = i < depth ? pcs[i] : 0;
+            }
+            slot.count = 1;
+            return true;
+        }
+        if (sameStack(slot, pcs, depth)) {
+            slot.count++;
+            return true;
+        }
+    }
+    _dropped++;
+    return false;
+}
+
+void profileWriteText(const ProfileHistogram* cores, int coreCount, uint32_t sampleHz,
+                      void (*write)(const String& chunk), size_t chunkBytes) {
+    String out;
+    out.reserve(chunkBytes + 96);
+    out = "# open-meeting-profile 1\n# hz " + String((unsigned long)sampleHz) + "\n";
+    for (int core = 0; core < coreCount; core++) {
+        out += "# core " + String(core) + " samples " + String((unsigned long)cores[core].samples()) +
+               " dropped " + String((unsigned long)cores[core].dropped()) + "\n";
+    }
+
+    char addr[12];
+    for (int core = 0; core < coreCount; core++) {
+        const ProfileHistogram& hist = cores[core];
+        for (size_t i = 0; i < hist.slotCount(); i++) {
+            const ProfileStack& stack = hist.slot(i);
+            if (stack.count == 0) continue;
+
+            out += String(core) + " " + String((unsigned long)stack.count);
+            for (int d = 0; d < PROFILER_STACK_DEPTH && stack.pcs[d] != 0; d++) {
+                snprintf(addr, sizeof(addr), " %08lx", (unsigned long)stack.pcs[d]);
+                out += addr;
+            }
+            out += "\n";
+
+            if (out.length() >= chunkBytes) {
+                write(out);
+                out = "";
+            }
+        }
+    }
+    write(out);
+}
+
+#if defined(PROFILER_ENABLED) && defined(ESP32)
+
+#include <esp_debug_helpers.h>
+#include <esp_freertos_hooks.h>
+#include <freertos/xtensa_context.h>
+#include <soc/cpu.h>
+#include <soc/soc_memory_layout.h>
+
+static ProfileHistogram histograms[portNUM_PROCESSORS];
+static bool running = false;
+
+// Runs in the tick interrupt of whichever core it is registered on
+static void IRAM_ATTR sampleTick() {
+    int core = xPortGetCoreID();
+    TaskHandle_t task = xTaskGetCurrentTaskHandleForCPU(core);
+    if (!task) return;
+
+    // On interrupt entry the port saves the interrupted task's registers (with
+    // its register windows spilled) as an XtExcFrame on the task stack and
+    // stores its address in pxTopOfStack, the first member of the TCB
+    const XtExcFrame* frame = *(const XtExcFrame* const*)task;
+
+    uint32_t pcs[PROFILER_STACK_DEPTH];
+    pcs[0] = frame->pc;
+    uint8_t depth = 1;
+
+    // Walk return addresses the same way esp_backtrace_print_from_frame() does
+    esp_backtrace_frame_t bt;
+    bt.pc = frame->pc;
+    bt.sp = frame->a1;
+    bt.next_pc = frame->a0;
+    bt.exc_frame = frame;
+    while (depth < PROFILER_STACK_DEPTH && bt.next_pc != 0 && esp_stack_ptr_is_sane(bt.sp)) {
+        if (!esp_backtrace_get_next_frame(&bt)) break;
+        pcs[depth++] = esp_cpu_process_stack_pc(bt.pc);
+    }
+
+    histograms[core].add(pcs, depth);
+}
+
+bool profilerStart() {
+    if (running) return true;
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        if (!histograms[core].begin(PROFILER_SLOTS)) {
+            Serial.println("Profiler: not enough heap for histograms");
+            for (int c = 0; c < portNUM_PROCESSORS; c++) histograms[c].end();
+            return false;
+        }
+    }
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        if (esp_register_freertos_tick_hook_for_cpu(sampleTick, core) != ESP_OK) {
+            Serial.println("Profiler: no free tick hook slot");
+            for (int c = 0; c < core; c++) esp_deregister_freertos_tick_hook_for_cpu(sampleTick, c);
+            return false;
+        }
+    }
+    running = true;
+    Serial.println("Profiler started");
+    return true;
+}
+
+void profilerStop() {
+    if (!running) return;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        esp_deregister_freertos_tick_hook_for_cpu(sampleTick, core);
+    }
+    running = false;
+    Serial.printf("Profiler stopped after %lu samples\n", (unsigned long)profilerSamples());
+}
+
+bool profilerRunning() {
+    return running;
+}
+
+uint32_t profilerSamples() {
+    uint32_t total = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        total += histograms[core].samples();
+    }
+    return total;
+}
+
+void profilerWriteText(void (*write)(const String& chunk)) {
+    profileWriteText(histograms, portNUM_PROCESSORS, configTICK_RATE_HZ, write);
+}
+
+#endif // PROFILER_ENABLED && ESP32
@@ -0,0 +1,122 @@
+#include "resume_state.h"
+
+// Bump when the layout changes so old RTC contents are ignored
+static const uint32_t RESUME_MAGIC = 0x4f4d5201;  // "OMR" v1
+
+// Copy at most size - 1 bytes, backing off so a multi-byte UTF-8 character
+// is never cut in half
+static void copyText(char* out, size_t size, const String& text) {
+    size_t len = text.length();
+    if (len >= size) {
+        len = size - 1;
+        while (len > 0 && ((uint8_t)text[len] & 0xC0) == 0x80) len--;
+    }
+    memcpy(out, text.c_str(), len);
+    out[len] = '\0';
+}
+
+static void packBooking(const Booking& in, BookingSnapshot& out) {
+    memset(&out, 0, sizeof(out));
+    out.isValid = in.isValid;
+    if (!in.isValid) return;
+    copyText(out.id, sizeof(out.id), in.id);
+    copyText(out.title, sizeof(out.title), in.title);
+    copyText(out.startTime, sizeof(out.startTime), in.startTime);
+    copyText(out.endTime, sizeof(out.endTime), in.endTime);
+    out.isDeviceBooking = in.isDeviceBooking;
+}
+
+static Booking unpackBooking(const BookingSnapshot& in) {
+    Booking booking;
+    booking.isValid = in.isValid;
+    booking.isDeviceBooking = in.isDeviceBooking;
+    if (in.isValid) {
+        booking.id = in.id;
+        booking.title = in.title;
+        booking.startTime = in.startTime;
+        booking.endTime = in.endTime;
+    }
+    return booking;
+}
+
+// FNV-1a
+static uint32_t checksumOf(const ResumeState& state) {
+    const uint8_t* bytes = (const uint8_t*)&state.wifiChannel;
+    size_t length = sizeof(ResumeState) - offsetof(ResumeState, wifiChannel);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+void saveResumeState(ResumeState& state, const RoomStatus* status, int32_t wifiChannel, const uint8_t* bssid) {
+    // Zero first so padding bytes are covered by the checksum deterministically
+    memset(&state, 0, sizeof(state));
+    state.wifiChannel = wifiChannel;
+    if (bssid) memcpy(state.bssid, bssid, sizeof(state.bssid));
+
+    if (status && status->isValid) {
+        RoomStatusSnapshot& s = state.status;
+        copyText(s.roomId, sizeof(s.roomId), status->room.id);
+        copyText(s.roomName, sizeof(s.roomName), status->room.name);
+        copyText(s.floor, sizeof(s.floor), status->room.floor);
+        s.capacity = status->room.capacity;
+        s.quickBookDurationCount = status->room.quickBookDurationCount;
+        for (int i = 0; i < 4; i++) s.quickBookDurations[i] = status->room.quickBookDurations[i];
+        s.isAvailable = status->isAvailable;
+        packBooking(status->currentBooking, s.currentBooking);
+        s.upcomingCount = status->upcomingCount;
+        for (int i = 0; i < 3; i++) {
+            if (i < status->upcomingCount) {
+                packBooking(status->upcomingBookings[i], s.upcomingBookings[i]);
+            }
+        }
+        s.openingHour = status->openingHour;
+        s.closingHour = status->closingHour;
+        state.hasStatus = true;
+    }
+
+    state.magic = RESUME_MAGIC;
+    state.checksum = checksumOf(state);
+}
+
+bool resumeStateValid(const ResumeState& state) {
+    return state.magic == RESUME_MAGIC && state.checksum == checksumOf(state);
+}
+
+void clearResumeState(ResumeState& state) {
+    memset(&state, 0, sizeof(state));
+}
+
+RoomStatus restoreRoomStatus(const ResumeState& state) {
+    RoomStatus status;
+    status.isValid = false;
+    status.upcomingCount = 0;
+    status.openingHour = -1;
+    status.closingHour = -1;
+    status.hasConfig = false;
+    status.fetchedAt = 0;
+    status.room.isValid = false;
+    status.currentBooking.isValid = false;
+    if (!resumeStateValid(state) || !state.hasStatus) return status;
+
+    const RoomStatusSnapshot& s = state.status;
+    status.room.id = s.roomId;
+    status.room.name = s.roomName;
+    status.room.floor = s.floor;
+    status.room.capacity = s.capacity;
+    status.room.quickBookDurationCount = s.quickBookDurationCount;
+    for (int i = 0; i < 4; i++) status.room.quickBookDurations[i] = s.quickBookDurations[i];
+    status.room.isValid = true;
+    status.isAvailable = s.isAvailable;
+    status.currentBooking = unpackBooking(s.currentBooking);
+    status.upcomingCount = s.upcomingCount;
+    for (int i = 0; i < s.upcomingCount && i < 3; i++) {
+        status.upcomingBookings[i] = unpackBooking(s.upcomingBookings[i]);
+    }
+    status.openingHour = s.openingHour;
+    status.closingHour = s.closingHour;
+    status.isValid = true;
+    return status;
+}
@@ -0,0 +1,451 @@
+#include "room_group.h"
+#include <ArduinoJson.h>
+#include <ESPmDNS.h>
+#include <HTTPClient.h>
+#include <WiFiClient.h>
+#include <mdns.h>
+#include "mqtt_link.h"
+#include "sha256.h"
+#include "time_utils.h"
+#include "trace.h"
+
+static bool mdnsRunning = false;
+
+static String timeText(time_t t) {
+    return String((unsigned long)t);
+}
+
+// What <mac> covers: every other field, in a fixed order
+static String beaconMessage(const RoomBeacon& b) {
+    return String("v2|") + b.roomId + "|" + b.key + "|" + b.fingerprint + "|" + String(b.configVersion) + "|" +
+           (b.upstreamOk ? "1" : "0") + "|" + (b.refresh ? "1" : "0") + "|" + timeText(b.sentAt);
+}
+
+// Compares MACs without stopping at the first difference
+static bool sameDigest(const String& a, const String& b) {
+    if (a.length() == 0 || a.length() != b.length()) {
+        return false;
+    }
+    uint8_t diff = 0;
+    for (unsigned int i = 0; i < a.length(); i++) {
+        diff |= (uint8_t)(a[i] ^ b[i]);
+    }
+    return diff == 0;
+}
+
+// Our clock is set and `sentAt` is within ROOM_GROUP_MAX_SKEW_S of it
+static bool freshTime(time_t sentAt, time_t now) {
+    if (!isWallTimeSynced(now)) {
+        return false;
+    }
+    time_t skew = sentAt > now ? sentAt - now : now - sentAt;
+    return skew <= ROOM_GROUP_MAX_SKEW_S;
+}
+
+String encodeRoomBeacon(const RoomBeacon& beacon, const String& secret) {
+    JsonDocument doc;
+    doc["v"] = 2;
+    doc["r"] = beacon.roomId;
+    doc["k"] = beacon.key;
+    doc["s"] = beacon.fingerprint;
+    doc["c"] = beacon.configVersion;
+    doc["o"] = beacon.upstreamOk ? 1 : 0;
+    doc["p"] = beacon.refresh ? 1 : 0;
+    doc["t"] = (unsigned long)beacon.sentAt;
+    doc["m"] = hmacSha256Hex(secret, beaconMessage(beacon));
+    String out;
+    serializeJson(doc, out);
+    return out;
+}
+
+bool parseRoomBeacon(const char* data, size_t length, const String& secret, time_t now, RoomBeacon& out) {
+    JsonDocument doc;
+    if (deserializeJson(doc, data, length) || (doc["v"] | 0) != 2) {
+        return false;
+    }
+    RoomBeacon b;
+    b.roomId = doc["r"] | "";
+    b.key = doc["k"] | "";
+    b.fingerprint = doc["s"] | "";
+    b.configVersion = doc["c"] | 0;
+    b.upstreamOk = (doc["o"] | 0) != 0;
+    b.refresh = (doc["p"] | 0) != 0;
+    b.sentAt = (time_t)(doc["t"] | 0UL);
+    String mac = doc["m"] | "";
+    if (b.roomId.length() == 0 || b.key.length() == 0 || !freshTime(b.sentAt, now) ||
+        !sameDigest(mac, hmacSha256Hex(secret, beaconMessage(b)))) {
+        return false;
+    }
+    out = b;
+    return true;
+}
+
+String roomStatusFingerprint(const String& body) {
+    return sha256Hex(body).substring(0, 16);
+}
+
+String roomRelayRequestMac(const String& secret, const String& roomId, time_t t) {
+    return hmacSha256Hex(secret, "relay|" + roomId + "|" + timeText(t));
+}
+
+String roomRelaySignature(const String& secret, const String& roomId, time_t t, const String& body) {
+    return hmacSha256Hex(secret, "status|" + roomId + "|" + timeText(t) + "|" + body);
+}
+
+void RoomGroup::setRoom(const String& roomId) {
+    if (roomId != _roomId) {
+        _roomId = roomId;
+        _count = 0;
+    }
+}
+
+bool RoomGroup::live(const RoomPeer& peer, uint32_t now) const {
+    return now - peer.lastSeen <= ROOM_GROUP_PEER_TIMEOUT_MS;
+}
+
+RoomBeaconResult RoomGroup::onBeacon(const RoomBeacon& beacon, uint32_t ip, uint32_t now) {
+    if (_roomId.length() == 0 || beacon.roomId != _roomId || beacon.key == _selfKey) {
+        return ROOM_BEACON_IGNORED;
+    }
+    for (size_t i = 0; i < _count; i++) {
+        if (_peers[i].beacon.key == beacon.key) {
+            // Same panel, maybe at a new address after a DHCP renewal, but
+            // not a copy of an earlier beacon sent from somewhere else
+            time_t last = _peers[i].beacon.sentAt;
+            if (beacon.sentAt < last || (ip != _peers[i].ip && beacon.sentAt == last)) {
+                return ROOM_BEACON_IGNORED;
+            }
+            _peers[i].ip = ip;
+            _peers[i].lastSeen = now;
+            _peers[i].beacon = beacon;
+            return ROOM_BEACON_KNOWN;
+        }
+    }
+    if (_count >= ROOM_GROUP_MAX_PEERS) {
+        return ROOM_BEACON_IGNORED;
+    }
+    _peers[_count].ip = ip;
+    _peers[_count].lastSeen = now;
+    _peers[_count].beacon = beacon;
+    _count++;
+    return ROOM_BEACON_NEW;
+}
+
+void RoomGroup::expire(uint32_t now) {
+    size_t kept = 0;
+    for (size_t i = 0; i < _count; i++) {
+        if (live(_peers[i], now)) {
+            if (kept != i) _peers[kept] = _peers[i];
+            kept++;
+        }
+    }
+    _count = kept;
+}
+
+const RoomPeer* RoomGroup::leader(uint32_t now, bool selfOk) const {
+    const RoomPeer* best = nullptr;
+    for (size_t i = 0; i < _count; i++) {
+        const RoomPeer& p = _peers[i];
+        if (!live(p, now) || !p.beacon.upstreamOk) continue;
+        if (!best || p.beacon.key < best->beacon.key) best = &p;
+    }
+    if (best && selfOk && _selfKey < best->beacon.key) {
+        return nullptr;
+    }
+    return best;
+}
+
+bool RoomGroup::hasPeer(uint32_t ip, uint32_t now) const {
+    for (size_t i = 0; i < _count; i++) {
+        if (_peers[i].ip == ip && live(_peers[i], now)) return true;
+    }
+    return false;
+}
+
+RoomGroupLink::RoomGroupLink(ApiClient& api)
+    : _api(api),
+      _running(false),
+      _selfOk(false),
+      _configVersion(0),
+      _relayPort(80),
+      _lastStart(0),
+      _startRetryMs(0),
+      _lastBeacon(0),
+      _lastDiscovery(0),
+      _lastDirectPoll(0),
+      _lastRelayAttempt(0),
+      _refreshWanted(false),
+      _vouchedAt(0) {}
+
+RoomGroupEvent RoomGroupLink::loop(bool enabled, const String& roomId, bool selfOk, uint32_t configVersion) {
+    if (!enabled) {
+        stop();
+        return ROOM_GROUP_IDLE;
+    }
+    _selfOk = selfOk;
+    _configVersion = configVersion;
+    // The key is the room's, so another room starts over
+    if (roomId.length() > 0 && roomId != _group.roomId()) {
+        stop();
+        _group.setRoom(roomId);
+        _fingerprint = "";
+        _startRetryMs = 0;
+    }
+    if (_group.roomId().length() == 0) {
+        return ROOM_GROUP_IDLE;
+    }
+    if (!_running && (nowMs() - _lastStart < _startRetryMs || !start(_group.roomId()))) {
+        return ROOM_GROUP_IDLE;
+    }
+
+    TRACE_SCOPE("roomGroup");
+    receiveBeacons();
+    uint32_t now = nowMs();
+    _group.expire(now);
+
+    if (now - _lastDiscovery > ROOM_GROUP_DISCOVER_MS) {
+        discoverPeers();
+    }
+    if (nowMs() - _lastBeacon > ROOM_GROUP_BEACON_MS) {
+        broadcastBeacon();
+    }
+
+    const RoomPeer* leader = _group.leader(nowMs(), _selfOk);
+    if (leader) {
+        _refreshWanted = false;
+        return follow(*leader);
+    }
+    if (_refreshWanted) {
+        // Leading, and a follower just booked or ended a meeting
+        _refreshWanted = false;
+        return ROOM_GROUP_POLL;
+    }
+    return ROOM_GROUP_IDLE;
+}
+
+bool RoomGroupLink::start(const String& roomId) {
+    _lastStart = nowMs();
+    _startRetryMs = ROOM_GROUP_BEACON_MS;
+    if (!isWallTimeSynced(wallNow())) {
+        return false;  // Beacons carry the time; wait for NTP
+    }
+    String room;
+    String secret;
+    if (!_api.fetchRoomGroupSecret(room, secret) || room != roomId) {
+        Serial.println("Room group: no key for this room from the server");
+        _startRetryMs = ROOM_GROUP_KEY_RETRY_MS;
+        return false;
+    }
+    String key = mqttDeviceKey(_api.getDeviceToken());
+    _group.setSelfKey(key);
+    if (!_udp.begin(ROOM_GROUP_PORT)) {
+        Serial.println("Room group: UDP port unavailable");
+        return false;
+    }
+    if (!startPanelMdns(key)) {
+        Serial.println("Room group: mDNS failed to start");
+        _udp.stop();
+        return false;
+    }
+    MDNS.addService("openmeeting", "udp", ROOM_GROUP_PORT);
+    MDNS.addServiceTxt("openmeeting", "udp", "room", roomId);
+    MDNS.addServiceTxt("openmeeting", "udp", "key", key);
+
+    _secret = secret;
+    _running = true;
+    _lastDiscovery = nowMs() - ROOM_GROUP_DISCOVER_MS;
+    _lastBeacon = nowMs() - ROOM_GROUP_BEACON_MS;
+    Serial.println("Room group started as " + key);
+    return true;
+}
+
+void RoomGroupLink::stop() {
+    if (!_running) {
+        return;
+    }
+    mdns_service_remove("_openmeeting", "_udp");
+    _udp.stop();
+    _group.setRoom("");
+    _secret = "";
+    _running = false;
+    _refreshWanted = false;
+    Serial.println("Room group stopped");
+}
+
+void RoomGroupLink::receiveBeacons() {
+    time_t wall = wallNow();
+    char packet[512];
+    while (_udp.parsePacket() > 0) {
+        int length = _udp.read(packet, sizeof(packet));
+        RoomBeacon beacon;
+        if (length <= 0 || !parseRoomBeacon(packet, length, _secret, wall, beacon)) {
+            continue;
+        }
+        IPAddress from = _udp.remoteIP();
+        RoomBeaconResult result = _group.onBeacon(beacon, (uint32_t)from, nowMs());
+        if (result == ROOM_BEACON_NEW) {
+            Serial.println("Room group: panel " + beacon.key + " at " + from.toString());
+            sendBeacon(from, false);
+        }
+        if (result != ROOM_BEACON_IGNORED && beacon.refresh) {
+            _refreshWanted = true;
+        }
+    }
+}
+
+// Ask mDNS for the room's other panels and introduce ourselves; they answer
+// with a beacon. Blocks for the length of the query.
+void RoomGroupLink::discoverPeers() {
+    TRACE_SCOPE("roomGroup.discover");
+    int found = MDNS.queryService("openmeeting", "udp");
+    for (int i = 0; i < found; i++) {
+        if (MDNS.txt(i, "room") == _group.roomId() && MDNS.txt(i, "key") != _group.selfKey()) {
+            sendBeacon(MDNS.IP(i), false);
+        }
+    }
+    _lastDiscovery = nowMs();
+}
+
+void RoomGroupLink::sendBeacon(const IPAddress& to, bool refresh) {
+    RoomBeacon beacon;
+    beacon.roomId = _group.roomId();
+    beacon.key = _group.selfKey();
+    beacon.fingerprint = _fingerprint;
+    beacon.configVersion = _configVersion;
+    beacon.upstreamOk = _selfOk;
+    beacon.refresh = refresh;
+    beacon.sentAt = wallNow();
+    String packet = encodeRoomBeacon(beacon, _secret);
+    _udp.beginPacket(to, ROOM_GROUP_PORT);
+    _udp.write((const uint8_t*)packet.c_str(), packet.length());
+    _udp.endPacket();
+}
+
+void RoomGroupLink::broadcastBeacon() {
+    for (size_t i = 0; i < _group.count(); i++) {
+        sendBeacon(IPAddress(_group.peer(i).ip), false);
+    }
+    _lastBeacon = nowMs();
+}
+
+// Show what the leader shows. A beacon with our fingerprint counts as a poll;
+// a different one fetches the leader's body. Relay failures leave the status
+// to age until pollIntervalMs() has the caller poll the server.
+RoomGroupEvent RoomGroupLink::follow(const RoomPeer& leader) {
+    uint32_t now = nowMs();
+    if (now - _lastDirectPoll < ROOM_GROUP_PEER_TIMEOUT_MS) {
+        return ROOM_GROUP_IDLE;  // Ours is newer until the leader has polled too
+    }
+    if (leader.beacon.configVersion > _configVersion) {
+        // The config block only comes with our own status request
+        Serial.println("Room group: leader runs a newer config, polling");
+        return ROOM_GROUP_POLL;
+    }
+    if (leader.beacon.fingerprint.length() == 0) {
+        return ROOM_GROUP_IDLE;
+    }
+    if (leader.beacon.fingerprint == _fingerprint) {
+        if (leader.lastSeen == _vouchedAt) {
+            return ROOM_GROUP_IDLE;
+        }
+        _vouchedAt = leader.lastSeen;
+        return ROOM_GROUP_VOUCHED;
+    }
+    if (now - _lastRelayAttempt < ROOM_GROUP_BEACON_MS) {
+        return ROOM_GROUP_IDLE;
+    }
+    _lastRelayAttempt = now;
+
+    TRACE_SCOPE("roomGroup.relay");
+    const String& roomId = _group.roomId();
+    time_t t = wallNow();
+    String url = "http://" + IPAddress(leader.ip).toString() + ":" + String(_relayPort) + "/room/status?t=" +
+                 timeText(t) + "&m=" + roomRelayRequestMac(_secret, roomId, t);
+    const char* headers[] = {ROOM_GROUP_SIGNATURE_HEADER};
+    WiFiClient client;
+    HTTPClient http;
+    http.begin(client, url);
+    http.setConnectTimeout(ROOM_GROUP_RELAY_TIMEOUT_MS);
+    http.setTimeout(ROOM_GROUP_RELAY_TIMEOUT_MS);
+    http.collectHeaders(headers, 1);
+    int code = http.GET();
+    String body = code == HTTP_CODE_OK ? http.getString() : String("");
+    String signature = http.header(ROOM_GROUP_SIGNATURE_HEADER);
+    http.end();
+    if (body.length() == 0) {
+        Serial.printf("Room group: no status from the leader (%d)\n", code);
+        return ROOM_GROUP_IDLE;
+    }
+    if (!sameDigest(signature, roomRelaySignature(_secret, roomId, t, body))) {
+        Serial.println("Room group: status from the leader is not signed for this room");
+        return ROOM_GROUP_IDLE;
+    }
+
+    RoomStatus relayed = _api.pushRoomStatus(body);
+    if (!relayed.isValid) {
+        Serial.println("Room group: unusable status from the leader");
+        return ROOM_GROUP_IDLE;
+    }
+    _fingerprint = roomStatusFingerprint(body);
+    _relayed = relayed;
+    return ROOM_GROUP_RELAYED;
+}
+
+void RoomGroupLink::polled(bool selfOk) {
+    if (!_running) {
+        return;
+    }
+    _selfOk = selfOk;
+    _lastDirectPoll = nowMs();
+    String body = _api.statusBody();
+    String fingerprint = body.length() > 0 ? roomStatusFingerprint(body) : String("");
+    if (fingerprint == _fingerprint) {
+        return;
+    }
+    _fingerprint = fingerprint;
+    if (!_group.leader(nowMs(), _selfOk)) {
+        broadcastBeacon();
+    }
+}
+
+void RoomGroupLink::refreshLeader() {
+    if (!_running) {
+        return;
+    }
+    const RoomPeer* leader = _group.leader(nowMs(), _selfOk);
+    if (leader) {
+        sendBeacon(IPAddress(leader->ip), true);
+    }
+}
+
+// Only for a panel of the room: it knows the key, asked within
+// ROOM_GROUP_MAX_SKEW_S, and beacons from where it asks
+int RoomGroupLink::answerRelay(uint32_t ip, const String& t, const String& mac, String& body, String& signature) {
+    time_t sentAt = (time_t)t.toInt();
+    if (!_running || !freshTime(sentAt, wallNow()) ||
+        !sameDigest(mac, roomRelayRequestMac(_secret, _group.roomId(), sentAt)) || !_group.hasPeer(ip, nowMs())) {
+        body = "Not a panel of this room";
+        return 403;
+    }
+    body = _api.statusBody();
+    if (body.length() == 0) {
+        body = "No status yet";
+        return 503;
+    }
+    signature = roomRelaySignature(_secret, _group.roomId(), sentAt, body);
+    return 200;
+}
+
+uint32_t RoomGroupLink::pollIntervalMs(uint32_t ms) const {
+    if (_running && _group.leader(nowMs(), _selfOk)) {
+        ms += ROOM_GROUP_PEER_TIMEOUT_MS;
+    }
+    return ms;
+}
+
+bool startPanelMdns(const String& key) {
+    if (!mdnsRunning) {
+        mdnsRunning = MDNS.begin((String("openmeeting-") + key.substring(0, 8)).c_str());
+    }
+    return mdnsRunning;
+}
@@ -0,0 +1,146 @@
+#include "runtime_config.h"
+#include "config.h"
+#include "mqtt_link.h"
+
+RuntimeConfig defaultRuntimeConfig() {
+    RuntimeConfig c;
+    c.version = 0;
+    c.statusPollMs = STATUS_POLL_INTERVAL;
+    c.pingMs = PING_INTERVAL;
+    c.firmwareCheckMs = FIRMWARE_CHECK_INTERVAL;
+    c.screenTimeoutMs = SCREEN_TIMEOUT_MS;
+    c.ledLevel = 255 - LED_BRIGHTNESS;
+    c.quickBookConfirm = QUICK_BOOK_CONFIRM;
+    c.bookingResultMs = BOOKING_RESULT_MS;
+    c.apiUrls = "";
+    c.mqttUrl = "";
+    c.roomGroup = ROOM_GROUP_ENABLED;
+    c.peerFirmware = PEER_FIRMWARE_ENABLED;
+    return c;
+}
+
+// Read an optional whole number in [min, max]; absent keeps *value
+static bool readRange(JsonObjectConst block, const char* key, uint32_t min, uint32_t max,
+                      uint32_t* value, String* error) {
+    JsonVariantConst v = block[key];
+    if (v.isNull()) return true;
+    if (!v.is<uint32_t>() || v.as<uint32_t>() < min || v.as<uint32_t>() > max) {
+        if (error) *error = String(key) + " must be " + String(min) + "-" + String(max);
+        return false;
+    }
+    *value = v.as<uint32_t>();
+    return true;
+}
+
+bool parseRuntimeConfig(JsonObjectConst block, RuntimeConfig& out, String* error) {
+    RuntimeConfig c = defaultRuntimeConfig();
+    uint32_t version = 0;
+    if (block.isNull() || block["version"].isNull()) {
+        if (error) *error = "version missing";
+        return false;
+    }
+    if (!readRange(block, "version", 1, UINT32_MAX, &version, error)) return false;
+    c.version = version;
+
+    // Seconds on the wire, with floors that keep a typo from flooding the server
+    uint32_t statusPoll = c.statusPollMs / 1000;
+    uint32_t ping = c.pingMs / 1000;
+    uint32_t firmwareCheck = c.firmwareCheckMs / 1000;
+    uint32_t screenTimeout = c.screenTimeoutMs / 1000;
+    uint32_t bookingResult = c.bookingResultMs / 1000;
+    uint32_t ledPercent = UINT32_MAX;
+    if (!readRange(block, "statusPollSeconds", 10, 3600, &statusPoll, error) ||
+        !readRange(block, "pingSeconds", 30, 3600, &ping, error) ||
+        !readRange(block, "firmwareCheckSeconds", 60, 86400, &firmwareCheck, error) ||
+        !readRange(block, "screenTimeoutSeconds", 10, 3600, &screenTimeout, error) ||
+        !readRange(block, "bookingResultSeconds", 1, 30, &bookingResult, error) ||
+        !readRange(block, "ledBrightness", 0, 100, &ledPercent, error)) {
+        return false;
+    }
+
+    JsonVariantConst confirm = block["quickBookConfirm"];
+    if (!confirm.isNull()) {
+        if (!confirm.is<bool>()) {
+            if (error) *error = "quickBookConfirm must be true or false";
+            return false;
+        }
+        c.quickBookConfirm = confirm.as<bool>();
+    }
+
+    JsonVariantConst group = block["roomGroup"];
+    if (!group.isNull()) {
+        if (!group.is<bool>()) {
+            if (error) *error = "roomGroup must be true or false";
+            return false;
+        }
+        c.roomGroup = group.as<bool>();
+    }
+
+    JsonVariantConst peerFirmware = block["peerFirmware"];
+    if (!peerFirmware.isNull()) {
+        if (!peerFirmware.is<bool>()) {
+            if (error) *error = "peerFirmware must be true or false";
+            return false;
+        }
+        c.peerFirmware = peerFirmware.as<bool>();
+    }
+
+    JsonVariantConst urls = block["apiUrls"];
+    if (!urls.isNull()) {
+        if (!urls.is<JsonArrayConst>() || urls.size() > API_MAX_ENDPOINTS) {
+            if (error) *error = "apiUrls must be a list of up to " + String(API_MAX_ENDPOINTS) + " URLs";
+            return false;
+        }
+        String list;
+        JsonArrayConst array = urls.as<JsonArrayConst>();
+        for (size_t i = 0; i < array.size(); i++) {
+            JsonVariantConst u = array[i];
+            String url = u.is<const char*>() ? u.as<String>() : String("");
+            if (!(url.startsWith("http://") || url.startsWith("https://")) || url.indexOf(',') >= 0) {
+                if (error) *error = "apiUrls must hold http:// or https:// URLs";
+                return false;
+            }
+            if (list.length() > 0) list += ",";
+            list += url;
+        }
+        c.apiUrls = list;
+    }
+
+    JsonVariantConst mqtt = block["mqttUrl"];
+    if (!mqtt.isNull()) {
+        MqttBroker broker;
+        String url = mqtt.is<const char*>() ? mqtt.as<String>() : String("");
+        if (url.length() > 200 || !parseMqttUrl(url, broker)) {
+            if (error) *error = "mqttUrl must be an mqtt:// or mqtts:// URL";
+            return false;
+        }
+        c.mqttUrl = url;
+    }
+
+    c.statusPollMs = statusPoll * 1000;
+    c.pingMs = ping * 1000;
+    c.firmwareCheckMs = firmwareCheck * 1000;
+    c.screenTimeoutMs = screenTimeout * 1000;
+    c.bookingResultMs = bookingResult * 1000;
+    if (ledPercent != UINT32_MAX) c.ledLevel = (ledPercent * 255 + 50) / 100;
+
+    out = c;
+    return true;
+}
+
+uint32_t runtimeConfigChanges(const RuntimeConfig& a, const RuntimeConfig& b) {
+    uint32_t changes = 0;
+    if (a.version != b.version) changes |= RC_VERSION;
+    if (a.statusPollMs != b.statusPollMs) changes |= RC_STATUS_POLL;
+    if (a.pingMs != b.pingMs) changes |= RC_PING;
+    if (a.firmwareCheckMs != b.firmwareCheckMs) changes |= RC_FIRMWARE_CHECK;
+    if (a.screenTimeoutMs != b.screenTimeoutMs) changes |= RC_SCREEN_TIMEOUT;
+    if (a.ledLevel != b.ledLevel) changes |= RC_LED_LEVEL;
+    if (a.quickBookConfirm != b.quickBookConfirm) changes |= RC_QUICK_BOOK_CONFIRM;
+    if (a.bookingResultMs != b.bookingResultMs) changes |= RC_BOOKING_RESULT;
+    if (a.apiUrls != b.apiUrls) changes |= RC_API_URLS;
+    if (a.mqttUrl != b.mqttUrl) changes |= RC_MQTT_URL;
+    if (a.roomGroup != b.roomGroup) changes |= RC_ROOM_GROUP;
+    if (a.peerFirmware != b.peerFirmware) changes |= RC_PEER_FIRMWARE;
+    return changes;
+}
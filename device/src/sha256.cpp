@@ -0,0 +1,141 @@
+#include "sha256.h"
+
+// FIPS 180-4, and the HMAC the room group signs its messages with
+
+static const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static inline uint32_t rotr(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+static void compress(uint32_t h[8], const uint8_t block[64]) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16 |
+               (uint32_t)block[i * 4 + 2] << 8 | block[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t t1 = hh + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+        uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        hh = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d;
+    h[4] += e; h[5] += f; h[6] += g; h[7] += hh;
+}
+
+// Incremental, so HMAC can hash the padded key and the message without
+// copying them into one buffer
+struct Sha256 {
+    uint32_t h[8];
+    uint8_t block[64];
+    size_t used;         // Bytes waiting in block
+    uint64_t length;     // Bytes hashed so far
+};
+
+static void sha256Begin(Sha256& ctx) {
+    static const uint32_t H0[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                   0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    memcpy(ctx.h, H0, sizeof(H0));
+    ctx.used = 0;
+    ctx.length = 0;
+}
+
+static void sha256Add(Sha256& ctx, const uint8_t* in, size_t len) {
+    ctx.length += len;
+    if (ctx.used > 0) {
+        size_t n = min(len, (size_t)64 - ctx.used);
+        memcpy(ctx.block + ctx.used, in, n);
+        ctx.used += n;
+        in += n;
+        len -= n;
+        if (ctx.used < 64) return;
+        compress(ctx.h, ctx.block);
+        ctx.used = 0;
+    }
+    for (; len >= 64; in += 64, len -= 64) {
+        compress(ctx.h, in);
+    }
+    memcpy(ctx.block, in, len);
+    ctx.used = len;
+}
+
+// Last block(s): the rest, 0x80, zeros, then the length in bits
+static void sha256End(Sha256& ctx, uint8_t digest[32]) {
+    uint8_t tail[128] = {};
+    memcpy(tail, ctx.block, ctx.used);
+    tail[ctx.used] = 0x80;
+    size_t tailLen = ctx.used < 56 ? 64 : 128;
+    uint64_t bits = ctx.length * 8;
+    for (int i = 0; i < 8; i++) {
+        tail[tailLen - 1 - i] = (uint8_t)(bits >> (i * 8));
+    }
+    compress(ctx.h, tail);
+    if (tailLen == 128) compress(ctx.h, tail + 64);
+    for (int i = 0; i < 32; i++) {
+        digest[i] = (uint8_t)(ctx.h[i / 4] >> (24 - (i % 4) * 8));
+    }
+}
+
+static String toHex(const uint8_t digest[32]) {
+    char hex[65];
+    for (int i = 0; i < 32; i++) {
+        snprintf(hex + i * 2, 3, "%02x", digest[i]);
+    }
+    return String(hex);
+}
+
+String sha256Hex(const String& data) {
+    Sha256 ctx;
+    uint8_t digest[32];
+    sha256Begin(ctx);
+    sha256Add(ctx, (const uint8_t*)data.c_str(), data.length());
+    sha256End(ctx, digest);
+    return toHex(digest);
+}
+
+// RFC 2104: H((K ^ opad) || H((K ^ ipad) || message)), K hashed first if
+// longer than a block
+String hmacSha256Hex(const String& key, const String& message) {
+    uint8_t k[64] = {};
+    Sha256 ctx;
+    if (key.length() > 64) {
+        sha256Begin(ctx);
+        sha256Add(ctx, (const uint8_t*)key.c_str(), key.length());
+        sha256End(ctx, k);
+    } else {
+        memcpy(k, key.c_str(), key.length());
+    }
+
+    uint8_t pad[64];
+    uint8_t inner[32];
+    for (int i = 0; i < 64; i++) pad[i] = k[i] ^ 0x36;
+    sha256Begin(ctx);
+    sha256Add(ctx, pad, 64);
+    sha256Add(ctx, (const uint8_t*)message.c_str(), message.length());
+    sha256End(ctx, inner);
+
+    uint8_t digest[32];
+    for (int i = 0; i < 64; i++) pad[i] = k[i] ^ 0x5c;
+    sha256Begin(ctx);
+    sha256Add(ctx, pad, 64);
+    sha256Add(ctx, inner, 32);
+    sha256End(ctx, digest);
+    return toHex(digest);
+}
@@ -0,0 +1,245 @@
+#include "status_led.h"
+#include "config.h"
+
+// Steps are written for full brightness and scaled by the configured LED
+// level when played
+static const uint8_t ON = 255;
+
+static const LedStep OFF_STEPS[] = {
+    {0, 0, 0, 0, 0},
+};
+static const LedStep AVAILABLE_STEPS[] = {
+    {0, ON, 0, 300, 0},
+};
+static const LedStep OCCUPIED_STEPS[] = {
+    {ON, 0, 0, 300, 0},
+};
+static const LedStep ENDING_SOON_STEPS[] = {
+    {ON, ON / 3, 0, 700, 100},
+    {ON / 8, ON / 24, 0, 700, 100},
+};
+static const LedStep OFFLINE_STEPS[] = {
+    {ON / 2, ON / 2, ON / 2, 2000, 200},
+    {0, 0, 0, 2000, 800},
+};
+static const LedStep BOOKED_STEPS[] = {
+    {0, ON, 0, 60, 120},
+    {0, 0, 0, 60, 120},
+    {0, ON, 0, 60, 120},
+    {0, 0, 0, 60, 300},
+};
+static const LedStep UPDATING_STEPS[] = {
+    {0, 0, ON, 0, 0},
+};
+
+#define STEPS(s) s, (uint8_t)(sizeof(s) / sizeof(s[0]))
+
+static const LedPatternSteps PATTERNS[LED_PATTERN_COUNT] = {
+    {STEPS(OFF_STEPS), false},
+    {STEPS(AVAILABLE_STEPS), false},
+    {STEPS(OCCUPIED_STEPS), false},
+    {STEPS(ENDING_SOON_STEPS), true},
+    {STEPS(OFFLINE_STEPS), true},
+    {STEPS(BOOKED_STEPS), false},
+    {STEPS(UPDATING_STEPS), false},
+};
+
+const LedPatternSteps& ledPatternSteps(LedPattern pattern) {
+    if ((unsigned)pattern >= LED_PATTERN_COUNT) pattern = LED_PATTERN_OFF;
+    return PATTERNS[pattern];
+}
+
+LedPattern roomLedPattern(bool isAvailable, bool endKnown, long secondsToEnd) {
+    if (isAvailable) return LED_PATTERN_AVAILABLE;
+    // Overdue meetings keep pulsing until the next status poll ends them
+    if (endKnown && secondsToEnd <= LED_ENDING_SOON_S) return LED_PATTERN_ENDING_SOON;
+    return LED_PATTERN_OCCUPIED;
+}
+
+uint8_t scaleLedLevel(uint8_t value, uint8_t level) {
+    return (uint16_t)value * level / 255;
+}
+
+void ledPatternAverage(LedPattern pattern, uint8_t level, uint8_t& red, uint8_t& green, uint8_t& blue) {
+    const LedPatternSteps& p = ledPatternSteps(pattern);
+    const LedStep& last = p.steps[p.count - 1];
+    if (!p.repeat) {
+        red = scaleLedLevel(last.red, level);
+        green = scaleLedLevel(last.green, level);
+        blue = scaleLedLevel(last.blue, level);
+        return;
+    }
+
+    // Fades are linear, so they average to the midpoint of their two ends
+    uint32_t sum[3] = {0, 0, 0};
+    uint32_t total = 0;
+    const LedStep* prev = &last;
+    for (uint8_t i = 0; i < p.count; i++) {
+        const LedStep& s = p.steps[i];
+        const uint8_t from[3] = {prev->red, prev->green, prev->blue};
+        const uint8_t to[3] = {s.red, s.green, s.blue};
+        for (int c = 0; c < 3; c++) {
+            sum[c] += (uint32_t)(from[c] + to[c]) * s.fadeMs / 2 + (uint32_t)to[c] * s.holdMs;
+        }
+        total += s.fadeMs + s.holdMs;
+        prev = &s;
+    }
+    red = scaleLedLevel(total ? sum[0] / total : 0, level);
+    green = scaleLedLevel(total ? sum[1] / total : 0, level);
+    blue = scaleLedLevel(total ? sum[2] / total : 0, level);
+}
+
+#ifdef ESP32
+
+#include <driver/ledc.h>
+
+StatusLed statusLed;
+
+static const uint8_t LED_CHANNELS[3] = {LED_RED_CHANNEL, LED_GREEN_CHANNEL, LED_BLUE_CHANNEL};
+static TaskHandle_t ledTask = nullptr;
+
+// The Arduino core maps channels 0-7 to the high-speed group and 8-15 to the
+// low-speed group
+static ledc_mode_t speedMode(uint8_t channel) {
+    return channel < 8 ? LEDC_HIGH_SPEED_MODE : LEDC_LOW_SPEED_MODE;
+}
+
+static ledc_channel_t groupChannel(uint8_t channel) {
+    return (ledc_channel_t)(channel % 8);
+}
+
+// Fade-complete interrupt: bit i of the task notification = channel i done
+static bool IRAM_ATTR onFadeEnd(const ledc_cb_param_t* param, void* arg) {
+    if (param->event != LEDC_FADE_END_EVT || !ledTask) return false;
+    BaseType_t woken = pdFALSE;
+    xTaskNotifyFromISR(ledTask, 1u << (uint32_t)(uintptr_t)arg, eSetBits, &woken);
+    return woken == pdTRUE;
+}
+
+StatusLed::StatusLed()
+    : _pattern(LED_PATTERN_OFF), _flash(LED_PATTERN_COUNT), _changed(false),
+      _level(255 - LED_BRIGHTNESS), _task(nullptr) {
+    memset(_channel, 0, sizeof(_channel));
+}
+
+void StatusLed::begin() {
+    if (_task) return;
+
+    // Already installed is fine
+    ledc_fade_func_install(0);
+    for (uint32_t i = 0; i < 3; i++) {
+        ledc_cbs_t callbacks = {};
+        callbacks.fade_cb = onFadeEnd;
+        ledc_cb_register(speedMode(LED_CHANNELS[i]), groupChannel(LED_CHANNELS[i]), &callbacks, (void*)(uintptr_t)i);
+    }
+
+    xTaskCreate(taskEntry, "led", 2048, this, 2, &_task);
+    ledTask = _task;
+}
+
+void StatusLed::show(LedPattern pattern) {
+    if (pattern == _pattern) return;
+    _pattern = pattern;
+    _changed = true;
+    if (_task) xTaskNotify(_task, 0, eNoAction);
+}
+
+void StatusLed::setLevel(uint8_t level) {
+    if (level == _level) return;
+    _level = level;
+    // Replays the current step at the new level
+    _changed = true;
+    if (_task) xTaskNotify(_task, 0, eNoAction);
+}
+
+void StatusLed::flash(LedPattern pattern) {
+    _flash = pattern;
+    _changed = true;
+    if (_task) xTaskNotify(_task, 0, eNoAction);
+}
+
+void StatusLed::taskEntry(void* arg) {
+    static_cast<StatusLed*>(arg)->run();
+}
+
+// Start the step's fades and wait for them to finish. The timeout covers a
+// fade-end interrupt that was missed while the CPU was in light sleep.
+void StatusLed::playStep(const LedStep& step) {
+    const uint8_t level = _level;
+    const uint8_t target[3] = {scaleLedLevel(step.red, level), scaleLedLevel(step.green, level),
+                               scaleLedLevel(step.blue, level)};
+    uint32_t pending = 0;
+
+    for (uint32_t i = 0; i < 3; i++) {
+        if (target[i] == _channel[i]) continue;
+        ledc_mode_t mode = speedMode(LED_CHANNELS[i]);
+        ledc_channel_t channel = groupChannel(LED_CHANNELS[i]);
+        uint32_t duty = 255 - target[i];  // Active LOW
+        if (step.fadeMs > 0 &&
+            ledc_set_fade_with_time(mode, channel, duty, step.fadeMs) == ESP_OK &&
+            ledc_fade_start(mode, channel, LEDC_FADE_NO_WAIT) == ESP_OK) {
+            pending |= 1u << i;
+        } else {
+            ledc_set_duty(mode, channel, duty);
+            ledc_update_duty(mode, channel);
+        }
+        _channel[i] = target[i];
+    }
+
+    TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(step.fadeMs + 100);
+    while (pending) {
+        TickType_t now = xTaskGetTickCount();
+        if ((int32_t)(deadline - now) <= 0) break;
+        uint32_t bits = 0;
+        if (xTaskNotifyWait(0, 0xFFFFFFFF, &bits, deadline - now) == pdFALSE) break;
+        pending &= ~bits;
+    }
+}
+
+void StatusLed::run() {
+    LedPattern playing = LED_PATTERN_COUNT;
+    uint8_t index = 0;
+    bool flashing = false;
+
+    for (;;) {
+        _changed = false;
+        LedPattern flash = _flash;
+        if (flash != LED_PATTERN_COUNT) {
+            _flash = LED_PATTERN_COUNT;
+            playing = flash;
+            flashing = true;
+            index = 0;
+        } else if (!flashing && playing != _pattern) {
+            playing = _pattern;
+            index = 0;
+        }
+
+        const LedPatternSteps& p = ledPatternSteps(playing);
+        const LedStep& step = p.steps[index];
+        playStep(step);
+
+        bool last = index + 1 >= p.count;
+        if (flashing) {
+            // Play the flash out in full, then back to the current pattern
+            vTaskDelay(pdMS_TO_TICKS(step.holdMs));
+            if (last) {
+                flashing = false;
+                playing = _pattern;
+                index = 0;
+            } else {
+                index++;
+            }
+            continue;
+        }
+
+        // Hold, ending early when show() or flash() is called
+        bool forever = last && !p.repeat;
+        if (!_changed) {
+            xTaskNotifyWait(0, 0xFFFFFFFF, nullptr, forever ? portMAX_DELAY : pdMS_TO_TICKS(step.holdMs));
+        }
+        if (_changed) continue;
+        index = last ? 0 : index + 1;
+    }
+}
+
+#endif // ESP32
@@ -0,0 +1,97 @@
+#include "telemetry.h"
+
+Telemetry::Telemetry()
+    : _head(0), _count(0), _bootId(0), _nextSeq(0), _startMs(0), _dropped(0), _started(false) {
+    resetCurrent();
+}
+
+void Telemetry::begin(uint32_t bootId, bool countBoot, uint32_t nowMs) {
+    _head = 0;
+    _count = 0;
+    _dropped = 0;
+    _bootId = bootId;
+    _nextSeq = countBoot ? 0 : 1;
+    _startMs = nowMs;
+    _started = true;
+    resetCurrent();
+}
+
+void Telemetry::resetCurrent() {
+    memset(&_current, 0, sizeof(_current));
+}
+
+void Telemetry::recordPoll(bool ok, uint32_t ms) {
+    if (_current.polls < UINT16_MAX) _current.polls++;
+    if (!ok) {
+        if (_current.pollErrors < UINT16_MAX) _current.pollErrors++;
+        return;
+    }
+    _current.pollMsSum += ms;
+    if (ms > _current.pollMsMax) _current.pollMsMax = ms > UINT16_MAX ? UINT16_MAX : ms;
+}
+
+void Telemetry::recordRedraw(uint32_t ms) {
+    if (_current.redraws < UINT16_MAX) _current.redraws++;
+    _current.redrawMsSum += ms;
+    if (ms > _current.redrawMsMax) _current.redrawMsMax = ms > UINT16_MAX ? UINT16_MAX : ms;
+}
+
+void Telemetry::recordHeap(uint32_t freeBytes) {
+    if (_current.heapMin == 0 || freeBytes < _current.heapMin) _current.heapMin = freeBytes;
+}
+
+bool Telemetry::tick(uint32_t nowMs, int rssi) {
+    if (!_started || nowMs - _startMs < TELEMETRY_SAMPLE_MS) {
+        return false;
+    }
+
+    _current.seq = _nextSeq++;
+    _current.endMs = nowMs;
+    _current.rssi = rssi < -127 ? -127 : rssi > 0 ? 0 : rssi;
+
+    // Full: the oldest sample goes, the server sees a gap in the numbering
+    if (_count == TELEMETRY_BUFFER_SAMPLES) {
+        _head = (_head + 1) % TELEMETRY_BUFFER_SAMPLES;
+        _count--;
+        _dropped++;
+    }
+    _ring[(_head + _count) % TELEMETRY_BUFFER_SAMPLES] = _current;
+    _count++;
+
+    resetCurrent();
+    _startMs = nowMs;
+    return true;
+}
+
+const TelemetrySample& Telemetry::sample(size_t index) const {
+    return _ring[(_head + index) % TELEMETRY_BUFFER_SAMPLES];
+}
+
+String Telemetry::encode(uint32_t nowMs) const {
+    String out;
+    out.reserve(48 + _count * 56);
+
+    char buf[96];
+    snprintf(buf, sizeof(buf), "{\"v\":1,\"b\":%lu,\"n\":%lu,\"s\":[",
+             (unsigned long)_bootId, (unsigned long)(_count > 0 ? sample(0).seq : _nextSeq));
+    out += buf;
+
+    // Samples are consecutive: a dropped sample only ever leaves the front
+    for (size_t i = 0; i < _count; i++) {
+        const TelemetrySample& s = sample(i);
+        snprintf(buf, sizeof(buf), "%s[%lu,%u,%u,%lu,%u,%lu,%d,%u,%lu,%u]",
+                 i > 0 ? "," : "",
+                 (unsigned long)((nowMs - s.endMs) / 1000), s.polls, s.pollErrors,
+                 (unsigned long)s.pollMsSum, s.pollMsMax, (unsigned long)s.heapMin, s.rssi,
+                 s.redraws, (unsigned long)s.redrawMsSum, s.redrawMsMax);
+        out += buf;
+    }
+    out += "]}";
+    return out;
+}
+
+void Telemetry::acknowledge(size_t count) {
+    if (count > _count) count = _count;
+    _head = (_head + count) % TELEMETRY_BUFFER_SAMPLES;
+    _count -= count;
+}
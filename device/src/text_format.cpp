@@ -0,0 +1,44 @@
+#include "text_format.h"
+
+String formatDurationLabel(int minutes) {
+    if (minutes < 60) {
+        return String(minutes) + " min";
+    } else if (minutes == 60) {
+        return "1 hour";
+    } else if (minutes % 60 == 0) {
+        return String(minutes / 60) + " hours";
+    } else {
+        float hours = minutes / 60.0;
+        // Format as "1.5 hours" etc.
+        if (minutes == 90) return "1.5 hours";
+        return String(hours, 1) + " hrs";
+    }
+}
+
+String truncateText(const String& text, int maxChars) {
+    if ((int)text.length() <= maxChars) {
+        return text;
+    }
+    return text.substring(0, maxChars - 3) + "...";
+}
+
+int wrapText(const String& text, int maxChars, String* lines, int maxLines) {
+    int count = 0;
+    String msg = text;
+    while (msg.length() > 0 && count < maxLines) {
+        String line = msg.substring(0, min((int)msg.length(), maxChars));
+        if ((int)msg.length() > maxChars) {
+            int lastSpace = line.lastIndexOf(' ');
+            if (lastSpace > 0) {
+                line = msg.substring(0, lastSpace);
+                msg = msg.substring(lastSpace + 1);
+            } else {
+                msg = msg.substring(maxChars);
+            }
+        } else {
+            msg = "";
+        }
+        lines[count++] = line;
+    }
+    return count;
+}
@@ -0,0 +1,100 @@
+#include "time_utils.h"
+
+bool isLeapYear(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
+}
+
+time_t utcToTimestamp(int year, int month, int day, int hour, int minute, int second) {
+    // Days in each month (non-leap year)
+    const int daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+    // Count days since Unix epoch (Jan 1, 1970)
+    long days = 0;
+
+    // Add days for complete years
+    for (int y = 1970; y < year; y++) {
+        days += isLeapYear(y) ? 366 : 365;
+    }
+
+    // Add days for complete months in current year
+    for (int m = 1; m < month; m++) {
+        days += daysInMonth[m - 1];
+        // Add leap day if needed
+        if (m == 2 && isLeapYear(year)) {
+            days++;
+        }
+    }
+
+    // Add remaining days
+    days += day - 1;  // -1 because day 1 is the first day
+
+    // Convert to timestamp
+    time_t timestamp = (time_t)days * 86400L + (long)hour * 3600L + (long)minute * 60L + (long)second;
+
+    return timestamp;
+}
+
+void applyTimezone(const String& timezone) {
+    // setenv/tzset re-parse the rules every time, so only switch on change.
+    // configTime() and anything else may have set TZ behind our back, so a
+    // change is checked against the environment, not only what we last set.
+    static String currentTimezone;
+    if (timezone.length() == 0) return;
+    const char* active = getenv("TZ");
+    if (timezone != currentTimezone || !active || timezone != active) {
+        setenv("TZ", timezone.c_str(), 1);
+        tzset();
+        currentTimezone = timezone;
+    }
+}
+
+void toLocalTime(time_t timestamp, const String& timezone, struct tm& out) {
+    applyTimezone(timezone);
+    localtime_r(&timestamp, &out);
+}
+
+bool isWallTimeSynced(time_t timestamp) {
+    struct tm utc;
+    gmtime_r(&timestamp, &utc);
+    return utc.tm_year >= (2024 - 1900);
+}
+
+time_t parseIsoTimestamp(const String& isoTime) {
+    // Parse ISO 8601 time string (e.g., "2024-01-15T14:30:00.000Z")
+    // Format: YYYY-MM-DDTHH:MM:SS.sssZ or YYYY-MM-DDTHH:MM:SSZ
+    int tIndex = isoTime.indexOf('T');
+    if (tIndex == -1) return 0;
+
+    // Extract date and time parts
+    String datePart = isoTime.substring(0, tIndex);  // YYYY-MM-DD
+    String timePart = isoTime.substring(tIndex + 1); // HH:MM:SS...
+
+    // Parse date
+    int year = datePart.substring(0, 4).toInt();
+    int month = datePart.substring(5, 7).toInt();
+    int day = datePart.substring(8, 10).toInt();
+
+    // Parse time
+    int hours = timePart.substring(0, 2).toInt();
+    int minutes = timePart.substring(3, 5).toInt();
+    int seconds = timePart.substring(6, 8).toInt();
+
+    // Convert UTC time to Unix timestamp
+    return utcToTimestamp(year, month, day, hours, minutes, seconds);
+}
+
+String formatLocalTime(const String& isoTime, const String& timezone) {
+    if (isoTime.length() == 0) return "";
+    if (isoTime.indexOf('T') == -1) return isoTime;
+
+    time_t timestamp = parseIsoTimestamp(isoTime);
+
+    // Convert to local time using timezone
+    struct tm localTime;
+    toLocalTime(timestamp, timezone, localTime);
+
+    // Format as HH:MM
+    char buffer[6];
+    snprintf(buffer, sizeof(buffer), "%02d:%02d", localTime.tm_hour, localTime.tm_min);
+    return String(buffer);
+}
@@ -9,6 +9,7 @@
 #define CST820_REG_YPOS_L     0x06
 #define CST820_REG_CHIP_ID    0xA7
 #define CST820_REG_SLEEP      0xE5
+#define CST820_REG_IRQ_PULSE  0xED  // INT low pulse width, 0.1 ms units (1-200)
 
 TouchController::TouchController() : _initialized(false) {}
 
@@ -37,6 +38,9 @@ void TouchController::begin(int sda, int scl, int rst, int intr) {
     _initialized = (chipId != 0xFF && chipId != 0x00);
 
     if (_initialized) {
+        // Longest INT pulse, so a tap is still asserted when the ESP32 comes
+        // out of light sleep and samples the line
+        writeRegister(CST820_REG_IRQ_PULSE, 200);
         Serial.println("Capacitive touch initialized");
     } else {
         Serial.println("Warning: Touch controller not detected");
@@ -0,0 +1,83 @@
+#include "trace.h"
+
+#ifdef TRACE_ENABLED
+
+#include "config.h"
+
+static TraceEvent events[TRACE_BUFFER_EVENTS];
+static size_t head = 0;    // Next slot to write
+static size_t count = 0;
+static bool paused = false;
+
+void traceRecord(const char* name, char phase) {
+    if (paused) return;
+
+    TraceEvent& ev = events[head];
+    ev.name = name;
+    ev.timestampUs = (uint32_t)micros();
+    ev.phase = phase;
+
+    head = (head + 1) % TRACE_BUFFER_EVENTS;
+    if (count < TRACE_BUFFER_EVENTS) count++;
+}
+
+void traceClear() {
+    head = 0;
+    count = 0;
+}
+
+size_t traceEventCount() {
+    return count;
+}
+
+const TraceEvent& traceEventAt(size_t index) {
+    size_t oldest = (head + TRACE_BUFFER_EVENTS - count) % TRACE_BUFFER_EVENTS;
+    return events[(oldest + index) % TRACE_BUFFER_EVENTS];
+}
+
+void traceWriteJson(void (*write)(const String& chunk), size_t chunkBytes) {
+    paused = true;
+
+    String out;
+    out.reserve(chunkBytes + 96);
+    out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"loop\"}}";
+
+    // Timestamps are relative to the oldest event, which keeps them ordered
+    // across a micros() wrap. Ends whose begin was overwritten are dropped.
+    uint32_t base = count > 0 ? traceEventAt(0).timestampUs : 0;
+    int depth = 0;
+    for (size_t i = 0; i < count; i++) {
+        const TraceEvent& ev = traceEventAt(i);
+        if (ev.phase == TRACE_PHASE_END) {
+            if (depth == 0) continue;
+            depth--;
+        } else if (ev.phase == TRACE_PHASE_BEGIN) {
+            depth++;
+        }
+
+        out += ",{\"name\":\"";
+        out += ev.name;
+        out += "\",\"ph\":\"";
+        out += ev.phase;
+        out += "\",\"ts\":";
+        out += (unsigned long)(ev.timestampUs - base);
+        out += ",\"pid\":1,\"tid\":1";
+        if (ev.phase == TRACE_PHASE_INSTANT) {
+            out += ",\"s\":\"t\"";
+        }
+        out += "}";
+
+        if (out.length() >= chunkBytes) {
+            write(out);
+            out = "";
+        }
+    }
+
+    out += "]}";
+    write(out);
+
+    paused = false;
+}
+
+#endif // TRACE_ENABLED
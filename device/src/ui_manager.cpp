@@ -1,5 +1,8 @@
 #include "ui_manager.h"
-#include <time.h>
+#include "time_utils.h"
+#include "text_format.h"
+#include "energy.h"
+#include "trace.h"
 
 UIManager::UIManager(TFT_eSPI& tft, TouchController& touch)
     : _tft(tft), _touch(touch), _currentState(UI_LOADING), _buttonCount(0) {
@@ -10,6 +13,7 @@ UIManager::UIManager(TFT_eSPI& tft, TouchController& touch)
 void UIManager::begin() {
     _tft.init();
     _tft.setRotation(TFT_ROTATION);
+    computeScreenLayouts(_tft.width(), _tft.height(), _layout);
     _tft.fillScreen(COLOR_BG);
 
     // Turn on backlight
@@ -17,22 +21,30 @@ void UIManager::begin() {
     pinMode(TFT_BL, OUTPUT);
     digitalWrite(TFT_BL, HIGH);
     #endif
+    energyMeter.setBacklight(true);
 }
 
 void UIManager::setBacklight(bool on) {
     #ifdef TFT_BL
     digitalWrite(TFT_BL, on ? HIGH : LOW);
     #endif
+    energyMeter.setBacklight(on);
 }
 
 void UIManager::setRotation(uint8_t rotation) {
     _tft.setRotation(rotation);
+    // Layouts only change with the screen size, so recompute here and nowhere else
+    computeScreenLayouts(_tft.width(), _tft.height(), _layout);
 }
 
 void UIManager::clearButtons() {
     _buttonCount = 0;
 }
 
+void UIManager::addButton(const Rect& r, const String& label, uint16_t bgColor, uint16_t textColor) {
+    addButton(r.x, r.y, r.w, r.h, label, bgColor, textColor);
+}
+
 void UIManager::addButton(int x, int y, int w, int h, const String& label, uint16_t bgColor, uint16_t textColor) {
     if (_buttonCount < 8) {
         _buttons[_buttonCount] = {x, y, w, h, label, bgColor, textColor, true};
@@ -61,105 +73,53 @@ int UIManager::checkButtonPress(int touchX, int touchY) {
 }
 
 void UIManager::drawHeader(const String& title, uint16_t bgColor) {
+    TRACE_SCOPE("ui.header");
+    const LayoutMetrics& m = _layout.metrics;
     // Minimal top bar
-    _tft.fillRect(0, 0, SCREEN_WIDTH, 3, bgColor);
+    _tft.fillRect(0, 0, m.width, m.px(3), bgColor);
     _tft.setTextColor(COLOR_TEXT);
     _tft.setTextDatum(TL_DATUM);
-    _tft.drawString(title, 12, 12, 4);
+    _tft.drawString(title, m.margin, m.px(12), m.fontTitle);
 }
 
 void UIManager::drawButton(int x, int y, int w, int h, const String& label, uint16_t bgColor, uint16_t textColor) {
-    _tft.fillRoundRect(x, y, w, h, 8, bgColor);
+    TRACE_SCOPE("ui.button");
+    _tft.fillRoundRect(x, y, w, h, _layout.metrics.px(8), bgColor);
     _tft.setTextColor(textColor);
     _tft.setTextDatum(MC_DATUM);
-    _tft.drawString(label, x + w/2, y + h/2, 2);
+    _tft.drawString(label, x + w/2, y + h/2, _layout.metrics.fontBody);
 }
 
-void UIManager::drawCard(int x, int y, int w, int h, uint16_t bgColor) {
-    _tft.fillRoundRect(x, y, w, h, 6, bgColor);
+void UIManager::drawButton(const Rect& r, const String& label, uint16_t bgColor, uint16_t textColor) {
+    drawButton(r.x, r.y, r.w, r.h, label, bgColor, textColor);
 }
 
-void UIManager::drawCenteredText(const String& text, int y, uint8_t font) {
-    _tft.setTextDatum(MC_DATUM);
-    _tft.drawString(text, SCREEN_WIDTH / 2, y, font);
+void UIManager::drawCard(int x, int y, int w, int h, uint16_t bgColor) {
+    _tft.fillRoundRect(x, y, w, h, _layout.metrics.px(6), bgColor);
 }
 
-// Helper function to check if a year is a leap year
-static bool isLeapYear(int year) {
-    return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
+void UIManager::drawCard(const Rect& r, uint16_t bgColor) {
+    drawCard(r.x, r.y, r.w, r.h, bgColor);
 }
 
-// Helper function to convert UTC time to Unix timestamp
-// This is our own implementation of timegm() since ESP32 doesn't have it
-static time_t utcToTimestamp(int year, int month, int day, int hour, int minute, int second) {
-    // Days in each month (non-leap year)
-    const int daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
-
-    // Count days since Unix epoch (Jan 1, 1970)
-    long days = 0;
-
-    // Add days for complete years
-    for (int y = 1970; y < year; y++) {
-        days += isLeapYear(y) ? 366 : 365;
-    }
+void UIManager::drawCenteredText(const String& text, int y, uint8_t font) {
+    _tft.setTextDatum(MC_DATUM);
+    _tft.drawString(text, _layout.metrics.width / 2, y, font);
+}
 
-    // Add days for complete months in current year
-    for (int m = 1; m < month; m++) {
-        days += daysInMonth[m - 1];
-        // Add leap day if needed
-        if (m == 2 && isLeapYear(year)) {
-            days++;
-        }
+void UIManager::drawWrappedMessage(const String& message) {
+    TRACE_SCOPE("ui.message");
+    const MessageLayout& l = _layout.message;
+    String lines[8];
+    int maxLines = (l.messageBottom - l.messageTop + l.lineHeight - 1) / l.lineHeight;
+    int count = wrapText(message, l.wrapChars, lines, min(maxLines, 8));
+    for (int i = 0; i < count; i++) {
+        _tft.drawString(lines[i], l.iconX, l.messageTop + i * l.lineHeight, _layout.metrics.fontBody);
     }
-
-    // Add remaining days
-    days += day - 1;  // -1 because day 1 is the first day
-
-    // Convert to timestamp
-    time_t timestamp = (time_t)days * 86400L + (long)hour * 3600L + (long)minute * 60L + (long)second;
-
-    return timestamp;
 }
 
 String UIManager::formatTime(const String& isoTime) {
-    if (isoTime.length() == 0) return "";
-
-    // Parse ISO 8601 time string (e.g., "2024-01-15T14:30:00.000Z")
-    // Format: YYYY-MM-DDTHH:MM:SS.sssZ or YYYY-MM-DDTHH:MM:SSZ
-    int tIndex = isoTime.indexOf('T');
-    if (tIndex == -1) return isoTime;
-
-    // Extract date and time parts
-    String datePart = isoTime.substring(0, tIndex);  // YYYY-MM-DD
-    String timePart = isoTime.substring(tIndex + 1); // HH:MM:SS...
-
-    // Parse date
-    int year = datePart.substring(0, 4).toInt();
-    int month = datePart.substring(5, 7).toInt();
-    int day = datePart.substring(8, 10).toInt();
-
-    // Parse time
-    int hours = timePart.substring(0, 2).toInt();
-    int minutes = timePart.substring(3, 5).toInt();
-    int seconds = timePart.substring(6, 8).toInt();
-
-    // Convert UTC time to Unix timestamp
-    time_t timestamp = utcToTimestamp(year, month, day, hours, minutes, seconds);
-
-    // Apply timezone if set
-    if (_timezone.length() > 0) {
-        setenv("TZ", _timezone.c_str(), 1);
-        tzset();
-    }
-
-    // Convert to local time using timezone
-    struct tm localTime;
-    localtime_r(&timestamp, &localTime);
-
-    // Format as HH:MM
-    char buffer[6];
-    snprintf(buffer, sizeof(buffer), "%02d:%02d", localTime.tm_hour, localTime.tm_min);
-    return String(buffer);
+    return formatLocalTime(isoTime, _timezone);
 }
 
 String UIManager::formatTimeRange(const String& start, const String& end) {
@@ -167,24 +127,25 @@ String UIManager::formatTimeRange(const String& start, const String& end) {
 }
 
 void UIManager::drawBookingCard(int y, const Booking& booking, bool isCurrent) {
+    TRACE_SCOPE("ui.bookingCard");
+    const LayoutMetrics& m = _layout.metrics;
+    const Rect& card = _layout.roomStatus.card;
     uint16_t cardColor = isCurrent ? 0x3000 : COLOR_CARD_BG;
     uint16_t accentColor = isCurrent ? COLOR_DANGER : COLOR_ACCENT;
 
     // Card with left accent bar
-    drawCard(12, y, SCREEN_WIDTH - 24, 42, cardColor);
-    _tft.fillRect(12, y, 4, 42, accentColor);
+    drawCard(card.x, y, card.w, card.h, cardColor);
+    _tft.fillRect(card.x, y, m.px(4), card.h, accentColor);
 
     _tft.setTextColor(COLOR_TEXT);
     _tft.setTextDatum(TL_DATUM);
 
-    String title = booking.title;
-    if (title.length() > 28) {
-        title = title.substring(0, 25) + "...";
-    }
-    _tft.drawString(title, 24, y + 8, 2);
+    String title = truncateText(booking.title, _layout.roomStatus.cardTitleChars);
+    int textX = card.x + m.margin;
+    _tft.drawString(title, textX, y + m.px(8), m.fontBody);
 
     _tft.setTextColor(COLOR_TEXT_MUTED);
-    _tft.drawString(formatTimeRange(booking.startTime, booking.endTime), 24, y + 26, 1);
+    _tft.drawString(formatTimeRange(booking.startTime, booking.endTime), textX, y + m.px(26), m.fontSmall);
 }
 
 void UIManager::drawStatusIndicator(bool available) {
@@ -194,156 +155,167 @@ void UIManager::drawStatusIndicator(bool available) {
 // ============== Screen Drawing Functions ==============
 
 void UIManager::showStartupScreen() {
+    TRACE_SCOPE("ui.startup");
     _currentState = UI_LOADING;
     clearButtons();
 
+    const LayoutMetrics& m = _layout.metrics;
     _tft.fillScreen(COLOR_BG);
 
     // Logo/title area
     _tft.setTextColor(COLOR_PRIMARY);
     _tft.setTextDatum(MC_DATUM);
-    _tft.drawString("MEETING ROOM", SCREEN_WIDTH/2, 30, 4);
+    _tft.drawString("MEETING ROOM", m.width/2, m.py(30), m.fontTitle);
     _tft.setTextColor(COLOR_TEXT_MUTED);
-    _tft.drawString("Display Setup", SCREEN_WIDTH/2, 55, 2);
+    _tft.drawString("Display Setup", m.width/2, m.py(55), m.fontBody);
 
     // Instructions card
-    drawCard(12, 75, SCREEN_WIDTH - 24, 130, COLOR_CARD_BG);
+    drawCard(m.margin, m.py(75), m.width - 2 * m.margin, m.px(130), COLOR_CARD_BG);
 
     _tft.setTextColor(COLOR_TEXT);
     _tft.setTextDatum(TL_DATUM);
-    int y = 85;
-    int x = 24;
+    int y = m.py(75) + m.px(10);
+    int x = 2 * m.margin;
 
-    _tft.drawString("1. Connect to WiFi:", x, y, 2);
+    _tft.drawString("1. Connect to WiFi:", x, y, m.fontBody);
     _tft.setTextColor(COLOR_ACCENT);
-    _tft.drawString("MeetingRoom-Setup", x + 130, y, 2);
-    y += 22;
+    _tft.drawString("MeetingRoom-Setup", x + m.px(130), y, m.fontBody);
+    y += m.px(22);
 
     _tft.setTextColor(COLOR_TEXT_MUTED);
-    _tft.drawString("Password: setup1234", x, y, 1);
-    y += 20;
+    _tft.drawString("Password: setup1234", x, y, m.fontSmall);
+    y += m.px(20);
 
     _tft.setTextColor(COLOR_TEXT);
-    _tft.drawString("2. Open browser:", x, y, 2);
-    y += 18;
+    _tft.drawString("2. Open browser:", x, y, m.fontBody);
+    y += m.px(18);
     _tft.setTextColor(COLOR_ACCENT);
-    _tft.drawString("http://192.168.4.1", x, y, 2);
-    y += 22;
+    _tft.drawString("http://192.168.4.1", x, y, m.fontBody);
+    y += m.px(22);
 
     _tft.setTextColor(COLOR_TEXT);
-    _tft.drawString("3. Configure WiFi & Token", x, y, 2);
+    _tft.drawString("3. Configure WiFi & Token", x, y, m.fontBody);
 
     _tft.setTextColor(COLOR_WARNING);
     _tft.setTextDatum(MC_DATUM);
-    _tft.drawString("Initializing...", SCREEN_WIDTH/2, 220, 2);
+    _tft.drawString("Initializing...", m.width/2, m.py(220), m.fontBody);
 }
 
 void UIManager::showWiFiSetup(const String& apName, const String& apPassword) {
+    TRACE_SCOPE("ui.wifiSetup");
     _currentState = UI_WIFI_SETUP;
     clearButtons();
 
+    const LayoutMetrics& m = _layout.metrics;
     _tft.fillScreen(COLOR_BG);
 
     // Status indicator
-    _tft.fillCircle(SCREEN_WIDTH/2, 50, 25, COLOR_WARNING);
+    _tft.fillCircle(m.width/2, m.py(50), m.px(25), COLOR_WARNING);
     _tft.setTextColor(COLOR_TEXT_DARK);
     _tft.setTextDatum(MC_DATUM);
-    _tft.drawString("!", SCREEN_WIDTH/2, 50, 4);
+    _tft.drawString("!", m.width/2, m.py(50), m.fontTitle);
 
     _tft.setTextColor(COLOR_TEXT);
-    _tft.drawString("WiFi Setup Required", SCREEN_WIDTH/2, 95, 2);
+    _tft.drawString("WiFi Setup Required", m.width/2, m.py(95), m.fontBody);
 
     // Info card
-    drawCard(12, 115, SCREEN_WIDTH - 24, 90, COLOR_CARD_BG);
+    drawCard(m.margin, m.py(115), m.width - 2 * m.margin, m.px(90), COLOR_CARD_BG);
 
     _tft.setTextColor(COLOR_TEXT_MUTED);
     _tft.setTextDatum(TL_DATUM);
-    _tft.drawString("Connect to network:", 24, 125, 1);
+    _tft.drawString("Connect to network:", 2 * m.margin, m.py(115) + m.px(10), m.fontSmall);
 
     _tft.setTextColor(COLOR_ACCENT);
     _tft.setTextDatum(MC_DATUM);
-    _tft.drawString(apName, SCREEN_WIDTH/2, 150, 4);
+    _tft.drawString(apName, m.width/2, m.py(115) + m.px(35), m.fontTitle);
 
     _tft.setTextColor(COLOR_TEXT_MUTED);
-    _tft.drawString("Password: " + apPassword, SCREEN_WIDTH/2, 180, 2);
+    _tft.drawString("Password: " + apPassword, m.width/2, m.py(115) + m.px(65), m.fontBody);
 
     _tft.setTextColor(COLOR_TEXT);
-    _tft.drawString("Then visit 192.168.4.1", SCREEN_WIDTH/2, 220, 2);
+    _tft.drawString("Then visit 192.168.4.1", m.width/2, m.py(220), m.fontBody);
 }
 
 void UIManager::showTokenSetup(const String& ipAddress) {
+    TRACE_SCOPE("ui.tokenSetup");
     _currentState = UI_TOKEN_SETUP;
     clearButtons();
 
+    const LayoutMetrics& m = _layout.metrics;
     _tft.fillScreen(COLOR_BG);
 
     // Success indicator
-    _tft.fillCircle(SCREEN_WIDTH/2, 45, 22, COLOR_SUCCESS);
+    _tft.fillCircle(m.width/2, m.py(45), m.px(22), COLOR_SUCCESS);
     _tft.setTextColor(COLOR_TEXT);
     _tft.setTextDatum(MC_DATUM);
-    _tft.drawString("OK", SCREEN_WIDTH/2, 45, 2);
+    _tft.drawString("OK", m.width/2, m.py(45), m.fontBody);
 
     _tft.setTextColor(COLOR_TEXT);
-    _tft.drawString("WiFi Connected", SCREEN_WIDTH/2, 85, 2);
+    _tft.drawString("WiFi Connected", m.width/2, m.py(85), m.fontBody);
 
     // URL card
-    drawCard(12, 105, SCREEN_WIDTH - 24, 55, COLOR_CARD_BG);
+    drawCard(m.margin, m.py(105), m.width - 2 * m.margin, m.px(55), COLOR_CARD_BG);
     _tft.setTextColor(COLOR_TEXT_MUTED);
-    _tft.drawString("Configure at:", SCREEN_WIDTH/2, 118, 1);
+    _tft.drawString("Configure at:", m.width/2, m.py(105) + m.px(13), m.fontSmall);
     _tft.setTextColor(COLOR_ACCENT);
-    _tft.drawString("http://" + ipAddress, SCREEN_WIDTH/2, 142, 4);
+    _tft.drawString("http://" + ipAddress, m.width/2, m.py(105) + m.px(37), m.fontTitle);
 
     // Instructions
     _tft.setTextColor(COLOR_TEXT_MUTED);
-    _tft.drawString("Enter API URL and device token", SCREEN_WIDTH/2, 180, 1);
-    _tft.drawString("from Admin > Rooms > Devices", SCREEN_WIDTH/2, 195, 1);
+    _tft.drawString("Enter API URL and device token", m.width/2, m.py(180), m.fontSmall);
+    _tft.drawString("from Admin > Rooms > Devices", m.width/2, m.py(180) + m.px(15), m.fontSmall);
 }
 
 void UIManager::showRoomStatus(const RoomStatus& status) {
+    TRACE_SCOPE("ui.roomStatus");
     _currentState = UI_ROOM_STATUS;
     clearButtons();
 
+    const LayoutMetrics& m = _layout.metrics;
+    const RoomStatusLayout& l = _layout.roomStatus;
+    TRACE_BEGIN("tft.fillScreen");
     _tft.fillScreen(COLOR_BG);
+    TRACE_END("tft.fillScreen");
 
     // Room name - top left
     _tft.setTextColor(COLOR_TEXT);
     _tft.setTextDatum(TL_DATUM);
-    _tft.drawString(status.room.name, 12, 10, 4);
+    _tft.drawString(status.room.name, l.title.x, l.title.y, m.fontTitle);
 
     // Large status indicator
-    int statusY = 50;
+    const Rect& panel = l.statusPanel;
+    int listY = l.listTop;
     if (status.isAvailable) {
         // Available - large green area
-        _tft.fillRoundRect(12, statusY, SCREEN_WIDTH - 24, 70, 8, COLOR_SUCCESS);
+        _tft.fillRoundRect(panel.x, panel.y, panel.w, panel.h, m.px(8), COLOR_SUCCESS);
         _tft.setTextColor(COLOR_TEXT);
         _tft.setTextDatum(MC_DATUM);
-        _tft.drawString("AVAILABLE", SCREEN_WIDTH/2, statusY + 28, 4);
+        _tft.drawString("AVAILABLE", panel.cx(), l.availableLabelY, m.fontTitle);
         _tft.setTextColor(0xBFFF);  // Light green tint
-        _tft.drawString("Tap to book", SCREEN_WIDTH/2, statusY + 52, 2);
-        addButton(12, statusY, SCREEN_WIDTH - 24, 70, "Book");
-        statusY += 80;
+        _tft.drawString("Tap to book", panel.cx(), l.availableHintY, m.fontBody);
+        addButton(panel, "Book");
     } else {
         // Occupied - large red area
-        _tft.fillRoundRect(12, statusY, SCREEN_WIDTH - 24, 70, 8, COLOR_DANGER);
+        _tft.fillRoundRect(panel.x, panel.y, panel.w, panel.h, m.px(8), COLOR_DANGER);
         _tft.setTextColor(COLOR_TEXT);
         _tft.setTextDatum(MC_DATUM);
-        _tft.drawString("OCCUPIED", SCREEN_WIDTH/2, statusY + 22, 4);
+        _tft.drawString("OCCUPIED", panel.cx(), l.occupiedLabelY, m.fontTitle);
 
         if (status.currentBooking.isValid) {
             String endTime = formatTime(status.currentBooking.endTime);
             _tft.setTextColor(0xFDB6);  // Light red tint
-            _tft.drawString("Until " + endTime, SCREEN_WIDTH/2, statusY + 50, 2);
+            _tft.drawString("Until " + endTime, panel.cx(), l.occupiedUntilY, m.fontBody);
         }
-        statusY += 80;
 
         // "End Meeting" button — only shown for quick bookings created from a device
         if (status.currentBooking.isDeviceBooking) {
-            _tft.fillRoundRect(12, statusY, SCREEN_WIDTH - 24, 36, 6, COLOR_DANGER);
+            const Rect& btn = l.endMeetingButton;
+            _tft.fillRoundRect(btn.x, btn.y, btn.w, btn.h, m.px(6), COLOR_DANGER);
             _tft.setTextColor(COLOR_TEXT);
             _tft.setTextDatum(MC_DATUM);
-            _tft.drawString("End Meeting Early", SCREEN_WIDTH/2, statusY + 18, 2);
-            addButton(12, statusY, SCREEN_WIDTH - 24, 36, "EndMeeting");
-            statusY += 46;
+            _tft.drawString("End Meeting Early", btn.cx(), btn.cy(), m.fontBody);
+            addButton(btn, "EndMeeting");
+            listY = l.listTopWithEndButton;
         }
     }
 
@@ -351,42 +323,28 @@ void UIManager::showRoomStatus(const RoomStatus& status) {
     if (status.upcomingCount > 0) {
         _tft.setTextColor(COLOR_TEXT_MUTED);
         _tft.setTextDatum(TL_DATUM);
-        _tft.drawString("NEXT", 12, statusY, 1);
-        statusY += 14;
+        _tft.drawString("NEXT", l.card.x, listY, m.fontSmall);
+        listY += l.listLabelHeight;
 
-        for (int i = 0; i < status.upcomingCount && statusY < SCREEN_HEIGHT - 35; i++) {
+        for (int i = 0; i < status.upcomingCount && listY < l.listLimitY; i++) {
             if (status.upcomingBookings[i].isValid) {
-                drawBookingCard(statusY, status.upcomingBookings[i], false);
-                statusY += 46;
+                drawBookingCard(listY, status.upcomingBookings[i], false);
+                listY += l.cardPitch;
             }
         }
     }
 
     // Refresh button - bottom right, minimal
-    _tft.fillCircle(SCREEN_WIDTH - 25, SCREEN_HEIGHT - 20, 15, COLOR_CARD_BG);
+    const Rect& refresh = l.refreshButton;
+    _tft.fillCircle(refresh.cx(), refresh.cy(), l.refreshRadius, COLOR_CARD_BG);
     _tft.setTextColor(COLOR_TEXT_MUTED);
     _tft.setTextDatum(MC_DATUM);
-    _tft.drawString("R", SCREEN_WIDTH - 25, SCREEN_HEIGHT - 20, 2);
-    addButton(SCREEN_WIDTH - 40, SCREEN_HEIGHT - 35, 30, 30, "Refresh");
-}
-
-// Helper to format duration label
-String formatDurationLabel(int minutes) {
-    if (minutes < 60) {
-        return String(minutes) + " min";
-    } else if (minutes == 60) {
-        return "1 hour";
-    } else if (minutes % 60 == 0) {
-        return String(minutes / 60) + " hours";
-    } else {
-        float hours = minutes / 60.0;
-        // Format as "1.5 hours" etc.
-        if (minutes == 90) return "1.5 hours";
-        return String(hours, 1) + " hrs";
-    }
+    _tft.drawString("R", refresh.cx(), refresh.cy(), m.fontBody);
+    addButton(refresh, "Refresh");
 }
 
 void UIManager::showQuickBookMenu(const RoomStatus& status) {
+    TRACE_SCOPE("ui.quickBook");
     _currentState = UI_QUICK_BOOK;
     clearButtons();
 
@@ -396,191 +354,156 @@ void UIManager::showQuickBookMenu(const RoomStatus& status) {
         _quickBookDurations[i] = (i < _quickBookDurationCount) ? status.room.quickBookDurations[i] : 0;
     }
 
+    const LayoutMetrics& m = _layout.metrics;
+    const QuickBookLayout& l = _layout.quickBook;
     _tft.fillScreen(COLOR_BG);
 
     _tft.setTextColor(COLOR_TEXT);
     _tft.setTextDatum(TL_DATUM);
-    _tft.drawString("Quick Book", 12, 12, 4);
+    _tft.drawString("Quick Book", l.title.x, l.title.y, m.fontTitle);
 
     _tft.setTextColor(COLOR_TEXT_MUTED);
-    _tft.drawString("Select duration", 12, 45, 2);
-
-    int btnWidth = 145;
-    int btnHeight = 50;
-    int gap = 10;
-    int startX = 12;
-    int startY = 75;
+    _tft.drawString("Select duration", l.subtitle.x, l.subtitle.y, m.fontBody);
 
     // Duration buttons - 2x2 grid (up to 4 durations from room config)
-    int positions[4][2] = {
-        {startX, startY},
-        {startX + btnWidth + gap, startY},
-        {startX, startY + btnHeight + gap},
-        {startX + btnWidth + gap, startY + btnHeight + gap}
-    };
-
     for (int i = 0; i < _quickBookDurationCount && i < 4; i++) {
         String label = formatDurationLabel(_quickBookDurations[i]);
-        drawButton(positions[i][0], positions[i][1], btnWidth, btnHeight, label, COLOR_CARD_BG, COLOR_TEXT);
-        addButton(positions[i][0], positions[i][1], btnWidth, btnHeight, String(_quickBookDurations[i]));
+        drawButton(l.durations[i], label, COLOR_CARD_BG, COLOR_TEXT);
+        addButton(l.durations[i], String(_quickBookDurations[i]));
     }
 
     // Cancel button
-    drawButton(12, SCREEN_HEIGHT - 45, SCREEN_WIDTH - 24, 38, "Cancel", COLOR_DANGER, COLOR_TEXT);
-    addButton(12, SCREEN_HEIGHT - 45, SCREEN_WIDTH - 24, 38, "Cancel");
+    drawButton(l.cancelButton, "Cancel", COLOR_DANGER, COLOR_TEXT);
+    addButton(l.cancelButton, "Cancel");
 }
 
 void UIManager::showBookingConfirm(int duration) {
+    TRACE_SCOPE("ui.bookingConfirm");
     _currentState = UI_BOOKING_CONFIRM;
     clearButtons();
 
+    const LayoutMetrics& m = _layout.metrics;
+    const ConfirmLayout& l = _layout.confirm;
     _tft.fillScreen(COLOR_BG);
 
     _tft.setTextColor(COLOR_TEXT);
     _tft.setTextDatum(TL_DATUM);
-    _tft.drawString("Confirm Booking", 12, 12, 4);
+    _tft.drawString("Confirm Booking", l.title.x, l.title.y, m.fontTitle);
 
     // Duration display
-    drawCard(12, 55, SCREEN_WIDTH - 24, 70, COLOR_CARD_BG);
+    drawCard(l.card, COLOR_CARD_BG);
     _tft.setTextColor(COLOR_TEXT_MUTED);
     _tft.setTextDatum(MC_DATUM);
-    _tft.drawString("Duration", SCREEN_WIDTH/2, 72, 2);
+    _tft.drawString("Duration", l.card.cx(), l.cardLabelY, m.fontBody);
     _tft.setTextColor(COLOR_SUCCESS);
-    _tft.drawString(String(duration) + " minutes", SCREEN_WIDTH/2, 100, 4);
+    _tft.drawString(String(duration) + " minutes", l.card.cx(), l.cardValueY, m.fontTitle);
 
     _tft.setTextColor(COLOR_TEXT_MUTED);
-    _tft.drawString("Starts immediately", SCREEN_WIDTH/2, 145, 2);
+    _tft.drawString("Starts immediately", l.card.cx(), l.noteY, m.fontBody);
 
     // Buttons
-    int btnY = SCREEN_HEIGHT - 55;
-    drawButton(12, btnY, 145, 45, "Cancel", COLOR_CARD_BG, COLOR_TEXT);
-    addButton(12, btnY, 145, 45, "Cancel");
+    drawButton(l.leftButton, "Cancel", COLOR_CARD_BG, COLOR_TEXT);
+    addButton(l.leftButton, "Cancel");
 
-    drawButton(163, btnY, 145, 45, "Confirm", COLOR_SUCCESS, COLOR_TEXT);
-    addButton(163, btnY, 145, 45, "Confirm");
+    drawButton(l.rightButton, "Confirm", COLOR_SUCCESS, COLOR_TEXT);
+    addButton(l.rightButton, "Confirm");
 }
 
 void UIManager::showEndMeetingConfirm() {
+    TRACE_SCOPE("ui.endMeetingConfirm");
     _currentState = UI_END_MEETING_CONFIRM;
     clearButtons();
 
+    const LayoutMetrics& m = _layout.metrics;
+    const ConfirmLayout& l = _layout.confirm;
     _tft.fillScreen(COLOR_BG);
 
     drawHeader("End Meeting", COLOR_DANGER);
 
     _tft.setTextColor(COLOR_TEXT);
     _tft.setTextDatum(MC_DATUM);
-    _tft.drawString("End meeting early?", SCREEN_WIDTH/2, 110, 4);
+    _tft.drawString("End meeting early?", m.width/2, l.line1Y, m.fontTitle);
     _tft.setTextColor(COLOR_TEXT_MUTED);
-    _tft.drawString("The room will be freed", SCREEN_WIDTH/2, 150, 2);
-    _tft.drawString("immediately for others.", SCREEN_WIDTH/2, 170, 2);
+    _tft.drawString("The room will be freed", m.width/2, l.line2Y, m.fontBody);
+    _tft.drawString("immediately for others.", m.width/2, l.line3Y, m.fontBody);
 
-    int btnY = SCREEN_HEIGHT - 55;
-    drawButton(12, btnY, 145, 45, "Cancel", COLOR_CARD_BG, COLOR_TEXT);
-    addButton(12, btnY, 145, 45, "Cancel");
+    drawButton(l.leftButton, "Cancel", COLOR_CARD_BG, COLOR_TEXT);
+    addButton(l.leftButton, "Cancel");
 
-    drawButton(163, btnY, 145, 45, "End Meeting", COLOR_DANGER, COLOR_TEXT);
-    addButton(163, btnY, 145, 45, "End Meeting");
+    drawButton(l.rightButton, "End Meeting", COLOR_DANGER, COLOR_TEXT);
+    addButton(l.rightButton, "End Meeting");
 }
 
 void UIManager::showBookingResult(bool success, const String& message) {
+    TRACE_SCOPE("ui.bookingResult");
     clearButtons();
 
+    const LayoutMetrics& m = _layout.metrics;
+    const MessageLayout& l = _layout.message;
     _tft.fillScreen(COLOR_BG);
 
     // Result indicator
     uint16_t indicatorColor = success ? COLOR_SUCCESS : COLOR_DANGER;
-    _tft.fillCircle(SCREEN_WIDTH/2, 70, 35, indicatorColor);
+    _tft.fillCircle(l.iconX, l.iconY, l.iconRadius, indicatorColor);
     _tft.setTextColor(COLOR_TEXT);
     _tft.setTextDatum(MC_DATUM);
-    _tft.drawString(success ? "OK" : "!", SCREEN_WIDTH/2, 70, 4);
+    _tft.drawString(success ? "OK" : "!", l.iconX, l.iconY, m.fontTitle);
 
     _tft.setTextColor(COLOR_TEXT);
-    _tft.drawString(success ? "Booked!" : "Error", SCREEN_WIDTH/2, 125, 4);
+    _tft.drawString(success ? "Booked!" : "Error", l.iconX, l.headingY, m.fontTitle);
 
     // Message
     _tft.setTextColor(COLOR_TEXT_MUTED);
-    int y = 160;
-    String msg = message;
-    while (msg.length() > 0 && y < 200) {
-        int maxChars = 35;
-        String line = msg.substring(0, min((int)msg.length(), maxChars));
-        if (msg.length() > maxChars) {
-            int lastSpace = line.lastIndexOf(' ');
-            if (lastSpace > 0) {
-                line = msg.substring(0, lastSpace);
-                msg = msg.substring(lastSpace + 1);
-            } else {
-                msg = msg.substring(maxChars);
-            }
-        } else {
-            msg = "";
-        }
-        _tft.drawString(line, SCREEN_WIDTH/2, y, 2);
-        y += 20;
-    }
+    drawWrappedMessage(message);
 
-    drawButton(SCREEN_WIDTH/2 - 60, SCREEN_HEIGHT - 50, 120, 40, "OK", COLOR_PRIMARY, COLOR_TEXT);
-    addButton(SCREEN_WIDTH/2 - 60, SCREEN_HEIGHT - 50, 120, 40, "OK");
+    drawButton(l.button, "OK", COLOR_PRIMARY, COLOR_TEXT);
+    addButton(l.button, "OK");
 }
 
 void UIManager::showError(const String& message, const String& buttonLabel) {
+    TRACE_SCOPE("ui.error");
     _currentState = UI_ERROR;
     clearButtons();
 
+    const LayoutMetrics& m = _layout.metrics;
+    const MessageLayout& l = _layout.message;
     _tft.fillScreen(COLOR_BG);
 
     // Error indicator
-    _tft.fillCircle(SCREEN_WIDTH/2, 70, 35, COLOR_DANGER);
+    _tft.fillCircle(l.iconX, l.iconY, l.iconRadius, COLOR_DANGER);
     _tft.setTextColor(COLOR_TEXT);
     _tft.setTextDatum(MC_DATUM);
-    _tft.drawString("!", SCREEN_WIDTH/2, 70, 4);
+    _tft.drawString("!", l.iconX, l.iconY, m.fontTitle);
 
     _tft.setTextColor(COLOR_TEXT);
-    _tft.drawString("Error", SCREEN_WIDTH/2, 125, 4);
+    _tft.drawString("Error", l.iconX, l.headingY, m.fontTitle);
 
     // Message
     _tft.setTextColor(COLOR_TEXT_MUTED);
-    int y = 160;
-    String msg = message;
-    while (msg.length() > 0 && y < 200) {
-        int maxChars = 35;
-        String line = msg.substring(0, min((int)msg.length(), maxChars));
-        if (msg.length() > maxChars) {
-            int lastSpace = line.lastIndexOf(' ');
-            if (lastSpace > 0) {
-                line = msg.substring(0, lastSpace);
-                msg = msg.substring(lastSpace + 1);
-            } else {
-                msg = msg.substring(maxChars);
-            }
-        } else {
-            msg = "";
-        }
-        _tft.drawString(line, SCREEN_WIDTH/2, y, 2);
-        y += 20;
-    }
+    drawWrappedMessage(message);
 
-    drawButton(SCREEN_WIDTH/2 - 60, SCREEN_HEIGHT - 50, 120, 40, buttonLabel, COLOR_PRIMARY, COLOR_TEXT);
-    addButton(SCREEN_WIDTH/2 - 60, SCREEN_HEIGHT - 50, 120, 40, buttonLabel);
+    drawButton(l.button, buttonLabel, COLOR_PRIMARY, COLOR_TEXT);
+    addButton(l.button, buttonLabel);
 }
 
 void UIManager::showLoading(const String& message) {
+    TRACE_SCOPE("ui.loading");
     _currentState = UI_LOADING;
     clearButtons();
 
+    const LoadingLayout& l = _layout.loading;
     _tft.fillScreen(COLOR_BG);
 
     // Loading spinner area
-    _tft.drawCircle(SCREEN_WIDTH/2, SCREEN_HEIGHT/2 - 20, 25, COLOR_PRIMARY);
-    _tft.drawCircle(SCREEN_WIDTH/2, SCREEN_HEIGHT/2 - 20, 20, COLOR_CARD_BG);
+    _tft.drawCircle(l.cx, l.cy, l.outerRadius, COLOR_PRIMARY);
+    _tft.drawCircle(l.cx, l.cy, l.innerRadius, COLOR_CARD_BG);
 
     // Spinner dot
-    _tft.fillCircle(SCREEN_WIDTH/2, SCREEN_HEIGHT/2 - 45, 5, COLOR_ACCENT);
+    _tft.fillCircle(l.cx, l.cy - l.outerRadius, l.dotRadius, COLOR_ACCENT);
 
     _tft.setTextColor(COLOR_TEXT);
     _tft.setTextDatum(MC_DATUM);
-    _tft.drawString(message, SCREEN_WIDTH/2, SCREEN_HEIGHT/2 + 30, 2);
+    _tft.drawString(message, l.cx, l.messageY, _layout.metrics.fontBody);
 }
 
 void UIManager::showConnecting() {
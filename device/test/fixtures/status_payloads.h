@@ -0,0 +1,26 @@
+#ifndef STATUS_PAYLOADS_H
+#define STATUS_PAYLOADS_H
+
+// /api/device/status responses recorded from the backend (tokens and ids anonymised).
+// Shared by the host tests and benchmarks.
+
+// Available room, nothing booked
+static const char STATUS_SMALL[] = R"JSON({"room":{"id":"3f1c2a9e-6b1d-4d0e-9a51-0c2b8f7e4a11","name":"Fjord","capacity":4,"amenities":[],"floor":"2","address":"","description":"","isActive":true,"parkId":"default","openingHour":null,"closingHour":null,"lockedToCompanyIds":[],"quickBookDurations":[30,60,90,120],"bookingEmail":null,"createdAt":"2025-01-10T08:00:00.000Z","updatedAt":"2025-01-10T08:00:00.000Z"},"currentBooking":null,"upcomingBookings":[],"isAvailable":true})JSON";
+
+// Occupied by a quick booking from the panel, three meetings coming up
+static const char STATUS_TYPICAL[] = R"JSON({"room":{"id":"8d2b6c1f-0e3a-4f5b-b7c9-1a2d3e4f5a6b","name":"Boardroom","capacity":12,"amenities":["projector","whiteboard","video"],"floor":"5","address":"Main St 1","description":"Large boardroom","isActive":true,"parkId":"default","openingHour":7,"closingHour":19,"lockedToCompanyIds":[],"quickBookDurations":[15,30,45,60],"bookingEmail":null,"createdAt":"2025-01-10T08:00:00.000Z","updatedAt":"2025-03-02T12:40:11.000Z"},"currentBooking":{"id":"b1a0c3d2-1111-4a4a-9c9c-000000000001","roomId":"8d2b6c1f-0e3a-4f5b-b7c9-1a2d3e4f5a6b","userId":"device-booking-user","title":"Quick Booking","description":"Quick booking from Boardroom door","startTime":"2025-03-12T09:05:00.000Z","endTime":"2025-03-12T09:35:00.000Z","attendees":[],"externalGuests":"[]","status":"confirmed","createdAt":"2025-03-12T09:03:12.512Z","updatedAt":"2025-03-12T09:03:12.512Z","room":{"id":"8d2b6c1f-0e3a-4f5b-b7c9-1a2d3e4f5a6b","name":"Boardroom","capacity":12,"amenities":["projector","whiteboard","video"],"floor":"5","quickBookDurations":[15,30,45,60]},"isDeviceBooking":true},"upcomingBookings":[{"id":"b1a0c3d2-2222-4a4a-9c9c-000000000002","roomId":"8d2b6c1f-0e3a-4f5b-b7c9-1a2d3e4f5a6b","userId":"u-42","title":"Weekly sync","description":"","startTime":"2025-03-12T10:00:00.000Z","endTime":"2025-03-12T11:00:00.000Z","attendees":["anna@example.com","ben@example.com"],"externalGuests":"[]","status":"confirmed","createdAt":"2025-03-01T10:00:00.000Z","updatedAt":"2025-03-01T10:00:00.000Z","room":{"id":"8d2b6c1f-0e3a-4f5b-b7c9-1a2d3e4f5a6b","name":"Boardroom","capacity":12,"amenities":["projector","whiteboard","video"],"floor":"5","quickBookDurations":[15,30,45,60]}},{"id":"b1a0c3d2-3333-4a4a-9c9c-000000000003","roomId":"8d2b6c1f-0e3a-4f5b-b7c9-1a2d3e4f5a6b","userId":"u-7","title":"Design review","description":"","startTime":"2025-03-12T12:30:00.000Z","endTime":"2025-03-12T13:30:00.000Z","attendees":["carl@example.com"],"externalGuests":"[]","status":"confirmed","createdAt":"2025-03-05T15:20:00.000Z","updatedAt":"2025-03-05T15:20:00.000Z","room":{"id":"8d2b6c1f-0e3a-4f5b-b7c9-1a2d3e4f5a6b","name":"Boardroom","capacity":12,"amenities":["projector","whiteboard","video"],"floor":"5","quickBookDurations":[15,30,45,60]}},{"id":"b1a0c3d2-4444-4a4a-9c9c-000000000004","roomId":"8d2b6c1f-0e3a-4f5b-b7c9-1a2d3e4f5a6b","userId":"u-9","title":"Interview","description":"","startTime":"2025-03-12T15:00:00.000Z","endTime":"2025-03-12T15:45:00.000Z","attendees":[],"externalGuests":"[]","status":"confirmed","createdAt":"2025-03-10T09:00:00.000Z","updatedAt":"2025-03-10T09:00:00.000Z","room":{"id":"8d2b6c1f-0e3a-4f5b-b7c9-1a2d3e4f5a6b","name":"Boardroom","capacity":12,"amenities":["projector","whiteboard","video"],"floor":"5","quickBookDurations":[15,30,45,60]}}],"isAvailable":false})JSON";
+
+// Busy room booked from the web app: long titles, many attendees, non-ASCII text
+static const char STATUS_LARGE[] = R"JSON({"room":{"id":"c0ffee00-aaaa-4bbb-8ccc-ddddeeeeffff","name":"Großer Saal – Nord","capacity":40,"amenities":["projector","whiteboard","video","conference phone","wheelchair access","catering","hearing loop","standing desks"],"floor":"Ground floor, east wing","address":"Industrial Park 12, Building C","description":"Main event room. Book at least two days ahead for catering. The back partition can be opened for all-hands meetings of up to 80 people.","isActive":true,"parkId":"park-berlin","openingHour":6,"closingHour":22,"lockedToCompanyIds":["comp-1","comp-2","comp-3"],"quickBookDurations":[30,60,90,120],"bookingEmail":"grosser-saal@rooms.example.com","createdAt":"2024-11-02T08:00:00.000Z","updatedAt":"2025-02-28T16:12:45.000Z"},"currentBooking":{"id":"e7e7e7e7-0001-4000-8000-000000000001","roomId":"c0ffee00-aaaa-4bbb-8ccc-ddddeeeeffff","userId":"u-1001","title":"Quarterly business review with regional sales leads and finance – Q1 planning","description":"Agenda: pipeline, forecast, hiring plan, budget reallocation, open questions from the last QBR and action item review.","startTime":"2025-03-12T08:00:00.000Z","endTime":"2025-03-12T11:30:00.000Z","attendees":["a.schmidt@example.com","b.meyer@example.com","c.wagner@example.com","d.becker@example.com","e.hoffmann@example.com","f.schulz@example.com","g.koch@example.com","h.richter@example.com","i.klein@example.com","j.wolf@example.com","k.neumann@example.com","l.schwarz@example.com"],"externalGuests":"[{\"name\":\"Jane Doe\",\"email\":\"jane@partner.example\",\"company\":\"Partner GmbH\"}]","status":"confirmed","createdAt":"2025-02-20T10:00:00.000Z","updatedAt":"2025-03-11T17:45:00.000Z","room":{"id":"c0ffee00-aaaa-4bbb-8ccc-ddddeeeeffff","name":"Großer Saal – Nord","capacity":40,"amenities":["projector","whiteboard","video","conference phone","wheelchair access","catering","hearing loop","standing desks"],"floor":"Ground floor, east wing","quickBookDurations":[30,60,90,120]},"isDeviceBooking":false},"upcomingBookings":[{"id":"e7e7e7e7-0002-4000-8000-000000000002","roomId":"c0ffee00-aaaa-4bbb-8ccc-ddddeeeeffff","userId":"u-1002","title":"All-hands: product roadmap 2025 and Q&A with leadership (hybrid, dial-in in invite)","description":"Hybrid event.","startTime":"2025-03-12T12:00:00.000Z","endTime":"2025-03-12T13:30:00.000Z","attendees":["all@example.com","remote@example.com","leads@example.com","office@example.com","it@example.com","facilities@example.com"],"externalGuests":"[]","status":"confirmed","createdAt":"2025-02-01T10:00:00.000Z","updatedAt":"2025-03-10T08:00:00.000Z","room":{"id":"c0ffee00-aaaa-4bbb-8ccc-ddddeeeeffff","name":"Großer Saal – Nord","capacity":40,"amenities":["projector","whiteboard","video","conference phone","wheelchair access","catering","hearing loop","standing desks"],"floor":"Ground floor, east wing","quickBookDurations":[30,60,90,120]}},{"id":"e7e7e7e7-0003-4000-8000-000000000003","roomId":"c0ffee00-aaaa-4bbb-8ccc-ddddeeeeffff","userId":"u-1003","title":"Kundenworkshop: Einführung neue Plattform – Teil 2 (Übungen)","description":"","startTime":"2025-03-12T14:00:00.000Z","endTime":"2025-03-12T17:00:00.000Z","attendees":["m.fischer@example.com","n.weber@example.com","o.bauer@example.com"],"externalGuests":"[{\"name\":\"Max Mustermann\",\"email\":\"max@kunde.example\",\"company\":\"Kunde AG\"},{\"name\":\"Erika Musterfrau\",\"email\":\"erika@kunde.example\",\"company\":\"Kunde AG\"}]","status":"confirmed","createdAt":"2025-02-15T10:00:00.000Z","updatedAt":"2025-02-15T10:00:00.000Z","room":{"id":"c0ffee00-aaaa-4bbb-8ccc-ddddeeeeffff","name":"Großer Saal – Nord","capacity":40,"amenities":["projector","whiteboard","video","conference phone","wheelchair access","catering","hearing loop","standing desks"],"floor":"Ground floor, east wing","quickBookDurations":[30,60,90,120]}},{"id":"e7e7e7e7-0004-4000-8000-000000000004","roomId":"c0ffee00-aaaa-4bbb-8ccc-ddddeeeeffff","userId":"u-1004","title":"Evening meetup","description":"","startTime":"2025-03-12T18:00:00.000Z","endTime":"2025-03-12T21:00:00.000Z","attendees":[],"externalGuests":"[]","status":"confirmed","createdAt":"2025-03-01T10:00:00.000Z","updatedAt":"2025-03-01T10:00:00.000Z","room":{"id":"c0ffee00-aaaa-4bbb-8ccc-ddddeeeeffff","name":"Großer Saal – Nord","capacity":40,"amenities":["projector","whiteboard","video","conference phone","wheelchair access","catering","hearing loop","standing desks"],"floor":"Ground floor, east wing","quickBookDurations":[30,60,90,120]}}],"isAvailable":false})JSON";
+
+// STATUS_TYPICAL for firmware that caches the room (sent X-Room-Version):
+// no room, slim bookings
+static const char STATUS_DYNAMIC[] = R"JSON({"roomVersion":"5e0c3a91d2b7f468","currentBooking":{"id":"b1a0c3d2-1111-4a4a-9c9c-000000000001","title":"Quick Booking","startTime":"2025-03-12T09:05:00.000Z","endTime":"2025-03-12T09:35:00.000Z","isDeviceBooking":true},"upcomingBookings":[{"id":"b1a0c3d2-2222-4a4a-9c9c-000000000002","title":"Weekly sync","startTime":"2025-03-12T10:00:00.000Z","endTime":"2025-03-12T10:30:00.000Z"}],"isAvailable":false,"openingHour":7,"closingHour":19})JSON";
+
+// /api/device/info for the room in STATUS_DYNAMIC
+static const char INFO_TYPICAL[] = R"JSON({"deviceName":"Boardroom door","room":{"id":"8d2b6c1f-0e3a-4f5b-b7c9-1a2d3e4f5a6b","name":"Boardroom","capacity":12,"amenities":["projector","whiteboard","video"],"floor":"5","address":"Main St 1","description":"Large boardroom","isActive":true,"parkId":"default","openingHour":7,"closingHour":19,"lockedToCompanyIds":[],"quickBookDurations":[15,30,45,60],"bookingEmail":null,"createdAt":"2025-01-10T08:00:00.000Z","updatedAt":"2025-03-02T12:40:11.000Z"},"roomVersion":"5e0c3a91d2b7f468"})JSON";
+
+// Rejected token
+static const char STATUS_ERROR[] = R"JSON({"error":"Invalid or inactive device token"})JSON";
+
+#endif // STATUS_PAYLOADS_H
@@ -0,0 +1,313 @@
+#include <unity.h>
+#include <ArduinoJson.h>
+#include "api_client.h"
+#include "config.h"
+#include "../fixtures/status_payloads.h"
+
+void setUp() {}
+void tearDown() {}
+
+void test_parse_small_status() {
+    RoomStatus status = ApiClient::parseRoomStatus(STATUS_SMALL);
+
+    TEST_ASSERT_TRUE(status.isValid);
+    TEST_ASSERT_TRUE(status.isAvailable);
+    TEST_ASSERT_EQUAL_STRING("Fjord", status.room.name.c_str());
+    TEST_ASSERT_EQUAL(4, status.room.capacity);
+    TEST_ASSERT_EQUAL_STRING("2", status.room.floor.c_str());
+    TEST_ASSERT_FALSE(status.currentBooking.isValid);
+    TEST_ASSERT_EQUAL(0, status.upcomingCount);
+
+    TEST_ASSERT_EQUAL(4, status.room.quickBookDurationCount);
+    TEST_ASSERT_EQUAL(30, status.room.quickBookDurations[0]);
+    TEST_ASSERT_EQUAL(120, status.room.quickBookDurations[3]);
+}
+
+void test_parse_typical_status() {
+    RoomStatus status = ApiClient::parseRoomStatus(STATUS_TYPICAL);
+
+    TEST_ASSERT_TRUE(status.isValid);
+    TEST_ASSERT_FALSE(status.isAvailable);
+    TEST_ASSERT_EQUAL_STRING("Boardroom", status.room.name.c_str());
+    TEST_ASSERT_EQUAL(12, status.room.capacity);
+
+    TEST_ASSERT_TRUE(status.currentBooking.isValid);
+    TEST_ASSERT_TRUE(status.currentBooking.isDeviceBooking);
+    TEST_ASSERT_EQUAL_STRING("Quick Booking", status.currentBooking.title.c_str());
+    TEST_ASSERT_EQUAL_STRING("2025-03-12T09:35:00.000Z", status.currentBooking.endTime.c_str());
+
+    TEST_ASSERT_EQUAL(3, status.upcomingCount);
+    TEST_ASSERT_EQUAL_STRING("Weekly sync", status.upcomingBookings[0].title.c_str());
+    TEST_ASSERT_EQUAL_STRING("Interview", status.upcomingBookings[2].title.c_str());
+    TEST_ASSERT_FALSE(status.upcomingBookings[0].isDeviceBooking);
+
+    TEST_ASSERT_EQUAL(4, status.room.quickBookDurationCount);
+    TEST_ASSERT_EQUAL(15, status.room.quickBookDurations[0]);
+    TEST_ASSERT_EQUAL(60, status.room.quickBookDurations[3]);
+}
+
+void test_parse_large_status() {
+    RoomStatus status = ApiClient::parseRoomStatus(STATUS_LARGE);
+
+    TEST_ASSERT_TRUE(status.isValid);
+    TEST_ASSERT_FALSE(status.isAvailable);
+    TEST_ASSERT_EQUAL_STRING("Großer Saal – Nord", status.room.name.c_str());
+    TEST_ASSERT_TRUE(status.currentBooking.isValid);
+    TEST_ASSERT_FALSE(status.currentBooking.isDeviceBooking);
+    TEST_ASSERT_EQUAL(3, status.upcomingCount);
+    TEST_ASSERT_EQUAL_STRING("Kundenworkshop: Einführung neue Plattform – Teil 2 (Übungen)",
+                             status.upcomingBookings[1].title.c_str());
+}
+
+void test_parse_error_response() {
+    RoomStatus status = ApiClient::parseRoomStatus(STATUS_ERROR);
+
+    TEST_ASSERT_FALSE(status.isValid);
+    TEST_ASSERT_EQUAL_STRING("Invalid or inactive device token", status.errorMessage.c_str());
+}
+
+void test_parse_truncated_response() {
+    String truncated = String(STATUS_TYPICAL).substring(0, 200);
+    RoomStatus status = ApiClient::parseRoomStatus(truncated);
+
+    TEST_ASSERT_FALSE(status.isValid);
+    TEST_ASSERT_EQUAL_STRING("Invalid response from server", status.errorMessage.c_str());
+}
+
+void test_parse_opening_hours() {
+    RoomStatus status = ApiClient::parseRoomStatus(
+        "{\"room\":{\"id\":\"r1\",\"name\":\"Nook\"},\"upcomingBookings\":[],"
+        "\"isAvailable\":true,\"openingHour\":7,\"closingHour\":19}");
+
+    TEST_ASSERT_EQUAL(7, status.openingHour);
+    TEST_ASSERT_EQUAL(19, status.closingHour);
+}
+
+void test_parse_without_opening_hours() {
+    // Servers before the hours were added to /status
+    RoomStatus status = ApiClient::parseRoomStatus(STATUS_TYPICAL);
+
+    TEST_ASSERT_EQUAL(-1, status.openingHour);
+    TEST_ASSERT_EQUAL(-1, status.closingHour);
+}
+
+void test_parse_runtime_config() {
+    RoomStatus status = ApiClient::parseRoomStatus(
+        "{\"room\":{\"id\":\"r1\",\"name\":\"Nook\"},\"upcomingBookings\":[],\"isAvailable\":true,"
+        "\"config\":{\"version\":4,\"statusPollSeconds\":90}}");
+
+    TEST_ASSERT_TRUE(status.isValid);
+    TEST_ASSERT_TRUE(status.hasConfig);
+    TEST_ASSERT_EQUAL_UINT32(4, status.config.version);
+    TEST_ASSERT_EQUAL_UINT32(90000, status.config.statusPollMs);
+}
+
+void test_parse_bad_runtime_config_keeps_status() {
+    RoomStatus status = ApiClient::parseRoomStatus(
+        "{\"room\":{\"id\":\"r1\",\"name\":\"Nook\"},\"upcomingBookings\":[],\"isAvailable\":true,"
+        "\"config\":{\"version\":4,\"statusPollSeconds\":1}}");
+
+    TEST_ASSERT_TRUE(status.isValid);
+    TEST_ASSERT_FALSE(status.hasConfig);
+}
+
+void test_parse_missing_room() {
+    RoomStatus status = ApiClient::parseRoomStatus("{\"isAvailable\":true,\"upcomingBookings\":[]}");
+
+    TEST_ASSERT_FALSE(status.isValid);
+    TEST_ASSERT_FALSE(status.room.isValid);
+}
+
+void test_parse_room_defaults() {
+    JsonDocument doc;
+    deserializeJson(doc, "{\"id\":\"r1\",\"name\":\"Nook\"}");
+    JsonObject obj = doc.as<JsonObject>();
+    Room room = ApiClient::parseRoom(obj);
+
+    TEST_ASSERT_TRUE(room.isValid);
+    TEST_ASSERT_EQUAL(0, room.capacity);
+    TEST_ASSERT_EQUAL(4, room.quickBookDurationCount);
+    TEST_ASSERT_EQUAL(30, room.quickBookDurations[0]);
+    TEST_ASSERT_EQUAL(60, room.quickBookDurations[1]);
+    TEST_ASSERT_EQUAL(90, room.quickBookDurations[2]);
+    TEST_ASSERT_EQUAL(120, room.quickBookDurations[3]);
+}
+
+void test_parse_room_caps_durations() {
+    JsonDocument doc;
+    deserializeJson(doc, "{\"id\":\"r1\",\"quickBookDurations\":[10,20,30,40,50,60]}");
+    JsonObject obj = doc.as<JsonObject>();
+    Room room = ApiClient::parseRoom(obj);
+
+    TEST_ASSERT_EQUAL(4, room.quickBookDurationCount);
+    TEST_ASSERT_EQUAL(40, room.quickBookDurations[3]);
+}
+
+void test_parse_booking_null() {
+    JsonObject obj;
+    Booking booking = ApiClient::parseBooking(obj);
+
+    TEST_ASSERT_FALSE(booking.isValid);
+}
+
+void test_parse_booking_without_id() {
+    JsonDocument doc;
+    deserializeJson(doc, "{\"title\":\"Ghost\"}");
+    JsonObject obj = doc.as<JsonObject>();
+    Booking booking = ApiClient::parseBooking(obj);
+
+    TEST_ASSERT_FALSE(booking.isValid);
+    TEST_ASSERT_FALSE(booking.isDeviceBooking);
+}
+
+void test_statuses_equal_for_same_payload() {
+    RoomStatus a = ApiClient::parseRoomStatus(STATUS_TYPICAL);
+    RoomStatus b = ApiClient::parseRoomStatus(STATUS_TYPICAL);
+
+    TEST_ASSERT_TRUE(roomStatusesAreEqual(a, b));
+}
+
+void test_statuses_differ_on_availability() {
+    RoomStatus a = ApiClient::parseRoomStatus(STATUS_TYPICAL);
+    RoomStatus b = a;
+    b.isAvailable = !a.isAvailable;
+
+    TEST_ASSERT_FALSE(roomStatusesAreEqual(a, b));
+}
+
+void test_statuses_differ_on_upcoming() {
+    RoomStatus a = ApiClient::parseRoomStatus(STATUS_TYPICAL);
+    RoomStatus b = a;
+    b.upcomingBookings[1].id = "changed";
+    TEST_ASSERT_FALSE(roomStatusesAreEqual(a, b));
+
+    RoomStatus c = a;
+    c.upcomingCount = 2;
+    TEST_ASSERT_FALSE(roomStatusesAreEqual(a, c));
+}
+
+void test_statuses_invalid_never_equal() {
+    RoomStatus a = ApiClient::parseRoomStatus(STATUS_ERROR);
+
+    TEST_ASSERT_FALSE(roomStatusesAreEqual(a, a));
+}
+
+void test_unconfigured_client_reports_connection_failure() {
+    ApiClient client;
+    RoomStatus status = client.getRoomStatus();
+
+    TEST_ASSERT_FALSE(status.isValid);
+    TEST_ASSERT_EQUAL_STRING("Failed to connect to server", status.errorMessage.c_str());
+}
+
+void test_api_url_trailing_slash_removed() {
+    ApiClient client;
+    client.setApiUrl("http://10.0.0.5:3001/");
+
+    TEST_ASSERT_EQUAL_STRING("http://10.0.0.5:3001", client.getApiUrl().c_str());
+    TEST_ASSERT_EQUAL_STRING("http://10.0.0.5:3001/api/device/firmware/download/1.2.0",
+                             client.getFirmwareDownloadUrl("1.2.0").c_str());
+}
+
+void test_parse_dynamic_status() {
+    RoomStatus status = ApiClient::parseRoomStatus(STATUS_DYNAMIC);
+
+    // Valid without a room; the client fills it in from its cache
+    TEST_ASSERT_TRUE(status.isValid);
+    TEST_ASSERT_FALSE(status.room.isValid);
+    TEST_ASSERT_EQUAL_STRING("5e0c3a91d2b7f468", status.roomVersion.c_str());
+    TEST_ASSERT_FALSE(status.isAvailable);
+    TEST_ASSERT_TRUE(status.currentBooking.isDeviceBooking);
+    TEST_ASSERT_EQUAL(1, status.upcomingCount);
+}
+
+void test_room_info_round_trips_through_flash_json() {
+    ApiClient client;
+    TEST_ASSERT_TRUE(client.loadRoomInfo(INFO_TYPICAL));
+
+    Room room;
+    String version;
+    TEST_ASSERT_TRUE(ApiClient::parseRoomInfo(client.roomInfoJson(), room, version));
+    TEST_ASSERT_EQUAL_STRING("5e0c3a91d2b7f468", version.c_str());
+    TEST_ASSERT_EQUAL_STRING("Boardroom", room.name.c_str());
+    TEST_ASSERT_EQUAL(12, room.capacity);
+    TEST_ASSERT_EQUAL(4, room.quickBookDurationCount);
+    TEST_ASSERT_EQUAL(45, room.quickBookDurations[2]);
+}
+
+void test_room_info_rejected_without_version() {
+    ApiClient client;
+    TEST_ASSERT_FALSE(client.loadRoomInfo("{\"room\":{\"id\":\"r-1\",\"name\":\"A\"}}"));
+    TEST_ASSERT_FALSE(client.loadRoomInfo(""));
+    TEST_ASSERT_EQUAL_STRING("", client.roomInfoJson().c_str());
+}
+
+// A status pushed over MQTT uses the cached room and becomes the cached status
+void test_pushed_status_uses_cached_room() {
+    ApiClient client;
+    TEST_ASSERT_TRUE(client.loadRoomInfo(INFO_TYPICAL));
+
+    RoomStatus status = client.pushRoomStatus(STATUS_DYNAMIC);
+    TEST_ASSERT_TRUE(status.isValid);
+    TEST_ASSERT_EQUAL_STRING("Boardroom", status.room.name.c_str());
+    TEST_ASSERT_FALSE(client.takeRoomInfoChanged());
+
+    RoomStatus reused = client.getRoomStatus(60000);
+    TEST_ASSERT_TRUE(reused.isValid);
+    TEST_ASSERT_EQUAL(status.fetchedAt, reused.fetchedAt);
+    TEST_ASSERT_EQUAL_UINT32(1, client.statusRequestsSaved());
+}
+
+// Another panel may have relayed it: only our own request changes the config
+void test_pushed_status_never_carries_config() {
+    const char* body =
+        "{\"room\":{\"id\":\"r1\",\"name\":\"Nook\"},\"upcomingBookings\":[],\"isAvailable\":true,"
+        "\"config\":{\"version\":4,\"apiUrls\":[\"http://10.0.0.66:3001\"]}}";
+    TEST_ASSERT_TRUE(ApiClient::parseRoomStatus(body).hasConfig);
+
+    ApiClient client;
+    RoomStatus status = client.pushRoomStatus(body);
+    TEST_ASSERT_TRUE(status.isValid);
+    TEST_ASSERT_FALSE(status.hasConfig);
+}
+
+void test_parse_hint_seconds() {
+    TEST_ASSERT_EQUAL(30, ApiClient::parseHintSeconds("30"));
+    TEST_ASSERT_EQUAL(0, ApiClient::parseHintSeconds(""));
+    TEST_ASSERT_EQUAL(0, ApiClient::parseHintSeconds("soon"));
+    TEST_ASSERT_EQUAL(0, ApiClient::parseHintSeconds("-5"));
+    // HTTP-date form isn't supported
+    TEST_ASSERT_EQUAL(0, ApiClient::parseHintSeconds("Wed, 21 Oct 2015 07:28:00 GMT"));
+    TEST_ASSERT_EQUAL(SERVER_HINT_MAX_S, ApiClient::parseHintSeconds("99999999999"));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_small_status);
+    RUN_TEST(test_parse_typical_status);
+    RUN_TEST(test_parse_large_status);
+    RUN_TEST(test_parse_error_response);
+    RUN_TEST(test_parse_truncated_response);
+    RUN_TEST(test_parse_opening_hours);
+    RUN_TEST(test_parse_without_opening_hours);
+    RUN_TEST(test_parse_runtime_config);
+    RUN_TEST(test_parse_bad_runtime_config_keeps_status);
+    RUN_TEST(test_parse_missing_room);
+    RUN_TEST(test_parse_room_defaults);
+    RUN_TEST(test_parse_room_caps_durations);
+    RUN_TEST(test_parse_booking_null);
+    RUN_TEST(test_parse_booking_without_id);
+    RUN_TEST(test_statuses_equal_for_same_payload);
+    RUN_TEST(test_statuses_differ_on_availability);
+    RUN_TEST(test_statuses_differ_on_upcoming);
+    RUN_TEST(test_statuses_invalid_never_equal);
+    RUN_TEST(test_unconfigured_client_reports_connection_failure);
+    RUN_TEST(test_api_url_trailing_slash_removed);
+    RUN_TEST(test_parse_dynamic_status);
+    RUN_TEST(test_room_info_round_trips_through_flash_json);
+    RUN_TEST(test_room_info_rejected_without_version);
+    RUN_TEST(test_pushed_status_uses_cached_room);
+    RUN_TEST(test_pushed_status_never_carries_config);
+    RUN_TEST(test_parse_hint_seconds);
+    return UNITY_END();
+}
@@ -0,0 +1,441 @@
+#include <unity.h>
+#include <ArduinoJson.h>
+#include <mock_device_api.h>
+#include <thread>
+#include "api_client.h"
+#include "../fixtures/status_payloads.h"
+
+static const char* TOKEN = "test-device-token";
+
+static MockDeviceApi server;
+static ApiClient client;
+
+void setUp() {
+    server.clearFaults();
+    server.clearLog();
+    server.requireToken(TOKEN);
+    server.setResponse("GET", "/status", 200, STATUS_TYPICAL);
+    server.setResponse("GET", "/ping", 200, "{\"status\":\"ok\",\"timestamp\":\"2025-03-12T09:00:00.000Z\"}");
+    server.setResponse("POST", "/quick-book", 201,
+        "{\"id\":\"b-1\",\"title\":\"Quick Booking\",\"startTime\":\"2025-03-12T09:00:00.000Z\",\"endTime\":\"2025-03-12T09:15:00.000Z\"}");
+
+    client.setApiUrl(server.url());
+    client.setDeviceToken(TOKEN);
+    client.invalidateStatus();
+}
+
+void tearDown() {}
+
+void test_status_served_from_fixture() {
+    RoomStatus status = client.getRoomStatus();
+
+    TEST_ASSERT_TRUE(status.isValid);
+    TEST_ASSERT_EQUAL_STRING("Boardroom", status.room.name.c_str());
+
+    std::vector<MockRequest> log = server.requests();
+    TEST_ASSERT_EQUAL(1, log.size());
+    TEST_ASSERT_EQUAL_STRING("GET", log[0].method.c_str());
+    TEST_ASSERT_EQUAL_STRING("/status", log[0].path.c_str());
+    TEST_ASSERT_EQUAL_STRING(TOKEN, log[0].deviceToken.c_str());
+}
+
+void test_wrong_token_rejected() {
+    client.setDeviceToken("revoked");
+
+    TEST_ASSERT_FALSE(client.ping());
+    TEST_ASSERT_EQUAL(401, HTTPClient::lastExchange().code);
+}
+
+void test_server_error_is_connection_failure() {
+    server.addFault("GET", "/status", MockFault::httpStatus(500));
+
+    RoomStatus status = client.getRoomStatus();
+
+    TEST_ASSERT_FALSE(status.isValid);
+    TEST_ASSERT_EQUAL_STRING("Failed to connect to server", status.errorMessage.c_str());
+    TEST_ASSERT_EQUAL(500, HTTPClient::lastExchange().code);
+}
+
+void test_overload_with_retry_after() {
+    server.addFault("*", "*", MockFault::httpStatus(429, 30));
+
+    QuickBookResult result = client.quickBook("Quick Booking", 15);
+
+    TEST_ASSERT_FALSE(result.success);
+    TEST_ASSERT_EQUAL(429, HTTPClient::lastExchange().code);
+    TEST_ASSERT_EQUAL(1, server.requestCount("POST", "/quick-book"));
+}
+
+void test_fault_consumed_after_times() {
+    MockFault fault = MockFault::httpStatus(503);
+    fault.times = 2;
+    server.addFault("GET", "/status", fault);
+
+    TEST_ASSERT_FALSE(client.getRoomStatus().isValid);
+    TEST_ASSERT_FALSE(client.getRoomStatus().isValid);
+    TEST_ASSERT_TRUE(client.getRoomStatus().isValid);
+
+    std::vector<MockRequest> log = server.requests();
+    TEST_ASSERT_EQUAL(3, log.size());
+    TEST_ASSERT_EQUAL(FAULT_STATUS, log[1].fault);
+    TEST_ASSERT_EQUAL(FAULT_NONE, log[2].fault);
+}
+
+void test_faults_apply_per_endpoint() {
+    server.addFault("GET", "/status", MockFault::reset());
+
+    TEST_ASSERT_TRUE(client.ping());
+    TEST_ASSERT_FALSE(client.getRoomStatus().isValid);
+}
+
+void test_truncated_body_rejected() {
+    server.addFault("GET", "/status", MockFault::truncate(200));
+
+    RoomStatus status = client.getRoomStatus();
+
+    TEST_ASSERT_FALSE(status.isValid);
+    TEST_ASSERT_EQUAL(HTTPC_ERROR_CONNECTION_LOST, HTTPClient::lastExchange().code);
+}
+
+void test_malformed_json_with_ok_status() {
+    String typical = STATUS_TYPICAL;
+    server.setResponse("GET", "/status", 200, typical.substring(0, typical.length() / 2));
+
+    RoomStatus status = client.getRoomStatus();
+
+    TEST_ASSERT_FALSE(status.isValid);
+    TEST_ASSERT_EQUAL(200, HTTPClient::lastExchange().code);
+}
+
+void test_connection_reset() {
+    server.addFault("GET", "/ping", MockFault::reset());
+
+    TEST_ASSERT_FALSE(client.ping());
+    TEST_ASSERT_TRUE(HTTPClient::lastExchange().code < 0);
+}
+
+void test_tls_failure() {
+    server.addFault("GET", "/status", MockFault::tlsAlert());
+
+    TEST_ASSERT_FALSE(client.getRoomStatus().isValid);
+    TEST_ASSERT_TRUE(HTTPClient::lastExchange().code < 0);
+}
+
+void test_latency_below_timeout() {
+    server.addFault("GET", "/status", MockFault::latency(150));
+
+    TEST_ASSERT_TRUE(client.getRoomStatus().isValid);
+    TEST_ASSERT_GREATER_OR_EQUAL(150000, HTTPClient::lastExchange().latencyUs);
+}
+
+void test_hang_hits_read_timeout() {
+    server.addFault("GET", "/status", MockFault::hang());
+
+    HTTPClient http;
+    http.begin(server.url() + "/api/device/status");
+    http.setTimeout(300);
+    http.addHeader("X-Device-Token", TOKEN);
+    int code = http.GET();
+
+    TEST_ASSERT_EQUAL(HTTPC_ERROR_READ_TIMEOUT, code);
+    TEST_ASSERT_UINT32_WITHIN(200000, 300000, HTTPClient::lastExchange().latencyUs);
+}
+
+void test_slowloris_outlasts_read_timeout() {
+    // The read timeout applies per read, so a server that keeps dripping
+    // bytes holds the client far longer than the timeout
+    server.addFault("GET", "/ping", MockFault::slowloris(16, 40));
+
+    HTTPClient http;
+    http.begin(server.url() + "/api/device/ping");
+    http.setTimeout(300);
+    http.addHeader("X-Device-Token", TOKEN);
+    int code = http.GET();
+
+    TEST_ASSERT_EQUAL(200, code);
+    TEST_ASSERT_GREATER_THAN(300000, HTTPClient::lastExchange().latencyUs);
+}
+
+void test_one_connection_per_request() {
+    client.getRoomStatus();
+    client.ping();
+    client.getRoomStatus();
+
+    TEST_ASSERT_EQUAL(3, server.requests().size());
+    TEST_ASSERT_EQUAL(3, server.connectionCount());
+}
+
+void test_fresh_status_reused() {
+    TEST_ASSERT_TRUE(client.getRoomStatus().isValid);
+    TEST_ASSERT_TRUE(client.getRoomStatus(5000).isValid);
+    TEST_ASSERT_EQUAL(1, server.requestCount("GET", "/status"));
+
+    // maxAgeMs 0 always asks the server
+    TEST_ASSERT_TRUE(client.getRoomStatus().isValid);
+    TEST_ASSERT_EQUAL(2, server.requestCount("GET", "/status"));
+}
+
+void test_failed_status_not_reused() {
+    MockFault fault = MockFault::httpStatus(503);
+    fault.times = 1;
+    server.addFault("GET", "/status", fault);
+
+    TEST_ASSERT_FALSE(client.getRoomStatus().isValid);
+    TEST_ASSERT_TRUE(client.getRoomStatus(5000).isValid);
+    TEST_ASSERT_EQUAL(2, server.requestCount("GET", "/status"));
+}
+
+void test_status_body_kept_for_relay() {
+    TEST_ASSERT_EQUAL_STRING("", client.statusBody().c_str());
+    TEST_ASSERT_TRUE(client.getRoomStatus().isValid);
+    TEST_ASSERT_EQUAL_STRING(STATUS_TYPICAL, client.statusBody().c_str());
+
+    // Nothing to relay once a failed poll or a booking made it stale
+    server.addFault("GET", "/status", MockFault::httpStatus(503));
+    TEST_ASSERT_FALSE(client.getRoomStatus().isValid);
+    TEST_ASSERT_EQUAL_STRING("", client.statusBody().c_str());
+    server.clearFaults();
+    TEST_ASSERT_TRUE(client.getRoomStatus().isValid);
+    TEST_ASSERT_TRUE(client.quickBook("Quick Booking", 15).success);
+    TEST_ASSERT_EQUAL_STRING("", client.statusBody().c_str());
+}
+
+void test_mutation_invalidates_fresh_status() {
+    client.getRoomStatus();
+    TEST_ASSERT_TRUE(client.quickBook("Quick Booking", 15).success);
+
+    TEST_ASSERT_TRUE(client.getRoomStatus(5000).isValid);
+    TEST_ASSERT_EQUAL(2, server.requestCount("GET", "/status"));
+}
+
+void test_concurrent_status_requests_coalesce() {
+    server.addFault("GET", "/status", MockFault::latency(300));
+    uint32_t savedBefore = client.statusRequestsSaved();
+
+    RoomStatus results[4];
+    std::vector<std::thread> callers;
+    for (int i = 0; i < 4; i++) {
+        callers.emplace_back([&results, i] { results[i] = client.getRoomStatus(); });
+        delay(20);
+    }
+    for (std::thread& t : callers) t.join();
+
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(results[i].isValid);
+        TEST_ASSERT_EQUAL_STRING("Boardroom", results[i].room.name.c_str());
+    }
+    TEST_ASSERT_EQUAL(1, server.requestCount("GET", "/status"));
+    TEST_ASSERT_EQUAL(3, client.statusRequestsSaved() - savedBefore);
+}
+
+void test_superseded_status_sent_again() {
+    MockFault fault = MockFault::latency(300);
+    fault.times = 1;
+    server.addFault("GET", "/status", fault);
+
+    RoomStatus status;
+    std::thread poll([&status] { status = client.getRoomStatus(); });
+    delay(100);
+    client.invalidateStatus();  // As a booking made meanwhile would
+    poll.join();
+
+    // The first answer is dropped; the caller gets the one sent after
+    TEST_ASSERT_TRUE(status.isValid);
+    TEST_ASSERT_EQUAL(2, server.requestCount("GET", "/status"));
+
+    // ...and that one is current, so it can be reused
+    TEST_ASSERT_TRUE(client.getRoomStatus(5000).isValid);
+    TEST_ASSERT_EQUAL(2, server.requestCount("GET", "/status"));
+}
+
+// Point a fresh client (no room cached) at a server that versions the room
+static void useDynamicStatus(ApiClient& c) {
+    c.setApiUrl(server.url());
+    c.setDeviceToken(TOKEN);
+    server.setResponse("GET", "/status", 200, STATUS_DYNAMIC);
+    server.setResponse("GET", "/info", 200, INFO_TYPICAL);
+}
+
+void test_room_fetched_once_per_version() {
+    ApiClient c;
+    useDynamicStatus(c);
+
+    RoomStatus status = c.getRoomStatus();
+    TEST_ASSERT_TRUE(status.isValid);
+    TEST_ASSERT_EQUAL_STRING("Boardroom", status.room.name.c_str());
+    TEST_ASSERT_TRUE(c.takeRoomInfoChanged());
+
+    TEST_ASSERT_TRUE(c.getRoomStatus().isValid);
+    TEST_ASSERT_EQUAL(2, server.requestCount("GET", "/status"));
+    TEST_ASSERT_EQUAL(1, server.requestCount("GET", "/info"));
+    TEST_ASSERT_FALSE(c.takeRoomInfoChanged());
+}
+
+void test_room_from_flash_skips_info() {
+    ApiClient c;
+    useDynamicStatus(c);
+    TEST_ASSERT_TRUE(c.loadRoomInfo(INFO_TYPICAL));
+
+    TEST_ASSERT_EQUAL_STRING("Boardroom", c.getRoomStatus().room.name.c_str());
+    TEST_ASSERT_EQUAL(0, server.requestCount("GET", "/info"));
+}
+
+void test_room_version_change_refetches_info() {
+    ApiClient c;
+    useDynamicStatus(c);
+    c.loadRoomInfo("{\"roomVersion\":\"old\",\"room\":{\"id\":\"r-1\",\"name\":\"Old name\"}}");
+
+    TEST_ASSERT_EQUAL_STRING("Boardroom", c.getRoomStatus().room.name.c_str());
+    TEST_ASSERT_EQUAL(1, server.requestCount("GET", "/info"));
+}
+
+void test_failed_info_keeps_cached_room() {
+    ApiClient c;
+    useDynamicStatus(c);
+    c.loadRoomInfo("{\"roomVersion\":\"old\",\"room\":{\"id\":\"r-1\",\"name\":\"Old name\"}}");
+    server.addFault("GET", "/info", MockFault::httpStatus(500));
+
+    RoomStatus status = c.getRoomStatus();
+    TEST_ASSERT_TRUE(status.isValid);
+    TEST_ASSERT_EQUAL_STRING("Old name", status.room.name.c_str());
+    TEST_ASSERT_FALSE(c.takeRoomInfoChanged());
+}
+
+void test_no_room_at_all_is_invalid() {
+    ApiClient c;
+    useDynamicStatus(c);
+    server.addFault("GET", "/info", MockFault::httpStatus(500));
+
+    RoomStatus status = c.getRoomStatus();
+    TEST_ASSERT_FALSE(status.isValid);
+    TEST_ASSERT_EQUAL_STRING("Failed to load room", status.errorMessage.c_str());
+}
+
+void test_busy_answer_sets_retry_after() {
+    MockFault fault = MockFault::httpStatus(503, 30);
+    fault.pollIntervalSec = 120;
+    fault.times = 1;
+    server.addFault("GET", "/status", fault);
+
+    TEST_ASSERT_FALSE(client.getRoomStatus().isValid);
+    TEST_ASSERT_UINT32_WITHIN(1000, 30000, client.retryAfterMs());
+    TEST_ASSERT_EQUAL(120000, client.pollIntervalMs(30000));
+
+    // The next clean answer lifts both
+    TEST_ASSERT_TRUE(client.getRoomStatus().isValid);
+    TEST_ASSERT_EQUAL(0, client.retryAfterMs());
+    TEST_ASSERT_EQUAL(30000, client.pollIntervalMs(30000));
+}
+
+void test_poll_hint_on_success() {
+    // A request that had to queue is answered but asks for slower polling
+    MockFault fault = MockFault::latency(0);
+    fault.pollIntervalSec = 120;
+    fault.times = 1;
+    server.addFault("GET", "/status", fault);
+
+    TEST_ASSERT_TRUE(client.getRoomStatus().isValid);
+    TEST_ASSERT_EQUAL(0, client.retryAfterMs());
+    TEST_ASSERT_EQUAL(120000, client.pollIntervalMs(30000));
+    // Never shorter than configured
+    TEST_ASSERT_EQUAL(300000, client.pollIntervalMs(300000));
+}
+
+// A URL nothing listens on: the port of a mock server that has stopped
+static String deadUrl() {
+    MockDeviceApi gone;
+    gone.start();
+    String url = gone.url();
+    gone.stop();
+    return url;
+}
+
+void test_status_fails_over_to_next_endpoint() {
+    ApiClient c;
+    c.setApiUrl(deadUrl() + "," + server.url());
+    c.setDeviceToken(TOKEN);
+
+    // The refused GET is sent again to the second endpoint, which then sticks
+    TEST_ASSERT_TRUE(c.getRoomStatus().isValid);
+    TEST_ASSERT_EQUAL_STRING(server.url().c_str(), c.currentApiUrl().c_str());
+    c.invalidateStatus();
+    TEST_ASSERT_TRUE(c.getRoomStatus().isValid);
+    TEST_ASSERT_EQUAL(2, server.requestCount("GET", "/status"));
+
+    Endpoint stats[API_MAX_ENDPOINTS];
+    TEST_ASSERT_EQUAL(2, c.endpointStats(stats, API_MAX_ENDPOINTS));
+    TEST_ASSERT_EQUAL(1, stats[0].errors);
+    TEST_ASSERT_TRUE(stats[1].ewmaMs > 0);
+}
+
+// A booking may have been made before the connection dropped: not resent
+void test_post_not_resent_to_next_endpoint() {
+    MockDeviceApi backup;
+    backup.start();
+    backup.setResponse("POST", "/quick-book", 201,
+        "{\"id\":\"b-2\",\"title\":\"Quick Booking\",\"startTime\":\"2025-03-12T09:00:00.000Z\",\"endTime\":\"2025-03-12T09:15:00.000Z\"}");
+    ApiClient c;
+    c.setApiUrl(server.url() + "," + backup.url());
+    c.setDeviceToken(TOKEN);
+    server.addFault("POST", "/quick-book", MockFault::reset());
+
+    TEST_ASSERT_FALSE(c.quickBook("Quick Booking", 15).success);
+    TEST_ASSERT_EQUAL(0, backup.requestCount("POST", "/quick-book"));
+
+    // The next attempt goes to the endpoint that answers
+    TEST_ASSERT_TRUE(c.quickBook("Quick Booking", 15).success);
+    TEST_ASSERT_EQUAL(1, backup.requestCount("POST", "/quick-book"));
+    backup.stop();
+}
+
+void test_server_pushed_endpoints_come_last() {
+    ApiClient c;
+    c.setApiUrl(server.url() + "/");
+    c.setExtraApiUrls("http://127.0.0.1:9," + server.url());
+
+    TEST_ASSERT_EQUAL_STRING(server.url().c_str(), c.getApiUrl().c_str());
+    Endpoint stats[API_MAX_ENDPOINTS];
+    TEST_ASSERT_EQUAL(2, c.endpointStats(stats, API_MAX_ENDPOINTS));
+    TEST_ASSERT_EQUAL_STRING(server.url().c_str(), stats[0].url.c_str());
+    TEST_ASSERT_EQUAL_STRING("http://127.0.0.1:9", stats[1].url.c_str());
+}
+
+int main(int argc, char** argv) {
+    server.start();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_status_served_from_fixture);
+    RUN_TEST(test_wrong_token_rejected);
+    RUN_TEST(test_server_error_is_connection_failure);
+    RUN_TEST(test_overload_with_retry_after);
+    RUN_TEST(test_fault_consumed_after_times);
+    RUN_TEST(test_faults_apply_per_endpoint);
+    RUN_TEST(test_truncated_body_rejected);
+    RUN_TEST(test_malformed_json_with_ok_status);
+    RUN_TEST(test_connection_reset);
+    RUN_TEST(test_tls_failure);
+    RUN_TEST(test_latency_below_timeout);
+    RUN_TEST(test_hang_hits_read_timeout);
+    RUN_TEST(test_slowloris_outlasts_read_timeout);
+    RUN_TEST(test_one_connection_per_request);
+    RUN_TEST(test_fresh_status_reused);
+    RUN_TEST(test_failed_status_not_reused);
+    RUN_TEST(test_status_body_kept_for_relay);
+    RUN_TEST(test_mutation_invalidates_fresh_status);
+    RUN_TEST(test_concurrent_status_requests_coalesce);
+    RUN_TEST(test_superseded_status_sent_again);
+    RUN_TEST(test_room_fetched_once_per_version);
+    RUN_TEST(test_room_from_flash_skips_info);
+    RUN_TEST(test_room_version_change_refetches_info);
+    RUN_TEST(test_failed_info_keeps_cached_room);
+    RUN_TEST(test_no_room_at_all_is_invalid);
+    RUN_TEST(test_busy_answer_sets_retry_after);
+    RUN_TEST(test_poll_hint_on_success);
+    RUN_TEST(test_status_fails_over_to_next_endpoint);
+    RUN_TEST(test_post_not_resent_to_next_endpoint);
+    RUN_TEST(test_server_pushed_endpoints_come_last);
+    int result = UNITY_END();
+
+    server.stop();
+    return result;
+}
@@ -0,0 +1,163 @@
+#include <unity.h>
+#include "clock.h"
+#include "config.h"
+#include "time_utils.h"
+
+static const time_t MAR_10_2025 = 1741564800;  // 2025-03-10 00:00:00 UTC
+static const char* CET = "CET-1CEST,M3.5.0,M10.5.0/3";
+
+void setUp() {}
+
+void tearDown() {
+    setClock(nullptr);
+}
+
+void test_simulated_clock_starts_where_told() {
+    SimulatedClock clock(MAR_10_2025, 1234);
+
+    TEST_ASSERT_EQUAL_UINT32(1234, clock.monotonicMs());
+    TEST_ASSERT_EQUAL_INT64((int64_t)MAR_10_2025, (int64_t)clock.wallTime());
+}
+
+void test_advance_moves_both_clocks() {
+    SimulatedClock clock(MAR_10_2025);
+
+    clock.advanceSeconds(90);
+    TEST_ASSERT_EQUAL_UINT32(90000, clock.monotonicMs());
+    TEST_ASSERT_EQUAL_INT64((int64_t)MAR_10_2025 + 90, (int64_t)clock.wallTime());
+
+    // Sub-second steps add up on the wall clock
+    clock.advanceMs(400);
+    clock.advanceMs(400);
+    TEST_ASSERT_EQUAL_INT64((int64_t)MAR_10_2025 + 90, (int64_t)clock.wallTime());
+    clock.advanceMs(400);
+    TEST_ASSERT_EQUAL_INT64((int64_t)MAR_10_2025 + 91, (int64_t)clock.wallTime());
+    TEST_ASSERT_EQUAL_UINT32(91200, clock.monotonicMs());
+}
+
+void test_active_clock_drives_free_functions() {
+    SimulatedClock clock(MAR_10_2025, 5000);
+    setClock(&clock);
+
+    TEST_ASSERT_EQUAL_UINT32(5000, nowMs());
+    TEST_ASSERT_EQUAL_INT64((int64_t)MAR_10_2025, (int64_t)wallNow());
+
+    clockDelay(3000);
+    TEST_ASSERT_EQUAL_UINT32(8000, nowMs());
+    TEST_ASSERT_EQUAL_INT64((int64_t)MAR_10_2025 + 3, (int64_t)wallNow());
+}
+
+void test_null_restores_system_clock() {
+    SimulatedClock clock(42);
+    setClock(&clock);
+    setClock(nullptr);
+
+    time_t system = time(nullptr);
+    TEST_ASSERT_INT_WITHIN(2, (int64_t)system, (int64_t)wallNow());
+}
+
+void test_ntp_sync_jumps_wall_only() {
+    SimulatedClock clock(0, 20000);
+    setClock(&clock);
+    TEST_ASSERT_FALSE(isWallTimeSynced(wallNow()));
+
+    clock.setWallTime(MAR_10_2025);
+
+    TEST_ASSERT_TRUE(isWallTimeSynced(wallNow()));
+    TEST_ASSERT_EQUAL_UINT32(20000, nowMs());
+}
+
+void test_monotonic_wraps_like_millis() {
+    SimulatedClock clock(MAR_10_2025, 0xFFFFFFFFu - 999);
+
+    clock.advanceMs(1500);
+
+    TEST_ASSERT_EQUAL_UINT32(500, clock.monotonicMs());
+    TEST_ASSERT_EQUAL_INT64((int64_t)MAR_10_2025 + 1, (int64_t)clock.wallTime());
+}
+
+void test_interval_check_across_rollover() {
+    SimulatedClock clock(MAR_10_2025, 0xFFFFFFFFu - 10000);
+    setClock(&clock);
+    uint32_t lastPoll = nowMs();
+
+    clock.advanceSeconds(30);
+    TEST_ASSERT_FALSE(nowMs() - lastPoll > STATUS_POLL_INTERVAL);
+
+    clock.advanceSeconds(1);
+    TEST_ASSERT_TRUE(nowMs() < lastPoll);  // Wrapped
+    TEST_ASSERT_TRUE(nowMs() - lastPoll > STATUS_POLL_INTERVAL);
+}
+
+void test_poll_schedule_steady_through_rollover() {
+    // Run the loop()'s status poll timer for 50 days, 1 s per pass
+    SimulatedClock clock(MAR_10_2025);
+    setClock(&clock);
+    uint32_t lastStatusUpdate = nowMs();
+    time_t lastPollWall = wallNow();
+    int polls = 0;
+    long shortestGap = 1000000, longestGap = 0;
+
+    for (long second = 0; second < 50L * 86400; second++) {
+        clock.advanceSeconds(1);
+        if (nowMs() - lastStatusUpdate > STATUS_POLL_INTERVAL) {
+            long gap = (long)(wallNow() - lastPollWall);
+            if (gap < shortestGap) shortestGap = gap;
+            if (gap > longestGap) longestGap = gap;
+            lastStatusUpdate = nowMs();
+            lastPollWall = wallNow();
+            polls++;
+        }
+    }
+
+    TEST_ASSERT_EQUAL(31, shortestGap);
+    TEST_ASSERT_EQUAL(31, longestGap);
+    TEST_ASSERT_EQUAL(50L * 86400 / 31, polls);
+}
+
+void test_local_time_across_dst_switch() {
+    // 2025-03-30 00:59:30 UTC is 01:59:30 CET; a minute later it's 03:00:30 CEST
+    SimulatedClock clock(1743296370);
+    setClock(&clock);
+    struct tm local;
+
+    toLocalTime(wallNow(), CET, local);
+    TEST_ASSERT_EQUAL(1, local.tm_hour);
+    TEST_ASSERT_EQUAL(59, local.tm_min);
+    TEST_ASSERT_EQUAL(0, local.tm_isdst);
+
+    clock.advanceSeconds(60);
+    toLocalTime(wallNow(), CET, local);
+    TEST_ASSERT_EQUAL(3, local.tm_hour);
+    TEST_ASSERT_EQUAL(0, local.tm_min);
+    TEST_ASSERT_TRUE(local.tm_isdst > 0);
+}
+
+void test_local_time_follows_timezone_changes() {
+    struct tm local;
+
+    toLocalTime(MAR_10_2025, "UTC0", local);
+    TEST_ASSERT_EQUAL(0, local.tm_hour);
+    toLocalTime(MAR_10_2025, CET, local);
+    TEST_ASSERT_EQUAL(1, local.tm_hour);
+    // Empty keeps the zone that is active
+    toLocalTime(MAR_10_2025, "", local);
+    TEST_ASSERT_EQUAL(1, local.tm_hour);
+    toLocalTime(MAR_10_2025, "UTC0", local);
+    TEST_ASSERT_EQUAL(0, local.tm_hour);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_simulated_clock_starts_where_told);
+    RUN_TEST(test_advance_moves_both_clocks);
+    RUN_TEST(test_active_clock_drives_free_functions);
+    RUN_TEST(test_null_restores_system_clock);
+    RUN_TEST(test_ntp_sync_jumps_wall_only);
+    RUN_TEST(test_monotonic_wraps_like_millis);
+    RUN_TEST(test_interval_check_across_rollover);
+    RUN_TEST(test_poll_schedule_steady_through_rollover);
+    RUN_TEST(test_local_time_across_dst_switch);
+    RUN_TEST(test_local_time_follows_timezone_changes);
+    return UNITY_END();
+}
@@ -0,0 +1,195 @@
+#include <unity.h>
+#include <ArduinoJson.h>
+#include <mock_device_api.h>
+#include "sha256.h"
+#include "../../tools/gateway/edge_gateway.h"
+
+static const char* TOKEN = "panel-token-a";
+static const char* ROOM = "room-1";
+static const char* ETAG = "\"full-1\"";
+static const char* DYNAMIC_ETAG = "\"dyn-1\"";
+
+static MockDeviceApi server;
+
+// The second device is not assigned to a room yet
+static String devicesBody() {
+    return String("{\"devices\":[") +
+           "{\"id\":\"dev-a\",\"roomId\":\"" + ROOM + "\",\"tokenHash\":\"" + sha256Hex(TOKEN) + "\"}," +
+           "{\"id\":\"dev-b\",\"roomId\":null,\"tokenHash\":\"" + sha256Hex("panel-token-b") + "\"}]}";
+}
+
+static String statusSyncBody(const char* config) {
+    return String("{\"rooms\":{\"room-1\":{\"etag\":\"\\\"full-1\\\"\",\"status\":{\"isAvailable\":true},"
+                  "\"dynamicEtag\":\"\\\"dyn-1\\\"\",\"dynamic\":{\"isAvailable\":true,\"roomVersion\":\"v1\"}}},"
+                  "\"config\":") + config + "}";
+}
+
+static GatewayOptions options(uint32_t maxStaleSec = 600) {
+    GatewayOptions o;
+    o.upstreamUrl = server.url();
+    o.gatewayToken = "gw-token";
+    o.maxStaleSec = maxStaleSec;
+    return o;
+}
+
+// A gateway that has synced its devices and the room's status once
+static void prime(EdgeGateway& gateway, const char* config = "null") {
+    server.setResponse("POST", "/api/gateway/status", 200, statusSyncBody(config));
+    TEST_ASSERT_TRUE(gateway.syncDevices());
+    TEST_ASSERT_TRUE(gateway.syncStatus(0));
+    server.clearLog();
+}
+
+static GatewayRequest statusRequest(const char* token) {
+    GatewayRequest r;
+    r.method = "GET";
+    r.path = "/status";
+    if (token) r.headers["x-device-token"] = token;
+    return r;
+}
+
+static String responseHeader(const GatewayResponse& response, const char* name) {
+    for (const auto& h : response.headers) {
+        if (h.first == name) return h.second;
+    }
+    return "";
+}
+
+void setUp() {
+    server.clearFaults();
+    server.clearLog();
+    server.setResponse("GET", "/api/gateway/devices", 200, devicesBody());
+    server.setResponse("GET", "/status", 200, "{\"isAvailable\":false}");
+    server.setResponse("POST", "/quick-book", 201, "{\"id\":\"b-1\"}");
+}
+
+void tearDown() {}
+
+void test_known_token_served_locally() {
+    EdgeGateway gateway(options());
+    prime(gateway);
+
+    GatewayResponse response = gateway.handle(statusRequest(TOKEN));
+    TEST_ASSERT_EQUAL(200, response.status);
+    TEST_ASSERT_EQUAL_STRING("{\"isAvailable\":true}", response.body.c_str());
+    TEST_ASSERT_EQUAL_STRING(ETAG, responseHeader(response, "ETag").c_str());
+    TEST_ASSERT_EQUAL(0, server.requestCount("GET", "/status"));
+}
+
+void test_unknown_token_forwarded() {
+    EdgeGateway gateway(options());
+    prime(gateway);
+
+    GatewayResponse response = gateway.handle(statusRequest("someone-else"));
+    TEST_ASSERT_EQUAL(200, response.status);
+    TEST_ASSERT_EQUAL_STRING("{\"isAvailable\":false}", response.body.c_str());
+    TEST_ASSERT_EQUAL(1, server.requestCount("GET", "/status"));
+    TEST_ASSERT_EQUAL_STRING("someone-else", server.requests()[0].deviceToken.c_str());
+
+    TEST_ASSERT_EQUAL(401, gateway.handle(statusRequest(nullptr)).status);
+}
+
+void test_if_none_match_gets_304() {
+    EdgeGateway gateway(options());
+    prime(gateway);
+
+    GatewayRequest request = statusRequest(TOKEN);
+    request.headers["if-none-match"] = ETAG;
+    GatewayResponse response = gateway.handle(request);
+    TEST_ASSERT_EQUAL(304, response.status);
+    TEST_ASSERT_EQUAL(0, response.body.length());
+
+    // Panels caching the room compare against the slim status's ETag
+    request.headers["x-room-version"] = "v1";
+    TEST_ASSERT_EQUAL(200, gateway.handle(request).status);
+    request.headers["if-none-match"] = DYNAMIC_ETAG;
+    TEST_ASSERT_EQUAL(304, gateway.handle(request).status);
+}
+
+void test_config_block_spliced_for_older_versions() {
+    EdgeGateway gateway(options());
+    prime(gateway, "{\"version\":3,\"statusPollSeconds\":30}");
+
+    GatewayRequest request = statusRequest(TOKEN);
+    request.headers["x-config-version"] = "2";
+    GatewayResponse response = gateway.handle(request);
+    TEST_ASSERT_EQUAL(200, response.status);
+    JsonDocument doc;
+    TEST_ASSERT_FALSE(deserializeJson(doc, response.body));
+    TEST_ASSERT_TRUE(doc["isAvailable"].as<bool>());
+    TEST_ASSERT_EQUAL(3, doc["config"]["version"].as<int>());
+    TEST_ASSERT_EQUAL(30, doc["config"]["statusPollSeconds"].as<int>());
+
+    request.headers["x-config-version"] = "3";
+    response = gateway.handle(request);
+    TEST_ASSERT_EQUAL_STRING("{\"isAvailable\":true}", response.body.c_str());
+}
+
+void test_quick_book_marks_room_stale() {
+    EdgeGateway gateway(options());
+    prime(gateway);
+
+    GatewayRequest book;
+    book.method = "POST";
+    book.path = "/quick-book";
+    book.headers["x-device-token"] = TOKEN;
+    book.body = "{\"durationMinutes\":15}";
+    TEST_ASSERT_EQUAL(201, gateway.handle(book).status);
+    TEST_ASSERT_EQUAL(1, server.requestCount("POST", "/quick-book"));
+
+    // The cached status predates the booking: ask upstream until the next sync
+    TEST_ASSERT_EQUAL_STRING("{\"isAvailable\":false}", gateway.handle(statusRequest(TOKEN)).body.c_str());
+    TEST_ASSERT_EQUAL(1, server.requestCount("GET", "/status"));
+
+    TEST_ASSERT_TRUE(gateway.syncStatus(0));
+    TEST_ASSERT_EQUAL_STRING("{\"isAvailable\":true}", gateway.handle(statusRequest(TOKEN)).body.c_str());
+    TEST_ASSERT_EQUAL(1, server.requestCount("GET", "/status"));
+}
+
+void test_forwarded_after_max_stale() {
+    EdgeGateway gateway(options(1));
+    prime(gateway);
+
+    TEST_ASSERT_EQUAL_STRING("{\"isAvailable\":true}", gateway.handle(statusRequest(TOKEN)).body.c_str());
+    TEST_ASSERT_EQUAL(0, server.requestCount("GET", "/status"));
+
+    // No sync for longer than maxStaleSec
+    delay(1100);
+    TEST_ASSERT_EQUAL_STRING("{\"isAvailable\":false}", gateway.handle(statusRequest(TOKEN)).body.c_str());
+    TEST_ASSERT_EQUAL(1, server.requestCount("GET", "/status"));
+}
+
+void test_devices_without_room_skipped() {
+    EdgeGateway gateway(options());
+    prime(gateway);
+
+    JsonDocument stats;
+    deserializeJson(stats, gateway.statsJson());
+    TEST_ASSERT_EQUAL(2, stats["devices"].as<int>());
+    TEST_ASSERT_EQUAL(1, stats["rooms"].as<int>());
+    TEST_ASSERT_EQUAL(1, stats["roomsCached"].as<int>());
+
+    // Every room has a status, so the next sync may long-poll
+    TEST_ASSERT_TRUE(gateway.syncStatus(0));
+    std::vector<MockRequest> log = server.requests();
+    TEST_ASSERT_EQUAL(1, log.size());
+    JsonDocument sent;
+    TEST_ASSERT_FALSE(deserializeJson(sent, log[0].body));
+    TEST_ASSERT_EQUAL(1, sent["rooms"].as<JsonObject>().size());
+    TEST_ASSERT_TRUE(sent["rooms"]["null"].isNull());
+}
+
+int main(int argc, char** argv) {
+    server.start();
+    UNITY_BEGIN();
+    RUN_TEST(test_known_token_served_locally);
+    RUN_TEST(test_unknown_token_forwarded);
+    RUN_TEST(test_if_none_match_gets_304);
+    RUN_TEST(test_config_block_spliced_for_older_versions);
+    RUN_TEST(test_quick_book_marks_room_stale);
+    RUN_TEST(test_forwarded_after_max_stale);
+    RUN_TEST(test_devices_without_room_skipped);
+    int result = UNITY_END();
+    server.stop();
+    return result;
+}
@@ -0,0 +1,151 @@
+#include <unity.h>
+#include "config.h"
+#include "endpoint_pool.h"
+
+static EndpointPool pool;
+
+static const uint32_t T0 = 1000;
+
+void setUp() {
+    pool.setUrls("");
+    pool.setUrls("http://a:3001,http://b:3001,http://c:3001");
+}
+
+void tearDown() {}
+
+void test_list_is_normalized() {
+    TEST_ASSERT_EQUAL(4, pool.setUrls(" http://a:3001/ ,,http://b:3001, http://a:3001,http://c:3001,http://d:3001,http://e:3001"));
+    TEST_ASSERT_EQUAL_STRING("http://a:3001,http://b:3001,http://c:3001,http://d:3001", pool.urls().c_str());
+    TEST_ASSERT_EQUAL(API_MAX_ENDPOINTS, pool.size());
+}
+
+void test_first_endpoint_until_measured() {
+    TEST_ASSERT_EQUAL(0, pool.select(T0));
+    pool.setUrls("");
+    TEST_ASSERT_EQUAL(-1, pool.select(T0));
+}
+
+// A somewhat faster endpoint isn't worth a cold connection
+void test_selection_is_sticky() {
+    pool.reportSuccess(0, 300, T0);
+    pool.reportSuccess(1, 200, T0);
+
+    TEST_ASSERT_EQUAL(0, pool.select(T0));
+}
+
+void test_clearly_faster_endpoint_wins() {
+    pool.reportSuccess(0, 300, T0);
+    pool.reportSuccess(2, 100, T0);
+
+    TEST_ASSERT_EQUAL(2, pool.select(T0));
+}
+
+void test_latency_is_smoothed() {
+    pool.reportSuccess(0, 100, T0);
+    pool.reportSuccess(0, 600, T0);
+
+    TEST_ASSERT_EQUAL_UINT32(200, pool.endpoint(0).ewmaMs);
+}
+
+// No answer at all: skipped at once, tried again after the back-off
+void test_hard_failure_fails_over() {
+    pool.select(T0);
+    pool.reportFailure(0, true, T0);
+
+    TEST_ASSERT_TRUE(pool.isDown(0, T0));
+    TEST_ASSERT_EQUAL(1, pool.select(T0));
+    TEST_ASSERT_FALSE(pool.isDown(0, T0 + ENDPOINT_DOWN_MS));
+}
+
+void test_server_errors_need_a_streak() {
+    pool.select(T0);
+    pool.reportFailure(0, false, T0);
+    TEST_ASSERT_EQUAL(0, pool.select(T0));
+
+    pool.reportFailure(0, false, T0);
+    TEST_ASSERT_EQUAL(1, pool.select(T0));
+}
+
+void test_success_resets_the_streak() {
+    pool.reportFailure(0, false, T0);
+    pool.reportSuccess(0, 100, T0);
+    pool.reportFailure(0, false, T0);
+
+    TEST_ASSERT_FALSE(pool.isDown(0, T0));
+}
+
+void test_back_off_doubles_up_to_the_cap() {
+    pool.reportFailure(0, true, T0);
+    TEST_ASSERT_EQUAL_UINT32(T0 + ENDPOINT_DOWN_MS, pool.endpoint(0).downUntil);
+    pool.reportFailure(0, true, T0);
+    TEST_ASSERT_EQUAL_UINT32(T0 + 2 * ENDPOINT_DOWN_MS, pool.endpoint(0).downUntil);
+
+    for (int i = 0; i < 20; i++) pool.reportFailure(0, true, T0);
+    TEST_ASSERT_EQUAL_UINT32(T0 + ENDPOINT_DOWN_MAX_MS, pool.endpoint(0).downUntil);
+}
+
+void test_all_down_retries_the_soonest() {
+    pool.reportFailure(0, true, T0);
+    pool.reportFailure(0, true, T0);
+    pool.reportFailure(1, true, T0 + 10);
+    pool.reportFailure(2, true, T0 + 5);
+
+    TEST_ASSERT_EQUAL(2, pool.select(T0 + 20));
+}
+
+// A failed-over device stays on the backup after the primary's back-off ends
+void test_recovered_endpoint_does_not_steal_back() {
+    pool.reportSuccess(0, 100, T0);
+    pool.reportFailure(0, true, T0);
+    TEST_ASSERT_EQUAL(1, pool.select(T0));
+    pool.reportSuccess(1, 150, T0);
+
+    TEST_ASSERT_EQUAL(1, pool.select(T0 + ENDPOINT_DOWN_MS));
+}
+
+void test_new_list_keeps_known_endpoints() {
+    pool.reportSuccess(1, 100, T0);
+    pool.reportFailure(0, true, T0);
+    TEST_ASSERT_EQUAL(1, pool.select(T0));
+
+    pool.setUrls("http://b:3001/,http://d:3001");
+
+    TEST_ASSERT_EQUAL(0, pool.current());
+    TEST_ASSERT_EQUAL_STRING("http://b:3001", pool.endpoint(0).url.c_str());
+    TEST_ASSERT_EQUAL_UINT32(100, pool.endpoint(0).ewmaMs);
+    TEST_ASSERT_EQUAL_UINT32(0, pool.endpoint(1).ewmaMs);
+}
+
+void test_probe_picks_stale_endpoints() {
+    pool.select(T0);
+    pool.reportSuccess(0, 100, T0);
+    pool.reportSuccess(1, 100, T0);
+    pool.reportSuccess(2, 100, T0 + 10);
+
+    TEST_ASSERT_EQUAL(-1, pool.probeCandidate(T0 + 20));
+    // Oldest measurement first, never the current endpoint
+    TEST_ASSERT_EQUAL(1, pool.probeCandidate(T0 + ENDPOINT_PROBE_MS + 10));
+
+    // An endpoint whose back-off is over is due straight away
+    pool.reportFailure(2, true, T0 + 20);
+    TEST_ASSERT_EQUAL(-1, pool.probeCandidate(T0 + 30));
+    TEST_ASSERT_EQUAL(2, pool.probeCandidate(T0 + 20 + ENDPOINT_DOWN_MS));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_list_is_normalized);
+    RUN_TEST(test_first_endpoint_until_measured);
+    RUN_TEST(test_selection_is_sticky);
+    RUN_TEST(test_clearly_faster_endpoint_wins);
+    RUN_TEST(test_latency_is_smoothed);
+    RUN_TEST(test_hard_failure_fails_over);
+    RUN_TEST(test_server_errors_need_a_streak);
+    RUN_TEST(test_success_resets_the_streak);
+    RUN_TEST(test_back_off_doubles_up_to_the_cap);
+    RUN_TEST(test_all_down_retries_the_soonest);
+    RUN_TEST(test_recovered_endpoint_does_not_steal_back);
+    RUN_TEST(test_new_list_keeps_known_endpoints);
+    RUN_TEST(test_probe_picks_stale_endpoints);
+    return UNITY_END();
+}
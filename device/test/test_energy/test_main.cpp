@@ -0,0 +1,171 @@
+#include <unity.h>
+#include "clock.h"
+#include "config.h"
+#include "energy.h"
+
+static SimulatedClock simClock(1741564800);
+static EnergyMeter meter;
+
+// Round numbers so expected charges are easy to check by hand
+static EnergyCurrents testCurrents() {
+    EnergyCurrents c;
+    c.baseMa = 10;
+    c.cpuBusyMa = 40;
+    c.cpuIdleMa = 20;
+    c.backlightOnMa = 60;
+    c.wifiMa[ENERGY_WIFI_OFF] = 0;
+    c.wifiMa[ENERGY_WIFI_MODEM_SLEEP] = 10;
+    c.wifiMa[ENERGY_WIFI_ACTIVE] = 100;
+    c.ledChannelMa = 8;
+    c.supplyMv = 5000;
+    return c;
+}
+
+void setUp() {
+    setClock(&simClock);
+    meter = EnergyMeter();
+    meter.begin(testCurrents());
+}
+
+void tearDown() {
+    setClock(nullptr);
+}
+
+void test_nothing_elapsed_reports_zero() {
+    EnergyReport r = meter.report();
+
+    TEST_ASSERT_EQUAL_UINT64(0, r.elapsedMs);
+    TEST_ASSERT_EQUAL_FLOAT(0, r.totalMah);
+    TEST_ASSERT_EQUAL_FLOAT(0, r.averageMa);
+}
+
+void test_time_split_between_states() {
+    // 1 h: busy 15 min, idle 45 min; backlight on for the first 30 min
+    meter.setBacklight(true);
+    simClock.advanceSeconds(15 * 60);
+    meter.setCpuBusy(false);
+    simClock.advanceSeconds(15 * 60);
+    meter.setBacklight(false);
+    simClock.advanceSeconds(30 * 60);
+
+    EnergyReport r = meter.report();
+
+    TEST_ASSERT_EQUAL_UINT64(3600000, r.elapsedMs);
+    TEST_ASSERT_EQUAL_UINT64(900000, r.cpuBusyMs);
+    TEST_ASSERT_EQUAL_UINT64(1800000, r.backlightOnMs);
+    TEST_ASSERT_EQUAL_UINT64(3600000, r.wifiMs[ENERGY_WIFI_OFF]);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 10, r.baseMah);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 40 * 0.25 + 20 * 0.75, r.cpuMah);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 30, r.backlightMah);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0, r.wifiMah);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 65, r.totalMah);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 65, r.averageMa);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 325, r.energyMwh);
+}
+
+void test_radio_activity_overrides_modem_sleep() {
+    meter.setWifi(ENERGY_WIFI_MODEM_SLEEP);
+    simClock.advanceSeconds(50);
+    meter.beginRadioActivity();
+    meter.beginRadioActivity();  // Nested: OTA inside a request
+    simClock.advanceSeconds(6);
+    meter.endRadioActivity();
+    simClock.advanceSeconds(4);
+    meter.endRadioActivity();
+    simClock.advanceSeconds(30);
+
+    EnergyReport r = meter.report();
+
+    TEST_ASSERT_EQUAL_UINT64(80000, r.wifiMs[ENERGY_WIFI_MODEM_SLEEP]);
+    TEST_ASSERT_EQUAL_UINT64(10000, r.wifiMs[ENERGY_WIFI_ACTIVE]);
+}
+
+void test_radio_activity_ignored_while_wifi_off() {
+    meter.beginRadioActivity();
+    simClock.advanceSeconds(10);
+    meter.endRadioActivity();
+
+    EnergyReport r = meter.report();
+
+    TEST_ASSERT_EQUAL_UINT64(10000, r.wifiMs[ENERGY_WIFI_OFF]);
+    TEST_ASSERT_EQUAL_UINT64(0, r.wifiMs[ENERGY_WIFI_ACTIVE]);
+}
+
+void test_led_duty_weighted_by_time() {
+    // Green at 20% for 30 min, then red fully on for 30 min
+    meter.setLedDuty(0, 51, 0);
+    simClock.advanceSeconds(30 * 60);
+    meter.setLedDuty(255, 0, 0);
+    simClock.advanceSeconds(30 * 60);
+
+    EnergyReport r = meter.report();
+
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.5, r.ledDuty[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.1, r.ledDuty[1]);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0, r.ledDuty[2]);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 8 * 0.5 + 8 * 0.1, r.ledMah);
+}
+
+void test_accounting_across_millis_rollover() {
+    SimulatedClock nearWrap(1741564800, 0xFFFFFFFFu - 5000);
+    setClock(&nearWrap);
+    meter.begin(testCurrents());
+
+    nearWrap.advanceSeconds(3);
+    meter.setCpuBusy(false);
+    nearWrap.advanceSeconds(7);
+
+    EnergyReport r = meter.report();
+
+    TEST_ASSERT_EQUAL_UINT64(10000, r.elapsedMs);
+    TEST_ASSERT_EQUAL_UINT64(3000, r.cpuBusyMs);
+}
+
+void test_state_before_begin_is_kept_but_not_timed() {
+    EnergyMeter late;
+    late.setBacklight(true);
+    simClock.advanceSeconds(100);
+    late.begin(testCurrents());
+    simClock.advanceSeconds(10);
+
+    EnergyReport r = late.report();
+
+    TEST_ASSERT_EQUAL_UINT64(10000, r.elapsedMs);
+    TEST_ASSERT_EQUAL_UINT64(10000, r.backlightOnMs);
+}
+
+void test_reset_restarts_totals() {
+    meter.setBacklight(true);
+    simClock.advanceSeconds(100);
+    meter.reset();
+    simClock.advanceSeconds(20);
+
+    EnergyReport r = meter.report();
+
+    TEST_ASSERT_EQUAL_UINT64(20000, r.elapsedMs);
+    TEST_ASSERT_EQUAL_UINT64(20000, r.backlightOnMs);
+}
+
+void test_default_table_matches_config() {
+    EnergyCurrents c = defaultEnergyCurrents();
+
+    TEST_ASSERT_EQUAL_FLOAT(ENERGY_BACKLIGHT_MA, c.backlightOnMa);
+    TEST_ASSERT_EQUAL_FLOAT(0, c.wifiMa[ENERGY_WIFI_OFF]);
+    TEST_ASSERT_TRUE(c.wifiMa[ENERGY_WIFI_ACTIVE] > c.wifiMa[ENERGY_WIFI_MODEM_SLEEP]);
+    TEST_ASSERT_TRUE(c.cpuBusyMa > c.cpuIdleMa);
+    TEST_ASSERT_EQUAL_UINT32(ENERGY_SUPPLY_MV, c.supplyMv);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_nothing_elapsed_reports_zero);
+    RUN_TEST(test_time_split_between_states);
+    RUN_TEST(test_radio_activity_overrides_modem_sleep);
+    RUN_TEST(test_radio_activity_ignored_while_wifi_off);
+    RUN_TEST(test_led_duty_weighted_by_time);
+    RUN_TEST(test_accounting_across_millis_rollover);
+    RUN_TEST(test_state_before_begin_is_kept_but_not_timed);
+    RUN_TEST(test_reset_restarts_totals);
+    RUN_TEST(test_default_table_matches_config);
+    return UNITY_END();
+}
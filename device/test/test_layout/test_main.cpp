@@ -0,0 +1,96 @@
+#include <unity.h>
+#include "layout.h"
+
+void setUp() {}
+void tearDown() {}
+
+static void assertRect(int x, int y, int w, int h, const Rect& r) {
+    TEST_ASSERT_EQUAL(x, r.x);
+    TEST_ASSERT_EQUAL(y, r.y);
+    TEST_ASSERT_EQUAL(w, r.w);
+    TEST_ASSERT_EQUAL(h, r.h);
+}
+
+void test_flex_row_splits_leftover_space() {
+    FlexItem items[] = {{10, 0}, {0, 1}, {0, 2}};
+    Rect out[3];
+    flexLayout({0, 0, 100, 20}, FLEX_ROW, items, 3, 5, out);
+    assertRect(0, 0, 10, 20, out[0]);
+    assertRect(15, 0, 26, 20, out[1]);
+    // The last growing item absorbs the rounding remainder
+    assertRect(46, 0, 54, 20, out[2]);
+}
+
+// The reference screen draws exactly what the hardcoded screens drew
+void test_reference_room_status() {
+    ScreenLayouts s;
+    computeScreenLayouts(320, 240, s);
+    const RoomStatusLayout& l = s.roomStatus;
+    TEST_ASSERT_EQUAL(10, l.title.y);
+    assertRect(12, 50, 296, 70, l.statusPanel);
+    TEST_ASSERT_EQUAL(78, l.availableLabelY);
+    TEST_ASSERT_EQUAL(102, l.availableHintY);
+    assertRect(12, 130, 296, 36, l.endMeetingButton);
+    TEST_ASSERT_EQUAL(176, l.listTopWithEndButton);
+    TEST_ASSERT_EQUAL(205, l.listLimitY);
+    TEST_ASSERT_EQUAL(28, l.cardTitleChars);
+    assertRect(280, 205, 30, 30, l.refreshButton);
+}
+
+void test_reference_quick_book() {
+    ScreenLayouts s;
+    computeScreenLayouts(320, 240, s);
+    const QuickBookLayout& l = s.quickBook;
+    assertRect(12, 75, 145, 50, l.durations[0]);
+    assertRect(167, 75, 145, 50, l.durations[1]);
+    assertRect(12, 135, 145, 50, l.durations[2]);
+    assertRect(167, 135, 145, 50, l.durations[3]);
+    assertRect(12, 195, 296, 38, l.cancelButton);
+}
+
+void test_reference_confirm() {
+    ScreenLayouts s;
+    computeScreenLayouts(320, 240, s);
+    const ConfirmLayout& l = s.confirm;
+    assertRect(12, 55, 296, 70, l.card);
+    TEST_ASSERT_EQUAL(72, l.cardLabelY);
+    TEST_ASSERT_EQUAL(100, l.cardValueY);
+    TEST_ASSERT_EQUAL(145, l.noteY);
+    TEST_ASSERT_EQUAL(110, l.line1Y);
+    TEST_ASSERT_EQUAL(150, l.line2Y);
+    TEST_ASSERT_EQUAL(170, l.line3Y);
+    assertRect(12, 185, 145, 45, l.leftButton);
+    assertRect(163, 185, 145, 45, l.rightButton);
+}
+
+void test_reference_message_and_loading() {
+    ScreenLayouts s;
+    computeScreenLayouts(320, 240, s);
+    TEST_ASSERT_EQUAL(70, s.message.iconY);
+    TEST_ASSERT_EQUAL(125, s.message.headingY);
+    assertRect(100, 190, 120, 40, s.message.button);
+    TEST_ASSERT_EQUAL(100, s.loading.cy);
+    TEST_ASSERT_EQUAL(150, s.loading.messageY);
+}
+
+void test_larger_screen_stays_on_screen() {
+    ScreenLayouts s;
+    computeScreenLayouts(480, 320, s);
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(s.quickBook.durations[i].right() <= 480);
+        TEST_ASSERT_TRUE(s.quickBook.durations[i].bottom() <= s.quickBook.cancelButton.y);
+    }
+    TEST_ASSERT_TRUE(s.confirm.rightButton.right() <= 480);
+    TEST_ASSERT_TRUE(s.confirm.noteY < s.confirm.leftButton.y);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_flex_row_splits_leftover_space);
+    RUN_TEST(test_reference_room_status);
+    RUN_TEST(test_reference_quick_book);
+    RUN_TEST(test_reference_confirm);
+    RUN_TEST(test_reference_message_and_loading);
+    RUN_TEST(test_larger_screen_stays_on_screen);
+    return UNITY_END();
+}
@@ -0,0 +1,94 @@
+#include <unity.h>
+#include "config.h"
+#include "peer_firmware.h"
+
+static const char* MD5 = "0123456789abcdef0123456789abcdef";
+
+static FirmwarePeer peer(uint32_t ip, const char* key, const char* version) {
+    FirmwarePeer p;
+    p.ip = ip;
+    p.key = key;
+    p.version = version;
+    return p;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_seed_round_trip() {
+    FirmwareSeed sent;
+    sent.version = "1.2.0";
+    sent.size = 1234567;
+    sent.md5 = MD5;
+
+    FirmwareSeed got;
+    TEST_ASSERT_TRUE(parseFirmwareSeed(encodeFirmwareSeed(sent), got));
+    TEST_ASSERT_EQUAL_STRING("1.2.0", got.version.c_str());
+    TEST_ASSERT_EQUAL_UINT32(1234567, got.size);
+    TEST_ASSERT_EQUAL_STRING(MD5, got.md5.c_str());
+
+    // Some servers list the checksum in capitals
+    TEST_ASSERT_TRUE(parseFirmwareSeed("1.2.0|10|0123456789ABCDEF0123456789ABCDEF", got));
+    TEST_ASSERT_EQUAL_STRING(MD5, got.md5.c_str());
+}
+
+void test_bad_seeds_rejected() {
+    FirmwareSeed got;
+    TEST_ASSERT_FALSE(parseFirmwareSeed("", got));
+    TEST_ASSERT_FALSE(parseFirmwareSeed("1.2.0", got));
+    TEST_ASSERT_FALSE(parseFirmwareSeed("|10|0123456789abcdef0123456789abcdef", got));
+    TEST_ASSERT_FALSE(parseFirmwareSeed("1.2.0|0|0123456789abcdef0123456789abcdef", got));
+    TEST_ASSERT_FALSE(parseFirmwareSeed("1.2.0|10|0123456789abcdef", got));
+    TEST_ASSERT_FALSE(parseFirmwareSeed("1.2.0|10|0123456789abcdef0123456789abcdeg", got));
+}
+
+void test_path_escapes_the_version() {
+    TEST_ASSERT_EQUAL_STRING("/firmware?version=1.2.0-rc_1", peerFirmwarePath("1.2.0-rc_1").c_str());
+    TEST_ASSERT_EQUAL_STRING("/firmware?version=1.2%2B3%26x", peerFirmwarePath("1.2+3&x").c_str());
+}
+
+void test_only_peers_with_the_version() {
+    FirmwarePeer peers[] = {
+        peer(1, "aaaa", "1.2.0"),
+        peer(2, "self", "1.2.0"),  // Our own advertisement
+        peer(3, "cccc", "1.1.4"),
+        peer(0, "dddd", "1.2.0"),  // No address resolved
+        peer(5, "eeee", "1.2.0"),
+    };
+    size_t kept = pickFirmwarePeers(peers, 5, "1.2.0", "self", 42);
+    TEST_ASSERT_EQUAL(2, kept);
+    for (size_t i = 0; i < kept; i++) {
+        TEST_ASSERT_TRUE(peers[i].ip == 1 || peers[i].ip == 5);
+    }
+    TEST_ASSERT_FALSE(peers[0].ip == peers[1].ip);
+}
+
+void test_order_depends_on_the_seed() {
+    // Panels with different seeds should not all start with the same peer
+    bool firstSeen[9] = {};
+    for (uint32_t seed = 0; seed < 64; seed++) {
+        FirmwarePeer peers[8];
+        for (uint32_t i = 0; i < 8; i++) {
+            peers[i] = peer(i + 1, "k", "1.2.0");
+            peers[i].key += String(i);
+        }
+        TEST_ASSERT_EQUAL(8, pickFirmwarePeers(peers, 8, "1.2.0", "self", seed * 2654435761u));
+        firstSeen[peers[0].ip] = true;
+    }
+    int distinct = 0;
+    for (int i = 1; i <= 8; i++) {
+        if (firstSeen[i]) distinct++;
+    }
+    TEST_ASSERT_TRUE(distinct >= 4);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_seed_round_trip);
+    RUN_TEST(test_bad_seeds_rejected);
+    RUN_TEST(test_path_escapes_the_version);
+    RUN_TEST(test_only_peers_with_the_version);
+    RUN_TEST(test_order_depends_on_the_seed);
+    return UNITY_END();
+}
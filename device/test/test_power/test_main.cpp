@@ -0,0 +1,114 @@
+#include <unity.h>
+#include "config.h"
+#include "power.h"
+#include "time_utils.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_no_deadlines_waits_the_cap() {
+    TEST_ASSERT_EQUAL_UINT32(500, msUntilNextDeadline(1000, nullptr, 0, 500));
+}
+
+void test_earliest_deadline_wins() {
+    PowerDeadline deadlines[] = {
+        {0, STATUS_POLL_INTERVAL},  // Due after 30001 ms
+        {0, 10000},                 // Due after 10001 ms
+    };
+
+    TEST_ASSERT_EQUAL_UINT32(1, msUntilNextDeadline(10000, deadlines, 2, 60000));
+    TEST_ASSERT_EQUAL_UINT32(4001, msUntilNextDeadline(6000, deadlines, 2, 60000));
+}
+
+void test_cap_bounds_long_waits() {
+    PowerDeadline deadlines[] = {{0, FIRMWARE_CHECK_INTERVAL}};
+
+    TEST_ASSERT_EQUAL_UINT32(IDLE_MAX_WAIT_MS, msUntilNextDeadline(0, deadlines, 1, IDLE_MAX_WAIT_MS));
+}
+
+void test_overdue_deadline_is_due_now() {
+    PowerDeadline deadlines[] = {{0, 1000}};
+
+    TEST_ASSERT_EQUAL_UINT32(0, msUntilNextDeadline(1001, deadlines, 1, 500));
+    TEST_ASSERT_EQUAL_UINT32(0, msUntilNextDeadline(5000, deadlines, 1, 500));
+}
+
+// Matches loop()'s "now - last > interval": waking after the returned delay
+// must find the timer due
+void test_wait_lands_on_first_due_millisecond() {
+    PowerDeadline deadlines[] = {{1000, 200}};
+    uint32_t now = 1050;
+
+    uint32_t wait = msUntilNextDeadline(now, deadlines, 1, 500);
+
+    TEST_ASSERT_TRUE(now + wait - deadlines[0].last > deadlines[0].interval);
+    TEST_ASSERT_FALSE(now + wait - 1 - deadlines[0].last > deadlines[0].interval);
+}
+
+void test_deadline_across_millis_rollover() {
+    PowerDeadline deadlines[] = {{0xFFFFFFFFu - 99, 300}};
+
+    // 150 ms after the timer started, 150 + 1 to go
+    TEST_ASSERT_EQUAL_UINT32(151, msUntilNextDeadline(50, deadlines, 1, 500));
+}
+
+static const char* CET = "CET-1CEST,M3.5.0,M10.5.0/3";
+
+void test_no_sleep_while_open() {
+    applyTimezone(CET);
+    // 2025-03-12 10:00 CET
+    TEST_ASSERT_EQUAL_UINT32(0, outOfHoursSleepSeconds(utcToTimestamp(2025, 3, 12, 9, 0, 0), 7, 19, 900));
+}
+
+void test_evening_sleeps_until_next_morning() {
+    applyTimezone(CET);
+    // 20:00 -> 06:45 next day
+    time_t now = utcToTimestamp(2025, 3, 12, 19, 0, 0);
+    TEST_ASSERT_EQUAL_UINT32(10 * 3600 + 45 * 60, outOfHoursSleepSeconds(now, 7, 19, 900));
+}
+
+void test_early_morning_sleeps_until_opening_today() {
+    applyTimezone(CET);
+    // 02:30 -> 06:45 the same day
+    time_t now = utcToTimestamp(2025, 3, 12, 1, 30, 0);
+    TEST_ASSERT_EQUAL_UINT32(4 * 3600 + 15 * 60, outOfHoursSleepSeconds(now, 7, 19, 900));
+}
+
+void test_no_sleep_within_lead_time() {
+    applyTimezone(CET);
+    // 06:50, already past the 06:45 wake
+    TEST_ASSERT_EQUAL_UINT32(0, outOfHoursSleepSeconds(utcToTimestamp(2025, 3, 12, 5, 50, 0), 7, 19, 900));
+}
+
+void test_sleep_across_dst_change() {
+    applyTimezone(CET);
+    // 2025-03-29 22:00 CET -> 2025-03-30 06:45 CEST: one hour shorter
+    time_t now = utcToTimestamp(2025, 3, 29, 21, 0, 0);
+    TEST_ASSERT_EQUAL_UINT32(7 * 3600 + 45 * 60, outOfHoursSleepSeconds(now, 7, 19, 900));
+}
+
+void test_unknown_or_invalid_hours_never_sleep() {
+    applyTimezone(CET);
+    time_t night = utcToTimestamp(2025, 3, 12, 23, 0, 0);
+    TEST_ASSERT_EQUAL_UINT32(0, outOfHoursSleepSeconds(night, -1, -1, 900));
+    TEST_ASSERT_EQUAL_UINT32(0, outOfHoursSleepSeconds(night, 19, 7, 900));
+    TEST_ASSERT_EQUAL_UINT32(0, outOfHoursSleepSeconds(night, 0, 25, 900));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_no_deadlines_waits_the_cap);
+    RUN_TEST(test_earliest_deadline_wins);
+    RUN_TEST(test_cap_bounds_long_waits);
+    RUN_TEST(test_overdue_deadline_is_due_now);
+    RUN_TEST(test_wait_lands_on_first_due_millisecond);
+    RUN_TEST(test_deadline_across_millis_rollover);
+    RUN_TEST(test_no_sleep_while_open);
+    RUN_TEST(test_evening_sleeps_until_next_morning);
+    RUN_TEST(test_early_morning_sleeps_until_opening_today);
+    RUN_TEST(test_no_sleep_within_lead_time);
+    RUN_TEST(test_sleep_across_dst_change);
+    RUN_TEST(test_unknown_or_invalid_hours_never_sleep);
+    return UNITY_END();
+}
@@ -0,0 +1,158 @@
+#include <unity.h>
+#include "config.h"
+#include "profiler.h"
+
+static ProfileHistogram hist;
+static String exported;
+static int chunks = 0;
+
+static void collect(const String& chunk) {
+    exported += chunk;
+    chunks++;
+}
+
+static uint32_t countOf(const uint32_t* pcs, uint8_t depth) {
+    for (size_t i = 0; i < hist.slotCount(); i++) {
+        const ProfileStack& slot = hist.slot(i);
+        if (slot.count == 0) continue;
+        bool match = true;
+        for (uint8_t d = 0; d < PROFILER_STACK_DEPTH; d++) {
+            if (slot.pcs[d] != (d < depth ? pcs[d] : 0)) match = false;
+        }
+        if (match) return slot.count;
+    }
+    return 0;
+}
+
+void setUp() {
+    hist.begin(64);
+}
+
+void tearDown() {
+    hist.end();
+}
+
+void test_identical_stacks_share_a_slot() {
+    uint32_t stack[] = {0x400d1234, 0x400d2000, 0x400d3000};
+
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(hist.add(stack, 3));
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(5, countOf(stack, 3));
+    TEST_ASSERT_EQUAL_UINT32(5, hist.samples());
+    TEST_ASSERT_EQUAL_UINT32(0, hist.dropped());
+}
+
+void test_callers_and_depth_distinguish_stacks() {
+    uint32_t a[] = {0x400d1234, 0x400d2000};
+    uint32_t b[] = {0x400d1234, 0x400d2fff};
+
+    hist.add(a, 2);
+    hist.add(b, 2);
+    hist.add(a, 1);
+
+    TEST_ASSERT_EQUAL_UINT32(1, countOf(a, 2));
+    TEST_ASSERT_EQUAL_UINT32(1, countOf(b, 2));
+    TEST_ASSERT_EQUAL_UINT32(1, countOf(a, 1));
+}
+
+void test_stacks_deeper_than_limit_are_cut() {
+    uint32_t deep[PROFILER_STACK_DEPTH + 2];
+    for (int i = 0; i < PROFILER_STACK_DEPTH + 2; i++) deep[i] = 0x400d0000 + i * 16;
+
+    hist.add(deep, PROFILER_STACK_DEPTH + 2);
+
+    TEST_ASSERT_EQUAL_UINT32(1, countOf(deep, PROFILER_STACK_DEPTH));
+}
+
+void test_full_table_drops_new_stacks() {
+    for (uint32_t i = 0; i < 64; i++) {
+        uint32_t pc = 0x400d0000 + i * 4;
+        TEST_ASSERT_TRUE(hist.add(&pc, 1));
+    }
+
+    uint32_t extra = 0x400e0000;
+    TEST_ASSERT_FALSE(hist.add(&extra, 1));
+    // Stacks already in the table still count
+    uint32_t first = 0x400d0000;
+    TEST_ASSERT_TRUE(hist.add(&first, 1));
+
+    TEST_ASSERT_EQUAL_UINT32(66, hist.samples());
+    TEST_ASSERT_EQUAL_UINT32(1, hist.dropped());
+}
+
+void test_clear_keeps_capacity() {
+    uint32_t pc = 0x400d1234;
+    hist.add(&pc, 1);
+
+    hist.clear();
+
+    TEST_ASSERT_EQUAL_UINT32(0, hist.samples());
+    TEST_ASSERT_EQUAL_UINT32(0, countOf(&pc, 1));
+    TEST_ASSERT_EQUAL(64, hist.slotCount());
+    TEST_ASSERT_TRUE(hist.add(&pc, 1));
+}
+
+void test_add_without_table_is_ignored() {
+    uint32_t pc = 0x400d1234;
+    hist.end();
+
+    TEST_ASSERT_FALSE(hist.add(&pc, 1));
+    TEST_ASSERT_EQUAL_UINT32(0, hist.samples());
+}
+
+void test_text_dump_format() {
+    ProfileHistogram cores[2];
+    cores[0].begin(8);
+    cores[1].begin(8);
+    uint32_t idle[] = {0x40086abc};
+    uint32_t draw[] = {0x400d5a10, 0x400d1f0c, 0x400d0a2b};
+    cores[0].add(idle, 1);
+    cores[0].add(idle, 1);
+    cores[1].add(draw, 3);
+
+    exported = "";
+    profileWriteText(cores, 2, 1000, collect);
+
+    TEST_ASSERT_EQUAL_STRING(
+        "# open-meeting-profile 1\n"
+        "# hz 1000\n"
+        "# core 0 samples 2 dropped 0\n"
+        "# core 1 samples 1 dropped 0\n"
+        "0 2 40086abc\n"
+        "1 1 400d5a10 400d1f0c 400d0a2b\n",
+        exported.c_str());
+}
+
+void test_text_dump_streams_in_chunks() {
+    for (uint32_t i = 0; i < 64; i++) {
+        uint32_t stack[] = {0x400d0000 + i * 4, 0x400d8000};
+        hist.add(stack, 2);
+    }
+
+    exported = "";
+    chunks = 0;
+    profileWriteText(&hist, 1, 1000, collect, 1 << 20);
+    String whole = exported;
+    TEST_ASSERT_EQUAL(1, chunks);
+
+    exported = "";
+    chunks = 0;
+    profileWriteText(&hist, 1, 1000, collect, 128);
+    TEST_ASSERT_TRUE(chunks > 5);
+    TEST_ASSERT_EQUAL_STRING(whole.c_str(), exported.c_str());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_identical_stacks_share_a_slot);
+    RUN_TEST(test_callers_and_depth_distinguish_stacks);
+    RUN_TEST(test_stacks_deeper_than_limit_are_cut);
+    RUN_TEST(test_full_table_drops_new_stacks);
+    RUN_TEST(test_clear_keeps_capacity);
+    RUN_TEST(test_add_without_table_is_ignored);
+    RUN_TEST(test_text_dump_format);
+    RUN_TEST(test_text_dump_streams_in_chunks);
+    return UNITY_END();
+}
@@ -0,0 +1,113 @@
+#include <unity.h>
+#include "resume_state.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+static const uint8_t BSSID[6] = {0x24, 0x0a, 0xc4, 0x12, 0x34, 0x56};
+
+static RoomStatus makeStatus() {
+    RoomStatus status;
+    status.isValid = true;
+    status.room.id = "3f2a9c1e-7b4d-4e8a-9c21-5d6f7a8b9c0d";
+    status.room.name = "Boardroom";
+    status.room.floor = "2";
+    status.room.capacity = 12;
+    status.room.quickBookDurationCount = 2;
+    status.room.quickBookDurations[0] = 15;
+    status.room.quickBookDurations[1] = 30;
+    status.room.isValid = true;
+    status.isAvailable = false;
+    status.currentBooking.isValid = true;
+    status.currentBooking.id = "b1";
+    status.currentBooking.title = "Weekly sync";
+    status.currentBooking.startTime = "2025-03-12T09:00:00.000Z";
+    status.currentBooking.endTime = "2025-03-12T10:00:00.000Z";
+    status.currentBooking.isDeviceBooking = true;
+    status.upcomingCount = 1;
+    status.upcomingBookings[0].isValid = true;
+    status.upcomingBookings[0].id = "b2";
+    status.upcomingBookings[0].title = "Retro";
+    status.upcomingBookings[0].startTime = "2025-03-12T14:00:00.000Z";
+    status.upcomingBookings[0].endTime = "2025-03-12T15:00:00.000Z";
+    status.upcomingBookings[0].isDeviceBooking = false;
+    status.openingHour = 7;
+    status.closingHour = 19;
+    return status;
+}
+
+void test_round_trip() {
+    ResumeState state;
+    RoomStatus status = makeStatus();
+
+    saveResumeState(state, &status, 6, BSSID);
+    RoomStatus restored = restoreRoomStatus(state);
+
+    TEST_ASSERT_TRUE(resumeStateValid(state));
+    TEST_ASSERT_EQUAL_INT32(6, state.wifiChannel);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(BSSID, state.bssid, 6);
+    TEST_ASSERT_TRUE(restored.isValid);
+    TEST_ASSERT_EQUAL_STRING("Boardroom", restored.room.name.c_str());
+    TEST_ASSERT_EQUAL_STRING(status.room.id.c_str(), restored.room.id.c_str());
+    TEST_ASSERT_EQUAL_INT(12, restored.room.capacity);
+    TEST_ASSERT_EQUAL_INT(30, restored.room.quickBookDurations[1]);
+    TEST_ASSERT_FALSE(restored.isAvailable);
+    TEST_ASSERT_EQUAL_STRING("Weekly sync", restored.currentBooking.title.c_str());
+    TEST_ASSERT_TRUE(restored.currentBooking.isDeviceBooking);
+    TEST_ASSERT_EQUAL_INT(1, restored.upcomingCount);
+    TEST_ASSERT_EQUAL_STRING("2025-03-12T14:00:00.000Z", restored.upcomingBookings[0].startTime.c_str());
+    TEST_ASSERT_EQUAL_INT(7, restored.openingHour);
+    TEST_ASSERT_EQUAL_INT(19, restored.closingHour);
+}
+
+void test_long_title_cut_at_character_boundary() {
+    ResumeState state;
+    RoomStatus status = makeStatus();
+    // 62 ASCII bytes, then a 2-byte character that would straddle the limit
+    status.currentBooking.title = String("") + "12345678901234567890123456789012345678901234567890123456789012" + "\xc3\xa9" + "!";
+
+    saveResumeState(state, &status, 6, BSSID);
+    RoomStatus restored = restoreRoomStatus(state);
+
+    TEST_ASSERT_EQUAL_INT(62, restored.currentBooking.title.length());
+}
+
+void test_corruption_is_detected() {
+    ResumeState state;
+    RoomStatus status = makeStatus();
+    saveResumeState(state, &status, 6, BSSID);
+
+    state.status.roomName[0] ^= 1;
+
+    TEST_ASSERT_FALSE(resumeStateValid(state));
+    TEST_ASSERT_FALSE(restoreRoomStatus(state).isValid);
+}
+
+void test_zeroed_memory_is_invalid() {
+    ResumeState state;
+    clearResumeState(state);
+
+    TEST_ASSERT_FALSE(resumeStateValid(state));
+}
+
+void test_access_point_only() {
+    ResumeState state;
+
+    saveResumeState(state, nullptr, 11, BSSID);
+
+    TEST_ASSERT_TRUE(resumeStateValid(state));
+    TEST_ASSERT_FALSE(state.hasStatus);
+    TEST_ASSERT_EQUAL_INT32(11, state.wifiChannel);
+    TEST_ASSERT_FALSE(restoreRoomStatus(state).isValid);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_long_title_cut_at_character_boundary);
+    RUN_TEST(test_corruption_is_detected);
+    RUN_TEST(test_zeroed_memory_is_invalid);
+    RUN_TEST(test_access_point_only);
+    return UNITY_END();
+}
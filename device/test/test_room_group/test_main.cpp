@@ -0,0 +1,372 @@
+#include <unity.h>
+#include <string.h>
+#include <ESPmDNS.h>
+#include <mock_device_api.h>
+#include "clock.h"
+#include "config.h"
+#include "mqtt_link.h"
+#include "room_group.h"
+#include "sha256.h"
+#include "../fixtures/status_payloads.h"
+
+static const char* ROOM = "room-1";
+static const char* SECRET = "5f0b9d4c1e2a7368a9b0c1d2e3f40516";
+static const time_t MAR_12_2025 = 1741770000;  // 09:00 UTC
+static const char* TOKEN = "panel-token-a";
+static const char* STATUS_ROOM = "3f1c2a9e-6b1d-4d0e-9a51-0c2b8f7e4a11";  // Of STATUS_SMALL
+static const uint32_t LOCALHOST = (uint32_t)IPAddress(127, 0, 0, 1);
+
+static MockDeviceApi server;
+
+static RoomBeacon beacon(const char* key, bool upstreamOk = true, const char* room = ROOM) {
+    RoomBeacon b;
+    b.roomId = room;
+    b.key = key;
+    b.fingerprint = "00112233aabbccdd";
+    b.configVersion = 3;
+    b.upstreamOk = upstreamOk;
+    b.refresh = false;
+    b.sentAt = MAR_12_2025;
+    return b;
+}
+
+static RoomGroup group(const char* selfKey) {
+    RoomGroup g;
+    g.setSelfKey(selfKey);
+    g.setRoom(ROOM);
+    return g;
+}
+
+static String wire(const RoomBeacon& b, const char* secret = SECRET) {
+    return encodeRoomBeacon(b, secret);
+}
+
+static bool parse(const String& w, RoomBeacon& out, time_t now = MAR_12_2025) {
+    return parseRoomBeacon(w.c_str(), w.length(), SECRET, now, out);
+}
+
+void setUp() {
+    server.clearLog();
+    server.setResponse("GET", "/room-group", 200,
+                       String("{\"roomId\":\"") + STATUS_ROOM + "\",\"secret\":\"" + SECRET + "\"}");
+    server.setResponse("GET", "/status", 200, STATUS_SMALL);
+    server.setResponseHeader("GET", "/room/status", ROOM_GROUP_SIGNATURE_HEADER, "");
+    MDNS.answers.clear();
+}
+
+void tearDown() {
+    setClock(nullptr);
+}
+
+void test_hmac_known_answer() {
+    // RFC 4231, test case 2
+    TEST_ASSERT_EQUAL_STRING("5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843",
+                             hmacSha256Hex("Jefe", "what do ya want for nothing?").c_str());
+}
+
+void test_beacon_round_trip() {
+    RoomBeacon sent = beacon("8f3a000000000000");
+    sent.refresh = true;
+
+    RoomBeacon got;
+    TEST_ASSERT_TRUE(parse(wire(sent), got));
+    TEST_ASSERT_EQUAL_STRING(ROOM, got.roomId.c_str());
+    TEST_ASSERT_EQUAL_STRING("8f3a000000000000", got.key.c_str());
+    TEST_ASSERT_EQUAL_STRING("00112233aabbccdd", got.fingerprint.c_str());
+    TEST_ASSERT_EQUAL_UINT32(3, got.configVersion);
+    TEST_ASSERT_TRUE(got.upstreamOk);
+    TEST_ASSERT_TRUE(got.refresh);
+    TEST_ASSERT_EQUAL(MAR_12_2025, got.sentAt);
+}
+
+void test_bad_beacons_rejected() {
+    RoomBeacon got;
+    const char* unsigned1 = "{\"v\":1,\"r\":\"room-1\",\"k\":\"aa\",\"o\":1}";
+    const char* unsigned2 = "{\"v\":2,\"r\":\"room-1\",\"k\":\"aa\",\"o\":1,\"t\":1741770000}";
+    TEST_ASSERT_FALSE(parse(unsigned1, got));
+    TEST_ASSERT_FALSE(parse(unsigned2, got));
+    TEST_ASSERT_FALSE(parse("hello", got));
+    TEST_ASSERT_FALSE(parse(wire(beacon("")), got));
+}
+
+// A host on the LAN without the room's secret can't win the election
+void test_forged_beacons_rejected() {
+    RoomBeacon got;
+    TEST_ASSERT_FALSE(parse(wire(beacon("0000000000000000"), "guessed-secret"), got));
+
+    String tampered = wire(beacon("8f3a000000000000"));
+    tampered.replace("8f3a000000000000", "0000000000000000");
+    TEST_ASSERT_FALSE(parse(tampered, got));
+}
+
+void test_stale_beacons_rejected() {
+    RoomBeacon got;
+    String w = wire(beacon("8f3a000000000000"));
+    TEST_ASSERT_TRUE(parse(w, got, MAR_12_2025 + ROOM_GROUP_MAX_SKEW_S));
+    TEST_ASSERT_FALSE(parse(w, got, MAR_12_2025 + ROOM_GROUP_MAX_SKEW_S + 1));
+    TEST_ASSERT_FALSE(parse(w, got, MAR_12_2025 - ROOM_GROUP_MAX_SKEW_S - 1));
+    TEST_ASSERT_FALSE(parse(w, got, 40));  // Our clock isn't set
+}
+
+void test_replayed_beacons_ignored() {
+    RoomGroup g = group("5000000000000000");
+    RoomBeacon b = beacon("1000000000000000");
+    b.sentAt = MAR_12_2025 + 5;
+    TEST_ASSERT_EQUAL(ROOM_BEACON_NEW, g.onBeacon(b, 1, 0));
+
+    RoomBeacon earlier = beacon("1000000000000000");
+    TEST_ASSERT_EQUAL(ROOM_BEACON_IGNORED, g.onBeacon(earlier, 1, 1000));
+    TEST_ASSERT_EQUAL(ROOM_BEACON_IGNORED, g.onBeacon(b, 66, 1000));  // The same beacon from elsewhere
+    TEST_ASSERT_EQUAL_UINT32(1, g.peer(0).ip);
+
+    b.sentAt += 5;
+    TEST_ASSERT_EQUAL(ROOM_BEACON_KNOWN, g.onBeacon(b, 2, 5000));
+    TEST_ASSERT_EQUAL_UINT32(2, g.peer(0).ip);
+}
+
+void test_fingerprint_is_stable_and_short() {
+    String a = roomStatusFingerprint("{\"isAvailable\":true}");
+    TEST_ASSERT_EQUAL(16, a.length());
+    TEST_ASSERT_EQUAL_STRING(a.c_str(), roomStatusFingerprint("{\"isAvailable\":true}").c_str());
+    TEST_ASSERT_FALSE(a == roomStatusFingerprint("{\"isAvailable\":false}"));
+}
+
+void test_only_our_room_counts() {
+    RoomGroup g = group("5000000000000000");
+
+    TEST_ASSERT_EQUAL(ROOM_BEACON_IGNORED, g.onBeacon(beacon("1000000000000000", true, "room-2"), 1, 0));
+    TEST_ASSERT_EQUAL(ROOM_BEACON_IGNORED, g.onBeacon(beacon("5000000000000000"), 1, 0));  // Our own
+    TEST_ASSERT_EQUAL(ROOM_BEACON_NEW, g.onBeacon(beacon("1000000000000000"), 1, 0));
+    RoomBeacon later = beacon("1000000000000000");
+    later.sentAt++;
+    TEST_ASSERT_EQUAL(ROOM_BEACON_KNOWN, g.onBeacon(later, 2, 1000));
+    TEST_ASSERT_EQUAL(1, g.count());
+    TEST_ASSERT_EQUAL_UINT32(2, g.peer(0).ip);  // Moved address
+
+    g.setRoom("room-2");
+    TEST_ASSERT_EQUAL(0, g.count());
+}
+
+void test_lowest_key_that_reaches_the_server_leads() {
+    RoomGroup g = group("5000000000000000");
+    TEST_ASSERT_NULL(g.leader(0, true));  // Alone
+
+    g.onBeacon(beacon("9000000000000000"), 9, 0);
+    TEST_ASSERT_NULL(g.leader(0, true));
+
+    g.onBeacon(beacon("1000000000000000", false), 1, 0);
+    TEST_ASSERT_NULL(g.leader(0, true));  // Lower, but can't poll
+
+    g.onBeacon(beacon("3000000000000000"), 3, 0);
+    const RoomPeer* leader = g.leader(0, true);
+    TEST_ASSERT_NOT_NULL(leader);
+    TEST_ASSERT_EQUAL_STRING("3000000000000000", leader->beacon.key.c_str());
+
+    // Without a server ourselves, the lowest peer that has one leads
+    g.onBeacon(beacon("3000000000000000", false), 3, 0);
+    leader = g.leader(0, false);
+    TEST_ASSERT_NOT_NULL(leader);
+    TEST_ASSERT_EQUAL_STRING("9000000000000000", leader->beacon.key.c_str());
+}
+
+void test_silent_leader_is_dropped() {
+    RoomGroup g = group("5000000000000000");
+    g.onBeacon(beacon("1000000000000000"), 1, 0);
+    g.onBeacon(beacon("9000000000000000"), 9, 0);
+    TEST_ASSERT_NOT_NULL(g.leader(ROOM_GROUP_PEER_TIMEOUT_MS, true));
+    TEST_ASSERT_TRUE(g.hasPeer(1, ROOM_GROUP_PEER_TIMEOUT_MS));
+
+    // 9 keeps beaconing, 1 went quiet: we lead again without waiting for expire()
+    g.onBeacon(beacon("9000000000000000"), 9, ROOM_GROUP_PEER_TIMEOUT_MS);
+    TEST_ASSERT_NULL(g.leader(ROOM_GROUP_PEER_TIMEOUT_MS + 1, true));
+    TEST_ASSERT_FALSE(g.hasPeer(1, ROOM_GROUP_PEER_TIMEOUT_MS + 1));
+
+    g.expire(ROOM_GROUP_PEER_TIMEOUT_MS + 1);
+    TEST_ASSERT_EQUAL(1, g.count());
+    TEST_ASSERT_EQUAL_STRING("9000000000000000", g.peer(0).beacon.key.c_str());
+}
+
+void test_table_is_bounded() {
+    RoomGroup g = group("0000000000000000");
+    char key[17];
+    for (int i = 0; i < ROOM_GROUP_MAX_PEERS; i++) {
+        snprintf(key, sizeof(key), "%016d", i + 1);
+        TEST_ASSERT_EQUAL(ROOM_BEACON_NEW, g.onBeacon(beacon(key), i + 1, 0));
+    }
+    TEST_ASSERT_EQUAL(ROOM_BEACON_IGNORED, g.onBeacon(beacon("ffffffffffffffff"), 99, 0));
+    TEST_ASSERT_EQUAL(ROOM_GROUP_MAX_PEERS, g.count());
+}
+
+// A panel whose API is the mock server, which also plays the leader's web server
+struct LinkFixture {
+    SimulatedClock clock;
+    ApiClient api;
+    RoomGroupLink link;
+
+    LinkFixture() : clock(MAR_12_2025, 100000), link(api) {
+        setClock(&clock);
+        api.setApiUrl(server.url());
+        api.setDeviceToken(TOKEN);
+        link.setRelayPort(server.port());
+    }
+
+    RoomGroupEvent loop(bool selfOk = true) { return link.loop(true, STATUS_ROOM, selfOk, 1); }
+
+    // A beacon from the mock server's address
+    void hear(const char* key, const String& fingerprint, const char* secret = SECRET) {
+        RoomBeacon b = beacon(key, true, STATUS_ROOM);
+        b.fingerprint = fingerprint;
+        b.configVersion = 1;
+        b.sentAt = clock.wallTime();
+        link.udp().incoming.push_back({IPAddress(LOCALHOST), ROOM_GROUP_PORT, encodeRoomBeacon(b, secret)});
+    }
+};
+
+void test_link_starts_with_the_servers_key() {
+    LinkFixture f;
+    f.clock.setWallTime(40);  // Before NTP
+    TEST_ASSERT_EQUAL(ROOM_GROUP_IDLE, f.loop());
+    TEST_ASSERT_FALSE(f.link.running());
+    TEST_ASSERT_EQUAL(0, server.requestCount("GET", "/room-group"));
+
+    f.clock.setWallTime(MAR_12_2025);
+    f.clock.advanceMs(ROOM_GROUP_BEACON_MS);
+    f.loop();
+    TEST_ASSERT_TRUE(f.link.running());
+    TEST_ASSERT_EQUAL(1, server.requestCount("GET", "/room-group"));
+    TEST_ASSERT_EQUAL(ROOM_GROUP_PORT, f.link.udp().localPort);
+    MDNSResponder::Service* service = MDNS.service("openmeeting", "udp");
+    TEST_ASSERT_NOT_NULL(service);
+    TEST_ASSERT_EQUAL_STRING(STATUS_ROOM, service->txt["room"].c_str());
+    TEST_ASSERT_EQUAL_STRING(mqttDeviceKey(TOKEN).c_str(), service->txt["key"].c_str());
+
+    f.link.loop(false, STATUS_ROOM, true, 1);
+    TEST_ASSERT_FALSE(f.link.running());
+    TEST_ASSERT_NULL(MDNS.service("openmeeting", "udp"));
+}
+
+// Servers without room group keys leave the group off, and aren't asked often
+void test_link_needs_a_key_for_the_room() {
+    server.setResponse("GET", "/room-group", 404, "{\"error\":\"Not found\"}");
+    LinkFixture f;
+    f.loop();
+    f.clock.advanceMs(ROOM_GROUP_KEY_RETRY_MS - 1);
+    f.loop();
+    TEST_ASSERT_FALSE(f.link.running());
+    TEST_ASSERT_EQUAL(1, server.requestCount("GET", "/room-group"));
+
+    // The key is for another room: the device moved since our status
+    server.setResponse("GET", "/room-group", 200, String("{\"roomId\":\"room-2\",\"secret\":\"") + SECRET + "\"}");
+    f.clock.advanceMs(1);
+    f.loop();
+    TEST_ASSERT_FALSE(f.link.running());
+    TEST_ASSERT_EQUAL(2, server.requestCount("GET", "/room-group"));
+}
+
+void test_link_ignores_unsigned_peers() {
+    LinkFixture f;
+    f.loop();
+    f.link.udp().sent.clear();
+
+    f.hear("0000000000000000", "", "guessed-secret");
+    f.loop();
+    TEST_ASSERT_EQUAL(0, f.link.group().count());
+    TEST_ASSERT_NULL(f.link.leader());
+
+    f.hear("0000000000000000", "");
+    f.loop();
+    TEST_ASSERT_EQUAL(1, f.link.group().count());
+    TEST_ASSERT_NOT_NULL(f.link.leader());
+    // Answered so it learns about us, signed with the room's key
+    TEST_ASSERT_EQUAL(1, f.link.udp().sent.size());
+    RoomBeacon answer;
+    const String& sent = f.link.udp().sent[0].data;
+    TEST_ASSERT_TRUE(parseRoomBeacon(sent.c_str(), sent.length(), SECRET, f.clock.wallTime(), answer));
+    TEST_ASSERT_EQUAL_STRING(mqttDeviceKey(TOKEN).c_str(), answer.key.c_str());
+}
+
+void test_relay_answers_signed_requests_only() {
+    LinkFixture f;
+    f.api.getRoomStatus();
+    f.loop();
+    String body;
+    String signature;
+    time_t t = f.clock.wallTime();
+    String mac = roomRelayRequestMac(SECRET, STATUS_ROOM, t);
+    TEST_ASSERT_EQUAL(403, f.link.answerRelay(LOCALHOST, String((long)t), mac, body, signature));  // Not a peer yet
+
+    f.hear("ffffffffffffffff", "");
+    f.loop();
+    TEST_ASSERT_EQUAL(200, f.link.answerRelay(LOCALHOST, String((long)t), mac, body, signature));
+    TEST_ASSERT_EQUAL_STRING(STATUS_SMALL, body.c_str());
+    TEST_ASSERT_EQUAL_STRING(roomRelaySignature(SECRET, STATUS_ROOM, t, body).c_str(), signature.c_str());
+
+    TEST_ASSERT_EQUAL(403, f.link.answerRelay(LOCALHOST, String((long)t), "", body, signature));
+    TEST_ASSERT_EQUAL(403, f.link.answerRelay(LOCALHOST, String((long)t),
+                                              roomRelayRequestMac("guessed-secret", STATUS_ROOM, t), body, signature));
+    TEST_ASSERT_EQUAL(403, f.link.answerRelay(LOCALHOST, String((long)(t + 1)), mac, body, signature));
+
+    // A request captured on the LAN goes stale
+    f.clock.advanceSeconds(ROOM_GROUP_MAX_SKEW_S + 1);
+    f.hear("ffffffffffffffff", "");
+    f.loop();
+    TEST_ASSERT_EQUAL(403, f.link.answerRelay(LOCALHOST, String((long)t), mac, body, signature));
+}
+
+// The follower checks the leader's signature and never takes the config
+// block from a relayed body
+void test_follower_takes_the_signed_status_only() {
+    String relayed = String(STATUS_SMALL);
+    relayed.replace("\"isAvailable\":true}",
+                    "\"isAvailable\":true,\"config\":{\"version\":1,\"apiUrls\":[\"http://10.0.0.66:3001\"]}}");
+    server.setResponse("GET", "/room/status", 200, relayed);
+    LinkFixture f;
+    f.loop();
+    f.hear("0000000000000000", roomStatusFingerprint(relayed));
+    TEST_ASSERT_EQUAL(ROOM_GROUP_IDLE, f.loop());  // Unsigned answer
+    TEST_ASSERT_EQUAL(1, server.requestCount("GET", "/room/status"));
+    String query = server.requests().back().query;
+    time_t t = f.clock.wallTime();
+    TEST_ASSERT_EQUAL_STRING(("t=" + String((long)t) + "&m=" + roomRelayRequestMac(SECRET, STATUS_ROOM, t)).c_str(),
+                             query.c_str());
+
+    f.clock.advanceMs(ROOM_GROUP_BEACON_MS + 1);
+    server.setResponseHeader("GET", "/room/status", ROOM_GROUP_SIGNATURE_HEADER,
+                             roomRelaySignature(SECRET, STATUS_ROOM, f.clock.wallTime(), relayed));
+    f.hear("0000000000000000", roomStatusFingerprint(relayed));
+    TEST_ASSERT_EQUAL(ROOM_GROUP_RELAYED, f.loop());
+    TEST_ASSERT_TRUE(f.link.relayedStatus().isValid);
+    TEST_ASSERT_FALSE(f.link.relayedStatus().hasConfig);
+    TEST_ASSERT_EQUAL_STRING(roomStatusFingerprint(relayed).c_str(), f.link.fingerprint().c_str());
+
+    // Further beacons with that fingerprint vouch for it
+    f.clock.advanceMs(ROOM_GROUP_BEACON_MS);
+    f.hear("0000000000000000", roomStatusFingerprint(relayed));
+    TEST_ASSERT_EQUAL(ROOM_GROUP_VOUCHED, f.loop());
+    TEST_ASSERT_EQUAL_UINT32(f.clock.monotonicMs(), f.link.vouchedAt());
+    TEST_ASSERT_EQUAL(2, server.requestCount("GET", "/room/status"));
+}
+
+int main(int argc, char** argv) {
+    server.start();
+    UNITY_BEGIN();
+    RUN_TEST(test_hmac_known_answer);
+    RUN_TEST(test_beacon_round_trip);
+    RUN_TEST(test_bad_beacons_rejected);
+    RUN_TEST(test_forged_beacons_rejected);
+    RUN_TEST(test_stale_beacons_rejected);
+    RUN_TEST(test_replayed_beacons_ignored);
+    RUN_TEST(test_fingerprint_is_stable_and_short);
+    RUN_TEST(test_only_our_room_counts);
+    RUN_TEST(test_lowest_key_that_reaches_the_server_leads);
+    RUN_TEST(test_silent_leader_is_dropped);
+    RUN_TEST(test_table_is_bounded);
+    RUN_TEST(test_link_starts_with_the_servers_key);
+    RUN_TEST(test_link_needs_a_key_for_the_room);
+    RUN_TEST(test_link_ignores_unsigned_peers);
+    RUN_TEST(test_relay_answers_signed_requests_only);
+    RUN_TEST(test_follower_takes_the_signed_status_only);
+    int result = UNITY_END();
+    server.stop();
+    return result;
+}
@@ -0,0 +1,103 @@
+#include <unity.h>
+#include "config.h"
+#include "status_led.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_available_is_green_whatever_the_time() {
+    TEST_ASSERT_EQUAL(LED_PATTERN_AVAILABLE, roomLedPattern(true, false, 0));
+    TEST_ASSERT_EQUAL(LED_PATTERN_AVAILABLE, roomLedPattern(true, true, 60));
+}
+
+void test_occupied_until_the_last_minutes() {
+    TEST_ASSERT_EQUAL(LED_PATTERN_OCCUPIED, roomLedPattern(false, true, LED_ENDING_SOON_S + 1));
+    TEST_ASSERT_EQUAL(LED_PATTERN_ENDING_SOON, roomLedPattern(false, true, LED_ENDING_SOON_S));
+    TEST_ASSERT_EQUAL(LED_PATTERN_ENDING_SOON, roomLedPattern(false, true, 1));
+}
+
+void test_overdue_meeting_keeps_pulsing() {
+    TEST_ASSERT_EQUAL(LED_PATTERN_ENDING_SOON, roomLedPattern(false, true, -30));
+}
+
+void test_unknown_end_stays_red() {
+    TEST_ASSERT_EQUAL(LED_PATTERN_OCCUPIED, roomLedPattern(false, false, 0));
+}
+
+void test_every_pattern_has_steps() {
+    for (int i = 0; i < LED_PATTERN_COUNT; i++) {
+        const LedPatternSteps& p = ledPatternSteps((LedPattern)i);
+        TEST_ASSERT_NOT_NULL(p.steps);
+        TEST_ASSERT_TRUE(p.count > 0);
+    }
+}
+
+// The booking flash returns to the room pattern, so it must not end lit
+void test_booked_flash_plays_once_and_ends_dark() {
+    const LedPatternSteps& p = ledPatternSteps(LED_PATTERN_BOOKED);
+    const LedStep& last = p.steps[p.count - 1];
+
+    TEST_ASSERT_FALSE(p.repeat);
+    TEST_ASSERT_EQUAL_UINT8(0, last.red);
+    TEST_ASSERT_EQUAL_UINT8(0, last.green);
+    TEST_ASSERT_EQUAL_UINT8(0, last.blue);
+}
+
+void test_solid_pattern_average_is_its_colour() {
+    uint8_t red, green, blue;
+
+    ledPatternAverage(LED_PATTERN_OCCUPIED, 255, red, green, blue);
+
+    TEST_ASSERT_EQUAL_UINT8(255, red);
+    TEST_ASSERT_EQUAL_UINT8(0, green);
+    TEST_ASSERT_EQUAL_UINT8(0, blue);
+}
+
+void test_repeating_pattern_average_is_time_weighted() {
+    uint8_t red, green, blue;
+
+    ledPatternAverage(LED_PATTERN_OFFLINE, 255, red, green, blue);
+
+    // Half brightness for 2000 / 2 + 200 + 2000 / 2 ms of a 5000 ms cycle
+    TEST_ASSERT_EQUAL_UINT8(127 * 2200 / 5000, red);
+    TEST_ASSERT_EQUAL_UINT8(red, green);
+    TEST_ASSERT_EQUAL_UINT8(red, blue);
+}
+
+void test_average_scales_with_level() {
+    uint8_t red, green, blue;
+
+    ledPatternAverage(LED_PATTERN_AVAILABLE, 255 - LED_BRIGHTNESS, red, green, blue);
+
+    TEST_ASSERT_EQUAL_UINT8(255 - LED_BRIGHTNESS, green);
+    TEST_ASSERT_EQUAL_UINT8(0, red);
+}
+
+void test_scale_led_level() {
+    TEST_ASSERT_EQUAL_UINT8(200, scaleLedLevel(255, 200));
+    TEST_ASSERT_EQUAL_UINT8(0, scaleLedLevel(255, 0));
+    TEST_ASSERT_EQUAL_UINT8(127, scaleLedLevel(127, 255));
+}
+
+void test_out_of_range_pattern_is_off() {
+    const LedPatternSteps& p = ledPatternSteps(LED_PATTERN_COUNT);
+
+    TEST_ASSERT_EQUAL_PTR(ledPatternSteps(LED_PATTERN_OFF).steps, p.steps);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_available_is_green_whatever_the_time);
+    RUN_TEST(test_occupied_until_the_last_minutes);
+    RUN_TEST(test_overdue_meeting_keeps_pulsing);
+    RUN_TEST(test_unknown_end_stays_red);
+    RUN_TEST(test_every_pattern_has_steps);
+    RUN_TEST(test_booked_flash_plays_once_and_ends_dark);
+    RUN_TEST(test_solid_pattern_average_is_its_colour);
+    RUN_TEST(test_repeating_pattern_average_is_time_weighted);
+    RUN_TEST(test_average_scales_with_level);
+    RUN_TEST(test_scale_led_level);
+    RUN_TEST(test_out_of_range_pattern_is_off);
+    return UNITY_END();
+}
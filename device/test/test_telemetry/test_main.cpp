@@ -0,0 +1,114 @@
+#include <unity.h>
+#include <ArduinoJson.h>
+#include "config.h"
+#include "telemetry.h"
+
+static Telemetry telemetry;
+
+void setUp() {
+    telemetry.begin(1234, true, 0);
+}
+
+void tearDown() {}
+
+void test_no_sample_before_the_minute_is_up() {
+    telemetry.recordPoll(true, 100);
+    TEST_ASSERT_FALSE(telemetry.tick(TELEMETRY_SAMPLE_MS - 1, -60));
+    TEST_ASSERT_EQUAL(0, telemetry.pending());
+}
+
+void test_sample_aggregates_the_minute() {
+    telemetry.recordPoll(true, 100);
+    telemetry.recordPoll(true, 300);
+    telemetry.recordPoll(false, 10000);
+    telemetry.recordRedraw(40);
+    telemetry.recordHeap(90000);
+    telemetry.recordHeap(80000);
+    telemetry.recordHeap(85000);
+    TEST_ASSERT_TRUE(telemetry.tick(TELEMETRY_SAMPLE_MS, -61));
+
+    const TelemetrySample& s = telemetry.sample(0);
+    TEST_ASSERT_EQUAL(0, s.seq);
+    TEST_ASSERT_EQUAL(3, s.polls);
+    TEST_ASSERT_EQUAL(1, s.pollErrors);
+    TEST_ASSERT_EQUAL(400, s.pollMsSum);  // Failed polls don't count toward latency
+    TEST_ASSERT_EQUAL(300, s.pollMsMax);
+    TEST_ASSERT_EQUAL(80000, s.heapMin);
+    TEST_ASSERT_EQUAL(-61, s.rssi);
+    TEST_ASSERT_EQUAL(1, s.redraws);
+    TEST_ASSERT_EQUAL(40, s.redrawMsMax);
+}
+
+void test_next_sample_starts_empty() {
+    telemetry.recordPoll(true, 100);
+    telemetry.tick(TELEMETRY_SAMPLE_MS, -60);
+    telemetry.tick(2 * TELEMETRY_SAMPLE_MS, -60);
+
+    TEST_ASSERT_EQUAL(2, telemetry.pending());
+    TEST_ASSERT_EQUAL(1, telemetry.sample(1).seq);
+    TEST_ASSERT_EQUAL(0, telemetry.sample(1).polls);
+}
+
+void test_resume_does_not_count_a_reboot() {
+    telemetry.begin(99, false, 0);
+    telemetry.tick(TELEMETRY_SAMPLE_MS, -60);
+    TEST_ASSERT_EQUAL(1, telemetry.sample(0).seq);
+}
+
+void test_encode_has_ages_and_first_seq() {
+    telemetry.recordPoll(true, 120);
+    telemetry.tick(TELEMETRY_SAMPLE_MS, -70);
+    telemetry.tick(2 * TELEMETRY_SAMPLE_MS, 0);
+
+    JsonDocument doc;
+    TEST_ASSERT_FALSE(deserializeJson(doc, telemetry.encode(2 * TELEMETRY_SAMPLE_MS + 5000)));
+    TEST_ASSERT_EQUAL(1, doc["v"].as<int>());
+    TEST_ASSERT_EQUAL(1234, doc["b"].as<int>());
+    TEST_ASSERT_EQUAL(0, doc["n"].as<int>());
+
+    JsonArray samples = doc["s"];
+    TEST_ASSERT_EQUAL(2, samples.size());
+    TEST_ASSERT_EQUAL(65, samples[0][0].as<int>());
+    TEST_ASSERT_EQUAL(1, samples[0][1].as<int>());
+    TEST_ASSERT_EQUAL(120, samples[0][3].as<int>());
+    TEST_ASSERT_EQUAL(-70, samples[0][6].as<int>());
+    TEST_ASSERT_EQUAL(5, samples[1][0].as<int>());
+    TEST_ASSERT_EQUAL(0, samples[1][6].as<int>());
+}
+
+void test_acknowledge_drops_the_uploaded_samples() {
+    telemetry.tick(TELEMETRY_SAMPLE_MS, -60);
+    telemetry.tick(2 * TELEMETRY_SAMPLE_MS, -60);
+    telemetry.acknowledge(1);
+
+    TEST_ASSERT_EQUAL(1, telemetry.pending());
+    TEST_ASSERT_EQUAL(1, telemetry.sample(0).seq);
+
+    JsonDocument doc;
+    deserializeJson(doc, telemetry.encode(2 * TELEMETRY_SAMPLE_MS));
+    TEST_ASSERT_EQUAL(1, doc["n"].as<int>());
+}
+
+// A full buffer drops from the front, so what is left stays consecutive
+void test_full_buffer_drops_the_oldest() {
+    for (uint32_t i = 1; i <= TELEMETRY_BUFFER_SAMPLES + 3; i++) {
+        telemetry.tick(i * TELEMETRY_SAMPLE_MS, -60);
+    }
+
+    TEST_ASSERT_EQUAL(TELEMETRY_BUFFER_SAMPLES, telemetry.pending());
+    TEST_ASSERT_EQUAL(3, telemetry.dropped());
+    TEST_ASSERT_EQUAL(3, telemetry.sample(0).seq);
+    TEST_ASSERT_EQUAL(TELEMETRY_BUFFER_SAMPLES + 2, telemetry.sample(TELEMETRY_BUFFER_SAMPLES - 1).seq);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_no_sample_before_the_minute_is_up);
+    RUN_TEST(test_sample_aggregates_the_minute);
+    RUN_TEST(test_next_sample_starts_empty);
+    RUN_TEST(test_resume_does_not_count_a_reboot);
+    RUN_TEST(test_encode_has_ages_and_first_seq);
+    RUN_TEST(test_acknowledge_drops_the_uploaded_samples);
+    RUN_TEST(test_full_buffer_drops_the_oldest);
+    return UNITY_END();
+}
@@ -0,0 +1,108 @@
+#include <unity.h>
+#include "time_utils.h"
+#include "timezones.h"
+
+void setUp() {}
+void tearDown() {}
+
+void test_leap_years() {
+    TEST_ASSERT_TRUE(isLeapYear(2000));
+    TEST_ASSERT_TRUE(isLeapYear(2024));
+    TEST_ASSERT_FALSE(isLeapYear(1900));
+    TEST_ASSERT_FALSE(isLeapYear(2100));
+    TEST_ASSERT_FALSE(isLeapYear(2025));
+}
+
+void test_utc_to_timestamp_known_values() {
+    TEST_ASSERT_EQUAL_INT64(0, (int64_t)utcToTimestamp(1970, 1, 1, 0, 0, 0));
+    TEST_ASSERT_EQUAL_INT64(951825600, (int64_t)utcToTimestamp(2000, 2, 29, 12, 0, 0));
+    TEST_ASSERT_EQUAL_INT64(1735689599, (int64_t)utcToTimestamp(2024, 12, 31, 23, 59, 59));
+    TEST_ASSERT_EQUAL_INT64(1741770300, (int64_t)utcToTimestamp(2025, 3, 12, 9, 5, 0));
+}
+
+void test_utc_to_timestamp_matches_timegm() {
+    // Walk ~60 years in 13-day steps with varying time of day
+    for (time_t t = 0; t < 1900000000; t += 13 * 86400 + 3671) {
+        struct tm tm;
+        gmtime_r(&t, &tm);
+        time_t ours = utcToTimestamp(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                                     tm.tm_hour, tm.tm_min, tm.tm_sec);
+        TEST_ASSERT_EQUAL_INT64((int64_t)t, (int64_t)ours);
+    }
+}
+
+void test_parse_iso_timestamp() {
+    TEST_ASSERT_EQUAL_INT64(1741770300, (int64_t)parseIsoTimestamp("2025-03-12T09:05:00.000Z"));
+    TEST_ASSERT_EQUAL_INT64(1741770300, (int64_t)parseIsoTimestamp("2025-03-12T09:05:00Z"));
+    TEST_ASSERT_EQUAL_INT64(0, (int64_t)parseIsoTimestamp("not a time"));
+    TEST_ASSERT_EQUAL_INT64(0, (int64_t)parseIsoTimestamp(""));
+}
+
+void test_format_utc() {
+    TEST_ASSERT_EQUAL_STRING("09:05", formatLocalTime("2025-03-12T09:05:00.000Z", "UTC0").c_str());
+    TEST_ASSERT_EQUAL_STRING("23:59", formatLocalTime("2025-03-12T23:59:59Z", "UTC0").c_str());
+}
+
+void test_format_central_europe_winter_and_summer() {
+    const char* cet = "CET-1CEST,M3.5.0,M10.5.0/3";
+    TEST_ASSERT_EQUAL_STRING("10:05", formatLocalTime("2025-03-12T09:05:00.000Z", cet).c_str());
+    TEST_ASSERT_EQUAL_STRING("11:05", formatLocalTime("2025-07-01T09:05:00.000Z", cet).c_str());
+}
+
+void test_format_across_dst_switch() {
+    const char* cet = "CET-1CEST,M3.5.0,M10.5.0/3";
+    // Clocks jump from 02:00 to 03:00 local on 2025-03-30
+    TEST_ASSERT_EQUAL_STRING("01:59", formatLocalTime("2025-03-30T00:59:00.000Z", cet).c_str());
+    TEST_ASSERT_EQUAL_STRING("03:00", formatLocalTime("2025-03-30T01:00:00.000Z", cet).c_str());
+    // And back from 03:00 to 02:00 on 2025-10-26
+    TEST_ASSERT_EQUAL_STRING("02:59", formatLocalTime("2025-10-26T00:59:00.000Z", cet).c_str());
+    TEST_ASSERT_EQUAL_STRING("02:00", formatLocalTime("2025-10-26T01:00:00.000Z", cet).c_str());
+}
+
+void test_format_other_zones() {
+    TEST_ASSERT_EQUAL_STRING("10:30", formatLocalTime("2025-03-12T14:30:00.000Z", "EST5EDT,M3.2.0,M11.1.0").c_str());
+    TEST_ASSERT_EQUAL_STRING("20:00", formatLocalTime("2025-03-12T14:30:00.000Z", "<+0530>-5:30").c_str());
+    TEST_ASSERT_EQUAL_STRING("03:30", formatLocalTime("2025-03-12T14:30:00.000Z", "NZST-12NZDT,M9.5.0,M4.1.0/3").c_str());
+}
+
+void test_format_every_configured_timezone() {
+    // Every zone offered in the setup page must produce a valid HH:MM
+    for (int i = 0; i < TIMEZONE_COUNT; i++) {
+        String formatted = formatLocalTime("2025-06-15T12:00:00.000Z", TIMEZONES[i].posixString);
+        TEST_ASSERT_EQUAL_MESSAGE(5, formatted.length(), TIMEZONES[i].name);
+        TEST_ASSERT_EQUAL_CHAR(':', formatted.charAt(2));
+    }
+}
+
+void test_timezone_reapplied_after_tz_reset() {
+    const char* cet = "CET-1CEST,M3.5.0,M10.5.0/3";
+    struct tm local;
+    applyTimezone(cet);
+    // configTime(0, 0, ...) does this on every (re)start of NTP
+    setenv("TZ", "UTC0", 1);
+    tzset();
+    toLocalTime(utcToTimestamp(2025, 3, 12, 9, 5, 0), cet, local);
+    TEST_ASSERT_EQUAL(10, local.tm_hour);
+    TEST_ASSERT_EQUAL_STRING("10:05", formatLocalTime("2025-03-12T09:05:00.000Z", "").c_str());
+}
+
+void test_format_passthrough() {
+    TEST_ASSERT_EQUAL_STRING("", formatLocalTime("", "UTC0").c_str());
+    TEST_ASSERT_EQUAL_STRING("not a time", formatLocalTime("not a time", "UTC0").c_str());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_leap_years);
+    RUN_TEST(test_utc_to_timestamp_known_values);
+    RUN_TEST(test_utc_to_timestamp_matches_timegm);
+    RUN_TEST(test_parse_iso_timestamp);
+    RUN_TEST(test_format_utc);
+    RUN_TEST(test_format_central_europe_winter_and_summer);
+    RUN_TEST(test_format_across_dst_switch);
+    RUN_TEST(test_format_other_zones);
+    RUN_TEST(test_format_every_configured_timezone);
+    RUN_TEST(test_timezone_reapplied_after_tz_reset);
+    RUN_TEST(test_format_passthrough);
+    return UNITY_END();
+}
@@ -0,0 +1,172 @@
+#include <unity.h>
+#include <ArduinoJson.h>
+#include <mock_device_api.h>
+#include "api_client.h"
+#include "config.h"
+#include "trace.h"
+#include "../fixtures/status_payloads.h"
+
+static String exported;
+static int chunks = 0;
+
+static void collect(const String& chunk) {
+    exported += chunk;
+    chunks++;
+}
+
+static String exportJson(size_t chunkBytes = 1024) {
+    exported = "";
+    chunks = 0;
+    traceWriteJson(collect, chunkBytes);
+    return exported;
+}
+
+// Names of the B/E/i events in the buffer, e.g. "B:loop E:loop"
+static String phases() {
+    String out;
+    for (size_t i = 0; i < traceEventCount(); i++) {
+        const TraceEvent& ev = traceEventAt(i);
+        if (out.length() > 0) out += " ";
+        out += ev.phase;
+        out += ":";
+        out += ev.name;
+    }
+    return out;
+}
+
+void setUp() {
+    traceClear();
+}
+
+void tearDown() {}
+
+void test_begin_end_recorded_in_order() {
+    TRACE_BEGIN("outer");
+    TRACE_BEGIN("inner");
+    delay(2);
+    TRACE_END("inner");
+    TRACE_INSTANT("mark");
+    TRACE_END("outer");
+
+    TEST_ASSERT_EQUAL_STRING("B:outer B:inner E:inner i:mark E:outer", phases().c_str());
+    uint32_t innerUs = traceEventAt(2).timestampUs - traceEventAt(1).timestampUs;
+    TEST_ASSERT_TRUE(innerUs >= 2000);
+    for (size_t i = 1; i < traceEventCount(); i++) {
+        TEST_ASSERT_TRUE(traceEventAt(i).timestampUs >= traceEventAt(i - 1).timestampUs);
+    }
+}
+
+static int earlyReturn(bool bail) {
+    TRACE_SCOPE("scoped");
+    if (bail) return 1;
+    TRACE_INSTANT("work");
+    return 0;
+}
+
+void test_scope_ends_on_early_return() {
+    earlyReturn(true);
+    earlyReturn(false);
+
+    TEST_ASSERT_EQUAL_STRING("B:scoped E:scoped B:scoped i:work E:scoped", phases().c_str());
+}
+
+void test_ring_keeps_newest_events() {
+    for (int i = 0; i < TRACE_BUFFER_EVENTS; i++) {
+        TRACE_INSTANT("old");
+    }
+    TRACE_BEGIN("new");
+    TRACE_END("new");
+
+    TEST_ASSERT_EQUAL(TRACE_BUFFER_EVENTS, traceEventCount());
+    TEST_ASSERT_EQUAL_STRING("old", traceEventAt(0).name);
+    TEST_ASSERT_EQUAL_STRING("new", traceEventAt(TRACE_BUFFER_EVENTS - 2).name);
+    TEST_ASSERT_EQUAL_STRING("new", traceEventAt(TRACE_BUFFER_EVENTS - 1).name);
+}
+
+void test_export_is_chrome_trace_json() {
+    TRACE_BEGIN("loop");
+    TRACE_BEGIN("http");
+    TRACE_END("http");
+    TRACE_END("loop");
+
+    JsonDocument doc;
+    TEST_ASSERT_FALSE(deserializeJson(doc, exportJson()));
+
+    JsonArray events = doc["traceEvents"];
+    TEST_ASSERT_EQUAL(5, events.size());  // Thread name metadata + 4
+    TEST_ASSERT_EQUAL_STRING("M", events[0]["ph"]);
+    TEST_ASSERT_EQUAL_STRING("loop", events[1]["name"]);
+    TEST_ASSERT_EQUAL_STRING("B", events[1]["ph"]);
+    TEST_ASSERT_EQUAL(0, events[1]["ts"].as<long>());
+    TEST_ASSERT_EQUAL_STRING("http", events[3]["name"]);
+    TEST_ASSERT_EQUAL_STRING("E", events[3]["ph"]);
+    TEST_ASSERT_EQUAL(1, events[4]["pid"].as<int>());
+    TEST_ASSERT_EQUAL(1, events[4]["tid"].as<int>());
+}
+
+void test_export_drops_ends_without_begin() {
+    // The begin of "lost" is overwritten once the ring wraps
+    TRACE_BEGIN("lost");
+    for (int i = 0; i < TRACE_BUFFER_EVENTS - 2; i++) {
+        TRACE_INSTANT("tick");
+    }
+    TRACE_END("lost");
+    TRACE_BEGIN("kept");
+    TRACE_END("kept");
+
+    JsonDocument doc;
+    TEST_ASSERT_FALSE(deserializeJson(doc, exportJson()));
+
+    for (JsonObject ev : doc["traceEvents"].as<JsonArray>()) {
+        TEST_ASSERT_NOT_EQUAL(0, strcmp("lost", ev["name"] | ""));
+    }
+    JsonArray events = doc["traceEvents"];
+    TEST_ASSERT_EQUAL_STRING("kept", events[events.size() - 1]["name"]);
+}
+
+void test_export_streams_in_chunks_and_is_not_traced() {
+    for (int i = 0; i < 200; i++) {
+        TRACE_BEGIN("draw");
+        TRACE_END("draw");
+    }
+
+    String whole = exportJson(1 << 20);
+    TEST_ASSERT_EQUAL(1, chunks);
+
+    String pieces = exportJson(256);
+    TEST_ASSERT_TRUE(chunks > 10);
+    TEST_ASSERT_EQUAL_STRING(whole.c_str(), pieces.c_str());
+
+    TEST_ASSERT_EQUAL(400, traceEventCount());
+}
+
+void test_api_request_phases() {
+    MockDeviceApi server;
+    server.setResponse("GET", "/status", 200, STATUS_TYPICAL);
+    server.start();
+    ApiClient client;
+    client.setApiUrl(server.url());
+    client.setDeviceToken("test-device-token");
+
+    RoomStatus status = client.getRoomStatus();
+    server.stop();
+
+    TEST_ASSERT_TRUE(status.isValid);
+    TEST_ASSERT_EQUAL_STRING(
+        "B:http B:http.begin E:http.begin B:http.request E:http.request "
+        "B:http.body E:http.body B:http.end E:http.end E:http "
+        "B:json.parse E:json.parse",
+        phases().c_str());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_end_recorded_in_order);
+    RUN_TEST(test_scope_ends_on_early_return);
+    RUN_TEST(test_ring_keeps_newest_events);
+    RUN_TEST(test_export_is_chrome_trace_json);
+    RUN_TEST(test_export_drops_ends_without_begin);
+    RUN_TEST(test_export_streams_in_chunks_and_is_not_traced);
+    RUN_TEST(test_api_request_phases);
+    return UNITY_END();
+}
@@ -0,0 +1,375 @@
+// Fleet load simulator: emulates many display panels polling one backend.
+//
+// Every simulated panel runs the firmware's own ApiClient (request building,
+// X-Device-Token auth and response parsing) on the same timers as main.cpp:
+// status poll, ping, firmware report/check, plus occasional quick bookings.
+//
+//   pio run -e fleet_sim
+//   .pio/build/fleet_sim/program --url http://localhost:3001 --tokens tokens.txt --devices 300
+//
+// tokens.txt holds one device token per line; panels reuse tokens round-robin
+// when there are fewer tokens than devices.
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+#include "config.h"
+#include "api_client.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    String url;
+    std::vector<String> tokens;
+    int devices = 100;
+    int durationSec = 300;
+    int threads = 64;
+    int rampSec = STATUS_POLL_INTERVAL / 1000;  // Spread boot-up over one poll interval
+    unsigned long pollMs = STATUS_POLL_INTERVAL;
+    unsigned long pingMs = PING_INTERVAL;
+    unsigned long firmwareMs = FIRMWARE_CHECK_INTERVAL;
+    double jitter = 0.1;                  // +/- fraction applied to every interval
+    double quickBooksPerHour = 0.5;       // Per device
+    double maxErrorRate = -1;             // Exit non-zero above this (0..1)
+    double maxP99Ms = -1;                 // Exit non-zero above this
+    unsigned seed = 1;
+};
+
+enum Action {
+    ACT_BOOT,
+    ACT_STATUS,
+    ACT_PING,
+    ACT_FIRMWARE,
+    ACT_QUICK_BOOK,
+    ACT_END_MEETING
+};
+
+struct Event {
+    Clock::time_point due;
+    int device;
+    Action action;
+    bool operator>(const Event& other) const { return due > other.due; }
+};
+
+struct SimDevice {
+    ApiClient client;
+    std::mutex busy;  // A real panel does one thing at a time
+    std::mt19937 rng; // Seeded from --seed and the panel's index, so runs repeat
+    bool hasQuickBooking = false;
+};
+
+// Per-endpoint request statistics
+struct EndpointStats {
+    std::vector<uint32_t> latenciesUs;
+    uint64_t ok = 0;
+    uint64_t http4xx = 0;
+    uint64_t http5xx = 0;
+    uint64_t transport = 0;
+    uint64_t invalid = 0;  // 2xx but the firmware could not use the body
+    uint64_t bytesIn = 0;
+
+    uint64_t total() const { return ok + http4xx + http5xx + transport + invalid; }
+    uint64_t errors() const { return total() - ok; }
+};
+
+static Options opts;
+static std::vector<std::unique_ptr<SimDevice>> devices;
+static std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+static std::mutex eventsMutex;
+static std::condition_variable eventsCv;
+static std::atomic<bool> stopping(false);
+static std::map<std::string, EndpointStats> stats;
+static std::mutex statsMutex;
+static Clock::time_point startTime;
+
+// Draws for a panel come from its own generator: which worker thread runs
+// an event doesn't change them
+static Clock::duration jittered(SimDevice& dev, unsigned long ms) {
+    std::uniform_real_distribution<double> dist(1.0 - opts.jitter, 1.0 + opts.jitter);
+    return std::chrono::microseconds((long long)(ms * 1000.0 * dist(dev.rng)));
+}
+
+static void schedule(int device, Action action, Clock::time_point due) {
+    {
+        std::lock_guard<std::mutex> lock(eventsMutex);
+        events.push({due, device, action});
+    }
+    eventsCv.notify_one();
+}
+
+static void scheduleQuickBook(int device, Clock::time_point from) {
+    if (opts.quickBooksPerHour <= 0) return;
+    std::exponential_distribution<double> dist(opts.quickBooksPerHour / 3600.0);
+    schedule(device, ACT_QUICK_BOOK, from + std::chrono::microseconds((long long)(dist(devices[device]->rng) * 1e6)));
+}
+
+// Record the request ApiClient just made on this thread
+static void record(bool usable) {
+    const HttpExchange& ex = HTTPClient::lastExchange();
+    std::string path = ex.path.c_str();
+    const std::string prefix = "/api/device";
+    if (path.compare(0, prefix.size(), prefix) == 0) path = path.substr(prefix.size());
+    std::string key = std::string(ex.method.c_str()) + " " + path;
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    EndpointStats& s = stats[key];
+    s.latenciesUs.push_back(ex.latencyUs);
+    s.bytesIn += ex.bytesIn;
+    if (ex.code < 0) s.transport++;
+    else if (usable) s.ok++;  // Includes answers the caller expects, like 409 on a taken slot
+    else if (ex.code >= 500) s.http5xx++;
+    else if (ex.code >= 400) s.http4xx++;
+    else s.invalid++;
+}
+
+static void runEvent(const Event& ev) {
+    SimDevice& dev = *devices[ev.device];
+    std::lock_guard<std::mutex> lock(dev.busy);
+    Clock::time_point now = Clock::now();
+
+    switch (ev.action) {
+        case ACT_BOOT: {
+            // Same order as setup(): report firmware, then first status
+            record(dev.client.reportFirmwareVersion(FIRMWARE_VERSION));
+            record(dev.client.getRoomStatus().isValid);
+            schedule(ev.device, ACT_STATUS, now + jittered(dev, opts.pollMs));
+            schedule(ev.device, ACT_PING, now + jittered(dev, opts.pingMs));
+            // First firmware check 60s after boot, as in setup()
+            schedule(ev.device, ACT_FIRMWARE, now + jittered(dev, 60000));
+            scheduleQuickBook(ev.device, now);
+            break;
+        }
+        case ACT_STATUS:
+            record(dev.client.getRoomStatus().isValid);
+            schedule(ev.device, ACT_STATUS, now + jittered(dev, opts.pollMs));
+            break;
+        case ACT_PING:
+            record(dev.client.ping());
+            schedule(ev.device, ACT_PING, now + jittered(dev, opts.pingMs));
+            break;
+        case ACT_FIRMWARE:
+            record(dev.client.reportFirmwareVersion(FIRMWARE_VERSION));
+            dev.client.checkForFirmwareUpdate();
+            record(HTTPClient::lastExchange().bytesIn > 0);
+            schedule(ev.device, ACT_FIRMWARE, now + jittered(dev, opts.firmwareMs));
+            break;
+        case ACT_QUICK_BOOK: {
+            QuickBookResult result = dev.client.quickBook("Load test", QUICK_BOOK_15);
+            // 409 (already booked) and 400 (outside hours) are expected outcomes, not failures
+            int code = HTTPClient::lastExchange().code;
+            record(result.success || code == 400 || code == 409);
+            // Like the UI, refresh status right after the booking result
+            record(dev.client.getRoomStatus().isValid);
+            if (result.success && std::uniform_int_distribution<int>(0, 1)(dev.rng) == 1) {
+                schedule(ev.device, ACT_END_MEETING, now + jittered(dev, 5 * 60000));
+            }
+            scheduleQuickBook(ev.device, now);
+            break;
+        }
+        case ACT_END_MEETING: {
+            EndMeetingResult result = dev.client.endMeeting();
+            int code = HTTPClient::lastExchange().code;
+            record(result.success || code == 400 || code == 404);
+            record(dev.client.getRoomStatus().isValid);
+            break;
+        }
+    }
+}
+
+static void worker() {
+    std::unique_lock<std::mutex> lock(eventsMutex);
+    while (!stopping) {
+        if (events.empty()) {
+            eventsCv.wait(lock);
+            continue;
+        }
+        Event ev = events.top();
+        if (Clock::now() < ev.due) {
+            eventsCv.wait_until(lock, ev.due);
+            continue;
+        }
+        events.pop();
+        lock.unlock();
+        runEvent(ev);
+        lock.lock();
+    }
+}
+
+static uint32_t percentile(std::vector<uint32_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t idx = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[idx];
+}
+
+static void printProgress() {
+    uint64_t total = 0, errors = 0;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        for (auto& kv : stats) {
+            total += kv.second.total();
+            errors += kv.second.errors();
+        }
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - startTime).count();
+    size_t queued;
+    {
+        std::lock_guard<std::mutex> lock(eventsMutex);
+        queued = events.size();
+    }
+    printf("[%6.0fs] requests=%llu (%.1f/s) errors=%llu queued=%zu\n", elapsed,
+           (unsigned long long)total, total / elapsed, (unsigned long long)errors, queued);
+    fflush(stdout);
+}
+
+// Print the final report; returns false when a configured threshold was exceeded
+static bool printReport() {
+    double elapsed = std::chrono::duration<double>(Clock::now() - startTime).count();
+    bool pass = true;
+    uint64_t total = 0, errors = 0;
+
+    printf("\n%d devices, %.0f s\n", opts.devices, elapsed);
+    printf("%-28s %9s %8s %9s %9s %9s %7s %6s %6s %6s %6s\n", "endpoint", "requests", "req/s",
+           "p50 ms", "p99 ms", "max ms", "err %", "4xx", "5xx", "net", "bad");
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    for (auto& kv : stats) {
+        EndpointStats& s = kv.second;
+        std::sort(s.latenciesUs.begin(), s.latenciesUs.end());
+        double p50 = percentile(s.latenciesUs, 0.50) / 1000.0;
+        double p99 = percentile(s.latenciesUs, 0.99) / 1000.0;
+        double max = s.latenciesUs.empty() ? 0 : s.latenciesUs.back() / 1000.0;
+        double errRate = s.total() ? (double)s.errors() / s.total() : 0;
+        total += s.total();
+        errors += s.errors();
+
+        printf("%-28s %9llu %8.2f %9.1f %9.1f %9.1f %7.2f %6llu %6llu %6llu %6llu\n", kv.first.c_str(),
+               (unsigned long long)s.total(), s.total() / elapsed, p50, p99, max, errRate * 100,
+               (unsigned long long)s.http4xx, (unsigned long long)s.http5xx,
+               (unsigned long long)s.transport, (unsigned long long)s.invalid);
+
+        if (opts.maxP99Ms >= 0 && p99 > opts.maxP99Ms) {
+            printf("  FAIL: p99 %.1f ms above limit %.1f ms\n", p99, opts.maxP99Ms);
+            pass = false;
+        }
+    }
+
+    double errRate = total ? (double)errors / total : 0;
+    printf("%-28s %9llu %8.2f %39.2f\n", "total", (unsigned long long)total, total / elapsed, errRate * 100);
+    if (opts.maxErrorRate >= 0 && errRate > opts.maxErrorRate) {
+        printf("FAIL: error rate %.2f%% above limit %.2f%%\n", errRate * 100, opts.maxErrorRate * 100);
+        pass = false;
+    }
+    return pass;
+}
+
+static void usage() {
+    printf("Usage: fleet_sim --url URL (--tokens FILE | --token TOKEN...) [options]\n"
+           "  --devices N          simulated panels (default 100)\n"
+           "  --duration SEC       test length (default 300)\n"
+           "  --threads N          concurrent requests (default 64)\n"
+           "  --ramp SEC           spread boot-up over SEC, 0 = all at once (default 30)\n"
+           "  --poll MS            status poll interval (default %d)\n"
+           "  --ping MS            ping interval (default %d)\n"
+           "  --firmware MS        firmware check interval (default %d)\n"
+           "  --jitter FRACTION    interval jitter, e.g. 0.1 = +/-10%% (default 0.1)\n"
+           "  --quick-books RATE   quick bookings per device per hour (default 0.5)\n"
+           "  --max-error-rate F   exit 1 if overall error rate exceeds F (0..1)\n"
+           "  --max-p99-ms MS      exit 1 if any endpoint's p99 exceeds MS\n"
+           "  --seed N             random seed (default 1)\n",
+           STATUS_POLL_INTERVAL, PING_INTERVAL, FIRMWARE_CHECK_INTERVAL);
+}
+
+static bool parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        String arg = argv[i];
+        if (i + 1 >= argc) {
+            printf("Missing value for %s\n", argv[i]);
+            return false;
+        }
+        const char* value = argv[++i];
+
+        if (arg == "--url") opts.url = value;
+        else if (arg == "--token") opts.tokens.push_back(value);
+        else if (arg == "--tokens") {
+            std::ifstream in(value);
+            std::string line;
+            while (std::getline(in, line)) {
+                String token(line);
+                token.trim();
+                if (token.length() > 0 && token.charAt(0) != '#') opts.tokens.push_back(token);
+            }
+        }
+        else if (arg == "--devices") opts.devices = atoi(value);
+        else if (arg == "--duration") opts.durationSec = atoi(value);
+        else if (arg == "--threads") opts.threads = atoi(value);
+        else if (arg == "--ramp") opts.rampSec = atoi(value);
+        else if (arg == "--poll") opts.pollMs = strtoul(value, nullptr, 10);
+        else if (arg == "--ping") opts.pingMs = strtoul(value, nullptr, 10);
+        else if (arg == "--firmware") opts.firmwareMs = strtoul(value, nullptr, 10);
+        else if (arg == "--jitter") opts.jitter = atof(value);
+        else if (arg == "--quick-books") opts.quickBooksPerHour = atof(value);
+        else if (arg == "--max-error-rate") opts.maxErrorRate = atof(value);
+        else if (arg == "--max-p99-ms") opts.maxP99Ms = atof(value);
+        else if (arg == "--seed") opts.seed = (unsigned)atoi(value);
+        else {
+            printf("Unknown option %s\n", argv[i - 1]);
+            return false;
+        }
+    }
+    return opts.url.length() > 0 && !opts.tokens.empty() && opts.devices > 0 && opts.threads > 0;
+}
+
+int main(int argc, char** argv) {
+    if (!parseArgs(argc, argv)) {
+        usage();
+        return 2;
+    }
+
+    printf("Simulating %d panels against %s with %zu token(s), %d threads\n",
+           opts.devices, opts.url.c_str(), opts.tokens.size(), opts.threads);
+
+    startTime = Clock::now();
+    std::mt19937 bootRng(opts.seed);
+    for (int i = 0; i < opts.devices; i++) {
+        devices.emplace_back(new SimDevice());
+        devices[i]->client.setApiUrl(opts.url);
+        devices[i]->client.setDeviceToken(opts.tokens[i % opts.tokens.size()]);
+        std::seed_seq seq{opts.seed, (unsigned)i};
+        devices[i]->rng.seed(seq);
+
+        long long offsetUs = opts.rampSec > 0
+            ? std::uniform_int_distribution<long long>(0, opts.rampSec * 1000000LL)(bootRng)
+            : 0;
+        schedule(i, ACT_BOOT, startTime + std::chrono::microseconds(offsetUs));
+    }
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < opts.threads; i++) {
+        workers.emplace_back(worker);
+    }
+
+    Clock::time_point end = startTime + std::chrono::seconds(opts.durationSec);
+    while (Clock::now() < end) {
+        std::this_thread::sleep_until(std::min(end, Clock::now() + std::chrono::seconds(10)));
+        printProgress();
+    }
+
+    stopping = true;
+    eventsCv.notify_all();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+
+    return printReport() ? 0 : 1;
+}
@@ -0,0 +1,365 @@
+#include "edge_gateway.h"
+
+#include <ArduinoJson.h>
+#include <HTTPClient.h>
+#include <time.h>
+#include "sha256.h"
+
+// Forwarded requests get the backend's own answer, however long it takes
+static const uint16_t FORWARD_TIMEOUT_MS = 30000;
+static const uint32_t SYNC_RETRY_MIN_MS = 5000;
+static const uint32_t SYNC_RETRY_MAX_MS = 60000;
+
+// Panel request headers the backend looks at
+static const char* FORWARD_REQUEST_HEADERS[] = {
+    "content-type", "x-device-token", "x-config-version", "x-room-version", "if-none-match",
+};
+// Backend response headers panels look at
+static const char* FORWARD_RESPONSE_HEADERS[] = {
+    "Content-Type", "ETag", "Retry-After", "X-Poll-Interval", "X-Firmware-Version", "X-Firmware-Checksum",
+};
+
+String GatewayRequest::header(const char* name) const {
+    auto it = headers.find(name);
+    return it != headers.end() ? it->second : String("");
+}
+
+static GatewayResponse jsonError(int status, const char* message) {
+    GatewayResponse response;
+    response.status = status;
+    response.body = String("{\"error\":\"") + message + "\"}";
+    return response;
+}
+
+static String isoNow() {
+    time_t now = time(nullptr);
+    struct tm utc;
+    gmtime_r(&now, &utc);
+    char buf[32];
+    strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S.000Z", &utc);
+    return String(buf);
+}
+
+EdgeGateway::EdgeGateway(const GatewayOptions& options) : _options(options) {
+    while (_options.upstreamUrl.endsWith("/")) {
+        _options.upstreamUrl = _options.upstreamUrl.substring(0, _options.upstreamUrl.length() - 1);
+    }
+}
+
+void EdgeGateway::start() {
+    if (_running) return;
+    _running = true;
+    _threads.emplace_back(&EdgeGateway::deviceLoop, this);
+    _threads.emplace_back(&EdgeGateway::statusLoop, this);
+}
+
+void EdgeGateway::stop() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+    }
+    _wake.notify_all();
+    for (std::thread& t : _threads) {
+        t.join();
+    }
+    _threads.clear();
+}
+
+bool EdgeGateway::sleepUnlessStopped(uint32_t ms, bool untilDevicesWanted) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _wake.wait_for(lock, std::chrono::milliseconds(ms), [&] {
+        return !_running || (untilDevicesWanted && _devicesWanted);
+    });
+    return _running;
+}
+
+void EdgeGateway::deviceLoop() {
+    while (_running) {
+        bool ok = syncDevices();
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _devicesWanted = false;
+        }
+        sleepUnlessStopped(ok ? _options.deviceSyncSec * 1000 : SYNC_RETRY_MIN_MS, true);
+    }
+}
+
+void EdgeGateway::statusLoop() {
+    uint32_t retryMs = SYNC_RETRY_MIN_MS;
+    while (_running) {
+        // Rooms without a status yet are fetched straight away
+        bool missing = false;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (const auto& room : _rooms) {
+                if (room.second.etag.length() == 0) missing = true;
+            }
+        }
+        if (syncStatus(missing ? 0 : _options.waitSec)) {
+            retryMs = SYNC_RETRY_MIN_MS;
+        } else {
+            sleepUnlessStopped(retryMs);
+            retryMs = retryMs * 2 > SYNC_RETRY_MAX_MS ? SYNC_RETRY_MAX_MS : retryMs * 2;
+        }
+    }
+}
+
+bool EdgeGateway::syncDevices() {
+    HTTPClient http;
+    http.begin(_options.upstreamUrl + "/api/gateway/devices");
+    http.setTimeout(FORWARD_TIMEOUT_MS);
+    http.addHeader("X-Gateway-Token", _options.gatewayToken);
+    int code = http.GET();
+    if (code != 200) {
+        _upstreamErrors++;
+        Serial.printf("Device sync failed: %d\n", code);
+        return false;
+    }
+
+    JsonDocument doc;
+    if (deserializeJson(doc, http.getString())) {
+        _upstreamErrors++;
+        return false;
+    }
+
+    std::map<String, DeviceEntry> devices;
+    for (JsonObject d : doc["devices"].as<JsonArray>()) {
+        DeviceEntry entry;
+        entry.id = d["id"].as<String>();
+        entry.roomId = d["roomId"] | "";  // Empty while the device has no room
+        devices[d["tokenHash"].as<String>()] = entry;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::set<String> roomIds;
+    for (const auto& d : devices) {
+        // A device without a room has no status to cache; its polls are forwarded
+        if (d.second.roomId.length() == 0) continue;
+        roomIds.insert(d.second.roomId);
+        _rooms[d.second.roomId];  // New rooms start without a status
+    }
+    for (auto it = _rooms.begin(); it != _rooms.end();) {
+        it = roomIds.count(it->first) ? std::next(it) : _rooms.erase(it);
+    }
+    if (devices.size() != _devices.size()) {
+        Serial.printf("Devices: %u in %u rooms\n", (unsigned)devices.size(), (unsigned)_rooms.size());
+    }
+    _devices.swap(devices);
+    return true;
+}
+
+bool EdgeGateway::syncStatus(uint32_t waitSec) {
+    JsonDocument request;
+    std::set<String> seen;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        JsonObject rooms = request["rooms"].to<JsonObject>();
+        for (const auto& room : _rooms) {
+            rooms[room.first] = room.second.etag;
+        }
+        request["configVersion"] = _configVersion;
+        request["wait"] = waitSec;
+        seen.swap(_seen);
+        JsonArray seenDoc = request["seen"].to<JsonArray>();
+        for (const String& id : seen) {
+            seenDoc.add(id);
+        }
+    }
+    String body;
+    serializeJson(request, body);
+
+    HTTPClient http;
+    http.begin(_options.upstreamUrl + "/api/gateway/status");
+    http.setTimeout((waitSec + 10) * 1000);
+    http.addHeader("Content-Type", "application/json");
+    http.addHeader("X-Gateway-Token", _options.gatewayToken);
+    int code = http.POST(body);
+
+    JsonDocument doc;
+    if (code != 200 || deserializeJson(doc, http.getString())) {
+        _upstreamErrors++;
+        Serial.printf("Status sync failed: %d\n", code);
+        // Report them with the next attempt
+        std::lock_guard<std::mutex> lock(_mutex);
+        _seen.insert(seen.begin(), seen.end());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (JsonPair kv : doc["rooms"].as<JsonObject>()) {
+        String roomId = kv.key().c_str();
+        auto it = _rooms.find(roomId);
+        if (it == _rooms.end()) continue;
+        if (kv.value().isNull()) {
+            // Not in this gateway's park: its panels are forwarded
+            _rooms.erase(it);
+            continue;
+        }
+        RoomEntry& room = it->second;
+        room.body = "";
+        room.dynamicBody = "";
+        serializeJson(kv.value()["status"], room.body);
+        serializeJson(kv.value()["dynamic"], room.dynamicBody);
+        room.etag = kv.value()["etag"].as<String>();
+        room.dynamicEtag = kv.value()["dynamicEtag"].as<String>();
+        room.stale = false;
+    }
+
+    JsonVariant config = doc["config"];
+    _configJson = "";
+    if (config.is<JsonObject>()) serializeJson(config, _configJson);
+    _configVersion = config["version"] | 0;
+    _lastStatusSync = millis();
+    _statusSynced = true;
+    return true;
+}
+
+bool EdgeGateway::cachedDevice(const String& token, DeviceEntry& out) {
+    String hash = sha256Hex(token);
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _devices.find(hash);
+    if (it == _devices.end()) return false;
+    out = it->second;
+    return true;
+}
+
+void EdgeGateway::markSeen(const String& deviceId) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _seen.insert(deviceId);
+}
+
+bool EdgeGateway::serveStatus(const GatewayRequest& request, const String& roomId, GatewayResponse& out) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _rooms.find(roomId);
+    if (it == _rooms.end() || it->second.etag.length() == 0 || it->second.stale) return false;
+    // Cut off from the backend for too long: let the panel see that
+    if (!_statusSynced || millis() - _lastStatusSync > _options.maxStaleSec * 1000) return false;
+
+    const RoomEntry& room = it->second;
+    bool dynamic = request.hasHeader("x-room-version");
+    const String& body = dynamic ? room.dynamicBody : room.body;
+    const String& etag = dynamic ? room.dynamicEtag : room.etag;
+
+    // Same rule as the backend: the config block goes to panels that don't have it
+    if (_configVersion > 0 && request.header("x-config-version") != String((unsigned long)_configVersion)) {
+        out.status = 200;
+        out.body = body.substring(0, body.length() - 1) + ",\"config\":" + _configJson + "}";
+        return true;
+    }
+
+    out.headers.push_back({"ETag", etag});
+    if (request.header("if-none-match") == etag) {
+        out.status = 304;
+        out.body = "";
+        _notModified++;
+    } else {
+        out.status = 200;
+        out.body = body;
+    }
+    return true;
+}
+
+GatewayResponse EdgeGateway::forward(const GatewayRequest& request) {
+    HTTPClient http;
+    http.begin(_options.upstreamUrl + "/api/device" + request.path);
+    http.setTimeout(FORWARD_TIMEOUT_MS);
+    for (const char* name : FORWARD_REQUEST_HEADERS) {
+        if (request.hasHeader(name)) http.addHeader(name, request.header(name));
+    }
+    http.addHeader("X-Gateway-Token", _options.gatewayToken);
+    http.collectHeaders(FORWARD_RESPONSE_HEADERS, sizeof(FORWARD_RESPONSE_HEADERS) / sizeof(FORWARD_RESPONSE_HEADERS[0]));
+
+    int code = http.sendRequest(request.method.c_str(), request.body);
+    _forwarded++;
+    if (code <= 0) {
+        _upstreamErrors++;
+        return jsonError(502, "Backend unreachable");
+    }
+
+    GatewayResponse response;
+    response.status = code;
+    response.body = http.getString();
+    for (const char* name : FORWARD_RESPONSE_HEADERS) {
+        String value = http.header(name);
+        if (value.length() == 0) continue;
+        if (strcmp(name, "Content-Type") == 0) {
+            response.contentType = value;
+        } else {
+            response.headers.push_back({name, value});
+        }
+    }
+    return response;
+}
+
+GatewayResponse EdgeGateway::handle(const GatewayRequest& request) {
+    int query = request.path.indexOf('?');
+    String route = query >= 0 ? request.path.substring(0, query) : request.path;
+    String token = request.header("x-device-token");
+
+    DeviceEntry device;
+    bool known = token.length() > 0 && cachedDevice(token, device);
+
+    if (request.method == "GET" && (route == "/status" || route == "/ping")) {
+        if (token.length() == 0) return jsonError(401, "Device token required");
+        if (known) {
+            GatewayResponse response;
+            if (route == "/ping") {
+                response.body = "{\"status\":\"ok\",\"timestamp\":\"" + isoNow() + "\"}";
+                markSeen(device.id);
+                _servedLocal++;
+                return response;
+            }
+            if (serveStatus(request, device.roomId, response)) {
+                markSeen(device.id);
+                _servedLocal++;
+                return response;
+            }
+        }
+    }
+
+    GatewayResponse response = forward(request);
+    bool ok = response.status >= 200 && response.status < 300;
+    if (ok && !known && token.length() > 0) {
+        // A device added since the last sync: fetch the list now
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _devicesWanted = true;
+        }
+        _wake.notify_all();
+    }
+    if (ok && known && (route == "/quick-book" || route == "/end-meeting")) {
+        // Until the long-poll brings the new status, the room's panels ask upstream
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _rooms.find(device.roomId);
+        if (it != _rooms.end()) it->second.stale = true;
+    }
+    return response;
+}
+
+String EdgeGateway::statsJson() {
+    JsonDocument doc;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        doc["upstream"] = _options.upstreamUrl;
+        doc["devices"] = _devices.size();
+        doc["rooms"] = _rooms.size();
+        size_t cached = 0;
+        for (const auto& room : _rooms) {
+            if (room.second.etag.length() > 0 && !room.second.stale) cached++;
+        }
+        doc["roomsCached"] = cached;
+        doc["configVersion"] = _configVersion;
+        if (_statusSynced) {
+            doc["lastStatusSyncS"] = (millis() - _lastStatusSync) / 1000;
+        } else {
+            doc["lastStatusSyncS"] = nullptr;
+        }
+    }
+    doc["servedLocal"] = (uint32_t)_servedLocal;
+    doc["notModified"] = (uint32_t)_notModified;
+    doc["forwarded"] = (uint32_t)_forwarded;
+    doc["upstreamErrors"] = (uint32_t)_upstreamErrors;
+    String out;
+    serializeJson(doc, out);
+    return out;
+}
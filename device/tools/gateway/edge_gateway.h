@@ -0,0 +1,110 @@
+#ifndef EDGE_GATEWAY_H
+#define EDGE_GATEWAY_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// A device API request as a panel sent it to the gateway
+struct GatewayRequest {
+    String method;
+    String path;                        // Relative to /api/device, with any query
+    std::map<String, String> headers;   // Lower-case names
+    String body;
+
+    String header(const char* name) const;
+    bool hasHeader(const char* name) const { return headers.count(name) > 0; }
+};
+
+struct GatewayResponse {
+    int status = 200;
+    String body;
+    String contentType = "application/json; charset=utf-8";
+    std::vector<std::pair<String, String>> headers;
+};
+
+struct GatewayOptions {
+    String upstreamUrl;         // Central backend, e.g. http://meet.example.com:3001
+    String gatewayToken;        // One of the backend's GATEWAY_TOKENS
+    uint32_t waitSec = 25;      // Long-poll hold asked of the backend
+    uint32_t deviceSyncSec = 60;
+    uint32_t maxStaleSec = 600; // Serve cached statuses this long without reaching the backend
+};
+
+// Answers the /api/device/* requests of a site's panels. /status and /ping
+// are served from memory: the device list comes from the backend's
+// /api/gateway/devices and the status of every room from one long-polled
+// /api/gateway/status, which returns as soon as a room's bookings change.
+// Everything else (quick-book, end-meeting, info, telemetry, firmware) is
+// forwarded upstream with the panel's own token.
+class EdgeGateway {
+public:
+    explicit EdgeGateway(const GatewayOptions& options);
+
+    // Sync threads; stop() waits for them (at most one long-poll)
+    void start();
+    void stop();
+
+    GatewayResponse handle(const GatewayRequest& request);
+
+    // One sync round each, also used by start()'s threads
+    bool syncDevices();
+    bool syncStatus(uint32_t waitSec);
+
+    // Counters and state as JSON, for GET /gateway
+    String statsJson();
+
+private:
+    struct DeviceEntry {
+        String id;
+        String roomId;
+    };
+
+    struct RoomEntry {
+        String body;          // Full status
+        String etag;
+        String dynamicBody;   // Without the room, for panels sending X-Room-Version
+        String dynamicEtag;
+        bool stale = false;   // Changed by a forwarded mutation, newer status not here yet
+    };
+
+    GatewayOptions _options;
+
+    std::mutex _mutex;
+    std::map<String, DeviceEntry> _devices;  // By token hash
+    std::map<String, RoomEntry> _rooms;
+    std::set<String> _seen;                  // Device ids to report on the next status sync
+    String _configJson;                      // Runtime config block, "" when none
+    uint32_t _configVersion = 0;
+    uint32_t _lastStatusSync = 0;            // millis() of the last successful status sync
+    bool _statusSynced = false;
+
+    std::atomic<bool> _running{false};
+    std::condition_variable _wake;           // Device sync early, or stop
+    bool _devicesWanted = false;
+    std::vector<std::thread> _threads;
+
+    std::atomic<uint32_t> _servedLocal{0};
+    std::atomic<uint32_t> _notModified{0};
+    std::atomic<uint32_t> _forwarded{0};
+    std::atomic<uint32_t> _upstreamErrors{0};
+
+    void deviceLoop();
+    void statusLoop();
+    // false once stopped; with untilDevicesWanted, also wakes for a device sync
+    bool sleepUnlessStopped(uint32_t ms, bool untilDevicesWanted = false);
+    void markSeen(const String& deviceId);
+
+    // false when the room's status has to come from upstream
+    bool serveStatus(const GatewayRequest& request, const String& roomId, GatewayResponse& out);
+    GatewayResponse forward(const GatewayRequest& request);
+    bool cachedDevice(const String& token, DeviceEntry& out);
+};
+
+#endif // EDGE_GATEWAY_H
@@ -0,0 +1,99 @@
+// Edge gateway: answers a site's panels from a box on their LAN.
+//
+// Panels point their API URL at the gateway instead of the backend. The
+// gateway keeps the site's device tokens and the status of every room in
+// memory, long-polls the backend for changes with one request for all rooms,
+// and forwards everything else (quick-book, end-meeting, firmware, ...).
+//
+//   pio run -e edge_gateway
+//   .pio/build/edge_gateway/program --upstream http://meet.example.com:3001 --token GATEWAY_TOKEN
+//
+// The token is one of the backend's GATEWAY_TOKENS and decides which park's
+// panels the gateway serves.
+
+#include <Arduino.h>
+#include <atomic>
+#include <signal.h>
+#include "edge_gateway.h"
+#include "gateway_server.h"
+
+struct Options {
+    GatewayOptions gateway;
+    String bindAddress = "0.0.0.0";
+    uint16_t port = 3001;
+};
+
+static Options opts;
+static std::atomic<bool> stopping(false);
+
+static void onSignal(int) {
+    stopping = true;
+}
+
+static void usage() {
+    printf("Usage: edge_gateway --upstream URL --token TOKEN [options]\n"
+           "  --upstream URL       backend base URL, http:// only\n"
+           "  --token TOKEN        gateway token from the backend's GATEWAY_TOKENS\n"
+           "  --listen PORT        port panels connect to (default 3001)\n"
+           "  --bind ADDR          address to listen on (default 0.0.0.0)\n"
+           "  --wait SEC           long-poll hold asked of the backend (default 25)\n"
+           "  --device-sync SEC    device list refresh interval (default 60)\n"
+           "  --max-stale SEC      serve cached statuses this long with the backend down (default 600)\n");
+}
+
+static bool parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        String arg = argv[i];
+        if (i + 1 >= argc) {
+            printf("Missing value for %s\n", argv[i]);
+            return false;
+        }
+        const char* value = argv[++i];
+
+        if (arg == "--upstream") opts.gateway.upstreamUrl = value;
+        else if (arg == "--token") opts.gateway.gatewayToken = value;
+        else if (arg == "--listen") opts.port = (uint16_t)atoi(value);
+        else if (arg == "--bind") opts.bindAddress = value;
+        else if (arg == "--wait") opts.gateway.waitSec = strtoul(value, nullptr, 10);
+        else if (arg == "--device-sync") opts.gateway.deviceSyncSec = strtoul(value, nullptr, 10);
+        else if (arg == "--max-stale") opts.gateway.maxStaleSec = strtoul(value, nullptr, 10);
+        else {
+            printf("Unknown option %s\n", argv[i - 1]);
+            return false;
+        }
+    }
+    while (opts.gateway.upstreamUrl.endsWith("/")) {
+        opts.gateway.upstreamUrl = opts.gateway.upstreamUrl.substring(0, opts.gateway.upstreamUrl.length() - 1);
+    }
+    return opts.gateway.upstreamUrl.startsWith("http://") && opts.gateway.gatewayToken.length() > 0 &&
+           opts.port > 0 && opts.gateway.deviceSyncSec > 0;
+}
+
+int main(int argc, char** argv) {
+    if (!parseArgs(argc, argv)) {
+        usage();
+        return 2;
+    }
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    EdgeGateway gateway(opts.gateway);
+    GatewayServer server(gateway);
+    if (!server.start(opts.bindAddress, opts.port)) {
+        printf("Cannot listen on %s:%u\n", opts.bindAddress.c_str(), opts.port);
+        return 1;
+    }
+    gateway.start();
+    printf("Edge gateway on %s:%u for %s\n", opts.bindAddress.c_str(), opts.port, opts.gateway.upstreamUrl.c_str());
+
+    while (!stopping) {
+        delay(200);
+    }
+
+    printf("Stopping\n");
+    server.stop();
+    gateway.stop();
+    return 0;
+}
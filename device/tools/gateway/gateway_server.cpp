@@ -0,0 +1,208 @@
+#include "gateway_server.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+static const char* API_PREFIX = "/api/device";
+static const size_t MAX_CONNECTIONS = 1024;
+static const size_t MAX_HEADER_BYTES = 16 * 1024;
+static const long MAX_BODY_BYTES = 64 * 1024;
+static const int IDLE_TIMEOUT_S = 30;  // Keep-alive connections left idle are closed
+
+static String statusText(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 404: return "Not Found";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 429: return "Too Many Requests";
+        case 500: return "Internal Server Error";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        default: return "Status";
+    }
+}
+
+static bool sendAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static bool sendResponse(int fd, const GatewayResponse& response, bool keepAlive) {
+    String raw = "HTTP/1.1 " + String(response.status) + " " + statusText(response.status) + "\r\n";
+    if (response.status != 304) raw += "Content-Type: " + response.contentType + "\r\n";
+    raw += "Content-Length: " + String((int)response.body.length()) + "\r\n";
+    for (const auto& h : response.headers) {
+        raw += h.first + ": " + h.second + "\r\n";
+    }
+    raw += keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+    raw += "\r\n";
+    raw += response.body;
+    return sendAll(fd, raw.c_str(), raw.length());
+}
+
+GatewayServer::GatewayServer(EdgeGateway& gateway) : _gateway(gateway), _listenFd(-1), _running(false) {}
+
+GatewayServer::~GatewayServer() {
+    stop();
+}
+
+bool GatewayServer::start(const String& bindAddress, uint16_t port) {
+    _listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (_listenFd < 0) return false;
+    int one = 1;
+    setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, bindAddress.c_str(), &addr.sin_addr) != 1 ||
+        bind(_listenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(_listenFd, 256) < 0) {
+        close(_listenFd);
+        _listenFd = -1;
+        return false;
+    }
+
+    _running = true;
+    _acceptThread = std::thread(&GatewayServer::acceptLoop, this);
+    return true;
+}
+
+void GatewayServer::stop() {
+    if (!_running) return;
+    _running = false;
+    _acceptThread.join();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (int fd : _connFds) {
+            shutdown(fd, SHUT_RDWR);
+        }
+    }
+    // Connection threads are detached; wait for them to let go of their sockets
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_connFds.empty()) break;
+        }
+        delay(10);
+    }
+    close(_listenFd);
+    _listenFd = -1;
+}
+
+void GatewayServer::acceptLoop() {
+    while (_running) {
+        struct pollfd pfd = {_listenFd, POLLIN, 0};
+        if (poll(&pfd, 1, 100) <= 0) continue;
+
+        int fd = accept(_listenFd, nullptr, nullptr);
+        if (fd < 0) continue;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_connFds.size() >= MAX_CONNECTIONS) {
+            close(fd);
+            continue;
+        }
+        struct timeval tv = {IDLE_TIMEOUT_S, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        _connFds.push_back(fd);
+        std::thread(&GatewayServer::serveConnection, this, fd).detach();
+    }
+}
+
+void GatewayServer::serveConnection(int fd) {
+    serveRequests(fd);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    shutdown(fd, SHUT_RDWR);
+    close(fd);
+    _connFds.erase(std::find(_connFds.begin(), _connFds.end(), fd));
+}
+
+void GatewayServer::serveRequests(int fd) {
+    std::string buffer;
+    char chunk[4096];
+
+    while (_running) {
+        // Request line and headers
+        size_t headerEnd;
+        while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+            if (buffer.size() > MAX_HEADER_BYTES) return;
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) return;
+            buffer.append(chunk, (size_t)n);
+        }
+
+        String head(buffer.substr(0, headerEnd));
+        buffer.erase(0, headerEnd + 4);
+
+        GatewayRequest request;
+        int lineEnd = head.indexOf("\r\n");
+        String requestLine = lineEnd >= 0 ? head.substring(0, lineEnd) : head;
+        int sp1 = requestLine.indexOf(' ');
+        int sp2 = requestLine.indexOf(' ', sp1 + 1);
+        if (sp1 < 0 || sp2 < 0) return;
+        request.method = requestLine.substring(0, sp1);
+        String target = requestLine.substring(sp1 + 1, sp2);
+
+        while (lineEnd >= 0) {
+            int next = head.indexOf("\r\n", lineEnd + 2);
+            String line = head.substring(lineEnd + 2, next < 0 ? head.length() : next);
+            int colon = line.indexOf(':');
+            if (colon > 0) {
+                String name = line.substring(0, colon);
+                name.toLowerCase();
+                String value = line.substring(colon + 1);
+                value.trim();
+                request.headers[name] = value;
+            }
+            lineEnd = next;
+        }
+        bool keepAlive = request.header("connection") != "close";
+
+        // Body
+        long contentLength = request.hasHeader("content-length") ? atol(request.header("content-length").c_str()) : 0;
+        if (contentLength < 0 || contentLength > MAX_BODY_BYTES) {
+            GatewayResponse tooLarge;
+            tooLarge.status = 413;
+            tooLarge.body = "{\"error\":\"Request too large\"}";
+            sendResponse(fd, tooLarge, false);
+            return;
+        }
+        while (buffer.size() < (size_t)contentLength) {
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) return;
+            buffer.append(chunk, (size_t)n);
+        }
+        request.body = String(buffer.substr(0, (size_t)contentLength));
+        buffer.erase(0, (size_t)contentLength);
+
+        GatewayResponse response;
+        if (target.startsWith(String(API_PREFIX) + "/")) {
+            request.path = target.substring(strlen(API_PREFIX));
+            response = _gateway.handle(request);
+        } else if (request.method == "GET" && target == "/gateway") {
+            response.body = _gateway.statsJson();
+        } else {
+            response.status = 404;
+            response.body = "{\"error\":\"Not found\"}";
+        }
+
+        if (!sendResponse(fd, response, keepAlive) || !keepAlive) return;
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef GATEWAY_SERVER_H
+#define GATEWAY_SERVER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "edge_gateway.h"
+
+// The gateway's HTTP/1.1 listener for panels: a thread per connection
+// (panels open one per request), keep-alive honoured, requests under
+// /api/device handed to EdgeGateway::handle(). GET /gateway returns its stats.
+class GatewayServer {
+public:
+    explicit GatewayServer(EdgeGateway& gateway);
+    ~GatewayServer();
+
+    bool start(const String& bindAddress, uint16_t port);
+    void stop();
+
+private:
+    EdgeGateway& _gateway;
+    int _listenFd;
+    std::atomic<bool> _running;
+    std::thread _acceptThread;
+    std::mutex _mutex;
+    std::vector<int> _connFds;
+
+    void acceptLoop();
+    void serveConnection(int fd);
+    void serveRequests(int fd);
+};
+
+#endif // GATEWAY_SERVER_H
@@ -0,0 +1,204 @@
+#!/usr/bin/env python3
+"""Symbolize a panel CPU profile and render it as a flame graph.
+
+Input is the text dump from GET /profile on an env:esp32-cyd-profile build:
+'#' header lines, then "<core> <count> <pc> <return address>..." in hex,
+innermost first. Addresses are resolved with the toolchain's addr2line
+against the firmware.elf of the exact build that was running.
+
+    python3 tools/profile/flamegraph.py panel-profile.txt --svg profile.svg
+    python3 tools/profile/flamegraph.py panel-profile.txt --folded profile.folded
+
+The folded output also works with flamegraph.pl, inferno or speedscope.
+"""
+
+import argparse
+import glob
+import html
+import os
+import shutil
+import subprocess
+import sys
+import urllib.request
+import zlib
+
+DEFAULT_ELF = ".pio/build/esp32-cyd-profile/firmware.elf"
+ADDR2LINE = "xtensa-esp32-elf-addr2line"
+
+
+def find_addr2line():
+    found = shutil.which(ADDR2LINE)
+    if found:
+        return found
+    pattern = os.path.expanduser("~/.platformio/packages/toolchain-xtensa*/bin/" + ADDR2LINE)
+    matches = sorted(glob.glob(pattern))
+    return matches[-1] if matches else None
+
+
+def read_profile(source):
+    if source.startswith("http://") or source.startswith("https://"):
+        with urllib.request.urlopen(source, timeout=30) as response:
+            return response.read().decode("utf-8")
+    with open(source, encoding="utf-8") as f:
+        return f.read()
+
+
+def parse_profile(text):
+    """Returns (header dict, [(core, count, [pc, ...])])."""
+    header = {}
+    samples = []
+    for line in text.splitlines():
+        line = line.strip()
+        if not line:
+            continue
+        if line.startswith("#"):
+            parts = line[1:].split()
+            if len(parts) >= 2 and parts[0] == "hz":
+                header["hz"] = int(parts[1])
+            elif len(parts) >= 6 and parts[0] == "core":
+                header.setdefault("cores", {})[int(parts[1])] = (int(parts[3]), int(parts[5]))
+            continue
+        fields = line.split()
+        core, count = int(fields[0]), int(fields[1])
+        samples.append((core, count, [int(pc, 16) for pc in fields[2:]]))
+    return header, samples
+
+
+def symbolize(addr2line, elf, addresses):
+    """Maps each address to its inline chain of function names, outermost first."""
+    names = {}
+    if not addresses:
+        return names
+    ordered = sorted(addresses)
+    output = subprocess.run(
+        [addr2line, "-a", "-f", "-i", "-C", "-e", elf] + ["0x%08x" % a for a in ordered],
+        check=True, capture_output=True, text=True).stdout.splitlines()
+
+    # "-a" starts each group with the address, then -i lists (function,
+    # file:line) pairs from the innermost inlined function out to the real one
+    current = None
+    expect_function = True
+    for line in output:
+        if line.startswith("0x"):
+            current = int(line, 16)
+            names[current] = []
+            expect_function = True
+        elif current is not None:
+            if expect_function and line != "??":
+                names[current].append(line)
+            expect_function = not expect_function
+    for address in ordered:
+        chain = names.get(address) or ["0x%08x" % address]
+        names[address] = list(reversed(chain))
+    return names
+
+
+def fold(samples, names, split_cores):
+    folded = {}
+    for core, count, pcs in samples:
+        frames = ["core%d" % core] if split_cores else []
+        for pc in reversed(pcs):
+            frames.extend(names.get(pc, ["0x%08x" % pc]))
+        key = ";".join(f.replace(";", ":") for f in frames)
+        folded[key] = folded.get(key, 0) + count
+    return folded
+
+
+def render_svg(folded, title, width=1200, row=16):
+    root = {"name": "all", "count": 0, "children": {}}
+    for stack, count in folded.items():
+        node = root
+        node["count"] += count
+        for frame in stack.split(";"):
+            node = node["children"].setdefault(frame, {"name": frame, "count": 0, "children": {}})
+            node["count"] += count
+
+    def depth(node):
+        return 1 + max((depth(c) for c in node["children"].values()), default=0)
+
+    total = max(root["count"], 1)
+    levels = depth(root)
+    height = (levels + 2) * row
+    rects = []
+
+    def place(node, x, level):
+        w = node["count"] * width / total
+        if w < 0.5:
+            return
+        y = height - (level + 1) * row
+        hue = zlib.crc32(node["name"].encode()) % 60
+        pct = 100.0 * node["count"] / total
+        label = html.escape(node["name"])
+        rects.append(
+            '<g><title>%s (%d samples, %.1f%%)</title>'
+            '<rect x="%.1f" y="%d" width="%.1f" height="%d" fill="hsl(%d,90%%,60%%)" stroke="#fff" stroke-width="0.5"/>'
+            '%s</g>' % (label, node["count"], pct, x, y, w, row - 1, hue,
+                        '<text x="%.1f" y="%d">%s</text>' % (x + 3, y + row - 4, label[:int(w / 7)])
+                        if w > 30 else ""))
+        cx = x
+        for child in sorted(node["children"].values(), key=lambda c: c["name"]):
+            place(child, cx, level + 1)
+            cx += child["count"] * width / total
+
+    place(root, 0, 0)
+    return ('<svg xmlns="http://www.w3.org/2000/svg" width="%d" height="%d" '
+            'font-family="monospace" font-size="11">'
+            '<text x="%d" y="%d" text-anchor="middle" font-size="14">%s</text>%s</svg>\n'
+            % (width, height, width // 2, row, html.escape(title), "".join(rects)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("profile", help="profile dump file, or the panel's /profile?session=... URL")
+    parser.add_argument("--elf", default=DEFAULT_ELF, help="firmware.elf of the running build (default: %(default)s)")
+    parser.add_argument("--addr2line", help="path to xtensa-esp32-elf-addr2line (default: PATH or ~/.platformio)")
+    parser.add_argument("--folded", help="write folded stacks here ('-' for stdout)")
+    parser.add_argument("--svg", help="write an SVG flame graph here")
+    parser.add_argument("--core", type=int, help="only include samples from this core")
+    parser.add_argument("--merge-cores", action="store_true", help="don't split the graph by core")
+    args = parser.parse_args()
+
+    header, samples = parse_profile(read_profile(args.profile))
+    if args.core is not None:
+        samples = [s for s in samples if s[0] == args.core]
+    if not samples:
+        sys.exit("profile has no samples")
+
+    addr2line = args.addr2line or find_addr2line()
+    if not addr2line:
+        sys.exit("%s not found; pass --addr2line" % ADDR2LINE)
+    if not os.path.exists(args.elf):
+        sys.exit("%s not found; pass --elf for the build that produced the profile" % args.elf)
+
+    addresses = {pc for _, _, pcs in samples for pc in pcs}
+    names = symbolize(addr2line, args.elf, addresses)
+    folded = fold(samples, names, split_cores=not args.merge_cores)
+
+    total = sum(count for _, count, _ in samples)
+    dropped = sum(d for _, d in header.get("cores", {}).values())
+    seconds = total / header["hz"] / max(len(header.get("cores", {})), 1) if header.get("hz") else 0
+    print("%d samples (%.0f s per core), %d dropped, %d distinct stacks"
+          % (total, seconds, dropped, len(folded)), file=sys.stderr)
+
+    if args.folded:
+        lines = "".join("%s %d\n" % (stack, count) for stack, count in sorted(folded.items()))
+        if args.folded == "-":
+            sys.stdout.write(lines)
+        else:
+            with open(args.folded, "w", encoding="utf-8") as f:
+                f.write(lines)
+    if args.svg:
+        with open(args.svg, "w", encoding="utf-8") as f:
+            f.write(render_svg(folded, "Panel CPU profile (%d samples)" % total))
+    if not args.folded and not args.svg:
+        # Top functions by self time
+        self_time = {}
+        for stack, count in folded.items():
+            leaf = stack.split(";")[-1]
+            self_time[leaf] = self_time.get(leaf, 0) + count
+        for name, count in sorted(self_time.items(), key=lambda kv: -kv[1])[:25]:
+            print("%6.1f%%  %s" % (100.0 * count / total, name))
+
+
+if __name__ == "__main__":
+    main()
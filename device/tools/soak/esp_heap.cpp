@@ -0,0 +1,245 @@
+#include "esp_heap.h"
+
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+
+// Block layout: [Header][payload...], blocks tile the region back to back.
+// size includes the header; prevSize lets free() find the previous block.
+struct Header {
+    uint32_t size;
+    uint32_t prevSize;
+    uint32_t used;
+    uint32_t pad;
+};
+
+static const size_t ALIGN = 16;
+static const size_t HEADER = sizeof(Header);
+static const size_t MIN_BLOCK = HEADER + ALIGN;
+
+static uint8_t* region = nullptr;
+static size_t regionSize = 0;
+static size_t freeBytes = 0;     // Sum of free block sizes
+static size_t minFreeBytes = 0;
+static uint32_t usedBlocks = 0;
+static uint64_t failedAllocs = 0;
+
+static thread_local bool deviceThread = false;
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+}
+
+static inline Header* headerOf(void* ptr) {
+    return (Header*)((uint8_t*)ptr - HEADER);
+}
+
+static inline Header* nextOf(Header* h) {
+    uint8_t* next = (uint8_t*)h + h->size;
+    return next < region + regionSize ? (Header*)next : nullptr;
+}
+
+static inline Header* prevOf(Header* h) {
+    return h->prevSize ? (Header*)((uint8_t*)h - h->prevSize) : nullptr;
+}
+
+static inline bool owns(void* ptr) {
+    return region && (uint8_t*)ptr >= region && (uint8_t*)ptr < region + regionSize;
+}
+
+static inline size_t blockSizeFor(size_t size) {
+    size_t payload = (size + ALIGN - 1) & ~(ALIGN - 1);
+    return payload + HEADER;
+}
+
+// Shrink h to need bytes, turning the tail into a free block when big enough
+static void split(Header* h, size_t need) {
+    if (h->size - need < MIN_BLOCK) return;
+
+    Header* rest = (Header*)((uint8_t*)h + need);
+    rest->size = h->size - (uint32_t)need;
+    rest->prevSize = (uint32_t)need;
+    rest->used = 0;
+    h->size = (uint32_t)need;
+
+    Header* after = nextOf(rest);
+    if (after) {
+        after->prevSize = rest->size;
+        if (!after->used) {
+            rest->size += after->size;
+            Header* afterNext = nextOf(rest);
+            if (afterNext) afterNext->prevSize = rest->size;
+        }
+    }
+}
+
+bool espHeapInit(size_t bytes) {
+    bytes &= ~(ALIGN - 1);
+    region = (uint8_t*)__real_malloc(bytes + ALIGN);
+    if (!region) return false;
+    region = (uint8_t*)(((uintptr_t)region + ALIGN - 1) & ~(uintptr_t)(ALIGN - 1));
+    regionSize = bytes;
+
+    Header* first = (Header*)region;
+    first->size = (uint32_t)bytes;
+    first->prevSize = 0;
+    first->used = 0;
+    freeBytes = bytes;
+    minFreeBytes = freeBytes;
+    return true;
+}
+
+void* espHeapAlloc(size_t size) {
+    size_t need = blockSizeFor(size ? size : 1);
+    for (Header* h = (Header*)region; h; h = nextOf(h)) {
+        if (h->used || h->size < need) continue;
+
+        split(h, need);
+        h->used = 1;
+        freeBytes -= h->size;
+        if (freeBytes < minFreeBytes) minFreeBytes = freeBytes;
+        usedBlocks++;
+        return (uint8_t*)h + HEADER;
+    }
+    failedAllocs++;
+    return nullptr;
+}
+
+void espHeapFree(void* ptr) {
+    Header* h = headerOf(ptr);
+    h->used = 0;
+    freeBytes += h->size;
+    usedBlocks--;
+
+    Header* next = nextOf(h);
+    if (next && !next->used) {
+        h->size += next->size;
+    }
+    Header* prev = prevOf(h);
+    if (prev && !prev->used) {
+        prev->size += h->size;
+        h = prev;
+    }
+    next = nextOf(h);
+    if (next) next->prevSize = h->size;
+}
+
+static void* espHeapRealloc(void* ptr, size_t size) {
+    Header* h = headerOf(ptr);
+    size_t need = blockSizeFor(size ? size : 1);
+    size_t oldPayload = h->size - HEADER;
+
+    if (need <= h->size) {
+        size_t before = h->size;
+        split(h, need);
+        freeBytes += before - h->size;
+        return ptr;
+    }
+
+    // Grow into a free neighbour without moving
+    Header* next = nextOf(h);
+    if (next && !next->used && h->size + next->size >= need) {
+        size_t before = h->size;
+        h->size += next->size;
+        Header* after = nextOf(h);
+        if (after) after->prevSize = h->size;
+        split(h, need);
+        freeBytes -= h->size - before;
+        if (freeBytes < minFreeBytes) minFreeBytes = freeBytes;
+        return ptr;
+    }
+
+    void* moved = espHeapAlloc(size);
+    if (!moved) return nullptr;
+    memcpy(moved, ptr, oldPayload < size ? oldPayload : size);
+    espHeapFree(ptr);
+    return moved;
+}
+
+EspHeapStats espHeapStats() {
+    EspHeapStats stats = {};
+    stats.totalBytes = regionSize;
+    stats.freeBytes = freeBytes;
+    stats.minimumFreeBytes = minFreeBytes;
+    stats.allocatedBlocks = usedBlocks;
+    stats.failedAllocations = failedAllocs;
+    for (Header* h = (Header*)region; h; h = nextOf(h)) {
+        if (h->used) continue;
+        stats.freeBlocks++;
+        if (h->size - HEADER > stats.largestFreeBlock) stats.largestFreeBlock = h->size - HEADER;
+    }
+    return stats;
+}
+
+DeviceHeapScope::DeviceHeapScope() : _previous(deviceThread) {
+    deviceThread = true;
+}
+
+DeviceHeapScope::~DeviceHeapScope() {
+    deviceThread = _previous;
+}
+
+HostHeapScope::HostHeapScope() : _previous(deviceThread) {
+    deviceThread = false;
+}
+
+HostHeapScope::~HostHeapScope() {
+    deviceThread = _previous;
+}
+
+// Allocation routing. Firmware code reaches malloc both directly (ArduinoJson)
+// and through operator new (String), so both are intercepted; see env:native_soak.
+// A failed device allocation is counted (the panel would have crashed or
+// dropped data) and then served from the host heap so the run can finish.
+
+extern "C" {
+void* __wrap_malloc(size_t size) {
+    if (!deviceThread) return __real_malloc(size);
+    void* p = espHeapAlloc(size);
+    return p ? p : __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t n, size_t size) {
+    void* p = __wrap_malloc(n * size);
+    if (p) memset(p, 0, n * size);
+    return p;
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    if (!ptr) return __wrap_malloc(size);
+    if (!owns(ptr)) return __real_realloc(ptr, size);
+
+    void* p = espHeapRealloc(ptr, size);
+    if (p) return p;
+    // Out of modelled heap: move the block to the host heap
+    p = __real_malloc(size);
+    size_t old = headerOf(ptr)->size - HEADER;
+    memcpy(p, ptr, old < size ? old : size);
+    espHeapFree(ptr);
+    return p;
+}
+
+void __wrap_free(void* ptr) {
+    if (!ptr) return;
+    if (owns(ptr)) espHeapFree(ptr);
+    else __real_free(ptr);
+}
+}
+
+void* operator new(size_t size) {
+    void* p = __wrap_malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept { __wrap_free(p); }
+void operator delete[](void* p) noexcept { __wrap_free(p); }
+void operator delete(void* p, size_t) noexcept { __wrap_free(p); }
+void operator delete[](void* p, size_t) noexcept { __wrap_free(p); }
@@ -0,0 +1,56 @@
+#ifndef ESP_HEAP_H
+#define ESP_HEAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Model of the ESP32 internal heap (ESP-IDF 4.x multi_heap, as used by the
+// Arduino core): one contiguous region, address-ordered first fit, block
+// headers, split on allocate, coalesce with both neighbours on free and
+// in-place realloc when the next block is free.
+//
+// Host code is 64-bit, so blocks are 16-byte granular with a 16-byte header
+// (ESP32: 4/8 bytes). Absolute numbers therefore run a little pessimistic;
+// trends are what the soak test looks at.
+
+struct EspHeapStats {
+    size_t totalBytes;
+    size_t freeBytes;           // heap_caps_get_free_size()
+    size_t largestFreeBlock;    // heap_caps_get_largest_free_block()
+    size_t minimumFreeBytes;    // heap_caps_get_minimum_free_size()
+    uint32_t allocatedBlocks;
+    uint32_t freeBlocks;
+    uint64_t failedAllocations;
+};
+
+// Allocate the region; must be called before the first DeviceHeapScope
+bool espHeapInit(size_t bytes);
+EspHeapStats espHeapStats();
+
+// Direct access, e.g. to model TLS buffers that live outside the firmware's code
+void* espHeapAlloc(size_t size);
+void espHeapFree(void* ptr);
+
+// While alive, heap calls on this thread (malloc, new, String, ArduinoJson)
+// are served from the modelled heap; everything else uses the host heap.
+// Freeing always goes to whichever heap owns the pointer.
+class DeviceHeapScope {
+public:
+    DeviceHeapScope();
+    ~DeviceHeapScope();
+
+private:
+    bool _previous;
+};
+
+// Inverse: host-side bookkeeping inside a device scope
+class HostHeapScope {
+public:
+    HostHeapScope();
+    ~HostHeapScope();
+
+private:
+    bool _previous;
+};
+
+#endif // ESP_HEAP_H
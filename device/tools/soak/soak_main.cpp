@@ -0,0 +1,624 @@
+// Long-duration soak: runs ApiClient and the host-built firmware modules for
+// simulated months against MockDeviceApi and watches the modelled ESP32 heap.
+//
+//   pio run -e native_soak -t exec                  # 60 simulated days
+//   .pio/build/native_soak/program --days 120 --csv heap.csv
+//
+// The loop below is modelled on the HTTP polling path of loop() in main.cpp,
+// not a copy of it, on a SimulatedClock (so the 49.7-day millis() rollover is
+// crossed): status polls with redraw on change, pings, firmware checks,
+// lost-connection retries, touch sequences (quick book, end meeting, refresh,
+// screen wake), setup page requests and WiFi drops. Intervals come from the
+// runtime config the server sends and the server's poll and retry hints, as on
+// the panel. Drawing is replaced by the String work the UI does for each
+// screen. MQTT, the room group, peer firmware, telemetry uploads, the LED and
+// out-of-hours sleep are not soaked; a change to loop() is not covered here
+// until this loop is changed too.
+//
+// Heap is sampled every simulated hour. The run fails when the largest free
+// block (or free heap) trends down faster than the allowed bytes per day,
+// falls below the TLS minimum, or any allocation fails.
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <mock_device_api.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <time.h>
+#include <vector>
+#include "config.h"
+#include "api_client.h"
+#include "clock.h"
+#include "runtime_config.h"
+#include "text_format.h"
+#include "time_utils.h"
+#include "esp_heap.h"
+
+struct SoakOptions {
+    int days = 60;
+    size_t heapBytes = 110 * 1024;      // Largest internal DRAM block with WiFi up
+    bool tls = true;                    // Model mbedTLS buffers for every request
+    double maxLfbLossPerDay = 64;       // Bytes/day the largest free block may shrink
+    double maxLeakPerDay = 64;          // Bytes/day free heap may shrink
+    size_t minLargestBlock = 26 * 1024; // Needed for a TLS handshake
+    int warmupHours = 24;               // Excluded from trend fitting
+    unsigned seed = 1;
+    String csvPath;
+};
+
+// mbedTLS allocations per HTTPS request on the Arduino core (context and
+// certificate state, 16 KB input record buffer, 4 KB output buffer)
+static const size_t TLS_BLOCKS[] = {4400, 16717, 4429};
+
+static const char* TIMEZONE = "CET-1CEST,M3.5.0,M10.5.0/3";
+static const time_t START_WALL = 1741564800;  // 2025-03-10 00:00 UTC, a Monday
+
+static SoakOptions opts;
+static MockDeviceApi server;
+static std::mt19937 rng;
+
+// Drives nowMs()/wallNow() for everything, including ApiClient and time_utils
+static SimulatedClock simClock(START_WALL);
+
+// --- Simulated room calendar (host heap) ---
+
+struct SimBooking {
+    time_t start;
+    time_t end;
+    std::string id;
+    std::string title;
+    int attendees;
+    bool device;
+};
+
+static std::vector<SimBooking> calendar;
+static time_t calendarUntil = START_WALL;
+static int bookingSeq = 0;
+
+static const char* TITLES[] = {
+    "Weekly sync",
+    "1:1",
+    "Design review",
+    "Interview",
+    "Quarterly business review with regional sales leads and finance - Q1 planning",
+    "All-hands: product roadmap and Q&A with leadership (hybrid, dial-in in invite)",
+    "Kundenworkshop: Einführung neue Plattform - Teil 2 (Übungen)",
+    "Sprint planning",
+    "Budget",
+    "Customer call - Großer Saal overflow",
+};
+
+static std::string isoTime(time_t t) {
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    char buf[32];
+    strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S.000Z", &tm);
+    return buf;
+}
+
+// Fill weekdays 07:00-19:00 UTC with meetings, one day at a time
+static void extendCalendar(time_t until) {
+    while (calendarUntil < until) {
+        time_t day = calendarUntil;
+        calendarUntil += 86400;
+        struct tm tm;
+        gmtime_r(&day, &tm);
+        if (tm.tm_wday == 0 || tm.tm_wday == 6) continue;
+
+        time_t t = day + 7 * 3600;
+        while (t < day + 19 * 3600) {
+            if (std::uniform_int_distribution<int>(0, 9)(rng) < 6) {
+                static const int lengths[] = {30, 45, 60, 90};
+                int minutes = lengths[std::uniform_int_distribution<int>(0, 3)(rng)];
+                SimBooking b;
+                b.start = t;
+                b.end = t + minutes * 60;
+                b.id = "b-" + std::to_string(++bookingSeq);
+                b.title = TITLES[std::uniform_int_distribution<int>(0, 9)(rng)];
+                b.attendees = std::uniform_int_distribution<int>(0, 8)(rng);
+                b.device = false;
+                calendar.push_back(b);
+                t = b.end;
+            }
+            t += std::uniform_int_distribution<int>(1, 4)(rng) * 15 * 60;
+        }
+    }
+}
+
+static void appendBooking(std::string& json, const SimBooking& b, bool current) {
+    json += "{\"id\":\"" + b.id + "\",\"roomId\":\"r-1\",\"userId\":\"";
+    json += b.device ? "device-booking-user" : "u-1";
+    json += "\",\"title\":\"" + b.title + "\",\"description\":\"\",\"startTime\":\"" + isoTime(b.start);
+    json += "\",\"endTime\":\"" + isoTime(b.end) + "\",\"attendees\":[";
+    for (int i = 0; i < b.attendees; i++) {
+        json += (i ? ",\"" : "\"") + std::string("person") + std::to_string(i) + "@example.com\"";
+    }
+    json += "],\"externalGuests\":\"[]\",\"status\":\"confirmed\",\"createdAt\":\"2025-03-01T10:00:00.000Z\","
+            "\"updatedAt\":\"2025-03-01T10:00:00.000Z\",\"room\":{\"id\":\"r-1\",\"name\":\"Boardroom\","
+            "\"capacity\":12,\"amenities\":[\"projector\",\"whiteboard\"],\"floor\":\"5\",\"quickBookDurations\":[15,30,45,60]}";
+    if (current) json += b.device ? ",\"isDeviceBooking\":true" : ",\"isDeviceBooking\":false";
+    json += "}";
+}
+
+// Same selection as GET /api/device/status: the running booking and the next three
+static std::string statusJson() {
+    const SimBooking* current = nullptr;
+    std::vector<const SimBooking*> upcoming;
+    for (const SimBooking& b : calendar) {
+        if (b.start <= wallNow() && wallNow() < b.end) current = &b;
+        else if (b.start > wallNow() && upcoming.size() < 3) upcoming.push_back(&b);
+    }
+
+    std::string json = "{\"room\":{\"id\":\"r-1\",\"name\":\"Boardroom\",\"capacity\":12,"
+        "\"amenities\":[\"projector\",\"whiteboard\"],\"floor\":\"5\",\"address\":\"Main St 1\","
+        "\"description\":\"Large boardroom\",\"isActive\":true,\"parkId\":\"default\",\"openingHour\":7,"
+        "\"closingHour\":19,\"lockedToCompanyIds\":[],\"quickBookDurations\":[15,30,45,60],"
+        "\"bookingEmail\":null,\"createdAt\":\"2025-01-10T08:00:00.000Z\",\"updatedAt\":\"2025-01-10T08:00:00.000Z\"},"
+        "\"currentBooking\":";
+    if (current) appendBooking(json, *current, true);
+    else json += "null";
+    json += ",\"upcomingBookings\":[";
+    for (size_t i = 0; i < upcoming.size(); i++) {
+        if (i) json += ",";
+        appendBooking(json, *upcoming[i], false);
+    }
+    json += "],\"isAvailable\":";
+    json += current ? "false}" : "true}";
+    return json;
+}
+
+static void advanceCalendar() {
+    HostHeapScope host;
+    // Drop bookings that ended over a day ago
+    size_t keep = 0;
+    for (size_t i = 0; i < calendar.size(); i++) {
+        if (calendar[i].end > wallNow() - 86400) calendar[keep++] = calendar[i];
+    }
+    calendar.resize(keep);
+    extendCalendar(wallNow() + 8 * 86400);
+    server.setResponse("GET", "/status", 200, String(statusJson()));
+}
+
+static bool roomFree(time_t from, time_t to) {
+    for (const SimBooking& b : calendar) {
+        if (b.start < to && from < b.end) return false;
+    }
+    return true;
+}
+
+// --- Device side (modelled heap) ---
+
+struct DeviceState {
+    ApiClient apiClient;
+    RoomStatus currentStatus;
+    RoomStatus lastStatus;
+    String buttonLabels[8];
+    int buttonCount = 0;
+    String sessionToken;
+    RuntimeConfig runtimeConfig = defaultRuntimeConfig();
+    bool connectionLost = false;
+    bool forceRedraw = true;
+    bool screenOn = true;
+    uint32_t lastStatusUpdate = 0;
+    uint32_t lastPing = 0;
+    uint32_t lastFirmwareCheck = 0;
+    uint32_t lastConnectionRetry = 0;
+    uint32_t connectionRetryMs = CONNECTION_RETRY_INTERVAL;
+    uint32_t lastActivityTime = 0;
+};
+
+static DeviceState deviceState;  // Globals live in .bss on the panel, not on the heap
+static DeviceState* device = &deviceState;
+static bool wifiDown = false;
+static uint64_t tlsFailures = 0;
+static uint64_t requests = 0;
+
+static void addButton(const String& label) {
+    if (device->buttonCount < 8) device->buttonLabels[device->buttonCount++] = label;
+}
+
+// String work of UIManager::showRoomStatus
+static void renderRoomStatus(const RoomStatus& status) {
+    device->buttonCount = 0;
+    String name = status.room.name;
+    if (status.isAvailable) {
+        addButton("Book");
+    } else if (status.currentBooking.isValid) {
+        String until = "Until " + formatLocalTime(status.currentBooking.endTime, TIMEZONE);
+        if (status.currentBooking.isDeviceBooking) addButton("EndMeeting");
+    }
+    for (int i = 0; i < status.upcomingCount; i++) {
+        const Booking& b = status.upcomingBookings[i];
+        String title = truncateText(b.title, 28);
+        String range = formatLocalTime(b.startTime, TIMEZONE) + " - " + formatLocalTime(b.endTime, TIMEZONE);
+    }
+    addButton("Refresh");
+}
+
+// String work of UIManager::showError / showBookingResult
+static void renderMessage(const String& message) {
+    device->buttonCount = 0;
+    String lines[8];
+    wrapText(message, 35, lines, 2);
+    addButton("Retry");
+}
+
+// Run one ApiClient call with the TLS session's buffers held around it
+template <typename F>
+static void withConnection(F call) {
+    requests++;
+    void* tls[3] = {nullptr, nullptr, nullptr};
+    if (opts.tls) {
+        for (int i = 0; i < 3; i++) {
+            tls[i] = espHeapAlloc(TLS_BLOCKS[i]);
+        }
+        if (!tls[0] || !tls[1] || !tls[2]) {
+            // Handshake would fail for lack of memory
+            tlsFailures++;
+            for (void* p : tls) {
+                if (p) espHeapFree(p);
+            }
+            if (!wifiDown) {
+                HostHeapScope host;
+                MockFault fault = MockFault::reset();
+                fault.times = 1;
+                server.addFault("*", "*", fault);
+            }
+            call();
+            return;
+        }
+    }
+    call();
+    for (int i = 2; i >= 0; i--) {
+        if (tls[i]) espHeapFree(tls[i]);
+    }
+}
+
+// updateRoomStatus() and handleRoomStatus() in main.cpp, less the LED,
+// preferences and room group
+static void updateRoomStatus() {
+    withConnection([] { device->currentStatus = device->apiClient.getRoomStatus(); });
+    device->lastStatusUpdate = device->currentStatus.fetchedAt;
+    if (device->currentStatus.hasConfig) {
+        device->runtimeConfig = device->currentStatus.config;
+        device->apiClient.setConfigVersion(device->runtimeConfig.version);
+    }
+
+    if (device->currentStatus.isValid) {
+        device->connectionLost = false;
+        if (device->forceRedraw || !roomStatusesAreEqual(device->currentStatus, device->lastStatus)) {
+            if (device->screenOn) renderRoomStatus(device->currentStatus);
+            device->forceRedraw = false;
+        }
+        device->lastStatus = device->currentStatus;
+    } else {
+        uint32_t retryAfter = device->apiClient.retryAfterMs();
+        device->connectionRetryMs = retryAfter > 0 ? retryAfter
+            : CONNECTION_RETRY_INTERVAL + std::uniform_int_distribution<uint32_t>(0, CONNECTION_RETRY_JITTER_MS - 1)(rng);
+        device->connectionLost = true;
+        device->lastConnectionRetry = nowMs();
+        if (retryAfter > 0 && device->lastStatus.isValid) {
+            device->currentStatus = device->lastStatus;
+            return;
+        }
+        String errorMsg = device->currentStatus.errorMessage.length() > 0 ?
+                          device->currentStatus.errorMessage : "Cannot reach server";
+        errorMsg += "\n\nRetrying in " + String(device->connectionRetryMs / 1000) + "s...";
+        renderMessage(errorMsg);
+    }
+}
+
+static void checkForFirmwareUpdate() {
+    withConnection([] { device->apiClient.reportFirmwareVersion(FIRMWARE_VERSION); });
+    FirmwareUpdateResult result;
+    withConnection([&result] { result = device->apiClient.checkForFirmwareUpdate(); });
+}
+
+// One pass of the polling part of loop() at nowMs()
+static void deviceLoop() {
+    const RuntimeConfig& config = device->runtimeConfig;
+    if (device->screenOn && nowMs() - device->lastActivityTime > config.screenTimeoutMs) {
+        device->screenOn = false;
+    }
+
+    if (device->connectionLost) {
+        if (nowMs() - device->lastConnectionRetry > device->connectionRetryMs) {
+            device->forceRedraw = true;
+            updateRoomStatus();
+            device->lastConnectionRetry = nowMs();
+        }
+        return;
+    }
+
+    if (nowMs() - device->lastStatusUpdate > device->apiClient.pollIntervalMs(config.statusPollMs)) {
+        updateRoomStatus();
+    }
+    if (nowMs() - device->lastPing > config.pingMs) {
+        withConnection([] { device->apiClient.ping(); });
+        device->lastPing = nowMs();
+    }
+    if (nowMs() - device->lastFirmwareCheck > config.firmwareCheckMs) {
+        checkForFirmwareUpdate();
+        device->lastFirmwareCheck = nowMs();
+    }
+}
+
+// Someone walks up to the panel: wake, then book, end the meeting or refresh
+static void touchSequence() {
+    device->lastActivityTime = nowMs();
+    if (!device->screenOn) {
+        device->screenOn = true;
+        if (device->currentStatus.isValid) renderRoomStatus(device->currentStatus);
+    }
+    if (device->connectionLost || !device->currentStatus.isValid) return;
+
+    int roll = std::uniform_int_distribution<int>(0, 9)(rng);
+    if (device->currentStatus.isAvailable && roll < 6) {
+        // Book -> duration menu -> confirm
+        device->buttonCount = 0;
+        for (int i = 0; i < device->currentStatus.room.quickBookDurationCount; i++) {
+            String label = formatDurationLabel(device->currentStatus.room.quickBookDurations[i]);
+            addButton(String(device->currentStatus.room.quickBookDurations[i]));
+        }
+        int duration = device->currentStatus.room.quickBookDurations[0];
+        String confirm = String(duration) + " minutes";
+
+        {
+            HostHeapScope host;
+            SimBooking b = {wallNow(), wallNow() + duration * 60, "q-" + std::to_string(++bookingSeq),
+                            "Quick Booking", 0, true};
+            if (roomFree(b.start, b.end)) {
+                calendar.push_back(b);
+                std::sort(calendar.begin(), calendar.end(),
+                          [](const SimBooking& x, const SimBooking& y) { return x.start < y.start; });
+                std::string json;
+                appendBooking(json, b, true);
+                server.setResponse("POST", "/quick-book", 201, String(json));
+            } else {
+                server.setResponse("POST", "/quick-book", 400, "{\"error\":\"Room is not available for booking\"}");
+            }
+            advanceCalendar();
+        }
+
+        QuickBookResult result;
+        withConnection([&result, duration] { result = device->apiClient.quickBook("Quick Booking", duration); });
+        renderMessage(result.message);
+        device->forceRedraw = true;
+        updateRoomStatus();
+    } else if (device->currentStatus.currentBooking.isDeviceBooking && roll < 8) {
+        {
+            HostHeapScope host;
+            for (SimBooking& b : calendar) {
+                if (b.device && b.start <= wallNow() && wallNow() < b.end) b.end = wallNow();
+            }
+            server.setResponse("POST", "/end-meeting", 200, "{\"message\":\"Meeting ended\"}");
+            advanceCalendar();
+        }
+        EndMeetingResult result;
+        withConnection([&result] { result = device->apiClient.endMeeting(); });
+        renderMessage(result.message);
+        device->forceRedraw = true;
+        updateRoomStatus();
+    } else {
+        device->forceRedraw = true;
+        updateRoomStatus();
+    }
+}
+
+// Admin opens the setup page: same String building as handleLogin/handleRoot
+static void setupPageRequest() {
+    device->sessionToken = "";
+    for (int i = 0; i < 32; i++) {
+        device->sessionToken += String(std::uniform_int_distribution<int>(0, 15)(rng), HEX);
+    }
+    String chunk = "<form action=\"/save?session=" + device->sessionToken + "\" method=\"POST\">"
+        "<input type=\"hidden\" name=\"session\" value=\"" + device->sessionToken + "\">"
+        "<input type=\"text\" name=\"apiUrl\" value=\"" + device->apiClient.getApiUrl() + "\">";
+    String masked = device->apiClient.getDeviceToken().substring(0, 4) + "..." ;
+    chunk = "<div class=\"current masked\">Current token: " + masked + "</div>";
+    for (int i = 0; i < 30; i++) {
+        String selected = (i == 2) ? " selected" : "";
+        chunk = "<option value=\"" + String(TIMEZONE) + "\"" + selected + ">Europe/Zone " + String(i) + "</option>";
+    }
+}
+
+// --- Harness ---
+
+struct HeapSample {
+    double day;
+    EspHeapStats stats;
+};
+
+// Least-squares slope of value(day) over the samples after warmup
+template <typename F>
+static double slopePerDay(const std::vector<HeapSample>& samples, F value) {
+    double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (const HeapSample& s : samples) {
+        if (s.day * 24 < opts.warmupHours) continue;
+        double x = s.day;
+        double y = (double)value(s.stats);
+        n++;
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    double denom = n * sxx - sx * sx;
+    return (n < 2 || denom == 0) ? 0 : (n * sxy - sx * sy) / denom;
+}
+
+static void usage() {
+    printf("Usage: soak [options]\n"
+           "  --days N                simulated days (default 60)\n"
+           "  --heap BYTES            modelled heap size (default %zu)\n"
+           "  --no-tls                don't model TLS buffers (plain http)\n"
+           "  --max-lfb-loss BYTES    allowed largest-free-block loss per day (default 64)\n"
+           "  --max-leak BYTES        allowed free-heap loss per day (default 64)\n"
+           "  --min-lfb BYTES         minimum largest free block (default %zu)\n"
+           "  --seed N                random seed (default 1)\n"
+           "  --csv FILE              write hourly heap samples\n",
+           opts.heapBytes, opts.minLargestBlock);
+}
+
+static bool parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        String arg = argv[i];
+        if (arg == "--no-tls") {
+            opts.tls = false;
+            continue;
+        }
+        if (i + 1 >= argc) return false;
+        const char* value = argv[++i];
+        if (arg == "--days") opts.days = atoi(value);
+        else if (arg == "--heap") opts.heapBytes = strtoul(value, nullptr, 10);
+        else if (arg == "--max-lfb-loss") opts.maxLfbLossPerDay = atof(value);
+        else if (arg == "--max-leak") opts.maxLeakPerDay = atof(value);
+        else if (arg == "--min-lfb") opts.minLargestBlock = strtoul(value, nullptr, 10);
+        else if (arg == "--seed") opts.seed = (unsigned)atoi(value);
+        else if (arg == "--csv") opts.csvPath = value;
+        else return false;
+    }
+    return opts.days > 0;
+}
+
+int main(int argc, char** argv) {
+    if (!parseArgs(argc, argv)) {
+        usage();
+        return 2;
+    }
+
+    rng.seed(opts.seed);
+    setClock(&simClock);
+    if (!espHeapInit(opts.heapBytes) || !server.start()) {
+        printf("Setup failed\n");
+        return 2;
+    }
+    server.setResponse("GET", "/ping", 200, "{\"status\":\"ok\",\"timestamp\":\"2025-03-10T00:00:00.000Z\"}");
+    server.setResponse("POST", "/firmware/report", 200, "{\"message\":\"Firmware version reported\"}");
+    server.setResponse("GET", "/firmware/check", 200,
+        "{\"updateAvailable\":false,\"currentVersion\":\"" FIRMWARE_VERSION "\",\"latestVersion\":\"" FIRMWARE_VERSION "\"}");
+    advanceCalendar();
+
+    std::vector<HeapSample> samples;
+    EspHeapStats boot;
+    {
+        DeviceHeapScope dev;
+        device->apiClient.setApiUrl(server.url());
+        device->apiClient.setDeviceToken("soak-device-token");
+        // setup(): report firmware, first status
+        withConnection([] { device->apiClient.reportFirmwareVersion(FIRMWARE_VERSION); });
+        updateRoomStatus();
+        device->lastPing = nowMs();
+        device->lastFirmwareCheck = nowMs();
+        boot = espHeapStats();
+    }
+    printf("Soak: %d days, %zu byte heap, TLS %s; boot free %zu, largest block %zu\n",
+           opts.days, opts.heapBytes, opts.tls ? "on" : "off", boot.freeBytes, boot.largestFreeBlock);
+
+    // Events are drawn per simulated minute
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    uint32_t wifiDownUntil = 0;
+    const long totalSeconds = (long)opts.days * 86400;
+
+    for (long second = 1; second <= totalSeconds; second++) {
+        simClock.advanceSeconds(1);  // nowMs() wraps after 49.7 days, as millis() does
+
+        if (second % 60 == 0) {
+            {
+                HostHeapScope host;
+                advanceCalendar();
+            }
+            struct tm tm;
+            time_t wall = wallNow();
+            gmtime_r(&wall, &tm);
+            bool workHours = tm.tm_wday != 0 && tm.tm_wday != 6 && tm.tm_hour >= 7 && tm.tm_hour < 19;
+
+            // WiFi drops about twice a week for 20-90 s
+            if (!wifiDown && chance(rng) < 2.0 / (7 * 1440)) {
+                wifiDown = true;
+                wifiDownUntil = nowMs() + std::uniform_int_distribution<uint32_t>(20, 90)(rng) * 1000;
+                server.addFault("*", "*", MockFault::reset());
+            }
+
+            DeviceHeapScope dev;
+            if (workHours && !wifiDown && chance(rng) < 4.0 / (12 * 60)) touchSequence();
+            if (!wifiDown && chance(rng) < 1.0 / (14 * 1440)) setupPageRequest();
+        }
+
+        if (wifiDown && (int32_t)(nowMs() - wifiDownUntil) >= 0) {
+            wifiDown = false;
+            server.clearFaults();
+            // Reconnect path: reload status straight away
+            DeviceHeapScope dev;
+            device->forceRedraw = true;
+            updateRoomStatus();
+        }
+
+        {
+            DeviceHeapScope dev;
+            deviceLoop();
+        }
+
+        if (second % 3600 == 0) {
+            HeapSample sample = {second / 86400.0, espHeapStats()};
+            samples.push_back(sample);
+            if (second % 86400 == 0) {
+                printf("day %3ld: free %6zu  largest %6zu  min %6zu  blocks %4u/%u  requests %llu\n",
+                       second / 86400, sample.stats.freeBytes, sample.stats.largestFreeBlock,
+                       sample.stats.minimumFreeBytes, sample.stats.allocatedBlocks, sample.stats.freeBlocks,
+                       (unsigned long long)requests);
+                fflush(stdout);
+            }
+        }
+    }
+
+    if (opts.csvPath.length() > 0) {
+        FILE* f = fopen(opts.csvPath.c_str(), "w");
+        if (f) {
+            fprintf(f, "day,free,largest_free_block,min_free,allocated_blocks,free_blocks\n");
+            for (const HeapSample& s : samples) {
+                fprintf(f, "%.4f,%zu,%zu,%zu,%u,%u\n", s.day, s.stats.freeBytes, s.stats.largestFreeBlock,
+                        s.stats.minimumFreeBytes, s.stats.allocatedBlocks, s.stats.freeBlocks);
+            }
+            fclose(f);
+        }
+    }
+
+    double lfbSlope = slopePerDay(samples, [](const EspHeapStats& s) { return s.largestFreeBlock; });
+    double freeSlope = slopePerDay(samples, [](const EspHeapStats& s) { return s.freeBytes; });
+    size_t lowestLfb = boot.largestFreeBlock;
+    for (const HeapSample& s : samples) {
+        if (s.day * 24 >= opts.warmupHours && s.stats.largestFreeBlock < lowestLfb) lowestLfb = s.stats.largestFreeBlock;
+    }
+    EspHeapStats end = espHeapStats();
+
+    printf("\nLargest free block trend: %+.1f bytes/day (limit -%.0f), lowest %zu (limit %zu)\n",
+           lfbSlope, opts.maxLfbLossPerDay, lowestLfb, opts.minLargestBlock);
+    printf("Free heap trend:          %+.1f bytes/day (limit -%.0f), minimum ever %zu\n",
+           freeSlope, opts.maxLeakPerDay, end.minimumFreeBytes);
+    printf("Failed allocations: %llu, TLS handshakes without memory: %llu, requests: %llu\n",
+           (unsigned long long)end.failedAllocations, (unsigned long long)tlsFailures, (unsigned long long)requests);
+
+    bool pass = true;
+    if (lfbSlope < -opts.maxLfbLossPerDay) {
+        printf("FAIL: largest free block is degrading (fragmentation)\n");
+        pass = false;
+    }
+    if (freeSlope < -opts.maxLeakPerDay) {
+        printf("FAIL: free heap is shrinking (leak)\n");
+        pass = false;
+    }
+    if (lowestLfb < opts.minLargestBlock) {
+        printf("FAIL: largest free block fell below the TLS minimum\n");
+        pass = false;
+    }
+    if (end.failedAllocations > 0) {
+        printf("FAIL: allocations failed\n");
+        pass = false;
+    }
+    printf("%s\n", pass ? "PASS" : "FAIL");
+
+    server.stop();
+    return pass ? 0 : 1;
+}
@@ -1,6 +1,6 @@
 import React, { useState, useEffect, useRef } from 'react';
 import { api } from '../services/api';
-import { Device, Firmware } from '../types';
+import { Device, DeviceTelemetryMetric, DeviceTelemetryReport, Firmware } from '../types';
 import { formatDistanceToNow } from 'date-fns';
 
 export function DevicesPage() {
@@ -19,12 +19,21 @@ export function DevicesPage() {
   const [selectedDevices, setSelectedDevices] = useState<Set<string>>(new Set());
   const [selectedFirmwareVersion, setSelectedFirmwareVersion] = useState('');
   const [scheduling, setScheduling] = useState(false);
+  const [telemetryMetric, setTelemetryMetric] = useState<DeviceTelemetryMetric>('poll');
+  const [telemetryHours, setTelemetryHours] = useState(24);
+  const [telemetry, setTelemetry] = useState<DeviceTelemetryReport | null>(null);
   const fileInputRef = useRef<HTMLInputElement>(null);
 
   useEffect(() => {
     loadData();
   }, []);
 
+  useEffect(() => {
+    api.getWorstPanels(telemetryMetric, telemetryHours)
+      .then(setTelemetry)
+      .catch(() => setTelemetry(null));
+  }, [telemetryMetric, telemetryHours]);
+
   const loadData = async () => {
     try {
       setLoading(true);
@@ -141,6 +150,8 @@ export function DevicesPage() {
     }
   };
 
+  const formatMs = (ms: number | null) => ms === null ? '–' : ms < 1000 ? `${ms} ms` : `${(ms / 1000).toFixed(1)} s`;
+
   const formatFileSize = (bytes: number) => {
     if (bytes < 1024) return `${bytes} B`;
     if (bytes < 1024 * 1024) return `${(bytes / 1024).toFixed(1)} KB`;
@@ -348,6 +359,64 @@ export function DevicesPage() {
         </div>
       </div>
 
+      {/* Fleet Health - worst panels by the selected metric */}
+      <div className="fleet-health-panel">
+        <div className="panel-header">
+          <h2>Fleet Health</h2>
+          <div className="fleet-health-filters">
+            <select value={telemetryMetric} onChange={e => setTelemetryMetric(e.target.value as DeviceTelemetryMetric)}>
+              <option value="poll">Slowest polls</option>
+              <option value="errors">Most poll errors</option>
+              <option value="heap">Lowest free heap</option>
+              <option value="rssi">Weakest WiFi</option>
+              <option value="redraw">Slowest redraws</option>
+              <option value="reboots">Most reboots</option>
+            </select>
+            <select value={telemetryHours} onChange={e => setTelemetryHours(parseInt(e.target.value, 10))}>
+              <option value={1}>Last hour</option>
+              <option value={24}>Last 24 hours</option>
+              <option value={24 * 7}>Last 7 days</option>
+              <option value={24 * 30}>Last 30 days</option>
+            </select>
+          </div>
+        </div>
+        {!telemetry || telemetry.panels.length === 0 ? (
+          <p className="empty-state">No telemetry received for this period.</p>
+        ) : (
+          <div className="table-container compact">
+            <table className="data-table">
+              <thead>
+                <tr>
+                  <th>Device</th>
+                  <th>Poll (avg / max)</th>
+                  <th>Poll errors</th>
+                  <th>Min free heap</th>
+                  <th>WiFi (avg / min)</th>
+                  <th>Redraw (avg / max)</th>
+                  <th>Reboots</th>
+                </tr>
+              </thead>
+              <tbody>
+                {telemetry.panels.map(panel => (
+                  <tr key={panel.deviceId}>
+                    <td>
+                      <div className="device-name">{panel.deviceName}</div>
+                      <div className="device-room">{panel.roomName || 'No room assigned'} · {panel.firmwareVersion || 'Unknown'}</div>
+                    </td>
+                    <td>{formatMs(panel.pollMsAvg)} / {formatMs(panel.pollMsMax)}</td>
+                    <td>{(panel.pollErrorRate * 100).toFixed(1)}% of {panel.polls}</td>
+                    <td>{panel.heapMin === null ? '–' : formatFileSize(panel.heapMin)}</td>
+                    <td>{panel.rssiAvg === null ? '–' : `${panel.rssiAvg} / ${panel.rssiMin} dBm`}</td>
+                    <td>{formatMs(panel.redrawMsAvg)} / {formatMs(panel.redrawMsMax)}</td>
+                    <td>{panel.reboots}</td>
+                  </tr>
+                ))}
+              </tbody>
+            </table>
+          </div>
+        )}
+      </div>
+
       {/* Device Detail Modal */}
       {selectedDevice && (
         <div className="modal-overlay" onClick={() => setSelectedDevice(null)}>
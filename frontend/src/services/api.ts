@@ -1,4 +1,4 @@
-import { AuthResponse, User, Company, MeetingRoom, Booking, UserRole, Settings, Device, Park, Firmware, TwoFaSetupResponse, TwoFaStatusResponse, TrustedDeviceInfo, ExternalGuest, GuestVisit, LdapConfig, LdapSyncResult, SsoConfig, SsoDiscoveryResult, CalendarToken, CalendarTokenCreated } from '../types';
+import { AuthResponse, User, Company, MeetingRoom, Booking, UserRole, Settings, DeviceRuntimeConfig, Device, DeviceTelemetryMetric, DeviceTelemetryReport, Park, Firmware, TwoFaSetupResponse, TwoFaStatusResponse, TrustedDeviceInfo, ExternalGuest, GuestVisit, LdapConfig, LdapSyncResult, SsoConfig, SsoDiscoveryResult, CalendarToken, CalendarTokenCreated } from '../types';
 
 const API_BASE = process.env.REACT_APP_API_URL || 'http://localhost:3001/api';
 
@@ -137,6 +137,13 @@ class ApiService {
     });
   }
 
+  async updateDeviceConfig(data: DeviceRuntimeConfig): Promise<Settings> {
+    return this.request<Settings>('/settings/device-config', {
+      method: 'PUT',
+      body: JSON.stringify(data)
+    });
+  }
+
   // Keep me logged in / activity tracking
   getKeepLoggedIn(): boolean {
     return localStorage.getItem('keepLoggedIn') === 'true';
@@ -574,6 +581,13 @@ class ApiService {
     await this.request(`/devices/${id}`, { method: 'DELETE' });
   }
 
+  async getWorstPanels(metric: DeviceTelemetryMetric, hours = 24): Promise<DeviceTelemetryReport> {
+    const params = new URLSearchParams({ metric, hours: String(hours) });
+    const selectedPark = this.getSelectedParkId();
+    if (selectedPark) params.append('parkId', selectedPark);
+    return this.request<DeviceTelemetryReport>(`/devices/telemetry/worst?${params.toString()}`);
+  }
+
   // Parks
   async getParks(includeInactive = false): Promise<Park[]> {
     const query = includeInactive ? '?includeInactive=true' : '';
@@ -106,6 +106,24 @@ export interface Settings {
   bannerLevel?: 'info' | 'warning' | 'critical';
   bannerStartsAt?: string | null;
   bannerEndsAt?: string | null;
+  // Runtime config pushed to display devices
+  deviceConfig?: DeviceRuntimeConfig;
+  deviceConfigVersion?: number;
+}
+
+// Unset values use the firmware default
+export interface DeviceRuntimeConfig {
+  statusPollSeconds?: number;
+  pingSeconds?: number;
+  firmwareCheckSeconds?: number;
+  screenTimeoutSeconds?: number;
+  ledBrightness?: number;
+  quickBookConfirm?: boolean;
+  bookingResultSeconds?: number;
+  apiUrls?: string[];
+  mqttUrl?: string;
+  roomGroup?: boolean;
+  peerFirmware?: boolean;
 }
 
 export interface Booking {
@@ -177,6 +195,36 @@ export interface Device {
   updatedAt?: string;
 }
 
+export type DeviceTelemetryMetric = 'poll' | 'errors' | 'heap' | 'rssi' | 'redraw' | 'reboots';
+
+// One panel's telemetry over the requested range
+export interface DeviceTelemetrySummary {
+  deviceId: string;
+  deviceName: string;
+  roomName: string | null;
+  firmwareVersion: string | null;
+  lastSeenAt: string | null;
+  samples: number;
+  polls: number;
+  pollErrorRate: number;      // 0-1
+  pollMsAvg: number | null;
+  pollMsMax: number;
+  heapMin: number | null;     // Bytes
+  rssiAvg: number | null;     // dBm
+  rssiMin: number | null;
+  redrawMsAvg: number | null;
+  redrawMsMax: number;
+  reboots: number;
+}
+
+export interface DeviceTelemetryReport {
+  metric: DeviceTelemetryMetric;
+  hours: number;
+  resolution: number;         // Seconds per stored bucket the summary was built from
+  since: string;
+  panels: DeviceTelemetrySummary[];
+}
+
 // Firmware types for OTA updates
 export interface Firmware {
   id: string;